@@ -0,0 +1,210 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "event.hpp"
+#include "msg_dispatch.hpp"
+
+using namespace lob;
+
+namespace
+{
+
+  constexpr size_t kEvents = 1 << 18;
+
+  // Random 64-byte events as gen_synth writes them. skewed rewrites the type
+  // bits to an ITCH-like mix (50% add, 35% delete, 10% cancel, 5% execute).
+  std::vector<std::uint8_t> make_events(bool skewed)
+  {
+    std::vector<std::uint8_t> buf(kEvents * kEventSize);
+    std::mt19937_64 rng(42);
+    for (size_t i = 0; i < kEvents; ++i)
+    {
+      std::uint64_t w[8];
+      for (auto &x : w)
+        x = rng();
+      if (skewed)
+      {
+        const std::uint64_t r = rng() % 100;
+        const std::uint64_t t = r < 50 ? 0 : r < 85 ? 3 : r < 95 ? 2 : 1;
+        w[0] = (w[0] & ~std::uint64_t{3}) | t;
+      }
+      std::memcpy(buf.data() + i * kEventSize, w, sizeof(w));
+    }
+    return buf;
+  }
+
+  const std::vector<std::uint8_t> &events(bool skewed)
+  {
+    static const std::vector<std::uint8_t> uniform = make_events(false);
+    static const std::vector<std::uint8_t> itch = make_events(true);
+    return skewed ? itch : uniform;
+  }
+
+  template <class Apply>
+  void run(benchmark::State &state, Apply apply)
+  {
+    const auto &buf = events(state.range(0) != 0);
+    std::uint64_t accepted = 0;
+    for (auto _ : state)
+    {
+      std::array<OrderBook, kSymbolCount> books;
+      for (size_t i = 0; i < kEvents; ++i)
+        accepted += apply(books, buf.data() + i * kEventSize, i);
+      do_not_optimize_away(accepted);
+    }
+    state.SetItemsProcessed(state.iterations() * kEvents);
+  }
+
+  // Handlers that only fold the decoded fields, so the dispatch benchmarks
+  // below measure decode and dispatch rather than the book.
+  struct Tally
+  {
+    std::uint64_t sum{0};
+  };
+
+  template <MsgType T>
+  struct TallyHandler
+  {
+    static bool apply(Tally &t, const Event &e)
+    {
+      t.sum += e.ref ^ static_cast<std::uint64_t>(e.px) ^ e.qty ^ static_cast<std::uint64_t>(T);
+      return true;
+    }
+  };
+
+  using TallyDispatch =
+      BasicMsgDispatch<Tally, TallyHandler, MsgType::Add, MsgType::Delete, MsgType::Cancel, MsgType::Execute>;
+
+  // The jump-table alternative to BasicMsgDispatch's compare chain, kept
+  // here only to be measured against it: one indirect call per event
+  // through a table built at compile time, unlisted types hitting reject.
+  template <class Target, template <MsgType> class Handler, MsgType... Ts>
+  struct TableDispatch
+  {
+    using Step = bool (*)(Target &, const std::uint8_t *, Event &);
+
+    template <MsgType T>
+    static bool step(Target &b, const std::uint8_t *p, Event &e)
+    {
+      decode_body<T>(p, e);
+      return Handler<T>::apply(b, e);
+    }
+
+    static bool reject(Target &, const std::uint8_t *, Event &) { return false; }
+
+    static constexpr std::array<Step, kMsgTypeCount> make_table() noexcept
+    {
+      std::array<Step, kMsgTypeCount> t{};
+      t.fill(&reject);
+      ((t[static_cast<size_t>(Ts)] = &step<Ts>), ...);
+      return t;
+    }
+    static constexpr std::array<Step, kMsgTypeCount> kTable = make_table();
+
+    static bool apply(Target &b, const std::uint8_t *p, Event &e)
+    {
+      return kTable[static_cast<size_t>(e.type)](b, p, e);
+    }
+  };
+
+  using TallyTable =
+      TableDispatch<Tally, TallyHandler, MsgType::Add, MsgType::Delete, MsgType::Cancel, MsgType::Execute>;
+  using BookTable =
+      TableDispatch<OrderBook, MsgHandler, MsgType::Add, MsgType::Delete, MsgType::Cancel, MsgType::Execute>;
+
+  template <class Apply>
+  void run_tally(benchmark::State &state, Apply apply)
+  {
+    const auto &buf = events(state.range(0) != 0);
+    for (auto _ : state)
+    {
+      Tally t;
+      for (size_t i = 0; i < kEvents; ++i)
+        apply(t, buf.data() + i * kEventSize, i);
+      do_not_optimize_away(t.sum);
+    }
+    state.SetItemsProcessed(state.iterations() * kEvents);
+  }
+
+} // namespace
+
+static void BM_DecodeDispatch_Switch(benchmark::State &state)
+{
+  run_tally(state, [](Tally &t, const std::uint8_t *p, size_t i)
+            {
+              const Event e = decode_event(p, i);
+              switch (e.type)
+              {
+              case MsgType::Add:
+                return TallyHandler<MsgType::Add>::apply(t, e);
+              case MsgType::Execute:
+                return TallyHandler<MsgType::Execute>::apply(t, e);
+              case MsgType::Cancel:
+                return TallyHandler<MsgType::Cancel>::apply(t, e);
+              case MsgType::Delete:
+                return TallyHandler<MsgType::Delete>::apply(t, e);
+              }
+              return false;
+            });
+}
+
+static void BM_DecodeDispatch_Chain(benchmark::State &state)
+{
+  run_tally(state, [](Tally &t, const std::uint8_t *p, size_t i)
+            {
+              Event e = decode_header(p, i);
+              return TallyDispatch::apply(t, p, e);
+            });
+}
+
+static void BM_DecodeDispatch_Table(benchmark::State &state)
+{
+  run_tally(state, [](Tally &t, const std::uint8_t *p, size_t i)
+            {
+              Event e = decode_header(p, i);
+              return TallyTable::apply(t, p, e);
+            });
+}
+
+// Baseline: full decode, then a runtime switch on the message type.
+static void BM_Dispatch_Switch(benchmark::State &state)
+{
+  run(state, [](auto &books, const std::uint8_t *p, size_t i)
+      {
+        const Event e = decode_event(p, i);
+        return apply_event(books[e.symbol], e);
+      });
+}
+
+// Header decode, then a chain of inlined per-type steps.
+static void BM_Dispatch_Chain(benchmark::State &state)
+{
+  run(state, [](auto &books, const std::uint8_t *p, size_t i)
+      {
+        Event e = decode_header(p, i);
+        return FullDispatch::apply(books[e.symbol], p, e);
+      });
+}
+
+// Header decode, then the compile-time jump table.
+static void BM_Dispatch_Table(benchmark::State &state)
+{
+  run(state, [](auto &books, const std::uint8_t *p, size_t i)
+      {
+        Event e = decode_header(p, i);
+        return BookTable::apply(books[e.symbol], p, e);
+      });
+}
+
+BENCHMARK(BM_Dispatch_Switch)->ArgName("itch_mix")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Dispatch_Chain)->ArgName("itch_mix")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Dispatch_Table)->ArgName("itch_mix")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DecodeDispatch_Switch)->ArgName("itch_mix")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DecodeDispatch_Chain)->ArgName("itch_mix")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DecodeDispatch_Table)->ArgName("itch_mix")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
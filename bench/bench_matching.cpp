@@ -0,0 +1,184 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "matching_engine.hpp"
+
+namespace
+{
+
+  constexpr std::int64_t kMid = 1'000'000;
+  constexpr std::uint32_t kOrdersPerLevel = 16;
+
+  struct Op
+  {
+    enum Kind : std::uint8_t
+    {
+      submit,
+      cancel,
+      replace
+    } kind;
+    lob::OrderRequest o;
+  };
+
+  // Resting book of `levels` prices per side, kOrdersPerLevel orders each.
+  void prefill(lob::MatchingEngine &m, std::int64_t levels)
+  {
+    std::uint64_t id = 1;
+    for (std::int64_t l = 1; l <= levels; ++l)
+      for (std::uint32_t k = 0; k < kOrdersPerLevel; ++k)
+      {
+        m.submit({id++, kMid - l, 100, lob::Side::Bid});
+        m.submit({id++, kMid + l, 100, lob::Side::Ask});
+      }
+  }
+
+  // Order flow for a book `levels` deep: passive adds across the depth,
+  // cancels and replaces of live orders, and marketable IOC/market orders
+  // that walk one or more levels. Ids are resolved against an engine run
+  // alongside, so the benchmark replays exactly this flow.
+  const std::vector<Op> &order_flow(std::int64_t levels)
+  {
+    static std::vector<std::pair<std::int64_t, std::vector<Op>>> cache;
+    for (const auto &c : cache)
+      if (c.first == levels)
+        return c.second;
+
+    std::vector<Op> ops;
+    ops.reserve(1 << 18);
+    lob::MatchingEngine m(static_cast<std::size_t>(levels) * kOrdersPerLevel * 4);
+    prefill(m, levels);
+    std::vector<std::uint64_t> live;
+    for (std::uint64_t id = 1; id <= static_cast<std::uint64_t>(levels) * kOrdersPerLevel * 2; ++id)
+      live.push_back(id);
+    std::uint64_t next_id = live.size() + 1;
+    std::mt19937_64 rng(0xB00C5ULL);
+    auto depth_px = [&](lob::Side s)
+    {
+      const auto d = 1 + static_cast<std::int64_t>(rng() % static_cast<std::uint64_t>(levels));
+      return s == lob::Side::Bid ? kMid - d : kMid + d;
+    };
+    while (ops.size() < (1u << 18))
+    {
+      const auto pick = rng() % 100;
+      const lob::Side side = rng() & 1 ? lob::Side::Bid : lob::Side::Ask;
+      Op op{Op::submit, {}};
+      if (pick < 30 && !live.empty())
+      {
+        const std::size_t k = rng() % live.size();
+        op = Op{Op::cancel, {live[k]}};
+        live[k] = live.back();
+        live.pop_back();
+        m.cancel(op.o.id);
+      }
+      else if (pick < 40 && !live.empty())
+      {
+        const std::uint64_t id = live[rng() % live.size()];
+        const std::uint32_t slot = m.book().slot_of(id);
+        if (slot == lob::OrderBook::kNil)
+          continue;
+        const lob::Side s = m.book().order_side(slot);
+        op = Op{Op::replace, {id, depth_px(s), 1 + static_cast<std::uint32_t>(rng() % 200), s}};
+        m.replace(id, op.o.px, op.o.qty);
+      }
+      else if (pick < 85)
+      {
+        op.o = {next_id++, depth_px(side), 1 + static_cast<std::uint32_t>(rng() % 200), side,
+                pick < 80 ? lob::OrderType::Limit : lob::OrderType::PostOnly};
+        if (m.submit(op.o).resting)
+          live.push_back(op.o.id);
+      }
+      else
+      {
+        // Marketable: up to a few levels through the touch.
+        const std::int64_t through = 1 + static_cast<std::int64_t>(rng() % 4);
+        op.o = {next_id++, side == lob::Side::Bid ? kMid + through : kMid - through,
+                1 + static_cast<std::uint32_t>(rng() % (kOrdersPerLevel * 200)), side,
+                pick < 95 ? lob::OrderType::IOC : (pick < 98 ? lob::OrderType::FOK : lob::OrderType::Market)};
+        m.submit(op.o);
+      }
+      ops.push_back(op);
+    }
+    cache.emplace_back(levels, std::move(ops));
+    return cache.back().second;
+  }
+
+} // namespace
+
+// Orders/sec and per-order latency percentiles on books of range(0) levels
+// per side. Each iteration replays the whole flow on a freshly filled book.
+static void BM_Match_OrderFlow(benchmark::State &state)
+{
+  const std::int64_t levels = state.range(0);
+  const auto &ops = order_flow(levels);
+  std::vector<std::uint32_t> lat_ns;
+  lat_ns.reserve(ops.size() * 8);
+  std::uint64_t fills = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    lob::MatchingEngine m(static_cast<std::size_t>(levels) * kOrdersPerLevel * 4);
+    prefill(m, levels);
+    state.ResumeTiming();
+    for (const Op &op : ops)
+    {
+      const auto t0 = std::chrono::steady_clock::now();
+      if (op.kind == Op::submit)
+        m.submit(op.o);
+      else if (op.kind == Op::cancel)
+        m.cancel(op.o.id);
+      else
+        m.replace(op.o.id, op.o.px, op.o.qty);
+      const auto t1 = std::chrono::steady_clock::now();
+      fills += m.fills().size();
+      if (lat_ns.size() < lat_ns.capacity())
+        lat_ns.push_back(static_cast<std::uint32_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+    }
+    do_not_optimize_away(m.book().size());
+  }
+  auto pct = [&](double p)
+  {
+    const auto k = static_cast<std::size_t>(p * static_cast<double>(lat_ns.size() - 1));
+    std::nth_element(lat_ns.begin(), lat_ns.begin() + static_cast<std::ptrdiff_t>(k), lat_ns.end());
+    return static_cast<double>(lat_ns[k]);
+  };
+  state.counters["p50_ns"] = pct(0.50);
+  state.counters["p99_ns"] = pct(0.99);
+  state.counters["p99.9_ns"] = pct(0.999);
+  state.counters["fills_per_order"] =
+      static_cast<double>(fills) / static_cast<double>(state.iterations() * ops.size());
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ops.size()));
+}
+
+// Cost of the match walk alone: an IOC that sweeps range(0) full levels of
+// the ask side, refilled outside the timed region.
+static void BM_Match_Sweep(benchmark::State &state)
+{
+  const std::int64_t sweep = state.range(0);
+  lob::MatchingEngine m(static_cast<std::size_t>(sweep + 1000) * kOrdersPerLevel * 4,
+                        static_cast<std::size_t>(sweep) * kOrdersPerLevel);
+  prefill(m, 1000);
+  std::uint64_t id = 1ull << 40, fills = 0;
+  for (auto _ : state)
+  {
+    m.submit({id++, kMid + sweep, static_cast<std::uint32_t>(sweep * kOrdersPerLevel * 100), lob::Side::Bid,
+              lob::OrderType::IOC});
+    fills += m.fills().size();
+    state.PauseTiming();
+    for (std::int64_t l = 1; l <= sweep; ++l)
+      for (std::uint32_t k = 0; k < kOrdersPerLevel; ++k)
+        m.submit({id++, kMid + l, 100, lob::Side::Ask});
+    state.ResumeTiming();
+  }
+  state.counters["fills"] = static_cast<double>(fills) / static_cast<double>(state.iterations());
+  state.SetItemsProcessed(state.iterations() * sweep * kOrdersPerLevel);
+}
+
+BENCHMARK(BM_Match_OrderFlow)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Match_Sweep)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kNanosecond);
@@ -0,0 +1,140 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "bqs/adapters/order_codecs.hpp"
+#include "bqs/adapters/tcp_order_flow.hpp"
+
+namespace
+{
+
+  namespace bqa = bqs::adapters;
+
+  std::vector<bqa::NewOrder> &synthetic_orders()
+  {
+    static std::vector<bqa::NewOrder> orders = []
+    {
+      std::vector<bqa::NewOrder> data(4096);
+      for (std::size_t i = 0; i < data.size(); ++i)
+      {
+        auto &o = data[i];
+        o.cl_ord_id = 1'000'000 + i;
+        o.transact_ns = 1'760'000'000'000'000'000ull + i * 1'000;
+        o.price = 1'000'000 + static_cast<std::int64_t>(i % 500) * 25;
+        o.qty = 100 + static_cast<std::uint32_t>(i % 900);
+        std::memcpy(o.symbol.data(), "AAPL", 4);
+        o.side = i % 2 ? bqa::OrderSide::sell : bqa::OrderSide::buy;
+        o.type = i % 10 == 0 ? bqa::OrderType::market : bqa::OrderType::limit;
+      }
+      return data;
+    }();
+    return orders;
+  }
+
+  template <typename Codec>
+  void encode_loop(benchmark::State &state, Codec &codec)
+  {
+    auto &orders = synthetic_orders();
+    std::vector<std::byte> buf(Codec::kMaxBytes);
+    std::size_t i = 0, bytes = 0;
+    for (auto _ : state)
+    {
+      const std::size_t n = codec.encode(orders[i++ & (orders.size() - 1)], buf.data());
+      bytes += n;
+      do_not_optimize_away(buf[n - 1]);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+  }
+
+} // namespace
+
+// Encode ns/order: typed encoders writing in place.
+static void BM_OrderEncode_Sbe(benchmark::State &state)
+{
+  bqa::SbeNewOrderCodec codec;
+  encode_loop(state, codec);
+}
+
+static void BM_OrderEncode_Fix(benchmark::State &state)
+{
+  bqa::FixNewOrderCodec codec("BQL", "EXCH");
+  encode_loop(state, codec);
+}
+
+// Baseline: what send_raw() callers did before, one std::string per order.
+static void BM_OrderEncode_FixString(benchmark::State &state)
+{
+  auto &orders = synthetic_orders();
+  std::uint64_t seq = 1;
+  std::size_t i = 0;
+  for (auto _ : state)
+  {
+    const auto &o = orders[i++ & (orders.size() - 1)];
+    std::string body = "35=D\x01"
+                       "49=BQL\x01"
+                       "56=EXCH\x01"
+                       "34=" +
+                       std::to_string(seq++) + "\x01"
+                                               "11=" +
+                       std::to_string(o.cl_ord_id) + "\x01"
+                                                     "55=" +
+                       std::string(o.symbol.data(), strnlen(o.symbol.data(), 8)) + "\x01"
+                                                                                   "54=" +
+                       std::to_string(static_cast<int>(o.side)) + "\x01"
+                                                                  "38=" +
+                       std::to_string(o.qty) + "\x01"
+                                               "40=" +
+                       std::to_string(static_cast<int>(o.type)) + "\x01"
+                                                                  "44=" +
+                       std::to_string(static_cast<double>(o.price) / 1e4) + "\x01";
+    std::string msg = "8=FIX.4.4\x01"
+                      "9=" +
+                      std::to_string(body.size()) + "\x01" + body;
+    unsigned sum = 0;
+    for (const char c : msg)
+      sum += static_cast<unsigned char>(c);
+    msg += "10=" + std::to_string(sum % 256 + 1000).substr(1) + "\x01";
+    do_not_optimize_away(msg.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Encode plus queue into the session send buffer and push to a local sink.
+static void BM_OrderSend_Sbe_TcpSink(benchmark::State &state)
+{
+  bqa::TcpSink sink;
+  std::string err;
+  if (!sink.start(0, err))
+  {
+    state.SkipWithError(err.c_str());
+    return;
+  }
+  bqa::OrderFlowOptions opts;
+  opts.flush_each = false;
+  bqa::TcpOrderFlowAdapter<bqa::SbeNewOrderCodec> tx({}, opts);
+  bqa::AdapterConfig cfg;
+  cfg.endpoint = sink.endpoint();
+  tx.configure(cfg);
+  tx.connect();
+  auto &orders = synthetic_orders();
+  std::size_t i = 0;
+  for (auto _ : state)
+  {
+    tx.send(orders[i++ & (orders.size() - 1)]);
+    if ((i & 63) == 0)
+      tx.flush();
+  }
+  tx.disconnect();
+  state.counters["send_calls"] = static_cast<double>(tx.stats().send_calls);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_OrderEncode_Sbe)->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_OrderEncode_Fix)->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_OrderEncode_FixString)->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_OrderSend_Sbe_TcpSink)->Unit(benchmark::kNanosecond)->UseRealTime();
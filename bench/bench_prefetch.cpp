@@ -0,0 +1,124 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "event.hpp"
+
+using namespace lob;
+
+namespace
+{
+
+  constexpr size_t kOps = 1 << 20;
+
+  struct Setup
+  {
+    OrderBook book;
+    std::vector<Event> flow;
+  };
+
+  // A book with `resting` orders over 256 ticks a side, and a flow that keeps
+  // its size steady: 40% adds of new ids, 40% deletes and 20% one-lot
+  // partial cancels of uniformly chosen resting orders. Every message is an
+  // index probe, and at millions of orders almost every probe (and the pool
+  // entries behind it) misses the cache.
+  const Setup &setup(size_t resting)
+  {
+    static std::vector<std::pair<size_t, Setup>> cache;
+    for (const auto &c : cache)
+      if (c.first == resting)
+        return c.second;
+
+    Setup s;
+    std::mt19937_64 rng(0x9F37ULL);
+    std::vector<std::uint64_t> live;
+    live.reserve(resting + kOps);
+    auto add = [&](std::uint64_t id)
+    {
+      const Side side = rng() & 1 ? Side::Ask : Side::Bid;
+      const std::int64_t off = static_cast<std::int64_t>(rng() % 256);
+      Event e{};
+      e.ref = id;
+      e.side = side;
+      e.px = side == Side::Bid ? kBasePriceTicks - 1 - off : kBasePriceTicks + off;
+      e.qty = 1000;
+      return e;
+    };
+    std::uint64_t next_id = 1;
+    for (; next_id <= resting; ++next_id)
+    {
+      const Event e = add(next_id);
+      s.book.add(e.ref, e.side, e.px, e.qty);
+      live.push_back(next_id);
+    }
+    s.flow.reserve(kOps);
+    for (size_t i = 0; i < kOps; ++i)
+    {
+      const std::uint64_t r = rng() % 10;
+      if (r < 4)
+      {
+        s.flow.push_back(add(next_id));
+        live.push_back(next_id++);
+        continue;
+      }
+      const size_t k = rng() % live.size();
+      Event e{};
+      e.ref = live[k];
+      if (r < 8)
+      {
+        e.type = MsgType::Delete;
+        live[k] = live.back();
+        live.pop_back();
+      }
+      else
+      {
+        e.type = MsgType::Cancel;
+        e.qty = 1;
+      }
+      s.flow.push_back(e);
+    }
+    cache.emplace_back(resting, std::move(s));
+    return cache.back().second;
+  }
+
+} // namespace
+
+// Throughput of the flow against the book vs. lookahead distance k, using
+// replay --prefetch-distance's pipeline: the index line of the message k
+// ahead, then the order's pool entries k/2 ahead. k = 0 is no prefetching.
+static void BM_Prefetch_Distance(benchmark::State &state)
+{
+  const Setup &s = setup(static_cast<size_t>(state.range(0)));
+  const size_t k = static_cast<size_t>(state.range(1));
+  const size_t half = k / 2;
+  const Event *flow = s.flow.data();
+  std::uint64_t accepted = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    OrderBook book = s.book;
+    state.ResumeTiming();
+    for (size_t i = 0; i < kOps; ++i)
+    {
+      if (k != 0)
+      {
+        if (i + k < kOps)
+          book.prefetch_index(flow[i + k].ref);
+        if (half != 0 && i + half < kOps && flow[i + half].type != MsgType::Add)
+          book.prefetch_order(flow[i + half].ref);
+      }
+      accepted += apply_event(book, flow[i]);
+    }
+    do_not_optimize_away(accepted);
+  }
+  state.SetItemsProcessed(state.iterations() * kOps);
+}
+
+BENCHMARK(BM_Prefetch_Distance)
+    ->ArgNames({"resting", "k"})
+    ->ArgsProduct({{1 << 20, 1 << 22}, {0, 1, 2, 4, 8, 16, 32, 64}})
+    ->Unit(benchmark::kMillisecond);
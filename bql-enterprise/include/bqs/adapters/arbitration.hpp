@@ -0,0 +1,169 @@
+#pragma once
+
+#include "bqs/adapters/histogram.hpp"
+#include "bqs/adapters/market_data_adapter.hpp"
+#include "bqs/adapters/mold_udp_adapter.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace bqs::adapters
+{
+
+    struct ArbitrationOptions
+    {
+        // How long a gap on the leading line may wait for the other line to
+        // fill it before later messages are released (0 = release at once).
+        int gap_wait_us{500};
+        // Sequence numbers remembered for duplicate suppression (rounded up
+        // to a power of two); older copies are dropped as stale.
+        std::size_t window{1 << 16};
+        // How long next_message() waits for data on either line.
+        int wait_ms{100};
+    };
+
+    struct ArbitrationLineStats
+    {
+        // Copies received on this line.
+        std::uint64_t messages{0};
+        // Copies that were first and got emitted.
+        std::uint64_t wins{0};
+        // Copies that lost to the other line.
+        std::uint64_t duplicates{0};
+        // Kernel receive time of a losing copy minus that of the winner (ns).
+        Log2Histogram lag_ns{};
+    };
+
+    struct ArbitrationStats
+    {
+        std::uint64_t emitted{0};
+        // Holes left open (neither line had the message in time) and their size.
+        std::uint64_t gaps{0};
+        std::uint64_t missing{0};
+        // Hole messages that arrived after later ones were released; they
+        // are dropped, not emitted out of order, and stay in `missing`.
+        std::uint64_t late{0};
+        // Copies older than the duplicate window.
+        std::uint64_t stale{0};
+        // Messages read() dropped because they can never fit its buffer.
+        std::uint64_t malformed{0};
+        ArbitrationLineStats line[2]{};
+
+        [[nodiscard]] double win_rate(int i) const noexcept
+        {
+            const std::uint64_t total = line[0].wins + line[1].wins;
+            return total ? static_cast<double>(line[i].wins) / static_cast<double>(total) : 0.0;
+        }
+    };
+
+    // Which sequence numbers in a sliding window have been emitted: one bit
+    // per sequence (slot = sequence mod span) plus the winning copy's
+    // receive time for lag accounting. The owner clears slots as the window
+    // slides forward.
+    class SequenceWindow
+    {
+    public:
+        explicit SequenceWindow(std::size_t span = 1 << 16)
+            : mask_(std::bit_ceil(std::max<std::size_t>(span, 64)) - 1), bits_((mask_ + 1) / 64, 0), ts_(mask_ + 1, 0)
+        {
+        }
+
+        [[nodiscard]] std::size_t span() const noexcept { return mask_ + 1; }
+        [[nodiscard]] bool seen(std::uint64_t seq) const noexcept
+        {
+            return (bits_[(seq & mask_) >> 6] >> (seq & 63)) & 1u;
+        }
+        [[nodiscard]] std::uint64_t first_ts(std::uint64_t seq) const noexcept { return ts_[seq & mask_]; }
+
+        void set(std::uint64_t seq, std::uint64_t ts) noexcept
+        {
+            bits_[(seq & mask_) >> 6] |= 1ull << (seq & 63);
+            ts_[seq & mask_] = ts;
+        }
+
+        // Forgets [from, to): slots about to be reused for those sequences.
+        void clear(std::uint64_t from, std::uint64_t to) noexcept
+        {
+            if (to - from >= span())
+            {
+                std::fill(bits_.begin(), bits_.end(), 0);
+                return;
+            }
+            for (std::uint64_t s = from; s < to; ++s)
+                bits_[(s & mask_) >> 6] &= ~(1ull << (s & 63));
+        }
+
+    private:
+        std::size_t mask_;
+        std::vector<std::uint64_t> bits_;
+        std::vector<std::uint64_t> ts_;
+    };
+
+    // Arbitrates the redundant A and B lines of one MoldUDP64 feed
+    // (AdapterConfig::endpoint is "groupA:port,groupB:port"). Each sequence
+    // number is emitted once, from whichever line delivered it first; the
+    // other copy is counted against its line together with how far it
+    // trailed. Output is always in sequence: a hole that outlives
+    // gap_wait_us is given up and later messages are released; a copy that
+    // fills it afterwards is dropped (counted as late).
+    class ArbitratedMarketDataAdapter final : public IMarketDataAdapter
+    {
+    public:
+        // line options apply to both lines; their wait_ms is forced to 0.
+        explicit ArbitratedMarketDataAdapter(UdpFeedOptions line = {}, ArbitrationOptions opts = {});
+        ArbitratedMarketDataAdapter(const ArbitratedMarketDataAdapter &) = delete;
+        ArbitratedMarketDataAdapter &operator=(const ArbitratedMarketDataAdapter &) = delete;
+
+        void configure(const AdapterConfig &cfg) override;
+        void connect() override;
+        void disconnect() override;
+        std::size_t read(std::span<std::byte> out) override;
+        void request_gap_fill(const SequenceRange &missing) override;
+        [[nodiscard]] AdapterStatus status() const override { return status_; }
+
+        // Next arbitrated message; false if none within wait_ms or both
+        // lines have ended (see status()).
+        bool next_message(MoldMessage &out);
+
+        [[nodiscard]] const ArbitrationStats &stats() const noexcept { return stats_; }
+        [[nodiscard]] const MoldUdpMarketDataAdapter &line(int i) const noexcept { return *lines_[i].feed; }
+
+    private:
+        struct Line
+        {
+            MoldUdpMarketDataAdapter *feed{nullptr};
+            MoldMessage msg{};
+            bool has{false};
+        };
+
+        [[nodiscard]] static bool live(const Line &l) noexcept;
+        // Pulls line i until it holds a message not yet emitted, or runs dry.
+        void refill(int i);
+        void emit(int i, MoldMessage &out);
+        // Waits for data on lines without a pending message.
+        void wait_lines(std::chrono::steady_clock::time_point until);
+
+        ArbitrationOptions opts_;
+        AdapterConfig cfg_{};
+        AdapterStatus status_{};
+        ArbitrationStats stats_{};
+        MoldUdpMarketDataAdapter a_;
+        MoldUdpMarketDataAdapter b_;
+        Line lines_[2];
+        SequenceWindow window_;
+        // Lowest sequence after everything emitted in order so far.
+        std::uint64_t next_{0};
+        std::uint64_t first_{0};
+        bool hole_open_{false};
+        std::chrono::steady_clock::time_point hole_deadline_{};
+
+        bool has_pending_{false};
+        MoldMessage pending_{};
+    };
+
+} // namespace bqs::adapters
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace bqs::adapters
+{
+
+    // Compression of an archived capture. zstd and LZ4 are each optional at
+    // build time (BQS_HAVE_ZSTD / BQS_HAVE_LZ4); codec_available() says which
+    // this build can decode.
+    enum class Codec : std::uint8_t
+    {
+        none,
+        zstd,
+        lz4,
+    };
+
+    // Codec of a file from its first bytes (frame magic). A leading
+    // skippable frame does not tell the two apart and reads as zstd.
+    [[nodiscard]] Codec detect_codec(std::span<const std::byte> head) noexcept;
+    // Same for the file at path, looking past leading skippable frames
+    // (none if it cannot be read).
+    [[nodiscard]] Codec detect_codec(const std::string &path) noexcept;
+    [[nodiscard]] const char *codec_name(Codec c) noexcept;
+    [[nodiscard]] bool codec_available(Codec c) noexcept;
+
+    // One independently decodable frame of a compressed file.
+    struct CompressedFrame
+    {
+        static constexpr std::uint64_t kUnknownSize = ~std::uint64_t{0};
+
+        std::uint64_t offset{0};
+        std::uint64_t bytes{0};
+        // Decompressed size if the frame header records it.
+        std::uint64_t content_bytes{kUnknownSize};
+    };
+
+    // Splits a whole compressed file into its frames, from the frame headers
+    // alone (LZ4 block headers are walked; nothing is decompressed).
+    // Skippable frames are left out. False with err on a truncated or
+    // foreign frame, or a codec this build lacks.
+    bool scan_frames(Codec c, std::span<const std::byte> file, std::vector<CompressedFrame> &out,
+                     std::string &err);
+
+    // Decompression state for one thread; reused frame after frame.
+    class FrameDecoder
+    {
+    public:
+        FrameDecoder() = default;
+        ~FrameDecoder();
+        FrameDecoder(const FrameDecoder &) = delete;
+        FrameDecoder &operator=(const FrameDecoder &) = delete;
+
+        // Decodes one whole frame into out, which is resized to the frame's
+        // content (its capacity is kept, so a reused vector stops
+        // allocating once it has seen the largest frame).
+        bool decode_frame(Codec c, std::span<const std::byte> frame, std::uint64_t content_bytes,
+                          std::vector<std::byte> &out, std::string &err);
+
+        // Incremental form: decodes from in[in_pos..] into out[out_pos..],
+        // advancing both. frame_done is set when a frame ends; the next call
+        // starts the next frame.
+        bool decode_some(Codec c, std::span<const std::byte> in, std::size_t &in_pos, std::span<std::byte> out,
+                         std::size_t &out_pos, bool &frame_done, std::string &err);
+
+    private:
+        bool ready(Codec c, std::string &err);
+
+        void *zstd_{nullptr};
+        void *lz4_{nullptr};
+    };
+
+    // Compresses in as a sequence of independent frames of frame_bytes
+    // input each (each records its content size), so a reader can decode
+    // them in parallel. Appends to out.
+    bool encode_frames(Codec c, std::span<const std::byte> in, std::size_t frame_bytes, int level,
+                       std::vector<std::byte> &out, std::string &err);
+
+} // namespace bqs::adapters
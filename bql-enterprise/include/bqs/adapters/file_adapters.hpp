@@ -0,0 +1,321 @@
+#pragma once
+
+#include "bqs/adapters/codec.hpp"
+#include "bqs/adapters/market_data_adapter.hpp"
+#include "bqs/adapters/pacing.hpp"
+#include "bqs/adapters/uring.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bqs::adapters
+{
+
+    // Options shared by the capture-file adapters. AdapterConfig::endpoint is
+    // the file path.
+    struct FileSourceOptions
+    {
+        // Byte offset to start from (e.g. a checkpoint's input offset).
+        std::uint64_t start_offset{0};
+        // Upper bound for one next_frame() span; 0 selects kDefaultFrameBytes.
+        std::size_t frame_bytes{0};
+        // Pre-fault the whole mapping at connect() (mmap adapter only).
+        bool populate{false};
+        // io_uring adapter: size of each read (rounded up to 4 KiB), reads
+        // kept in flight, and whether to bypass the page cache (O_DIRECT;
+        // ignored where the filesystem refuses it).
+        std::size_t read_bytes{1 << 20};
+        unsigned queue_depth{4};
+        bool direct{false};
+        // Compressed adapter: decompression threads (0 = one per CPU) and
+        // decoded units held ahead of the consumer (0 = two per thread).
+        unsigned decode_threads{0};
+        unsigned decode_window{0};
+        PacingConfig pacing{};
+
+        static constexpr std::size_t kDefaultFrameBytes = 256 * 1024;
+    };
+
+    // Streams a capture file with read(2). status().last_sequence is the
+    // absolute byte offset just past the last byte delivered.
+    class FileMarketDataAdapter final : public IMarketDataAdapter
+    {
+    public:
+        explicit FileMarketDataAdapter(FileSourceOptions opts = {}) : opts_(opts) {}
+        ~FileMarketDataAdapter() override;
+        FileMarketDataAdapter(const FileMarketDataAdapter &) = delete;
+        FileMarketDataAdapter &operator=(const FileMarketDataAdapter &) = delete;
+
+        void configure(const AdapterConfig &cfg) override;
+        void connect() override;
+        void disconnect() override;
+        std::size_t read(std::span<std::byte> out) override;
+        // A file has no upstream to recover from; the request is recorded only.
+        void request_gap_fill(const SequenceRange &missing) override;
+        [[nodiscard]] AdapterStatus status() const override { return status_; }
+
+        [[nodiscard]] std::uint64_t size_bytes() const noexcept { return size_; }
+        [[nodiscard]] const PacingStats &pacing_stats() const noexcept { return pacer_.stats(); }
+
+    private:
+        AdapterConfig cfg_{};
+        FileSourceOptions opts_;
+        AdapterStatus status_{};
+        Pacer pacer_{};
+        int fd_{-1};
+        std::uint64_t size_{0};
+        std::uint64_t offset_{0};
+    };
+
+    // Maps a capture file read-only. next_frame() hands out spans that point
+    // into the mapping, so a consumer can decode in place with no copy; read()
+    // is kept for contract callers and copies. status().last_sequence is the
+    // absolute byte offset just past the last byte delivered.
+    class MmapMarketDataAdapter final : public IMarketDataAdapter
+    {
+    public:
+        explicit MmapMarketDataAdapter(FileSourceOptions opts = {}) : opts_(opts) {}
+        ~MmapMarketDataAdapter() override;
+        MmapMarketDataAdapter(const MmapMarketDataAdapter &) = delete;
+        MmapMarketDataAdapter &operator=(const MmapMarketDataAdapter &) = delete;
+
+        void configure(const AdapterConfig &cfg) override;
+        void connect() override;
+        void disconnect() override;
+        std::size_t read(std::span<std::byte> out) override;
+        void request_gap_fill(const SequenceRange &missing) override;
+        [[nodiscard]] AdapterStatus status() const override { return status_; }
+
+        // Next span of at most max_bytes (0 = the configured frame size),
+        // valid until disconnect(). Empty at end of file. When the span is
+        // shorter than the remaining data it ends on a record boundary if
+        // pacing is enabled.
+        std::span<const std::byte> next_frame(std::size_t max_bytes = 0);
+
+        [[nodiscard]] std::uint64_t size_bytes() const noexcept { return size_; }
+        [[nodiscard]] const PacingStats &pacing_stats() const noexcept { return pacer_.stats(); }
+
+    private:
+        AdapterConfig cfg_{};
+        FileSourceOptions opts_;
+        AdapterStatus status_{};
+        Pacer pacer_{};
+        const std::byte *base_{nullptr};
+        std::uint64_t size_{0};
+        std::uint64_t offset_{0};
+    };
+
+    struct UringReadStats
+    {
+        std::uint64_t reads{0};
+        std::uint64_t bytes{0};
+        // next_frame() calls that found the next read still in flight.
+        std::uint64_t waits{0};
+        // Reads the kernel cut short before end of file (finished with pread).
+        std::uint64_t short_reads{0};
+        // What connect() got: io_uring (else pread), registered buffers,
+        // O_DIRECT.
+        bool uring{false};
+        bool registered{false};
+        bool direct{false};
+    };
+
+    // Reads a capture file through io_uring with queue_depth reads of
+    // read_bytes in flight, each into its own registered buffer, so the
+    // device works ahead while the consumer decodes. Reads complete in any
+    // order and are handed out in file order; a buffer is refilled with the
+    // read queue_depth ahead as soon as the consumer moves past it. Without
+    // io_uring the same buffers are filled with pread. When
+    // pacing.record_bytes is set, frames never split a record (a record
+    // straddling two reads is handed out on its own, copied).
+    // status().last_sequence is the absolute byte offset just past the last
+    // byte delivered.
+    class UringFileMarketDataAdapter final : public IMarketDataAdapter
+    {
+    public:
+        explicit UringFileMarketDataAdapter(FileSourceOptions opts = {}) : opts_(opts) {}
+        ~UringFileMarketDataAdapter() override;
+        UringFileMarketDataAdapter(const UringFileMarketDataAdapter &) = delete;
+        UringFileMarketDataAdapter &operator=(const UringFileMarketDataAdapter &) = delete;
+
+        void configure(const AdapterConfig &cfg) override;
+        void connect() override;
+        void disconnect() override;
+        std::size_t read(std::span<std::byte> out) override;
+        void request_gap_fill(const SequenceRange &missing) override;
+        [[nodiscard]] AdapterStatus status() const override { return status_; }
+
+        // Next span of at most max_bytes (0 = the rest of the current read),
+        // valid until the next call. Empty at end of file.
+        std::span<const std::byte> next_frame(std::size_t max_bytes = 0);
+
+        [[nodiscard]] std::uint64_t size_bytes() const noexcept { return size_; }
+        [[nodiscard]] const UringReadStats &read_stats() const noexcept { return stats_; }
+        // Why io_uring is not in use; empty if it is.
+        [[nodiscard]] const std::string &uring_error() const noexcept { return uring_error_; }
+        [[nodiscard]] const PacingStats &pacing_stats() const noexcept { return pacer_.stats(); }
+
+    private:
+        static constexpr std::int64_t kPending = -1;
+
+        [[nodiscard]] std::byte *buffer(std::uint64_t chunk) const noexcept
+        {
+            return bufs_ + (chunk % depth_) * chunk_bytes_;
+        }
+        [[nodiscard]] std::uint32_t chunk_len(std::uint64_t chunk) const noexcept;
+        // Starts reading chunk into its buffer.
+        bool submit(std::uint64_t chunk);
+        // Waits for chunk and makes it current.
+        bool take(std::uint64_t chunk);
+        void fail_io(const std::string &what, int err);
+
+        AdapterConfig cfg_{};
+        FileSourceOptions opts_;
+        AdapterStatus status_{};
+        Pacer pacer_{};
+        UringReadStats stats_{};
+        std::string uring_error_;
+        IoUring ring_;
+        int fd_{-1};
+        std::uint64_t size_{0};
+        std::uint64_t offset_{0};
+
+        std::byte *bufs_{nullptr};
+        std::size_t chunk_bytes_{0};
+        unsigned depth_{0};
+        // Reads start at base_ (start_offset rounded down for O_DIRECT).
+        std::uint64_t base_{0};
+        std::uint64_t chunks_{0};
+        // Result per buffer: bytes read, or kPending.
+        std::vector<std::int64_t> result_;
+        // Chunk being consumed, and the unread part of it.
+        std::uint64_t next_chunk_{0};
+        bool holding_{false};
+        std::size_t pos_{0};
+        std::size_t len_{0};
+        // A record split across two reads, reassembled: the head of it sits
+        // past len_ in the current buffer until that buffer is left.
+        std::vector<std::byte> carry_;
+        std::size_t carry_have_{0};
+        std::size_t tail_part_{0};
+        bool carry_ready_{false};
+    };
+
+    struct DecodeStats
+    {
+        Codec codec{Codec::none};
+        std::uint64_t frames{0};
+        std::uint64_t compressed_bytes{0};
+        // Decompressed units handed to the consumer, and how many of them
+        // it had to wait for.
+        std::uint64_t units{0};
+        std::uint64_t waits{0};
+        unsigned threads{0};
+        // Whole frames decoded side by side (else one thread streams them).
+        bool parallel{false};
+    };
+
+    // Reads a zstd or LZ4 compressed capture (detected from the frame
+    // magic) and hands out the decompressed bytes in order; offsets,
+    // start_offset and status().last_sequence all count decompressed bytes.
+    // The file is mapped and split into frames up front. When it holds
+    // several independent frames of bounded size, decode_threads workers
+    // each take the next frame and decode it into its slot of a reorder
+    // window of decode_window units; the consumer takes the slots in frame
+    // order and a slot is refilled once the consumer is past it. A single
+    // frame (what `zstd capture.bin` writes) cannot be split, so one worker
+    // streams it in read_bytes units instead. Records are never split
+    // across next_frame() spans when pacing.record_bytes is set.
+    class CompressedFileMarketDataAdapter final : public IMarketDataAdapter
+    {
+    public:
+        explicit CompressedFileMarketDataAdapter(FileSourceOptions opts = {}) : opts_(opts) {}
+        ~CompressedFileMarketDataAdapter() override;
+        CompressedFileMarketDataAdapter(const CompressedFileMarketDataAdapter &) = delete;
+        CompressedFileMarketDataAdapter &operator=(const CompressedFileMarketDataAdapter &) = delete;
+
+        void configure(const AdapterConfig &cfg) override;
+        void connect() override;
+        void disconnect() override;
+        std::size_t read(std::span<std::byte> out) override;
+        void request_gap_fill(const SequenceRange &missing) override;
+        [[nodiscard]] AdapterStatus status() const override { return status_; }
+
+        // Next span of at most max_bytes (0 = the rest of the current
+        // unit), valid until the next call. Empty at end of file.
+        std::span<const std::byte> next_frame(std::size_t max_bytes = 0);
+
+        // Decompressed size when every frame header records it; otherwise 0
+        // until the end of the file has been reached.
+        [[nodiscard]] std::uint64_t size_bytes() const noexcept { return size_; }
+        [[nodiscard]] const DecodeStats &decode_stats() const noexcept { return stats_; }
+        [[nodiscard]] const PacingStats &pacing_stats() const noexcept { return pacer_.stats(); }
+
+    private:
+        struct Unit
+        {
+            std::vector<std::byte> data;
+            std::string error;
+            bool done{false};
+            bool last{false};
+        };
+
+        [[nodiscard]] std::span<const std::byte> frame_bytes(std::size_t i) const noexcept
+        {
+            return {base_ + frames_[i].offset, static_cast<std::size_t>(frames_[i].bytes)};
+        }
+        void decode_frames();
+        void stream_frames();
+        // Worker side: waits for unit's slot to be free; false on stop.
+        bool claim_slot(std::uint64_t unit);
+        void publish(std::uint64_t unit, std::string error, bool last);
+        // Consumer side: waits for next_unit_ and makes it current.
+        bool take();
+        void stop_workers();
+
+        AdapterConfig cfg_{};
+        FileSourceOptions opts_;
+        AdapterStatus status_{};
+        Pacer pacer_{};
+        DecodeStats stats_{};
+        const std::byte *base_{nullptr};
+        std::size_t map_bytes_{0};
+        std::vector<CompressedFrame> frames_;
+        std::uint64_t size_{0};
+        std::uint64_t offset_{0};
+
+        std::vector<std::thread> workers_;
+        std::mutex mu_;
+        std::condition_variable work_cv_;
+        std::condition_variable ready_cv_;
+        std::vector<Unit> units_;
+        std::uint64_t claimed_{0};
+        std::uint64_t released_{0};
+        bool stop_{false};
+
+        // Unit being consumed and the unread part of it; skip_ is what is
+        // still to be dropped to reach start_offset, and stream_end_ the
+        // decompressed offset at the end of the current unit.
+        std::uint64_t next_unit_{0};
+        bool holding_{false};
+        bool last_{false};
+        bool ended_{false};
+        std::size_t pos_{0};
+        std::size_t len_{0};
+        std::uint64_t skip_{0};
+        std::uint64_t stream_end_{0};
+        // A record split across two units, reassembled as in the io_uring
+        // reader.
+        std::vector<std::byte> carry_;
+        std::size_t carry_have_{0};
+        std::size_t tail_part_{0};
+        bool carry_ready_{false};
+    };
+
+} // namespace bqs::adapters
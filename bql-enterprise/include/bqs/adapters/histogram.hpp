@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace bqs::adapters
+{
+
+    // Fixed-size power-of-two histogram: bucket i holds values v with
+    // bit_width(v) == i, i.e. [2^(i-1), 2^i). Recording is a couple of
+    // instructions and never allocates, so it is safe on the receive path.
+    struct Log2Histogram
+    {
+        static constexpr std::size_t kBuckets = 64;
+
+        std::array<std::uint64_t, kBuckets> counts{};
+        std::uint64_t n{0};
+        std::uint64_t sum{0};
+        std::uint64_t max{0};
+
+        void add(std::uint64_t v) noexcept
+        {
+            ++counts[std::min<std::size_t>(std::bit_width(v), kBuckets - 1)];
+            ++n;
+            sum += v;
+            max = v > max ? v : max;
+        }
+
+        // Exclusive upper bound of bucket i.
+        [[nodiscard]] static constexpr std::uint64_t upper_bound(std::size_t i) noexcept
+        {
+            return i >= 63 ? ~0ull : (1ull << i);
+        }
+
+        [[nodiscard]] double mean() const noexcept { return n ? static_cast<double>(sum) / static_cast<double>(n) : 0.0; }
+
+        // Upper bound of the bucket holding quantile q (capped at max).
+        [[nodiscard]] std::uint64_t quantile(double q) const noexcept
+        {
+            if (n == 0)
+                return 0;
+            const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(n - 1)) + 1;
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < kBuckets; ++i)
+            {
+                seen += counts[i];
+                if (seen >= rank)
+                    return upper_bound(i) - 1 < max ? upper_bound(i) - 1 : max;
+            }
+            return max;
+        }
+    };
+
+} // namespace bqs::adapters
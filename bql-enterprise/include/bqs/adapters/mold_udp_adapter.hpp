@@ -0,0 +1,229 @@
+#pragma once
+
+#include "bqs/adapters/histogram.hpp"
+#include "bqs/adapters/market_data_adapter.hpp"
+#include "bqs/adapters/moldudp64.hpp"
+#include "bqs/adapters/reorder_ring.hpp"
+#include "bqs/adapters/rewind.hpp"
+#include "bqs/adapters/xsk.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace bqs::adapters
+{
+
+    enum class ReceiveMode : std::uint8_t
+    {
+        // Sleep in recvmmsg until a datagram arrives (interrupt-driven).
+        blocking = 0,
+        // Spin on non-blocking recvmmsg; never sleeps in the kernel.
+        busy_poll = 1,
+    };
+
+    struct UdpFeedOptions
+    {
+        // Local interface address used to join the group.
+        std::string interface{"127.0.0.1"};
+        // Datagrams requested per recvmmsg call.
+        std::size_t batch{64};
+        // Receive ring capacity in datagrams; sized once at connect().
+        std::size_t ring_slots{4096};
+        // Requested SO_RCVBUF (the kernel may clamp it).
+        int rcvbuf_bytes{32 << 20};
+        ReceiveMode mode{ReceiveMode::blocking};
+        // SO_BUSY_POLL budget in microseconds (0 = leave unset). Also sets
+        // SO_PREFER_BUSY_POLL so the NIC queue is polled from our context.
+        int busy_poll_us{0};
+        // Busy-poll backoff: this many empty polls spin back to back, after
+        // which each empty poll yields the CPU first.
+        std::uint32_t spin_polls{10000};
+        // How long next_message() waits for data when the ring is empty
+        // (0 = not at all; the caller polls fd() itself).
+        int wait_ms{100};
+        // Disconnect after this long without a datagram; 0 = never.
+        int idle_timeout_ms{0};
+        // Gap recovery. With rewind.server set, live messages past a gap are
+        // held in a sequence-indexed ring (reorder_slots messages of at most
+        // reorder_slot_bytes) while the rewinder fills it, and released in
+        // order. A gap still open after gap_timeout_ms is given up.
+        RewindOptions rewind{};
+        std::size_t reorder_slots{65536};
+        std::size_t reorder_slot_bytes{256};
+        int gap_timeout_ms{500};
+        // With xdp.ifname set, datagrams are taken from an AF_XDP socket on
+        // that interface's RX queue instead of recvmmsg; if AF_XDP cannot be
+        // set up the adapter says why (xdp_error()) and uses recvmmsg.
+        XdpOptions xdp{};
+    };
+
+    struct UdpFeedStats
+    {
+        std::uint64_t packets{0};
+        std::uint64_t messages{0};
+        std::uint64_t bytes{0};
+        std::uint64_t batches{0};
+        std::uint64_t heartbeats{0};
+        std::uint64_t duplicates{0};
+        std::uint64_t gaps{0};
+        // Messages never delivered (skipped, or given up on during recovery).
+        std::uint64_t missing{0};
+        // Messages delivered from rewinder responses.
+        std::uint64_t recovered{0};
+        // Live messages beyond the reorder window (re-requested instead).
+        std::uint64_t reorder_overflows{0};
+        std::uint64_t reorder_peak{0};
+        std::uint64_t malformed{0};
+        // Cumulative datagrams the kernel dropped on this socket (SO_RXQ_OVFL).
+        std::uint64_t kernel_drops{0};
+        // Busy-poll loop: non-blocking polls that returned nothing, and how
+        // many of those yielded.
+        std::uint64_t empty_polls{0};
+        std::uint64_t yields{0};
+        // Datagrams per non-empty recvmmsg.
+        Log2Histogram batch_size{};
+        // Kernel receive timestamp to the start of processing, per datagram (ns).
+        Log2Histogram wake_ns{};
+        // AF_XDP frames for this port but another group, dropped.
+        std::uint64_t xdp_foreign{0};
+        // SO_BUSY_POLL / SO_PREFER_BUSY_POLL were accepted by the kernel.
+        bool busy_poll_socket{false};
+        // Receiving through AF_XDP, and whether the driver gave us zero-copy.
+        bool xdp{false};
+        bool xdp_zero_copy{false};
+    };
+
+    // One MoldUDP64 message, viewed in place in the receive ring. The payload
+    // stays valid until the next call into the adapter.
+    struct MoldMessage
+    {
+        std::span<const std::byte> payload;
+        std::uint64_t sequence{0};
+        // Kernel receive time (SO_TIMESTAMPNS, CLOCK_REALTIME); 0 if absent.
+        // AF_XDP has no stamp: there it is when the frame left the RX ring.
+        std::uint64_t rx_ts_ns{0};
+    };
+
+    // Joins a MoldUDP64 multicast group (AdapterConfig::endpoint is
+    // "group:port") and drains it with batched recvmmsg into a pre-sized
+    // ring. Sequence numbers are tracked from AdapterConfig::start_sequence
+    // (0 = the first packet seen): duplicates are dropped and every forward
+    // jump is reported through request_gap_fill(). With UdpFeedOptions::xdp
+    // the ring is filled from an AF_XDP socket instead and slots point into
+    // its UMEM, so payloads are never copied on the way in. Without a rewinder the
+    // gap is skipped; with one, status() reports SessionState::recovering
+    // while later messages are held back, and delivery stays in sequence.
+    // read() copies whole message payloads back to back; next_message() is
+    // the zero-copy path.
+    class MoldUdpMarketDataAdapter final : public IMarketDataAdapter
+    {
+    public:
+        explicit MoldUdpMarketDataAdapter(UdpFeedOptions opts = {});
+        ~MoldUdpMarketDataAdapter() override;
+        MoldUdpMarketDataAdapter(const MoldUdpMarketDataAdapter &) = delete;
+        MoldUdpMarketDataAdapter &operator=(const MoldUdpMarketDataAdapter &) = delete;
+
+        void configure(const AdapterConfig &cfg) override;
+        void connect() override;
+        void disconnect() override;
+        std::size_t read(std::span<std::byte> out) override;
+        void request_gap_fill(const SequenceRange &missing) override;
+        [[nodiscard]] AdapterStatus status() const override { return status_; }
+
+        // Next in-sequence message; false if none arrived within wait_ms or
+        // the session ended (see status()).
+        bool next_message(MoldMessage &out);
+
+        [[nodiscard]] const UdpFeedStats &stats() const noexcept { return stats_; }
+        [[nodiscard]] const RewindStats &rewind_stats() const noexcept { return rewind_.stats(); }
+        // Receive socket (the AF_XDP one when active), for callers
+        // multiplexing several feeds.
+        [[nodiscard]] int fd() const noexcept { return xsk_.is_open() ? xsk_.fd() : fd_; }
+        // Why AF_XDP was asked for but not used; empty otherwise.
+        [[nodiscard]] const std::string &xdp_error() const noexcept { return xdp_error_; }
+        // Next sequence number the adapter expects (0 before the first packet).
+        [[nodiscard]] std::uint64_t expected_sequence() const noexcept { return expected_; }
+
+    private:
+        static constexpr std::size_t kSlotBytes = 2048;
+
+        static constexpr std::uint64_t kNoFrame = ~std::uint64_t{0};
+
+        struct Slot
+        {
+            // Datagram bytes: in ring_, or in the UMEM frame `frame`.
+            const std::byte *data{nullptr};
+            std::uint64_t frame{kNoFrame};
+            std::uint32_t len{0};
+            bool truncated{false};
+            std::uint64_t rx_ts_ns{0};
+        };
+
+        // One recvmmsg into the free part of the ring. Returns datagrams read.
+        std::size_t fill(bool wait);
+        // The same from the AF_XDP RX ring.
+        std::size_t fill_xdp(bool wait);
+        // Drops the packet at head_, returning its UMEM frame if it has one.
+        void pop_head() noexcept;
+        // Waits up to wait_ms for at least one datagram in the configured mode.
+        std::size_t fill_wait();
+        std::byte *slot_data(std::uint64_t i) noexcept { return ring_.data() + (i % opts_.ring_slots) * kSlotBytes; }
+        [[nodiscard]] bool recovering() const noexcept { return horizon_ > expected_; }
+        // Sequences below upto exist: report any not yet seen as a gap.
+        void note_gap(std::uint64_t upto);
+        // Routes one message. True when it is next in sequence and out is set.
+        bool accept(std::uint64_t seq, std::span<const std::byte> msg, std::uint64_t ts, bool rewound,
+                    MoldMessage &out);
+        // Skips the missing run at the head of the reorder window.
+        void give_up_head();
+        void drain_rewinder();
+        void deliver(MoldMessage &out, std::span<const std::byte> msg, std::uint64_t seq, std::uint64_t ts);
+
+        AdapterConfig cfg_{};
+        UdpFeedOptions opts_;
+        AdapterStatus status_{};
+        UdpFeedStats stats_{};
+        int fd_{-1};
+
+        std::vector<std::byte> ring_;
+        std::vector<Slot> slots_;
+        std::vector<mmsghdr> msgs_;
+        std::vector<iovec> iovs_;
+        std::vector<std::byte> control_;
+        std::uint64_t head_{0};
+        std::uint64_t tail_{0};
+        XskSocket xsk_;
+        std::vector<XdpFrame> xdp_frames_;
+        std::string xdp_error_;
+        // Joined group, network byte order.
+        std::uint32_t group_{0};
+
+        // Packet at head_ being consumed.
+        bool in_packet_{false};
+        mold::MessageCursor cursor_{{}};
+        std::uint64_t cursor_seq_{0};
+        std::uint64_t cursor_ts_{0};
+
+        std::uint64_t expected_{0};
+        // One past the highest sequence seen while recovering.
+        std::uint64_t horizon_{0};
+        std::chrono::steady_clock::time_point head_since_{};
+        bool end_seen_{false};
+        bool have_session_{false};
+        RewindClient rewind_;
+        ReorderRing reorder_;
+        std::vector<std::byte> rewind_buf_;
+
+        bool has_pending_{false};
+        MoldMessage pending_{};
+        std::chrono::steady_clock::time_point last_rx_{};
+    };
+
+} // namespace bqs::adapters
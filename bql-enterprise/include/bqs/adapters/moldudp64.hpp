@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+namespace bqs::adapters::mold
+{
+
+    // MoldUDP64 framing (public Nasdaq spec). A downstream packet is a 20-byte
+    // header followed by `count` length-prefixed messages; all integers are
+    // big-endian. count == 0 is a heartbeat whose sequence is the next
+    // expected one; count == 0xFFFF marks end of session.
+    inline constexpr std::size_t kSessionBytes = 10;
+    inline constexpr std::size_t kHeaderBytes = 20;
+    inline constexpr std::uint16_t kEndOfSession = 0xFFFF;
+    // Largest payload that fits a standard 1500-byte Ethernet frame.
+    inline constexpr std::size_t kMaxPacketBytes = 1472;
+
+    [[nodiscard]] inline std::uint64_t load_be64(const std::byte *p) noexcept
+    {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i)
+            v = (v << 8) | static_cast<std::uint8_t>(p[i]);
+        return v;
+    }
+
+    [[nodiscard]] inline std::uint16_t load_be16(const std::byte *p) noexcept
+    {
+        return static_cast<std::uint16_t>((static_cast<std::uint8_t>(p[0]) << 8) | static_cast<std::uint8_t>(p[1]));
+    }
+
+    inline void store_be64(std::byte *p, std::uint64_t v) noexcept
+    {
+        for (int i = 7; i >= 0; --i, v >>= 8)
+            p[i] = static_cast<std::byte>(v & 0xFF);
+    }
+
+    inline void store_be16(std::byte *p, std::uint16_t v) noexcept
+    {
+        p[0] = static_cast<std::byte>(v >> 8);
+        p[1] = static_cast<std::byte>(v & 0xFF);
+    }
+
+    struct PacketHeader
+    {
+        char session[kSessionBytes]{};
+        std::uint64_t sequence{0};
+        std::uint16_t count{0};
+
+        [[nodiscard]] bool heartbeat() const noexcept { return count == 0; }
+        [[nodiscard]] bool end_of_session() const noexcept { return count == kEndOfSession; }
+        // Number of sequence numbers the packet covers.
+        [[nodiscard]] std::uint16_t messages() const noexcept { return end_of_session() ? 0 : count; }
+    };
+
+    [[nodiscard]] inline bool parse_header(std::span<const std::byte> pkt, PacketHeader &h) noexcept
+    {
+        if (pkt.size() < kHeaderBytes)
+            return false;
+        std::memcpy(h.session, pkt.data(), kSessionBytes);
+        h.sequence = load_be64(pkt.data() + 10);
+        h.count = load_be16(pkt.data() + 18);
+        return true;
+    }
+
+    // Walks the length-prefixed message blocks after the header. next()
+    // returns false at the end of the packet or if a block overruns it.
+    class MessageCursor
+    {
+    public:
+        explicit MessageCursor(std::span<const std::byte> pkt) noexcept
+            : p_(pkt.data() + (pkt.size() >= kHeaderBytes ? kHeaderBytes : pkt.size())), end_(pkt.data() + pkt.size())
+        {
+        }
+
+        bool next(std::span<const std::byte> &msg) noexcept
+        {
+            if (end_ - p_ < 2)
+                return false;
+            const std::size_t len = load_be16(p_);
+            if (static_cast<std::size_t>(end_ - p_ - 2) < len)
+                return false;
+            msg = {p_ + 2, len};
+            p_ += 2 + len;
+            return true;
+        }
+
+    private:
+        const std::byte *p_;
+        const std::byte *end_;
+    };
+
+    // Builds one downstream packet in a caller-provided buffer.
+    class PacketBuilder
+    {
+    public:
+        PacketBuilder(std::span<std::byte> buf, std::string_view session, std::uint64_t sequence) noexcept : buf_(buf)
+        {
+            std::memset(buf_.data(), ' ', kSessionBytes);
+            std::memcpy(buf_.data(), session.data(), session.size() < kSessionBytes ? session.size() : kSessionBytes);
+            store_be64(buf_.data() + 10, sequence);
+            store_be16(buf_.data() + 18, 0);
+        }
+
+        // Appends one message; false if it would not fit.
+        bool add(std::span<const std::byte> msg) noexcept
+        {
+            if (used_ + 2 + msg.size() > buf_.size() || count_ == kEndOfSession - 1)
+                return false;
+            store_be16(buf_.data() + used_, static_cast<std::uint16_t>(msg.size()));
+            std::memcpy(buf_.data() + used_ + 2, msg.data(), msg.size());
+            used_ += 2 + msg.size();
+            store_be16(buf_.data() + 18, ++count_);
+            return true;
+        }
+
+        void mark_end_of_session() noexcept { store_be16(buf_.data() + 18, kEndOfSession); }
+
+        [[nodiscard]] std::uint16_t count() const noexcept { return count_; }
+        [[nodiscard]] std::span<const std::byte> bytes() const noexcept { return buf_.first(used_); }
+
+    private:
+        std::span<std::byte> buf_;
+        std::size_t used_{kHeaderBytes};
+        std::uint16_t count_{0};
+    };
+
+} // namespace bqs::adapters::mold
@@ -0,0 +1,327 @@
+#pragma once
+
+#include "bqs/adapters/order_flow_adapter.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace bqs::adapters
+{
+
+    // Order encoders share one shape so TcpOrderFlowAdapter<Codec> can write
+    // straight into its send buffer:
+    //   static constexpr std::size_t kMaxBytes;       // worst-case message size
+    //   std::size_t encode(const NewOrder &, std::byte *out) noexcept;
+    // out has room for kMaxBytes; encode returns the bytes written.
+
+    namespace wire
+    {
+        template <typename T>
+        inline void store_le(std::byte *p, T v) noexcept
+        {
+            if constexpr (std::endian::native == std::endian::little)
+                std::memcpy(p, &v, sizeof(T));
+            else
+                for (std::size_t i = 0; i < sizeof(T); ++i)
+                    p[i] = static_cast<std::byte>(static_cast<std::uint64_t>(v) >> (8 * i));
+        }
+
+        template <typename T>
+        inline T load_le(const std::byte *p) noexcept
+        {
+            T v;
+            if constexpr (std::endian::native == std::endian::little)
+                std::memcpy(&v, p, sizeof(T));
+            else
+            {
+                std::uint64_t u = 0;
+                for (std::size_t i = 0; i < sizeof(T); ++i)
+                    u |= std::uint64_t(std::to_integer<std::uint8_t>(p[i])) << (8 * i);
+                v = static_cast<T>(u);
+            }
+            return v;
+        }
+
+        inline std::size_t count_digits(std::uint64_t v) noexcept
+        {
+            std::size_t n = 1;
+            for (; v >= 10; v /= 10)
+                ++n;
+            return n;
+        }
+    } // namespace wire
+
+    // SBE NewOrderSingle framed for a byte stream: a Simple Open Framing
+    // Header (u32 big-endian frame length, u16 big-endian encoding type
+    // 0x5BE0), the SBE message header (blockLength, templateId, schemaId,
+    // version; u16 little endian) and one fixed-size block. Price is a
+    // mantissa with the constant exponent -NewOrder::kPriceDecimals.
+    struct SbeNewOrderCodec
+    {
+        static constexpr std::uint16_t kEncodingType = 0x5BE0;
+        static constexpr std::uint16_t kTemplateId = 1;
+        static constexpr std::uint16_t kSchemaId = 42;
+        static constexpr std::uint16_t kVersion = 1;
+        static constexpr std::size_t kFramingBytes = 6;
+        static constexpr std::size_t kHeaderBytes = 8;
+        // cl_ord_id, transact_ns, price, qty, symbol, side, type, tif, pad
+        static constexpr std::uint16_t kBlockLength = 8 + 8 + 8 + 4 + 8 + 1 + 1 + 1 + 1;
+        static constexpr std::size_t kMaxBytes = kFramingBytes + kHeaderBytes + kBlockLength;
+
+        std::size_t encode(const NewOrder &o, std::byte *out) const noexcept
+        {
+            out[0] = std::byte{0};
+            out[1] = std::byte{0};
+            out[2] = std::byte{0};
+            out[3] = static_cast<std::byte>(kMaxBytes);
+            out[4] = static_cast<std::byte>(kEncodingType >> 8);
+            out[5] = static_cast<std::byte>(kEncodingType & 0xFF);
+            std::byte *h = out + kFramingBytes;
+            wire::store_le<std::uint16_t>(h + 0, kBlockLength);
+            wire::store_le<std::uint16_t>(h + 2, kTemplateId);
+            wire::store_le<std::uint16_t>(h + 4, kSchemaId);
+            wire::store_le<std::uint16_t>(h + 6, kVersion);
+            std::byte *b = h + kHeaderBytes;
+            wire::store_le<std::uint64_t>(b + 0, o.cl_ord_id);
+            wire::store_le<std::uint64_t>(b + 8, o.transact_ns);
+            wire::store_le<std::int64_t>(b + 16, o.price);
+            wire::store_le<std::uint32_t>(b + 24, o.qty);
+            std::memcpy(b + 28, o.symbol.data(), 8);
+            b[36] = static_cast<std::byte>(o.side);
+            b[37] = static_cast<std::byte>(o.type);
+            b[38] = static_cast<std::byte>(o.tif);
+            b[39] = std::byte{0};
+            return kMaxBytes;
+        }
+
+        // Parses one framed message from the front of in; false if it is
+        // incomplete or not a NewOrderSingle of this schema.
+        static bool decode(std::span<const std::byte> in, NewOrder &o, std::size_t &used) noexcept
+        {
+            if (in.size() < kMaxBytes)
+                return false;
+            const std::uint32_t frame = (std::to_integer<std::uint32_t>(in[0]) << 24) |
+                                        (std::to_integer<std::uint32_t>(in[1]) << 16) |
+                                        (std::to_integer<std::uint32_t>(in[2]) << 8) | std::to_integer<std::uint32_t>(in[3]);
+            const std::uint16_t enc =
+                static_cast<std::uint16_t>((std::to_integer<std::uint16_t>(in[4]) << 8) | std::to_integer<std::uint16_t>(in[5]));
+            const std::byte *h = in.data() + kFramingBytes;
+            if (frame != kMaxBytes || enc != kEncodingType || wire::load_le<std::uint16_t>(h) != kBlockLength ||
+                wire::load_le<std::uint16_t>(h + 2) != kTemplateId || wire::load_le<std::uint16_t>(h + 4) != kSchemaId)
+                return false;
+            const std::byte *b = h + kHeaderBytes;
+            o.cl_ord_id = wire::load_le<std::uint64_t>(b + 0);
+            o.transact_ns = wire::load_le<std::uint64_t>(b + 8);
+            o.price = wire::load_le<std::int64_t>(b + 16);
+            o.qty = wire::load_le<std::uint32_t>(b + 24);
+            std::memcpy(o.symbol.data(), b + 28, 8);
+            o.side = static_cast<OrderSide>(b[36]);
+            o.type = static_cast<OrderType>(b[37]);
+            o.tif = static_cast<TimeInForce>(b[38]);
+            used = kMaxBytes;
+            return true;
+        }
+    };
+
+    // FIX 4.4 NewOrderSingle (35=D) in tag=value form. The constant part of
+    // the header (MsgType and CompIDs) and its checksum are prepared once;
+    // encode() works BodyLength out from the field widths first, so the
+    // message is written in one forward pass with the checksum summed as
+    // bytes go out. SendingTime and TransactTime both carry transact_ns.
+    class FixNewOrderCodec
+    {
+    public:
+        static constexpr std::size_t kMaxBytes = 320;
+
+        explicit FixNewOrderCodec(std::string_view sender = "BQL", std::string_view target = "EXCH",
+                                  std::uint64_t first_seq = 1)
+            : next_seq_(first_seq)
+        {
+            fixed_ = "35=D\x01"
+                     "49=";
+            fixed_.append(sender.substr(0, 32));
+            fixed_ += "\x01"
+                      "56=";
+            fixed_.append(target.substr(0, 32));
+            fixed_ += '\x01';
+            for (const char c : fixed_)
+                fixed_sum_ += static_cast<unsigned char>(c);
+        }
+
+        [[nodiscard]] std::uint64_t next_seq() const noexcept { return next_seq_; }
+
+        std::size_t encode(const NewOrder &o, std::byte *out) noexcept
+        {
+            char *const start = reinterpret_cast<char *>(out);
+            const std::uint64_t seq = next_seq_++;
+            const std::size_t sym_len = strnlen(o.symbol.data(), o.symbol.size());
+            const bool limit = o.type == OrderType::limit;
+            const std::uint64_t abs_px = o.price < 0 ? 0 - static_cast<std::uint64_t>(o.price) : static_cast<std::uint64_t>(o.price);
+            const std::uint64_t px_int = abs_px / kPriceScale;
+            const std::size_t px_len = (o.price < 0) + wire::count_digits(px_int) + 1 + NewOrder::kPriceDecimals;
+
+            // Every field is "tag=value<SOH>"; 52 and 60 are 21-char timestamps.
+            const std::size_t body = fixed_.size() + (4 + wire::count_digits(seq)) + (4 + kStampBytes) +
+                                     (4 + wire::count_digits(o.cl_ord_id)) + (4 + sym_len) + 5 + (4 + kStampBytes) +
+                                     (4 + wire::count_digits(o.qty)) + 5 + (limit ? 4 + px_len : 0) + 5;
+
+            Writer w{start, 0};
+            w.raw("8=FIX.4.4\x01"
+                  "9=",
+                  12);
+            w.uint(body, wire::count_digits(body));
+            w.ch('\x01');
+            w.raw(fixed_.data(), fixed_.size(), fixed_sum_);
+            w.tag("34=");
+            w.uint(seq, wire::count_digits(seq));
+            w.ch('\x01');
+            const char *stamp = format_stamp(o.transact_ns);
+            w.tag("52=");
+            w.raw(stamp, kStampBytes);
+            w.ch('\x01');
+            w.tag("11=");
+            w.uint(o.cl_ord_id, wire::count_digits(o.cl_ord_id));
+            w.ch('\x01');
+            w.tag("55=");
+            w.raw(o.symbol.data(), sym_len);
+            w.ch('\x01');
+            w.tag("54=");
+            w.ch(static_cast<char>('0' + static_cast<int>(o.side)));
+            w.ch('\x01');
+            w.tag("60=");
+            w.raw(stamp, kStampBytes);
+            w.ch('\x01');
+            w.tag("38=");
+            w.uint(o.qty, wire::count_digits(o.qty));
+            w.ch('\x01');
+            w.tag("40=");
+            w.ch(static_cast<char>('0' + static_cast<int>(o.type)));
+            w.ch('\x01');
+            if (limit)
+            {
+                w.tag("44=");
+                if (o.price < 0)
+                    w.ch('-');
+                w.uint(px_int, wire::count_digits(px_int));
+                w.ch('.');
+                w.uint(abs_px % kPriceScale, NewOrder::kPriceDecimals);
+                w.ch('\x01');
+            }
+            w.tag("59=");
+            w.ch(static_cast<char>('0' + static_cast<int>(o.tif)));
+            w.ch('\x01');
+
+            const unsigned sum = w.sum & 0xFF;
+            char *p = w.p;
+            p[0] = '1';
+            p[1] = '0';
+            p[2] = '=';
+            p[3] = static_cast<char>('0' + sum / 100);
+            p[4] = static_cast<char>('0' + sum / 10 % 10);
+            p[5] = static_cast<char>('0' + sum % 10);
+            p[6] = '\x01';
+            return static_cast<std::size_t>(p + 7 - start);
+        }
+
+    private:
+        static constexpr std::size_t kStampBytes = 21; // YYYYMMDD-HH:MM:SS.sss
+        static constexpr std::uint64_t kPriceScale = [] {
+            std::uint64_t s = 1;
+            for (int i = 0; i < NewOrder::kPriceDecimals; ++i)
+                s *= 10;
+            return s;
+        }();
+
+        struct Writer
+        {
+            char *p;
+            unsigned sum;
+
+            void ch(char c) noexcept
+            {
+                *p++ = c;
+                sum += static_cast<unsigned char>(c);
+            }
+            void raw(const char *s, std::size_t n) noexcept
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                    ch(s[i]);
+            }
+            // Copies bytes whose checksum contribution is already known.
+            void raw(const char *s, std::size_t n, unsigned s_sum) noexcept
+            {
+                std::memcpy(p, s, n);
+                p += n;
+                sum += s_sum;
+            }
+            void tag(const char (&t)[4]) noexcept { raw(t, 3); }
+            // Writes v as exactly `digits` decimal digits (zero padded).
+            void uint(std::uint64_t v, std::size_t digits) noexcept
+            {
+                for (std::size_t i = digits; i-- > 0; v /= 10)
+                {
+                    p[i] = static_cast<char>('0' + v % 10);
+                    sum += static_cast<unsigned char>(p[i]);
+                }
+                p += digits;
+            }
+        };
+
+        static void put2(char *p, unsigned v) noexcept
+        {
+            p[0] = static_cast<char>('0' + v / 10);
+            p[1] = static_cast<char>('0' + v % 10);
+        }
+
+        // UTC timestamp with millisecond precision. Orders cluster in time, so
+        // the date and time of day are only re-rendered when the second
+        // changes (civil-from-days after H. Hinnant's date algorithms).
+        const char *format_stamp(std::uint64_t ns) noexcept
+        {
+            char *const out = stamp_;
+            const std::uint64_t ms = ns / 1'000'000;
+            const std::uint64_t secs = ms / 1000;
+            const auto msec = static_cast<unsigned>(ms % 1000);
+            out[18] = static_cast<char>('0' + msec / 100);
+            put2(out + 19, msec % 100);
+            if (secs == stamp_secs_)
+                return out;
+            stamp_secs_ = secs;
+            const auto days = static_cast<std::int64_t>(secs / 86400);
+            const auto sod = static_cast<unsigned>(secs % 86400);
+            const std::int64_t z = days + 719468;
+            const std::int64_t era = z / 146097;
+            const auto doe = static_cast<unsigned>(z - era * 146097);
+            const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const unsigned mp = (5 * doy + 2) / 153;
+            const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+            const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+            const auto y = static_cast<unsigned>(yoe + era * 400 + (m <= 2));
+            put2(out, y / 100 % 100);
+            put2(out + 2, y % 100);
+            put2(out + 4, m);
+            put2(out + 6, d);
+            out[8] = '-';
+            put2(out + 9, sod / 3600);
+            out[11] = ':';
+            put2(out + 12, sod / 60 % 60);
+            out[14] = ':';
+            put2(out + 15, sod % 60);
+            out[17] = '.';
+            return out;
+        }
+
+        std::string fixed_;
+        unsigned fixed_sum_{0};
+        char stamp_[kStampBytes]{};
+        std::uint64_t stamp_secs_{~0ull};
+        std::uint64_t next_seq_;
+    };
+
+} // namespace bqs::adapters
@@ -2,12 +2,52 @@
 
 #include "bqs/adapters/adapter_types.hpp"
 
+#include <array>
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace bqs::adapters
 {
 
+    // Wire values follow FIX (Side 54, OrdType 40, TimeInForce 59).
+    enum class OrderSide : std::uint8_t
+    {
+        buy = 1,
+        sell = 2,
+    };
+
+    enum class OrderType : std::uint8_t
+    {
+        market = 1,
+        limit = 2,
+    };
+
+    enum class TimeInForce : std::uint8_t
+    {
+        day = 0,
+        ioc = 3,
+        fok = 4,
+    };
+
+    // Typed new-order request; encoders write it straight onto the wire.
+    struct NewOrder
+    {
+        // price is fixed point with this many decimals.
+        static constexpr int kPriceDecimals = 4;
+
+        std::uint64_t cl_ord_id{0};
+        // UTC nanoseconds since the epoch.
+        std::uint64_t transact_ns{0};
+        std::int64_t price{0};
+        std::uint32_t qty{0};
+        // Left-aligned, NUL-padded.
+        std::array<char, 8> symbol{};
+        OrderSide side{OrderSide::buy};
+        OrderType type{OrderType::limit};
+        TimeInForce tif{TimeInForce::day};
+    };
+
     // Placeholder interface for enterprise order-flow connectivity.
     // No venue-specific semantics are expressed here.
     class IOrderFlowAdapter
@@ -19,10 +59,12 @@ namespace bqs::adapters
         virtual void connect() = 0;
         virtual void disconnect() = 0;
 
-        // Submit a pre-encoded message payload. In an enterprise build this would be
-        // typed and validated per venue; here we keep it generic.
+        // Submit a pre-encoded message payload.
         virtual void send_raw(std::string_view payload) = 0;
 
+        // Encode and submit a new order without building an intermediate string.
+        virtual void send(const NewOrder &order) = 0;
+
         [[nodiscard]] virtual AdapterStatus status() const = 0;
     };
 
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace bqs::adapters
+{
+
+    // Extracts the capture timestamp (ns) of the record at `record`, which is
+    // the `index`-th fixed-size record of the stream.
+    using RecordTimestampFn = std::uint64_t (*)(const std::byte *record, std::uint64_t index);
+
+    struct PacingConfig
+    {
+        // 0 = unpaced (as fast as the consumer pulls); 1 = recorded rate;
+        // N = N times the recorded rate.
+        double speed{0.0};
+        std::size_t record_bytes{0};
+        RecordTimestampFn timestamp{nullptr};
+
+        [[nodiscard]] bool enabled() const noexcept
+        {
+            return speed > 0.0 && record_bytes > 0 && timestamp != nullptr;
+        }
+    };
+
+    struct PacingStats
+    {
+        std::uint64_t sleeps{0};
+        std::uint64_t max_lag_ns{0};
+    };
+
+    // Releases records no earlier than their recorded offset from the first
+    // record, scaled by 1/speed. Long waits sleep and the final stretch spins,
+    // so release jitter stays in the low microseconds.
+    class Pacer
+    {
+    public:
+        void configure(const PacingConfig &cfg) noexcept
+        {
+            cfg_ = cfg;
+            started_ = false;
+        }
+
+        [[nodiscard]] bool enabled() const noexcept { return cfg_.enabled(); }
+
+        // Of the n bytes at data (whose first record has stream index
+        // first_index), returns how many bytes of whole records are due now.
+        // Blocks until at least the first record is due.
+        std::size_t due_bytes(const std::byte *data, std::size_t n, std::uint64_t first_index);
+
+        [[nodiscard]] const PacingStats &stats() const noexcept { return stats_; }
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        [[nodiscard]] clock::time_point due_at(std::uint64_t ts_ns) const noexcept;
+
+        PacingConfig cfg_{};
+        bool started_{false};
+        std::uint64_t ts0_{0};
+        clock::time_point t0_{};
+        PacingStats stats_{};
+    };
+
+} // namespace bqs::adapters
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace bqs::adapters
+{
+
+    // Sequence-indexed holding area for messages that arrived ahead of a
+    // gap. Slot = sequence mod capacity (a power of two), each a fixed-size
+    // copy of the payload, so put/take are O(1) and nothing allocates after
+    // construction. The caller keeps every held sequence inside one window
+    // of `capacity()` starting at the next sequence it expects.
+    class ReorderRing
+    {
+    public:
+        ReorderRing() = default;
+        ReorderRing(std::size_t capacity, std::size_t slot_bytes)
+            : mask_(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity) - 1), slot_bytes_(slot_bytes),
+              data_((mask_ + 1) * slot_bytes), len_(mask_ + 1, kEmpty), ts_(mask_ + 1, 0)
+        {
+        }
+
+        [[nodiscard]] std::size_t capacity() const noexcept { return mask_ + 1; }
+        [[nodiscard]] std::size_t slot_bytes() const noexcept { return slot_bytes_; }
+        [[nodiscard]] std::size_t size() const noexcept { return held_; }
+
+        [[nodiscard]] bool has(std::uint64_t seq) const noexcept { return len_[seq & mask_] != kEmpty; }
+
+        // Copies msg into seq's slot; false if it is too large or already held.
+        bool put(std::uint64_t seq, std::span<const std::byte> msg, std::uint64_t ts) noexcept
+        {
+            const std::size_t i = seq & mask_;
+            if (msg.size() > slot_bytes_ || len_[i] != kEmpty)
+                return false;
+            std::memcpy(data_.data() + i * slot_bytes_, msg.data(), msg.size());
+            len_[i] = static_cast<std::uint32_t>(msg.size());
+            ts_[i] = ts;
+            ++held_;
+            return true;
+        }
+
+        // Releases seq's slot; the returned view stays valid until the slot
+        // is reused (seq + capacity()).
+        std::span<const std::byte> take(std::uint64_t seq, std::uint64_t &ts) noexcept
+        {
+            const std::size_t i = seq & mask_;
+            const std::span<const std::byte> v{data_.data() + i * slot_bytes_, len_[i]};
+            ts = ts_[i];
+            len_[i] = kEmpty;
+            --held_;
+            return v;
+        }
+
+        void clear() noexcept
+        {
+            std::fill(len_.begin(), len_.end(), kEmpty);
+            held_ = 0;
+        }
+
+    private:
+        // Occupancy is tracked per slot only; the window rule makes the
+        // sequence implicit.
+        static constexpr std::uint32_t kEmpty = ~0u;
+
+        std::size_t mask_{0};
+        std::size_t slot_bytes_{0};
+        std::vector<std::byte> data_;
+        std::vector<std::uint32_t> len_;
+        std::vector<std::uint64_t> ts_;
+        std::size_t held_{0};
+    };
+
+} // namespace bqs::adapters
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "bqs/adapters/adapter_types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bqs::adapters
+{
+
+    // MoldUDP64 retransmission ("rewinder") request: a 20-byte packet of
+    // session, first sequence and message count sent by unicast UDP; the
+    // server answers with ordinary downstream packets to the requester.
+    struct RewindOptions
+    {
+        // "host:port" of the rewinder; empty disables gap recovery.
+        std::string server;
+        // Messages asked for per request (a response must fit one datagram
+        // per request in most servers, so keep this modest).
+        std::uint16_t max_per_request{256};
+        // Requests in flight at once.
+        std::size_t max_outstanding{8};
+        // Token-bucket limit on requests sent, including retries.
+        double requests_per_sec{2000.0};
+        std::uint32_t burst{16};
+        // Unanswered requests are re-sent after retry_ms, at most max_retries times.
+        int retry_ms{50};
+        int max_retries{3};
+    };
+
+    struct RewindStats
+    {
+        std::uint64_t requests{0};
+        std::uint64_t retries{0};
+        std::uint64_t abandoned{0};
+        // Ranges merged into an already wanted range.
+        std::uint64_t coalesced{0};
+        // pump() calls that had work but no request token.
+        std::uint64_t rate_limited{0};
+        std::uint64_t responses{0};
+    };
+
+    // Gap-fill client. Wanted ranges are kept coalesced (overlapping and
+    // adjacent ranges merge), cut into requests of max_per_request, and sent
+    // under the outstanding and rate limits; pump() drives sending and
+    // retries. The owning adapter reports progress through satisfied_below().
+    class RewindClient
+    {
+    public:
+        ~RewindClient() { close(); }
+
+        bool open(const RewindOptions &opts, std::string &err);
+        void close();
+        [[nodiscard]] bool is_open() const noexcept { return fd_ >= 0; }
+        [[nodiscard]] int fd() const noexcept { return fd_; }
+
+        void set_session(const char (&session)[10]);
+        void request(const SequenceRange &missing);
+        // Everything below seq has been delivered or given up: forget it.
+        void satisfied_below(std::uint64_t seq);
+        void pump(std::chrono::steady_clock::time_point now);
+        // One response datagram (non-blocking); 0 when none is waiting.
+        std::size_t receive(std::span<std::byte> buf);
+
+        [[nodiscard]] bool idle() const noexcept { return wanted_.empty() && outstanding_.empty(); }
+        [[nodiscard]] const RewindStats &stats() const noexcept { return stats_; }
+
+    private:
+        struct InFlight
+        {
+            std::uint64_t begin;
+            std::uint16_t count;
+            std::chrono::steady_clock::time_point sent;
+            int tries;
+        };
+
+        bool send(std::uint64_t begin, std::uint16_t count);
+
+        RewindOptions opts_{};
+        int fd_{-1};
+        char session_[10]{};
+        std::map<std::uint64_t, std::uint64_t> wanted_; // begin -> end (inclusive)
+        std::vector<InFlight> outstanding_;
+        double tokens_{0.0};
+        std::chrono::steady_clock::time_point refilled_{};
+        RewindStats stats_{};
+    };
+
+    // Stand-in rewinder for tests and the loopback sender: answers requests
+    // from an in-memory capture of fixed-size records (record k carries
+    // sequence first_seq + k) on a background thread.
+    class RewindServer
+    {
+    public:
+        // capture must outlive the server.
+        RewindServer(std::span<const std::byte> capture, std::size_t record_bytes, std::string session,
+                     std::uint64_t first_seq = 1);
+        ~RewindServer() { stop(); }
+
+        // Binds bind_addr:port (0 = ephemeral) and starts serving.
+        bool start(const std::string &bind_addr, std::uint16_t port, std::string &err);
+        void stop();
+        [[nodiscard]] std::uint16_t port() const noexcept { return port_; }
+
+        // Ignore the next n requests (exercises client retries).
+        void drop_next(std::uint32_t n) noexcept { drop_next_.store(n); }
+        [[nodiscard]] std::uint64_t requests() const noexcept { return requests_.load(); }
+
+    private:
+        void serve();
+
+        std::span<const std::byte> capture_;
+        std::size_t record_bytes_;
+        std::string session_;
+        std::uint64_t first_seq_;
+        int fd_{-1};
+        std::uint16_t port_{0};
+        std::atomic<bool> stop_{false};
+        std::atomic<std::uint32_t> drop_next_{0};
+        std::atomic<std::uint64_t> requests_{0};
+        std::thread thread_;
+    };
+
+} // namespace bqs::adapters
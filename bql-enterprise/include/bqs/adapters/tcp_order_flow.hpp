@@ -0,0 +1,211 @@
+#pragma once
+
+#include "bqs/adapters/order_codecs.hpp"
+#include "bqs/adapters/order_flow_adapter.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bqs::adapters
+{
+
+    struct OrderFlowOptions
+    {
+        // Send buffer, allocated once at connect(); encoders write into it.
+        std::size_t send_buffer_bytes{1 << 20};
+        bool tcp_nodelay{true};
+        // Push each message to the socket as it is queued. When false the
+        // caller batches and calls flush().
+        bool flush_each{true};
+    };
+
+    struct OrderFlowStats
+    {
+        std::uint64_t orders{0};
+        std::uint64_t raw_messages{0};
+        std::uint64_t bytes{0};
+        std::uint64_t send_calls{0};
+        // send() calls that left bytes queued (socket buffer full).
+        std::uint64_t partial_sends{0};
+        // Messages refused because the send buffer had no room.
+        std::uint64_t rejected{0};
+    };
+
+    // Non-template half of a TCP order-entry session: the connection and the
+    // send buffer. Messages are encoded in place at reserve() and queued by
+    // commit(); flush() writes as much as the socket takes without blocking.
+    class TcpOrderSession
+    {
+    public:
+        TcpOrderSession() = default;
+        ~TcpOrderSession() { close(); }
+        TcpOrderSession(const TcpOrderSession &) = delete;
+        TcpOrderSession &operator=(const TcpOrderSession &) = delete;
+
+        // endpoint is "host:port" (IPv4).
+        bool open(const std::string &endpoint, const OrderFlowOptions &opts, std::string &err);
+        void close();
+        [[nodiscard]] bool is_open() const noexcept { return fd_ >= 0; }
+
+        // Room for n bytes at the end of the queue, or nullptr if even after
+        // flushing there is none.
+        std::byte *reserve(std::size_t n);
+        void commit(std::size_t n) noexcept { tail_ += n; }
+        // False on a socket error (see error()).
+        bool flush();
+        [[nodiscard]] std::size_t queued() const noexcept { return tail_ - head_; }
+        [[nodiscard]] const std::string &error() const noexcept { return error_; }
+        [[nodiscard]] const OrderFlowStats &stats() const noexcept { return stats_; }
+        OrderFlowStats &stats() noexcept { return stats_; }
+
+    private:
+        int fd_{-1};
+        std::vector<std::byte> buf_;
+        std::size_t head_{0};
+        std::size_t tail_{0};
+        std::string error_;
+        OrderFlowStats stats_{};
+    };
+
+    // Order entry over TCP with a compile-time encoder (SbeNewOrderCodec,
+    // FixNewOrderCodec or anything of the same shape). send() encodes the
+    // order directly into the session's send buffer: no string, no heap.
+    template <typename Codec>
+    class TcpOrderFlowAdapter final : public IOrderFlowAdapter
+    {
+    public:
+        explicit TcpOrderFlowAdapter(Codec codec = {}, OrderFlowOptions opts = {})
+            : codec_(std::move(codec)), opts_(opts)
+        {
+        }
+
+        void configure(const AdapterConfig &cfg) override { cfg_ = cfg; }
+
+        void connect() override
+        {
+            status_ = AdapterStatus{SessionState::connecting, 0, {}};
+            std::string err;
+            if (!session_.open(cfg_.endpoint, opts_, err))
+            {
+                status_ = AdapterStatus{SessionState::disconnected, 0, err};
+                return;
+            }
+            status_.state = SessionState::established;
+        }
+
+        void disconnect() override
+        {
+            if (session_.is_open())
+                session_.flush();
+            session_.close();
+            if (status_.state != SessionState::disconnected)
+                status_.state = SessionState::closed;
+        }
+
+        void send_raw(std::string_view payload) override
+        {
+            std::byte *p = reserve(payload.size());
+            if (!p)
+                return;
+            std::memcpy(p, payload.data(), payload.size());
+            session_.commit(payload.size());
+            ++session_.stats().raw_messages;
+            after_queue();
+        }
+
+        void send(const NewOrder &order) override
+        {
+            std::byte *p = reserve(Codec::kMaxBytes);
+            if (!p)
+                return;
+            session_.commit(codec_.encode(order, p));
+            ++session_.stats().orders;
+            after_queue();
+        }
+
+        bool flush()
+        {
+            if (!session_.flush())
+                fail();
+            return status_.state == SessionState::established;
+        }
+
+        [[nodiscard]] AdapterStatus status() const override { return status_; }
+        [[nodiscard]] const OrderFlowStats &stats() const noexcept { return session_.stats(); }
+        [[nodiscard]] Codec &codec() noexcept { return codec_; }
+
+    private:
+        std::byte *reserve(std::size_t n)
+        {
+            if (status_.state != SessionState::established)
+                return nullptr;
+            std::byte *p = session_.reserve(n);
+            if (!p)
+            {
+                ++session_.stats().rejected;
+                if (!session_.error().empty())
+                    fail();
+            }
+            return p;
+        }
+
+        void after_queue()
+        {
+            ++status_.last_sequence;
+            if (opts_.flush_each)
+                flush();
+        }
+
+        void fail()
+        {
+            status_.state = SessionState::disconnected;
+            status_.detail = session_.error();
+        }
+
+        Codec codec_;
+        OrderFlowOptions opts_;
+        AdapterConfig cfg_{};
+        AdapterStatus status_{};
+        TcpOrderSession session_;
+    };
+
+    // Stand-in venue for tests and benches: accepts one TCP connection on
+    // 127.0.0.1 and collects everything it receives on a background thread.
+    class TcpSink
+    {
+    public:
+        TcpSink() = default;
+        ~TcpSink() { stop(); }
+        TcpSink(const TcpSink &) = delete;
+        TcpSink &operator=(const TcpSink &) = delete;
+
+        // Listens on port (0 = ephemeral).
+        bool start(std::uint16_t port, std::string &err);
+        void stop();
+        [[nodiscard]] std::uint16_t port() const noexcept { return port_; }
+        [[nodiscard]] std::string endpoint() const { return "127.0.0.1:" + std::to_string(port_); }
+
+        // Waits until at least n bytes arrived (or timeout); returns a copy.
+        std::vector<std::byte> wait_for(std::size_t n, std::chrono::milliseconds timeout);
+
+    private:
+        void serve();
+
+        int listen_fd_{-1};
+        std::uint16_t port_{0};
+        std::atomic<bool> stop_{false};
+        std::thread thread_;
+        std::mutex mu_;
+        std::vector<std::byte> data_;
+    };
+
+} // namespace bqs::adapters
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include <sys/uio.h>
+
+namespace bqs::adapters
+{
+
+    // One completed request: the user_data it was submitted with and the
+    // result (bytes, or -errno).
+    struct UringCompletion
+    {
+        std::uint64_t user_data{0};
+        std::int32_t result{0};
+    };
+
+    // Minimal io_uring instance on the raw syscalls (no liburing): the SQ
+    // and CQ rings and the SQE array mapped once, reads queued with read(),
+    // one io_uring_enter per submit_and_wait(). Only what the file reader
+    // needs; not thread-safe.
+    class IoUring
+    {
+    public:
+        IoUring() = default;
+        ~IoUring() { close(); }
+        IoUring(const IoUring &) = delete;
+        IoUring &operator=(const IoUring &) = delete;
+
+        // False with err set when the kernel has no io_uring (or it is
+        // disabled by policy).
+        bool open(unsigned entries, std::string &err);
+        void close();
+        [[nodiscard]] bool is_open() const noexcept { return fd_ >= 0; }
+
+        // Registers fixed buffers; read() with a buf_index then skips the
+        // per-request page pinning. False if the kernel refuses (memlock).
+        bool register_buffers(std::span<const iovec> bufs) noexcept;
+        [[nodiscard]] bool buffers_registered() const noexcept { return registered_; }
+
+        // Queues a read of len bytes at off into buf (buf_index is used when
+        // buffers are registered). False if the SQ is full.
+        bool read(int fd, void *buf, std::uint32_t len, std::uint64_t off, std::uint16_t buf_index,
+                  std::uint64_t user_data) noexcept;
+        // Submits queued reads and waits for at least min_complete
+        // completions. Returns false (errno set) on failure.
+        bool submit_and_wait(unsigned min_complete) noexcept;
+        // Takes one completion if there is one.
+        bool peek(UringCompletion &out) noexcept;
+
+    private:
+        int fd_{-1};
+        void *sq_map_{nullptr};
+        std::size_t sq_map_bytes_{0};
+        void *cq_map_{nullptr};
+        std::size_t cq_map_bytes_{0};
+        void *sqes_{nullptr};
+        std::size_t sqes_bytes_{0};
+        std::uint32_t *sq_head_{nullptr};
+        std::uint32_t *sq_tail_{nullptr};
+        std::uint32_t *sq_array_{nullptr};
+        std::uint32_t sq_mask_{0};
+        std::uint32_t *cq_head_{nullptr};
+        std::uint32_t *cq_tail_{nullptr};
+        void *cqes_{nullptr};
+        std::uint32_t cq_mask_{0};
+        unsigned to_submit_{0};
+        bool registered_{false};
+    };
+
+} // namespace bqs::adapters
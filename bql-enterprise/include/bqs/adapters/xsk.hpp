@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bqs::adapters
+{
+
+    struct XdpOptions
+    {
+        // Interface whose RX queue is taken over; empty disables AF_XDP.
+        std::string ifname;
+        std::uint32_t queue{0};
+        // UMEM: frames of frame_bytes each (both powers of two).
+        std::uint32_t frames{8192};
+        std::uint32_t frame_bytes{2048};
+        // RX ring entries (power of two). The fill ring holds every frame.
+        std::uint32_t ring_size{4096};
+        // Ask for XDP_ZEROCOPY first; drivers without it get copy mode.
+        bool zero_copy{true};
+    };
+
+    // One received frame, in place in the UMEM. addr goes back to release()
+    // once the caller is done with the bytes.
+    struct XdpFrame
+    {
+        const std::byte *data{nullptr};
+        std::uint32_t len{0};
+        std::uint64_t addr{0};
+    };
+
+    // An AF_XDP socket bound to one RX queue, set up with raw syscalls (no
+    // libbpf): a UMEM of fixed frames, the fill and RX rings mapped into our
+    // address space (a completion ring is registered because bind() insists,
+    // but nothing is transmitted), and a small XDP program that redirects
+    // IPv4 UDP datagrams for one destination port into the socket and
+    // passes everything else to the kernel stack. Received frames are
+    // whole Ethernet frames; they stay ours until release() hands them back
+    // through the fill ring. The program detaches when the socket closes.
+    class XskSocket
+    {
+    public:
+        XskSocket() = default;
+        ~XskSocket() { close(); }
+        XskSocket(const XskSocket &) = delete;
+        XskSocket &operator=(const XskSocket &) = delete;
+
+        // False with err set if any step fails (no AF_XDP, no privilege,
+        // unknown interface, ...); nothing is left attached in that case.
+        bool open(const XdpOptions &opts, std::uint16_t udp_port, std::string &err);
+        void close();
+        [[nodiscard]] bool is_open() const noexcept { return fd_ >= 0; }
+        [[nodiscard]] int fd() const noexcept { return fd_; }
+        [[nodiscard]] bool zero_copy() const noexcept { return zero_copy_; }
+        // The program runs in the driver (not the generic skb hook).
+        [[nodiscard]] bool native() const noexcept { return native_; }
+
+        // Takes up to n frames off the RX ring.
+        std::size_t receive(XdpFrame *out, std::size_t n) noexcept;
+        // Returns a frame to the kernel through the fill ring.
+        void release(std::uint64_t addr) noexcept;
+        // Sleeps until the RX ring is non-empty or timeout_ms passes.
+        void wait(int timeout_ms) noexcept;
+        // In need-wakeup mode the kernel stops refilling until poked; busy
+        // pollers call this when the RX ring comes up empty.
+        void kick() noexcept;
+
+    private:
+        struct Ring
+        {
+            std::uint32_t *producer{nullptr};
+            std::uint32_t *consumer{nullptr};
+            std::uint32_t *flags{nullptr};
+            void *desc{nullptr};
+            std::uint32_t mask{0};
+            void *map{nullptr};
+            std::size_t map_bytes{0};
+        };
+
+        bool attach(std::uint16_t udp_port, std::string &err);
+
+        int fd_{-1};
+        int map_fd_{-1};
+        int prog_fd_{-1};
+        int link_fd_{-1};
+        std::byte *umem_{nullptr};
+        std::size_t umem_bytes_{0};
+        std::uint64_t frame_mask_{0};
+        std::uint32_t ifindex_{0};
+        std::uint32_t queue_{0};
+        Ring rx_{};
+        Ring fill_{};
+        bool zero_copy_{false};
+        bool native_{false};
+    };
+
+} // namespace bqs::adapters
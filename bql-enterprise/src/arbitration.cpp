@@ -0,0 +1,259 @@
+#include "bqs/adapters/arbitration.hpp"
+
+#include <cstring>
+#include <ctime>
+
+#include <poll.h>
+
+namespace bqs::adapters
+{
+
+    namespace
+    {
+        UdpFeedOptions line_options(UdpFeedOptions o)
+        {
+            // The arbiter multiplexes both sockets itself.
+            o.wait_ms = 0;
+            return o;
+        }
+    } // namespace
+
+    ArbitratedMarketDataAdapter::ArbitratedMarketDataAdapter(UdpFeedOptions line, ArbitrationOptions opts)
+        : opts_(opts), a_(line_options(line)), b_(line_options(line)), window_(opts.window)
+    {
+        lines_[0].feed = &a_;
+        lines_[1].feed = &b_;
+    }
+
+    void ArbitratedMarketDataAdapter::configure(const AdapterConfig &cfg)
+    {
+        cfg_ = cfg;
+        const auto comma = cfg.endpoint.find(',');
+        AdapterConfig a = cfg, b = cfg;
+        a.name = cfg.name + ".A";
+        b.name = cfg.name + ".B";
+        a.endpoint = cfg.endpoint.substr(0, comma);
+        b.endpoint = comma == std::string::npos ? std::string{} : cfg.endpoint.substr(comma + 1);
+        a_.configure(a);
+        b_.configure(b);
+    }
+
+    void ArbitratedMarketDataAdapter::connect()
+    {
+        disconnect();
+        stats_ = ArbitrationStats{};
+        window_ = SequenceWindow(opts_.window);
+        next_ = first_ = cfg_.start_sequence;
+        hole_open_ = false;
+        has_pending_ = false;
+        a_.connect();
+        b_.connect();
+        for (Line &l : lines_)
+            l.has = false;
+        // One line is enough to run on; both down is a failed connect.
+        status_ = AdapterStatus{SessionState::established, next_ ? next_ - 1 : 0, {}};
+        if (!live(lines_[0]) && !live(lines_[1]))
+        {
+            status_.state = SessionState::disconnected;
+            status_.detail = "A: " + a_.status().detail + "; B: " + b_.status().detail;
+        }
+        else if (!live(lines_[0]) || !live(lines_[1]))
+            status_.detail = live(lines_[0]) ? "B down: " + b_.status().detail : "A down: " + a_.status().detail;
+    }
+
+    void ArbitratedMarketDataAdapter::disconnect()
+    {
+        a_.disconnect();
+        b_.disconnect();
+        if (status_.state != SessionState::disconnected)
+            status_.state = SessionState::closed;
+    }
+
+    bool ArbitratedMarketDataAdapter::live(const Line &l) noexcept
+    {
+        const SessionState s = l.feed->status().state;
+        return s == SessionState::established || s == SessionState::recovering;
+    }
+
+    void ArbitratedMarketDataAdapter::refill(int i)
+    {
+        Line &l = lines_[i];
+        ArbitrationLineStats &ls = stats_.line[i];
+        for (;;)
+        {
+            if (!l.has)
+            {
+                if (!live(l) || !l.feed->next_message(l.msg))
+                    return;
+                l.has = true;
+                ++ls.messages;
+            }
+            const std::uint64_t seq = l.msg.sequence;
+            if (next_ == 0 || seq >= next_)
+                return;
+            if (seq < first_ || seq + window_.span() <= next_)
+                ++stats_.stale;
+            else if (window_.seen(seq))
+            {
+                ++ls.duplicates;
+                const std::uint64_t won = window_.first_ts(seq);
+                if (won && l.msg.rx_ts_ns)
+                    ls.lag_ns.add(l.msg.rx_ts_ns > won ? l.msg.rx_ts_ns - won : 0);
+            }
+            else
+            {
+                // Fills a hole that later messages were already released
+                // past: applying it now would be out of order, so it stays
+                // in `missing`. Marked seen so the other copy is a duplicate.
+                ++stats_.late;
+                window_.set(seq, l.msg.rx_ts_ns);
+            }
+            l.has = false;
+        }
+    }
+
+    void ArbitratedMarketDataAdapter::emit(int i, MoldMessage &out)
+    {
+        Line &l = lines_[i];
+        const std::uint64_t seq = l.msg.sequence;
+        if (next_ == 0)
+            next_ = seq;
+        if (first_ == 0)
+            first_ = seq;
+        // refill() only leaves messages at or past next_.
+        if (seq > next_)
+        {
+            ++stats_.gaps;
+            stats_.missing += seq - next_;
+        }
+        window_.clear(next_, seq + 1);
+        next_ = seq + 1;
+        status_.last_sequence = seq;
+        window_.set(seq, l.msg.rx_ts_ns);
+        ++stats_.line[i].wins;
+        ++stats_.emitted;
+        hole_open_ = false;
+        l.has = false;
+        // Valid until the next call into this line, i.e. into the arbiter.
+        out = l.msg;
+    }
+
+    void ArbitratedMarketDataAdapter::wait_lines(std::chrono::steady_clock::time_point until)
+    {
+        pollfd fds[2];
+        nfds_t n = 0;
+        for (const Line &l : lines_)
+            if (!l.has && live(l))
+                fds[n++] = pollfd{l.feed->fd(), POLLIN, 0};
+        const auto left = until - std::chrono::steady_clock::now();
+        if (n == 0 || left <= std::chrono::nanoseconds::zero())
+            return;
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+        const timespec ts{static_cast<time_t>(ns / 1'000'000'000), static_cast<long>(ns % 1'000'000'000)};
+        ::ppoll(fds, n, &ts, nullptr);
+    }
+
+    bool ArbitratedMarketDataAdapter::next_message(MoldMessage &out)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(opts_.wait_ms);
+        for (;;)
+        {
+            refill(0);
+            refill(1);
+            int c = -1;
+            if (lines_[0].has && lines_[1].has)
+            {
+                // Lowest sequence first; on a tie the earlier kernel stamp wins.
+                const MoldMessage &a = lines_[0].msg, &b = lines_[1].msg;
+                c = (b.sequence < a.sequence || (b.sequence == a.sequence && b.rx_ts_ns < a.rx_ts_ns)) ? 1 : 0;
+            }
+            else if (lines_[0].has || lines_[1].has)
+                c = lines_[0].has ? 0 : 1;
+
+            if (c >= 0)
+            {
+                const Line &other = lines_[1 - c];
+                const std::uint64_t seq = lines_[c].msg.sequence;
+                // A message past a hole is held while the other line may
+                // still deliver the hole; if that line is past it too, or
+                // gone, nobody will.
+                if (next_ == 0 || seq <= next_ || opts_.gap_wait_us == 0 || other.has || !live(other))
+                {
+                    emit(c, out);
+                    return true;
+                }
+                const auto now = std::chrono::steady_clock::now();
+                if (!hole_open_)
+                {
+                    hole_open_ = true;
+                    hole_deadline_ = now + std::chrono::microseconds(opts_.gap_wait_us);
+                }
+                if (now >= hole_deadline_)
+                {
+                    emit(c, out);
+                    return true;
+                }
+                if (now >= deadline)
+                    return false;
+                wait_lines(std::min(hole_deadline_, deadline));
+                continue;
+            }
+
+            // Nothing pending. A line that saw end of session knows where the
+            // feed stops; once we are there the session is over.
+            bool any_live = false, ended = false, done = false;
+            for (const Line &l : lines_)
+            {
+                any_live |= live(l);
+                if (l.feed->status().state == SessionState::closed)
+                {
+                    ended = true;
+                    done |= next_ != 0 && next_ >= l.feed->expected_sequence();
+                }
+            }
+            if (done || !any_live)
+            {
+                status_.state = ended ? SessionState::closed : SessionState::disconnected;
+                status_.detail = ended ? "end of session" : "A: " + a_.status().detail + "; B: " + b_.status().detail;
+                return false;
+            }
+            if (std::chrono::steady_clock::now() >= deadline)
+                return false;
+            wait_lines(deadline);
+        }
+    }
+
+    std::size_t ArbitratedMarketDataAdapter::read(std::span<std::byte> out)
+    {
+        std::size_t n = 0;
+        MoldMessage m;
+        while (has_pending_ || next_message(m))
+        {
+            if (has_pending_)
+                m = pending_;
+            if (m.payload.size() > out.size() - n)
+            {
+                if (n == 0)
+                {
+                    // Can never fit this buffer: drop it rather than stall.
+                    ++stats_.malformed;
+                    has_pending_ = false;
+                    continue;
+                }
+                pending_ = m;
+                has_pending_ = true;
+                break;
+            }
+            has_pending_ = false;
+            std::memcpy(out.data() + n, m.payload.data(), m.payload.size());
+            n += m.payload.size();
+        }
+        return n;
+    }
+
+    void ArbitratedMarketDataAdapter::request_gap_fill(const SequenceRange &missing)
+    {
+        status_.detail = "gap " + std::to_string(missing.begin_inclusive) + "-" + std::to_string(missing.end_inclusive);
+    }
+
+} // namespace bqs::adapters
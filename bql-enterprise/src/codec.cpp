@@ -0,0 +1,419 @@
+#include "bqs/adapters/codec.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef BQS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef BQS_HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+namespace bqs::adapters
+{
+
+    namespace
+    {
+        constexpr std::uint32_t kZstdMagic = 0xFD2FB528u;
+        constexpr std::uint32_t kLz4Magic = 0x184D2204u;
+        // Shared by both formats: 0x184D2A50..0x184D2A5F, then a 32-bit length.
+        constexpr std::uint32_t kSkippableMagic = 0x184D2A50u;
+        constexpr std::uint32_t kSkippableMask = 0xFFFFFFF0u;
+
+        std::uint32_t le32(const std::byte *p) noexcept
+        {
+            std::uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        std::uint64_t le64(const std::byte *p) noexcept
+        {
+            std::uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        bool missing(Codec c, std::string &err)
+        {
+            err = std::string("this build has no ") + codec_name(c) + " support";
+            return false;
+        }
+
+        bool truncated(std::uint64_t at, std::string &err)
+        {
+            err = "truncated frame at offset " + std::to_string(at);
+            return false;
+        }
+
+        // Length of the LZ4 frame at p (at most n bytes), from its header and
+        // block headers; 0 if it runs past n.
+        std::size_t lz4_frame_bytes(const std::byte *p, std::size_t n, std::uint64_t &content, std::string &err)
+        {
+            if (n < 7)
+                return 0;
+            const auto flg = static_cast<std::uint8_t>(p[4]);
+            if ((flg >> 6) != 1)
+            {
+                err = "unsupported LZ4 frame version";
+                return 0;
+            }
+            std::size_t q = 4 + 2 + ((flg & 0x08) ? 8 : 0) + ((flg & 0x01) ? 4 : 0) + 1;
+            if (q > n)
+                return 0;
+            content = (flg & 0x08) ? le64(p + 6) : CompressedFrame::kUnknownSize;
+            const std::size_t block_check = (flg & 0x10) ? 4 : 0;
+            for (;;)
+            {
+                if (n - q < 4)
+                    return 0;
+                const std::uint32_t bs = le32(p + q);
+                q += 4;
+                if (bs == 0)
+                    break;
+                const std::size_t len = (bs & 0x7FFFFFFFu) + block_check;
+                if (n - q < len)
+                    return 0;
+                q += len;
+            }
+            if (flg & 0x04)
+                q += 4;
+            return q <= n ? q : 0;
+        }
+    } // namespace
+
+    Codec detect_codec(std::span<const std::byte> head) noexcept
+    {
+        if (head.size() < 4)
+            return Codec::none;
+        const std::uint32_t m = le32(head.data());
+        if (m == kZstdMagic || (m & kSkippableMask) == kSkippableMagic)
+            return Codec::zstd;
+        if (m == kLz4Magic)
+            return Codec::lz4;
+        return Codec::none;
+    }
+
+    Codec detect_codec(const std::string &path) noexcept
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return Codec::none;
+        Codec c = Codec::none;
+        std::byte head[8];
+        off_t off = 0;
+        for (int i = 0; i < 16 && ::pread(fd, head, sizeof(head), off) == static_cast<ssize_t>(sizeof(head)); ++i)
+        {
+            c = detect_codec(std::span<const std::byte>(head));
+            if ((le32(head) & kSkippableMask) != kSkippableMagic)
+                break;
+            c = Codec::none;
+            off += 8 + static_cast<off_t>(le32(head + 4));
+        }
+        ::close(fd);
+        return c;
+    }
+
+    const char *codec_name(Codec c) noexcept
+    {
+        switch (c)
+        {
+        case Codec::zstd:
+            return "zstd";
+        case Codec::lz4:
+            return "lz4";
+        case Codec::none:
+            break;
+        }
+        return "none";
+    }
+
+    bool codec_available(Codec c) noexcept
+    {
+        switch (c)
+        {
+        case Codec::zstd:
+#ifdef BQS_HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+        case Codec::lz4:
+#ifdef BQS_HAVE_LZ4
+            return true;
+#else
+            return false;
+#endif
+        case Codec::none:
+            break;
+        }
+        return true;
+    }
+
+    bool scan_frames(Codec c, std::span<const std::byte> file, std::vector<CompressedFrame> &out, std::string &err)
+    {
+        out.clear();
+        if (c == Codec::none || !codec_available(c))
+            return missing(c, err);
+        const std::byte *p = file.data();
+        const std::size_t n = file.size();
+        std::size_t pos = 0;
+        while (pos < n)
+        {
+            if (n - pos < 8)
+                return truncated(pos, err);
+            const std::uint32_t m = le32(p + pos);
+            if ((m & kSkippableMask) == kSkippableMagic)
+            {
+                const std::size_t len = 8 + std::size_t{le32(p + pos + 4)};
+                if (n - pos < len)
+                    return truncated(pos, err);
+                pos += len;
+                continue;
+            }
+            CompressedFrame f;
+            f.offset = pos;
+            if (c == Codec::lz4)
+            {
+                if (m != kLz4Magic)
+                {
+                    err = "not an LZ4 frame at offset " + std::to_string(pos);
+                    return false;
+                }
+                f.bytes = lz4_frame_bytes(p + pos, n - pos, f.content_bytes, err);
+                if (f.bytes == 0)
+                    return err.empty() ? truncated(pos, err) : false;
+            }
+            else
+            {
+#ifdef BQS_HAVE_ZSTD
+                const std::size_t len = ZSTD_findFrameCompressedSize(p + pos, n - pos);
+                if (ZSTD_isError(len))
+                {
+                    err = "bad zstd frame at offset " + std::to_string(pos) + ": " + ZSTD_getErrorName(len);
+                    return false;
+                }
+                f.bytes = len;
+                const unsigned long long cs = ZSTD_getFrameContentSize(p + pos, n - pos);
+                if (cs == ZSTD_CONTENTSIZE_ERROR)
+                {
+                    err = "bad zstd frame header at offset " + std::to_string(pos);
+                    return false;
+                }
+                if (cs != ZSTD_CONTENTSIZE_UNKNOWN)
+                    f.content_bytes = cs;
+#endif
+            }
+            out.push_back(f);
+            pos += f.bytes;
+        }
+        return true;
+    }
+
+    // --- FrameDecoder ---
+
+    FrameDecoder::~FrameDecoder()
+    {
+#ifdef BQS_HAVE_ZSTD
+        ZSTD_freeDCtx(static_cast<ZSTD_DCtx *>(zstd_));
+#endif
+#ifdef BQS_HAVE_LZ4
+        if (lz4_)
+            LZ4F_freeDecompressionContext(static_cast<LZ4F_dctx *>(lz4_));
+#endif
+    }
+
+    bool FrameDecoder::ready(Codec c, std::string &err)
+    {
+        if (!codec_available(c) || c == Codec::none)
+            return missing(c, err);
+#ifdef BQS_HAVE_ZSTD
+        if (c == Codec::zstd && !zstd_)
+            zstd_ = ZSTD_createDCtx();
+        if (c == Codec::zstd && !zstd_)
+        {
+            err = "ZSTD_createDCtx failed";
+            return false;
+        }
+#endif
+#ifdef BQS_HAVE_LZ4
+        if (c == Codec::lz4 && !lz4_)
+        {
+            LZ4F_dctx *d = nullptr;
+            if (LZ4F_isError(LZ4F_createDecompressionContext(&d, LZ4F_VERSION)))
+            {
+                err = "LZ4F_createDecompressionContext failed";
+                return false;
+            }
+            lz4_ = d;
+        }
+#endif
+        return true;
+    }
+
+    bool FrameDecoder::decode_frame(Codec c, std::span<const std::byte> frame, std::uint64_t content_bytes,
+                                    std::vector<std::byte> &out, std::string &err)
+    {
+        if (!ready(c, err))
+            return false;
+        // Start clean, whatever an earlier frame left behind.
+#ifdef BQS_HAVE_ZSTD
+        if (c == Codec::zstd)
+        {
+            auto *d = static_cast<ZSTD_DCtx *>(zstd_);
+            ZSTD_DCtx_reset(d, ZSTD_reset_session_only);
+            if (content_bytes != CompressedFrame::kUnknownSize)
+            {
+                // Known size: one shot, straight into out.
+                out.resize(content_bytes);
+                const std::size_t r = ZSTD_decompressDCtx(d, out.data(), out.size(), frame.data(), frame.size());
+                if (ZSTD_isError(r))
+                {
+                    err = std::string("zstd: ") + ZSTD_getErrorName(r);
+                    return false;
+                }
+                if (r != content_bytes)
+                {
+                    err = "zstd frame shorter than its header says";
+                    return false;
+                }
+                return true;
+            }
+        }
+#endif
+#ifdef BQS_HAVE_LZ4
+        if (c == Codec::lz4)
+            LZ4F_resetDecompressionContext(static_cast<LZ4F_dctx *>(lz4_));
+#endif
+        out.resize(content_bytes != CompressedFrame::kUnknownSize
+                       ? static_cast<std::size_t>(content_bytes)
+                       : std::max({out.capacity(), frame.size() * 4, std::size_t{1} << 16}));
+        std::size_t in_pos = 0;
+        std::size_t out_pos = 0;
+        bool done = false;
+        while (!done)
+        {
+            if (out_pos == out.size())
+                out.resize(std::max<std::size_t>(out.size() * 2, std::size_t{1} << 16));
+            if (!decode_some(c, frame, in_pos, out, out_pos, done, err))
+                return false;
+            if (!done && in_pos == frame.size() && out_pos < out.size())
+            {
+                err = "frame ends before its end mark";
+                return false;
+            }
+        }
+        out.resize(out_pos);
+        return true;
+    }
+
+    bool FrameDecoder::decode_some(Codec c, std::span<const std::byte> in, std::size_t &in_pos,
+                                   std::span<std::byte> out, std::size_t &out_pos, bool &frame_done, std::string &err)
+    {
+        if (!ready(c, err))
+            return false;
+        frame_done = false;
+#ifdef BQS_HAVE_ZSTD
+        if (c == Codec::zstd)
+        {
+            ZSTD_inBuffer ib{in.data(), in.size(), in_pos};
+            ZSTD_outBuffer ob{out.data(), out.size(), out_pos};
+            const std::size_t r = ZSTD_decompressStream(static_cast<ZSTD_DCtx *>(zstd_), &ob, &ib);
+            if (ZSTD_isError(r))
+            {
+                err = std::string("zstd: ") + ZSTD_getErrorName(r);
+                return false;
+            }
+            in_pos = ib.pos;
+            out_pos = ob.pos;
+            frame_done = r == 0;
+            return true;
+        }
+#endif
+#ifdef BQS_HAVE_LZ4
+        if (c == Codec::lz4)
+        {
+            std::size_t src = in.size() - in_pos;
+            std::size_t dst = out.size() - out_pos;
+            const std::size_t r = LZ4F_decompress(static_cast<LZ4F_dctx *>(lz4_), out.data() + out_pos, &dst,
+                                                  in.data() + in_pos, &src, nullptr);
+            if (LZ4F_isError(r))
+            {
+                err = std::string("lz4: ") + LZ4F_getErrorName(r);
+                return false;
+            }
+            in_pos += src;
+            out_pos += dst;
+            frame_done = r == 0;
+            return true;
+        }
+#endif
+        (void)in;
+        (void)in_pos;
+        (void)out;
+        (void)out_pos;
+        return missing(c, err);
+    }
+
+    bool encode_frames(Codec c, std::span<const std::byte> in, std::size_t frame_bytes, int level,
+                       std::vector<std::byte> &out, std::string &err)
+    {
+        if (c == Codec::none || !codec_available(c))
+            return missing(c, err);
+        frame_bytes = std::max<std::size_t>(frame_bytes, 1);
+#ifdef BQS_HAVE_ZSTD
+        if (c == Codec::zstd)
+        {
+            ZSTD_CCtx *cc = ZSTD_createCCtx();
+            bool ok = cc != nullptr;
+            for (std::size_t pos = 0; ok && pos < in.size(); pos += frame_bytes)
+            {
+                const std::size_t len = std::min(frame_bytes, in.size() - pos);
+                const std::size_t at = out.size();
+                out.resize(at + ZSTD_compressBound(len));
+                const std::size_t r = ZSTD_compressCCtx(cc, out.data() + at, out.size() - at, in.data() + pos, len, level);
+                ok = !ZSTD_isError(r);
+                out.resize(ok ? at + r : at);
+                if (!ok)
+                    err = std::string("zstd: ") + ZSTD_getErrorName(r);
+            }
+            ZSTD_freeCCtx(cc);
+            return ok;
+        }
+#endif
+#ifdef BQS_HAVE_LZ4
+        if (c == Codec::lz4)
+        {
+            for (std::size_t pos = 0; pos < in.size(); pos += frame_bytes)
+            {
+                const std::size_t len = std::min(frame_bytes, in.size() - pos);
+                LZ4F_preferences_t prefs{};
+                prefs.frameInfo.contentSize = len;
+                prefs.frameInfo.blockSizeID = LZ4F_max4MB;
+                prefs.compressionLevel = level;
+                const std::size_t at = out.size();
+                out.resize(at + LZ4F_compressFrameBound(len, &prefs));
+                const std::size_t r =
+                    LZ4F_compressFrame(out.data() + at, out.size() - at, in.data() + pos, len, &prefs);
+                if (LZ4F_isError(r))
+                {
+                    out.resize(at);
+                    err = std::string("lz4: ") + LZ4F_getErrorName(r);
+                    return false;
+                }
+                out.resize(at + r);
+            }
+            return true;
+        }
+#endif
+        (void)in;
+        (void)level;
+        (void)out;
+        return missing(c, err);
+    }
+
+} // namespace bqs::adapters
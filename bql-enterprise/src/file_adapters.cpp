@@ -0,0 +1,866 @@
+#include "bqs/adapters/file_adapters.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bqs::adapters
+{
+
+    namespace
+    {
+        void fail(AdapterStatus &st, const std::string &what)
+        {
+            st.state = SessionState::disconnected;
+            st.detail = what + ": " + std::strerror(errno);
+        }
+
+        std::string gap_note(const SequenceRange &missing)
+        {
+            return "gap fill not available for file input (" + std::to_string(missing.begin_inclusive) + "-" +
+                   std::to_string(missing.end_inclusive) + ")";
+        }
+    } // namespace
+
+    // --- FileMarketDataAdapter ---
+
+    FileMarketDataAdapter::~FileMarketDataAdapter() { disconnect(); }
+
+    void FileMarketDataAdapter::configure(const AdapterConfig &cfg)
+    {
+        cfg_ = cfg;
+        pacer_.configure(opts_.pacing);
+    }
+
+    void FileMarketDataAdapter::connect()
+    {
+        disconnect();
+        status_ = AdapterStatus{SessionState::connecting, 0, {}};
+        fd_ = ::open(cfg_.endpoint.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0)
+            return fail(status_, "open " + cfg_.endpoint);
+        struct stat st{};
+        if (::fstat(fd_, &st) != 0)
+        {
+            fail(status_, "fstat " + cfg_.endpoint);
+            disconnect();
+            return;
+        }
+        size_ = static_cast<std::uint64_t>(st.st_size);
+        if (opts_.start_offset > size_)
+        {
+            disconnect();
+            status_.state = SessionState::disconnected;
+            status_.detail = "start offset beyond end of " + cfg_.endpoint;
+            return;
+        }
+        ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+        offset_ = opts_.start_offset;
+        status_ = AdapterStatus{SessionState::established, offset_, {}};
+    }
+
+    void FileMarketDataAdapter::disconnect()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+        if (status_.state != SessionState::disconnected)
+            status_.state = SessionState::closed;
+    }
+
+    std::size_t FileMarketDataAdapter::read(std::span<std::byte> out)
+    {
+        if (fd_ < 0 || out.empty())
+            return 0;
+        // pread keeps no file position, so a pacer that releases fewer bytes
+        // than were read simply re-reads the rest next time.
+        ssize_t n;
+        do
+            n = ::pread(fd_, out.data(), out.size(), static_cast<off_t>(offset_));
+        while (n < 0 && errno == EINTR);
+        if (n < 0)
+        {
+            fail(status_, "read " + cfg_.endpoint);
+            return 0;
+        }
+        if (n == 0)
+        {
+            status_.state = SessionState::closed;
+            return 0;
+        }
+        const std::size_t rb = opts_.pacing.record_bytes;
+        const std::size_t k = pacer_.due_bytes(out.data(), static_cast<std::size_t>(n), rb ? offset_ / rb : 0);
+        offset_ += k;
+        status_.last_sequence = offset_;
+        return k;
+    }
+
+    void FileMarketDataAdapter::request_gap_fill(const SequenceRange &missing)
+    {
+        status_.detail = gap_note(missing);
+    }
+
+    // --- MmapMarketDataAdapter ---
+
+    MmapMarketDataAdapter::~MmapMarketDataAdapter() { disconnect(); }
+
+    void MmapMarketDataAdapter::configure(const AdapterConfig &cfg)
+    {
+        cfg_ = cfg;
+        pacer_.configure(opts_.pacing);
+    }
+
+    void MmapMarketDataAdapter::connect()
+    {
+        disconnect();
+        status_ = AdapterStatus{SessionState::connecting, 0, {}};
+        const int fd = ::open(cfg_.endpoint.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return fail(status_, "open " + cfg_.endpoint);
+        struct stat st{};
+        if (::fstat(fd, &st) != 0)
+        {
+            fail(status_, "fstat " + cfg_.endpoint);
+            ::close(fd);
+            return;
+        }
+        size_ = static_cast<std::uint64_t>(st.st_size);
+        if (opts_.start_offset > size_)
+        {
+            ::close(fd);
+            status_.state = SessionState::disconnected;
+            status_.detail = "start offset beyond end of " + cfg_.endpoint;
+            return;
+        }
+        if (size_ > 0)
+        {
+            const int flags = MAP_PRIVATE | (opts_.populate ? MAP_POPULATE : 0);
+            void *p = ::mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                fail(status_, "mmap " + cfg_.endpoint);
+                ::close(fd);
+                return;
+            }
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+            base_ = static_cast<const std::byte *>(p);
+        }
+        // The mapping keeps the file referenced.
+        ::close(fd);
+        offset_ = opts_.start_offset;
+        status_ = AdapterStatus{SessionState::established, offset_, {}};
+    }
+
+    void MmapMarketDataAdapter::disconnect()
+    {
+        if (base_)
+            ::munmap(const_cast<std::byte *>(base_), size_);
+        base_ = nullptr;
+        if (status_.state != SessionState::disconnected)
+            status_.state = SessionState::closed;
+    }
+
+    std::span<const std::byte> MmapMarketDataAdapter::next_frame(std::size_t max_bytes)
+    {
+        if (status_.state != SessionState::established)
+            return {};
+        if (offset_ == size_)
+        {
+            status_.state = SessionState::closed;
+            return {};
+        }
+        if (max_bytes == 0)
+            max_bytes = opts_.frame_bytes ? opts_.frame_bytes : FileSourceOptions::kDefaultFrameBytes;
+        std::size_t len = static_cast<std::size_t>(std::min<std::uint64_t>(max_bytes, size_ - offset_));
+        const std::size_t rb = opts_.pacing.record_bytes;
+        if (pacer_.enabled())
+        {
+            if (len >= rb)
+                len -= len % rb;
+            len = pacer_.due_bytes(base_ + offset_, len, offset_ / rb);
+        }
+        const std::span<const std::byte> frame{base_ + offset_, len};
+        offset_ += len;
+        status_.last_sequence = offset_;
+        return frame;
+    }
+
+    std::size_t MmapMarketDataAdapter::read(std::span<std::byte> out)
+    {
+        if (out.empty())
+            return 0;
+        const auto frame = next_frame(out.size());
+        if (!frame.empty())
+            std::memcpy(out.data(), frame.data(), frame.size());
+        return frame.size();
+    }
+
+    void MmapMarketDataAdapter::request_gap_fill(const SequenceRange &missing)
+    {
+        status_.detail = gap_note(missing);
+    }
+
+    // --- UringFileMarketDataAdapter ---
+
+    namespace
+    {
+        constexpr std::size_t kDirectAlign = 4096;
+    } // namespace
+
+    UringFileMarketDataAdapter::~UringFileMarketDataAdapter() { disconnect(); }
+
+    void UringFileMarketDataAdapter::configure(const AdapterConfig &cfg)
+    {
+        cfg_ = cfg;
+        pacer_.configure(opts_.pacing);
+    }
+
+    void UringFileMarketDataAdapter::connect()
+    {
+        disconnect();
+        status_ = AdapterStatus{SessionState::connecting, 0, {}};
+        stats_ = UringReadStats{};
+        if (opts_.direct)
+        {
+            // tmpfs and friends refuse O_DIRECT; read through the cache there.
+            fd_ = ::open(cfg_.endpoint.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+            stats_.direct = fd_ >= 0;
+        }
+        if (fd_ < 0)
+            fd_ = ::open(cfg_.endpoint.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0)
+            return fail(status_, "open " + cfg_.endpoint);
+        struct stat st{};
+        if (::fstat(fd_, &st) != 0)
+        {
+            fail(status_, "fstat " + cfg_.endpoint);
+            disconnect();
+            return;
+        }
+        size_ = static_cast<std::uint64_t>(st.st_size);
+        if (opts_.start_offset > size_)
+        {
+            disconnect();
+            status_.state = SessionState::disconnected;
+            status_.detail = "start offset beyond end of " + cfg_.endpoint;
+            return;
+        }
+        if (!stats_.direct)
+            ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+        // Page-sized and page-aligned, as O_DIRECT and registration want.
+        chunk_bytes_ = (std::max<std::size_t>(opts_.read_bytes, 1) + kDirectAlign - 1) / kDirectAlign * kDirectAlign;
+        depth_ = std::clamp(opts_.queue_depth, 1u, 256u);
+        void *p = ::mmap(nullptr, std::size_t{depth_} * chunk_bytes_, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+        {
+            fail(status_, "mmap read buffers");
+            disconnect();
+            return;
+        }
+        bufs_ = static_cast<std::byte *>(p);
+        uring_error_.clear();
+        stats_.uring = ring_.open(depth_, uring_error_);
+        if (stats_.uring)
+        {
+            std::vector<iovec> iov(depth_);
+            for (unsigned i = 0; i < depth_; ++i)
+                iov[i] = iovec{buffer(i), chunk_bytes_};
+            stats_.registered = ring_.register_buffers(iov);
+        }
+
+        base_ = opts_.start_offset / kDirectAlign * kDirectAlign;
+        chunks_ = (size_ - base_ + chunk_bytes_ - 1) / chunk_bytes_;
+        result_.assign(depth_, 0);
+        next_chunk_ = 0;
+        holding_ = false;
+        pos_ = len_ = 0;
+        carry_.assign(opts_.pacing.record_bytes, std::byte{0});
+        carry_have_ = tail_part_ = 0;
+        carry_ready_ = false;
+        offset_ = opts_.start_offset;
+        status_ = AdapterStatus{SessionState::established, offset_, {}};
+        for (std::uint64_t c = 0; c < std::min<std::uint64_t>(depth_, chunks_); ++c)
+            if (!submit(c))
+                return;
+    }
+
+    void UringFileMarketDataAdapter::disconnect()
+    {
+        // Let reads still in flight land before their buffers go away.
+        UringCompletion c;
+        while (ring_.is_open() && std::find(result_.begin(), result_.end(), kPending) != result_.end() &&
+               ring_.submit_and_wait(1))
+            while (ring_.peek(c))
+                result_[c.user_data % depth_] = 0;
+        ring_.close();
+        if (bufs_)
+            ::munmap(bufs_, std::size_t{depth_} * chunk_bytes_);
+        bufs_ = nullptr;
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+        if (status_.state != SessionState::disconnected)
+            status_.state = SessionState::closed;
+    }
+
+    void UringFileMarketDataAdapter::fail_io(const std::string &what, int err)
+    {
+        errno = err;
+        fail(status_, what + " " + cfg_.endpoint);
+    }
+
+    std::uint32_t UringFileMarketDataAdapter::chunk_len(std::uint64_t chunk) const noexcept
+    {
+        return static_cast<std::uint32_t>(std::min<std::uint64_t>(chunk_bytes_, size_ - (base_ + chunk * chunk_bytes_)));
+    }
+
+    bool UringFileMarketDataAdapter::submit(std::uint64_t chunk)
+    {
+        const std::uint64_t off = base_ + chunk * chunk_bytes_;
+        const unsigned slot = static_cast<unsigned>(chunk % depth_);
+        result_[slot] = kPending;
+        ++stats_.reads;
+        if (stats_.uring)
+        {
+            // O_DIRECT wants whole blocks; the kernel stops at end of file.
+            const std::uint32_t len = stats_.direct ? static_cast<std::uint32_t>(chunk_bytes_) : chunk_len(chunk);
+            if (ring_.read(fd_, buffer(chunk), len, off, static_cast<std::uint16_t>(slot), chunk) &&
+                ring_.submit_and_wait(0))
+                return true;
+            fail_io("io_uring submit", errno);
+            return false;
+        }
+        ssize_t n;
+        do
+            n = ::pread(fd_, buffer(chunk), chunk_len(chunk), static_cast<off_t>(off));
+        while (n < 0 && errno == EINTR);
+        if (n < 0)
+        {
+            fail_io("read", errno);
+            return false;
+        }
+        result_[slot] = n;
+        return true;
+    }
+
+    bool UringFileMarketDataAdapter::take(std::uint64_t chunk)
+    {
+        const unsigned slot = static_cast<unsigned>(chunk % depth_);
+        if (result_[slot] == kPending)
+            ++stats_.waits;
+        while (result_[slot] == kPending)
+        {
+            UringCompletion c;
+            while (ring_.peek(c))
+            {
+                if (c.result < 0)
+                {
+                    fail_io("io_uring read", -c.result);
+                    return false;
+                }
+                result_[c.user_data % depth_] = c.result;
+            }
+            if (result_[slot] == kPending && !ring_.submit_and_wait(1))
+            {
+                fail_io("io_uring wait", errno);
+                return false;
+            }
+        }
+
+        std::byte *buf = buffer(chunk);
+        const std::uint32_t want = chunk_len(chunk);
+        std::size_t got = std::min<std::size_t>(static_cast<std::size_t>(result_[slot]), want);
+        if (got < want)
+        {
+            // Rare for regular files; finish the read synchronously.
+            ++stats_.short_reads;
+            const std::uint64_t off = base_ + chunk * chunk_bytes_;
+            while (got < want)
+            {
+                const ssize_t n = ::pread(fd_, buf + got, want - got, static_cast<off_t>(off + got));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                {
+                    fail_io("read", n < 0 ? errno : EIO);
+                    return false;
+                }
+                got += static_cast<std::size_t>(n);
+            }
+        }
+        stats_.bytes += want;
+        holding_ = true;
+        pos_ = chunk == 0 ? static_cast<std::size_t>(opts_.start_offset - base_) : 0;
+        len_ = want;
+        tail_part_ = 0;
+
+        const std::size_t rb = carry_.size();
+        if (rb == 0)
+            return true;
+        if (carry_have_)
+        {
+            // Finish the record the previous read ended in.
+            const std::size_t n = std::min(rb - carry_have_, len_ - pos_);
+            std::memcpy(carry_.data() + carry_have_, buf + pos_, n);
+            carry_have_ += n;
+            pos_ += n;
+            carry_ready_ = carry_have_ == rb;
+        }
+        if (chunk + 1 < chunks_)
+        {
+            // The start of a record this read cuts in two is kept back.
+            const std::uint64_t end = base_ + chunk * chunk_bytes_ + len_;
+            tail_part_ = std::min<std::size_t>((end - opts_.start_offset) % rb, len_ - pos_);
+            len_ -= tail_part_;
+        }
+        return true;
+    }
+
+    std::span<const std::byte> UringFileMarketDataAdapter::next_frame(std::size_t max_bytes)
+    {
+        for (;;)
+        {
+            if (status_.state != SessionState::established)
+                return {};
+            const std::size_t rb = carry_.size();
+            if (carry_ready_)
+            {
+                carry_ready_ = false;
+                carry_have_ = 0;
+                if (pacer_.enabled())
+                    (void)pacer_.due_bytes(carry_.data(), rb, offset_ / rb);
+                offset_ += rb;
+                status_.last_sequence = offset_;
+                return {carry_.data(), rb};
+            }
+            if (holding_ && pos_ < len_)
+            {
+                std::size_t len = len_ - pos_;
+                if (max_bytes)
+                    len = std::min(len, max_bytes);
+                if (pacer_.enabled())
+                {
+                    if (len >= rb)
+                        len -= len % rb;
+                    len = pacer_.due_bytes(buffer(next_chunk_) + pos_, len, offset_ / rb);
+                }
+                const std::span<const std::byte> frame{buffer(next_chunk_) + pos_, len};
+                pos_ += len;
+                offset_ += len;
+                status_.last_sequence = offset_;
+                return frame;
+            }
+            if (holding_)
+            {
+                // Done with this buffer: keep what it holds of the next
+                // record, then put it back to work.
+                if (tail_part_)
+                {
+                    std::memcpy(carry_.data(), buffer(next_chunk_) + len_, tail_part_);
+                    carry_have_ = tail_part_;
+                }
+                holding_ = false;
+                if (next_chunk_ + depth_ < chunks_ && !submit(next_chunk_ + depth_))
+                    return {};
+                ++next_chunk_;
+            }
+            if (next_chunk_ == chunks_)
+            {
+                status_.state = SessionState::closed;
+                return {};
+            }
+            if (!take(next_chunk_))
+                return {};
+        }
+    }
+
+    std::size_t UringFileMarketDataAdapter::read(std::span<std::byte> out)
+    {
+        if (out.empty())
+            return 0;
+        const auto frame = next_frame(out.size());
+        if (!frame.empty())
+            std::memcpy(out.data(), frame.data(), frame.size());
+        return frame.size();
+    }
+
+    void UringFileMarketDataAdapter::request_gap_fill(const SequenceRange &missing)
+    {
+        status_.detail = gap_note(missing);
+    }
+
+    // --- CompressedFileMarketDataAdapter ---
+
+    namespace
+    {
+        // Frames decoded whole must stay this small decompressed, or (size
+        // not recorded) compressed; anything larger is streamed.
+        constexpr std::uint64_t kParallelFrameBytes = 256u << 20;
+        constexpr std::uint64_t kParallelPackedBytes = 32u << 20;
+    } // namespace
+
+    CompressedFileMarketDataAdapter::~CompressedFileMarketDataAdapter() { disconnect(); }
+
+    void CompressedFileMarketDataAdapter::configure(const AdapterConfig &cfg)
+    {
+        cfg_ = cfg;
+        pacer_.configure(opts_.pacing);
+    }
+
+    void CompressedFileMarketDataAdapter::connect()
+    {
+        disconnect();
+        status_ = AdapterStatus{SessionState::connecting, 0, {}};
+        stats_ = DecodeStats{};
+        const int fd = ::open(cfg_.endpoint.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return fail(status_, "open " + cfg_.endpoint);
+        struct stat st{};
+        if (::fstat(fd, &st) != 0)
+        {
+            fail(status_, "fstat " + cfg_.endpoint);
+            ::close(fd);
+            return;
+        }
+        map_bytes_ = static_cast<std::size_t>(st.st_size);
+        if (map_bytes_ > 0)
+        {
+            void *p = ::mmap(nullptr, map_bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                fail(status_, "mmap " + cfg_.endpoint);
+                ::close(fd);
+                return;
+            }
+            base_ = static_cast<const std::byte *>(p);
+            ::madvise(p, map_bytes_, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+
+        const std::span<const std::byte> file{base_, map_bytes_};
+        stats_.codec = detect_codec(file);
+        std::string err;
+        if (stats_.codec == Codec::none)
+            err = "not a zstd or LZ4 file";
+        else
+            (void)scan_frames(stats_.codec, file, frames_, err);
+        if (!err.empty())
+        {
+            disconnect();
+            status_.state = SessionState::disconnected;
+            status_.detail = cfg_.endpoint + ": " + err;
+            return;
+        }
+        stats_.frames = frames_.size();
+        stats_.compressed_bytes = map_bytes_;
+
+        bool known = true;
+        size_ = 0;
+        stats_.parallel = frames_.size() > 1;
+        for (const CompressedFrame &f : frames_)
+        {
+            known = known && f.content_bytes != CompressedFrame::kUnknownSize;
+            size_ += known ? f.content_bytes : 0;
+            stats_.parallel = stats_.parallel && (f.content_bytes != CompressedFrame::kUnknownSize
+                                                      ? f.content_bytes <= kParallelFrameBytes
+                                                      : f.bytes <= kParallelPackedBytes);
+        }
+        if (!known)
+            size_ = 0;
+        else if (opts_.start_offset > size_)
+        {
+            disconnect();
+            status_.state = SessionState::disconnected;
+            status_.detail = "start offset beyond end of " + cfg_.endpoint;
+            return;
+        }
+        // Frames wholly before start_offset whose size is on record are not
+        // decoded at all; the rest of the way is decoded and dropped.
+        std::size_t first = 0;
+        std::uint64_t at = 0;
+        while (first < frames_.size() && frames_[first].content_bytes != CompressedFrame::kUnknownSize &&
+               at + frames_[first].content_bytes <= opts_.start_offset)
+            at += frames_[first++].content_bytes;
+        frames_.erase(frames_.begin(), frames_.begin() + static_cast<std::ptrdiff_t>(first));
+        skip_ = opts_.start_offset - at;
+        stream_end_ = at;
+
+        const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+        stats_.threads = stats_.parallel
+                             ? static_cast<unsigned>(std::min<std::size_t>(
+                                   opts_.decode_threads ? opts_.decode_threads : cpus, frames_.size()))
+                             : 1;
+        const unsigned window =
+            opts_.decode_window ? std::max(opts_.decode_window, stats_.threads) : 2 * stats_.threads;
+        units_ = std::vector<Unit>(std::max(window, 2u));
+        claimed_ = released_ = 0;
+        stop_ = false;
+        next_unit_ = 0;
+        holding_ = last_ = false;
+        ended_ = frames_.empty();
+        pos_ = len_ = 0;
+        carry_.assign(opts_.pacing.record_bytes, std::byte{0});
+        carry_have_ = tail_part_ = 0;
+        carry_ready_ = false;
+        offset_ = opts_.start_offset;
+        status_ = AdapterStatus{SessionState::established, offset_, {}};
+        if (ended_)
+            return;
+        for (unsigned i = 0; i < stats_.threads; ++i)
+            workers_.emplace_back([this] { stats_.parallel ? decode_frames() : stream_frames(); });
+    }
+
+    void CompressedFileMarketDataAdapter::stop_workers()
+    {
+        {
+            std::lock_guard lk(mu_);
+            stop_ = true;
+        }
+        work_cv_.notify_all();
+        for (std::thread &t : workers_)
+            t.join();
+        workers_.clear();
+    }
+
+    void CompressedFileMarketDataAdapter::disconnect()
+    {
+        stop_workers();
+        if (base_)
+            ::munmap(const_cast<std::byte *>(base_), map_bytes_);
+        base_ = nullptr;
+        map_bytes_ = 0;
+        frames_.clear();
+        if (status_.state != SessionState::disconnected)
+            status_.state = SessionState::closed;
+    }
+
+    bool CompressedFileMarketDataAdapter::claim_slot(std::uint64_t unit)
+    {
+        std::unique_lock lk(mu_);
+        work_cv_.wait(lk, [&] { return stop_ || unit < released_ + units_.size(); });
+        return !stop_;
+    }
+
+    void CompressedFileMarketDataAdapter::publish(std::uint64_t unit, std::string error, bool last)
+    {
+        {
+            std::lock_guard lk(mu_);
+            Unit &u = units_[unit % units_.size()];
+            u.error = std::move(error);
+            u.last = last;
+            u.done = true;
+        }
+        ready_cv_.notify_one();
+    }
+
+    void CompressedFileMarketDataAdapter::decode_frames()
+    {
+        FrameDecoder dec;
+        std::string err;
+        for (;;)
+        {
+            std::uint64_t i;
+            {
+                std::unique_lock lk(mu_);
+                work_cv_.wait(lk, [&]
+                              { return stop_ || claimed_ >= frames_.size() || claimed_ < released_ + units_.size(); });
+                if (stop_ || claimed_ >= frames_.size())
+                    return;
+                i = claimed_++;
+            }
+            // The slot is this worker's until the consumer releases unit i.
+            Unit &u = units_[i % units_.size()];
+            err.clear();
+            if (!dec.decode_frame(stats_.codec, frame_bytes(i), frames_[i].content_bytes, u.data, err))
+                err = "frame at offset " + std::to_string(frames_[i].offset) + ": " + err;
+            publish(i, err, i + 1 == frames_.size());
+        }
+    }
+
+    void CompressedFileMarketDataAdapter::stream_frames()
+    {
+        FrameDecoder dec;
+        std::string err;
+        const std::size_t unit_bytes = std::max<std::size_t>(opts_.read_bytes, 4096);
+        std::size_t f = 0;
+        std::size_t in_pos = 0;
+        for (std::uint64_t i = 0; f < frames_.size(); ++i)
+        {
+            if (!claim_slot(i))
+                return;
+            Unit &u = units_[i % units_.size()];
+            u.data.resize(unit_bytes);
+            std::size_t out_pos = 0;
+            while (out_pos < u.data.size() && f < frames_.size())
+            {
+                const auto in = frame_bytes(f);
+                bool done = false;
+                if (!dec.decode_some(stats_.codec, in, in_pos, u.data, out_pos, done, err))
+                    break;
+                if (done)
+                {
+                    ++f;
+                    in_pos = 0;
+                }
+                else if (in_pos == in.size() && out_pos < u.data.size())
+                {
+                    err = "frame ends before its end mark";
+                    break;
+                }
+            }
+            if (!err.empty())
+                err = "frame at offset " + std::to_string(frames_[f].offset) + ": " + err;
+            u.data.resize(out_pos);
+            publish(i, err, f == frames_.size());
+            if (!err.empty())
+                return;
+        }
+    }
+
+    bool CompressedFileMarketDataAdapter::take()
+    {
+        Unit &u = units_[next_unit_ % units_.size()];
+        {
+            std::unique_lock lk(mu_);
+            if (!u.done)
+            {
+                ++stats_.waits;
+                ready_cv_.wait(lk, [&] { return u.done; });
+            }
+        }
+        if (!u.error.empty())
+        {
+            status_.state = SessionState::disconnected;
+            status_.detail = "decompress " + cfg_.endpoint + ": " + u.error;
+            return false;
+        }
+        ++stats_.units;
+        holding_ = true;
+        last_ = u.last;
+        len_ = u.data.size();
+        stream_end_ += len_;
+        pos_ = static_cast<std::size_t>(std::min<std::uint64_t>(skip_, len_));
+        skip_ -= pos_;
+        tail_part_ = 0;
+
+        const std::size_t rb = carry_.size();
+        if (rb == 0)
+            return true;
+        if (carry_have_)
+        {
+            const std::size_t n = std::min(rb - carry_have_, len_ - pos_);
+            std::memcpy(carry_.data() + carry_have_, u.data.data() + pos_, n);
+            carry_have_ += n;
+            pos_ += n;
+            carry_ready_ = carry_have_ == rb;
+        }
+        if (!last_ && stream_end_ > opts_.start_offset)
+        {
+            tail_part_ = std::min<std::size_t>((stream_end_ - opts_.start_offset) % rb, len_ - pos_);
+            len_ -= tail_part_;
+        }
+        return true;
+    }
+
+    std::span<const std::byte> CompressedFileMarketDataAdapter::next_frame(std::size_t max_bytes)
+    {
+        for (;;)
+        {
+            if (status_.state != SessionState::established)
+                return {};
+            const std::size_t rb = carry_.size();
+            if (carry_ready_)
+            {
+                carry_ready_ = false;
+                carry_have_ = 0;
+                if (pacer_.enabled())
+                    (void)pacer_.due_bytes(carry_.data(), rb, offset_ / rb);
+                offset_ += rb;
+                status_.last_sequence = offset_;
+                return {carry_.data(), rb};
+            }
+            // Only a unit being held is safe to look at; the others belong
+            // to the workers.
+            const std::byte *data = holding_ ? units_[next_unit_ % units_.size()].data.data() : nullptr;
+            if (holding_ && pos_ < len_)
+            {
+                std::size_t len = len_ - pos_;
+                if (max_bytes)
+                    len = std::min(len, max_bytes);
+                if (pacer_.enabled())
+                {
+                    if (len >= rb)
+                        len -= len % rb;
+                    len = pacer_.due_bytes(data + pos_, len, offset_ / rb);
+                }
+                const std::span<const std::byte> frame{data + pos_, len};
+                pos_ += len;
+                offset_ += len;
+                status_.last_sequence = offset_;
+                return frame;
+            }
+            if (holding_)
+            {
+                if (tail_part_)
+                {
+                    std::memcpy(carry_.data(), data + len_, tail_part_);
+                    carry_have_ = tail_part_;
+                }
+                holding_ = false;
+                ended_ = last_;
+                {
+                    std::lock_guard lk(mu_);
+                    units_[next_unit_ % units_.size()].done = false;
+                    released_ = ++next_unit_;
+                }
+                work_cv_.notify_all();
+            }
+            if (ended_)
+            {
+                if (carry_have_)
+                {
+                    // A short record at the very end: pass it on as it is.
+                    const std::size_t n = carry_have_;
+                    carry_have_ = 0;
+                    offset_ += n;
+                    status_.last_sequence = offset_;
+                    return {carry_.data(), n};
+                }
+                if (skip_)
+                {
+                    status_.state = SessionState::disconnected;
+                    status_.detail = "start offset beyond end of " + cfg_.endpoint;
+                    return {};
+                }
+                size_ = offset_;
+                status_.state = SessionState::closed;
+                return {};
+            }
+            if (!take())
+                return {};
+        }
+    }
+
+    std::size_t CompressedFileMarketDataAdapter::read(std::span<std::byte> out)
+    {
+        if (out.empty())
+            return 0;
+        const auto frame = next_frame(out.size());
+        if (!frame.empty())
+            std::memcpy(out.data(), frame.data(), frame.size());
+        return frame.size();
+    }
+
+    void CompressedFileMarketDataAdapter::request_gap_fill(const SequenceRange &missing)
+    {
+        status_.detail = gap_note(missing);
+    }
+
+} // namespace bqs::adapters
@@ -0,0 +1,591 @@
+#include "bqs/adapters/mold_udp_adapter.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+
+namespace bqs::adapters
+{
+
+    namespace
+    {
+        constexpr std::size_t kControlBytes = CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(std::uint32_t));
+
+        std::uint64_t realtime_ns() noexcept
+        {
+            timespec ts;
+            ::clock_gettime(CLOCK_REALTIME, &ts);
+            return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000ull + static_cast<std::uint64_t>(ts.tv_nsec);
+        }
+
+        bool parse_endpoint(const std::string &ep, in_addr &group, std::uint16_t &port)
+        {
+            const auto colon = ep.rfind(':');
+            if (colon == std::string::npos || inet_pton(AF_INET, ep.substr(0, colon).c_str(), &group) != 1)
+                return false;
+            char *end = nullptr;
+            const unsigned long p = std::strtoul(ep.c_str() + colon + 1, &end, 10);
+            if (*end != '\0' || p == 0 || p > 65535)
+                return false;
+            port = static_cast<std::uint16_t>(p);
+            return true;
+        }
+
+        std::uint16_t load_be16(const std::byte *p) noexcept
+        {
+            return static_cast<std::uint16_t>(std::to_integer<unsigned>(p[0]) << 8 | std::to_integer<unsigned>(p[1]));
+        }
+
+        // UDP payload of an untagged Ethernet/IPv4 frame; empty if the frame
+        // is not one or is cut short. dst_ip is left in network order.
+        std::span<const std::byte> udp_payload(std::span<const std::byte> f, std::uint32_t &dst_ip) noexcept
+        {
+            constexpr std::size_t kEth = 14, kUdp = 8;
+            if (f.size() < kEth + 20 + kUdp || load_be16(f.data() + 12) != 0x0800)
+                return {};
+            const std::size_t ihl = (std::to_integer<std::size_t>(f[kEth]) & 0xf) * 4;
+            if (ihl < 20 || std::to_integer<unsigned>(f[kEth + 9]) != IPPROTO_UDP || f.size() < kEth + ihl + kUdp)
+                return {};
+            std::memcpy(&dst_ip, f.data() + kEth + 16, sizeof(dst_ip));
+            const std::size_t udp = kEth + ihl, len = load_be16(f.data() + udp + 4);
+            // The UDP length, not the frame length: short frames are padded.
+            if (len < kUdp || udp + len > f.size())
+                return {};
+            return f.subspan(udp + kUdp, len - kUdp);
+        }
+    } // namespace
+
+    MoldUdpMarketDataAdapter::MoldUdpMarketDataAdapter(UdpFeedOptions opts) : opts_(std::move(opts))
+    {
+        opts_.batch = std::max<std::size_t>(1, opts_.batch);
+        opts_.ring_slots = std::max(opts_.ring_slots, opts_.batch);
+    }
+
+    MoldUdpMarketDataAdapter::~MoldUdpMarketDataAdapter() { disconnect(); }
+
+    void MoldUdpMarketDataAdapter::configure(const AdapterConfig &cfg) { cfg_ = cfg; }
+
+    void MoldUdpMarketDataAdapter::connect()
+    {
+        disconnect();
+        status_ = AdapterStatus{SessionState::connecting, 0, {}};
+        stats_ = UdpFeedStats{};
+
+        in_addr group{}, iface{};
+        std::uint16_t port = 0;
+        if (!parse_endpoint(cfg_.endpoint, group, port) || inet_pton(AF_INET, opts_.interface.c_str(), &iface) != 1)
+        {
+            status_.state = SessionState::disconnected;
+            status_.detail = "bad endpoint '" + cfg_.endpoint + "' or interface '" + opts_.interface + "'";
+            return;
+        }
+
+        auto fail = [this](const char *what)
+        {
+            status_.state = SessionState::disconnected;
+            status_.detail = std::string(what) + ": " + std::strerror(errno);
+            if (fd_ >= 0)
+                ::close(fd_);
+            fd_ = -1;
+        };
+
+        fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0)
+            return fail("socket");
+        const int on = 1;
+        ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        // SO_RCVBUFFORCE bypasses rmem_max when privileged; fall back otherwise.
+        if (::setsockopt(fd_, SOL_SOCKET, SO_RCVBUFFORCE, &opts_.rcvbuf_bytes, sizeof(opts_.rcvbuf_bytes)) != 0)
+            ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &opts_.rcvbuf_bytes, sizeof(opts_.rcvbuf_bytes));
+        ::setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+        ::setsockopt(fd_, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on));
+        if (opts_.wait_ms > 0)
+        {
+            timeval tv{opts_.wait_ms / 1000, (opts_.wait_ms % 1000) * 1000};
+            ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        }
+        // Socket busy polling lets the kernel poll the device queue from the
+        // receive call instead of waiting for the softirq; best-effort since
+        // raising it above net.core.busy_read needs CAP_NET_ADMIN.
+        if (opts_.busy_poll_us > 0)
+            stats_.busy_poll_socket =
+                ::setsockopt(fd_, SOL_SOCKET, SO_BUSY_POLL, &opts_.busy_poll_us, sizeof(opts_.busy_poll_us)) == 0 &&
+                ::setsockopt(fd_, SOL_SOCKET, SO_PREFER_BUSY_POLL, &on, sizeof(on)) == 0;
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr = group;
+        if (::bind(fd_, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0)
+            return fail("bind");
+        // The membership is kept with AF_XDP too: it is what makes the
+        // host (and the switch) accept the group at all.
+        ip_mreq mreq{group, iface};
+        if (::setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0)
+            return fail("IP_ADD_MEMBERSHIP");
+        group_ = group.s_addr;
+        xdp_error_.clear();
+        if (!opts_.xdp.ifname.empty())
+        {
+            stats_.xdp = xsk_.open(opts_.xdp, port, xdp_error_);
+            stats_.xdp_zero_copy = xsk_.zero_copy();
+        }
+
+        // Everything the receive path touches is sized here, once.
+        ring_.assign(opts_.ring_slots * kSlotBytes, std::byte{0});
+        slots_.assign(opts_.ring_slots, Slot{});
+        msgs_.assign(opts_.batch, mmsghdr{});
+        iovs_.assign(opts_.batch, iovec{});
+        xdp_frames_.assign(opts_.batch, XdpFrame{});
+        control_.assign(opts_.batch * kControlBytes, std::byte{0});
+        head_ = tail_ = 0;
+        in_packet_ = false;
+        has_pending_ = false;
+        expected_ = cfg_.start_sequence;
+        horizon_ = 0;
+        end_seen_ = false;
+        have_session_ = false;
+        if (!opts_.rewind.server.empty())
+        {
+            std::string err;
+            if (!rewind_.open(opts_.rewind, err))
+            {
+                status_.state = SessionState::disconnected;
+                status_.detail = err;
+                ::close(fd_);
+                fd_ = -1;
+                return;
+            }
+            reorder_ = ReorderRing(opts_.reorder_slots, opts_.reorder_slot_bytes);
+            rewind_buf_.assign(mold::kMaxPacketBytes, std::byte{0});
+        }
+        last_rx_ = std::chrono::steady_clock::now();
+        status_ = AdapterStatus{SessionState::established, expected_ ? expected_ - 1 : 0, {}};
+    }
+
+    void MoldUdpMarketDataAdapter::disconnect()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+        // Slots may still point into the UMEM; connect() starts them over.
+        xsk_.close();
+        rewind_.close();
+        if (status_.state != SessionState::disconnected)
+            status_.state = SessionState::closed;
+    }
+
+    std::size_t MoldUdpMarketDataAdapter::fill(bool wait)
+    {
+        if (xsk_.is_open())
+            return fill_xdp(wait);
+        const std::size_t n = std::min<std::size_t>(opts_.batch, opts_.ring_slots - (tail_ - head_));
+        if (n == 0 || fd_ < 0)
+            return 0;
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            iovs_[j] = iovec{slot_data(tail_ + j), kSlotBytes};
+            msghdr &h = msgs_[j].msg_hdr;
+            h = msghdr{};
+            h.msg_iov = &iovs_[j];
+            h.msg_iovlen = 1;
+            h.msg_control = control_.data() + j * kControlBytes;
+            h.msg_controllen = kControlBytes;
+        }
+        int got;
+        do
+            got = ::recvmmsg(fd_, msgs_.data(), static_cast<unsigned>(n), wait ? MSG_WAITFORONE : MSG_DONTWAIT, nullptr);
+        while (got < 0 && errno == EINTR);
+        if (got <= 0)
+        {
+            if (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                status_.state = SessionState::disconnected;
+                status_.detail = std::string("recvmmsg: ") + std::strerror(errno);
+            }
+            return 0;
+        }
+
+        last_rx_ = std::chrono::steady_clock::now();
+        ++stats_.batches;
+        stats_.batch_size.add(static_cast<std::uint64_t>(got));
+        for (int j = 0; j < got; ++j)
+        {
+            Slot &s = slots_[(tail_ + static_cast<std::uint64_t>(j)) % opts_.ring_slots];
+            const msghdr &h = msgs_[j].msg_hdr;
+            s.data = slot_data(tail_ + static_cast<std::uint64_t>(j));
+            s.frame = kNoFrame;
+            s.len = msgs_[j].msg_len;
+            s.truncated = (h.msg_flags & MSG_TRUNC) != 0;
+            s.rx_ts_ns = 0;
+            for (cmsghdr *c = CMSG_FIRSTHDR(&h); c; c = CMSG_NXTHDR(const_cast<msghdr *>(&h), c))
+            {
+                if (c->cmsg_level != SOL_SOCKET)
+                    continue;
+                if (c->cmsg_type == SCM_TIMESTAMPNS)
+                {
+                    timespec ts;
+                    std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+                    s.rx_ts_ns = static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000ull + static_cast<std::uint64_t>(ts.tv_nsec);
+                }
+                else if (c->cmsg_type == SO_RXQ_OVFL)
+                {
+                    std::uint32_t drops;
+                    std::memcpy(&drops, CMSG_DATA(c), sizeof(drops));
+                    stats_.kernel_drops = drops;
+                }
+            }
+            stats_.bytes += s.len;
+        }
+        stats_.packets += static_cast<std::uint64_t>(got);
+        tail_ += static_cast<std::uint64_t>(got);
+        return static_cast<std::size_t>(got);
+    }
+
+    std::size_t MoldUdpMarketDataAdapter::fill_xdp(bool wait)
+    {
+        const std::size_t n = std::min<std::size_t>(opts_.batch, opts_.ring_slots - (tail_ - head_));
+        if (n == 0)
+            return 0;
+        std::size_t got = xsk_.receive(xdp_frames_.data(), n);
+        if (got == 0)
+        {
+            if (wait)
+                xsk_.wait(opts_.wait_ms);
+            else
+                xsk_.kick();
+            got = xsk_.receive(xdp_frames_.data(), n);
+            if (got == 0)
+                return 0;
+        }
+
+        last_rx_ = std::chrono::steady_clock::now();
+        const std::uint64_t now = realtime_ns();
+        ++stats_.batches;
+        stats_.batch_size.add(got);
+        std::size_t kept = 0;
+        for (std::size_t j = 0; j < got; ++j)
+        {
+            const XdpFrame &f = xdp_frames_[j];
+            std::uint32_t dst = 0;
+            const auto payload = udp_payload({f.data, f.len}, dst);
+            if (payload.empty() || dst != group_)
+            {
+                // The program matched on port only; sort out the rest here.
+                ++(payload.empty() ? stats_.malformed : stats_.xdp_foreign);
+                xsk_.release(f.addr);
+                continue;
+            }
+            Slot &s = slots_[tail_ % opts_.ring_slots];
+            s = Slot{payload.data(), f.addr, static_cast<std::uint32_t>(payload.size()), false, now};
+            stats_.bytes += s.len;
+            ++tail_;
+            ++kept;
+        }
+        stats_.packets += kept;
+        return kept;
+    }
+
+    void MoldUdpMarketDataAdapter::pop_head() noexcept
+    {
+        const Slot &s = slots_[head_ % opts_.ring_slots];
+        if (s.frame != kNoFrame)
+            xsk_.release(s.frame);
+        ++head_;
+    }
+
+    std::size_t MoldUdpMarketDataAdapter::fill_wait()
+    {
+        std::size_t got = 0;
+        if (opts_.wait_ms == 0)
+            got = fill(false);
+        else if (opts_.mode == ReceiveMode::blocking)
+            got = fill(true);
+        else
+        {
+            // Spin, then spin-and-yield, until data or wait_ms runs out. The
+            // clock is only read every 64 empty polls.
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(opts_.wait_ms);
+            for (std::uint64_t empty = 1; !(got = fill(false)) && status_.state != SessionState::disconnected; ++empty)
+            {
+                ++stats_.empty_polls;
+                if (empty > opts_.spin_polls)
+                {
+                    ++stats_.yields;
+                    ::sched_yield();
+                }
+                if (empty % 64 == 0 && std::chrono::steady_clock::now() >= deadline)
+                    break;
+            }
+        }
+        if (got == 0 && status_.state != SessionState::disconnected && opts_.idle_timeout_ms > 0 &&
+            std::chrono::steady_clock::now() - last_rx_ > std::chrono::milliseconds(opts_.idle_timeout_ms))
+        {
+            status_.state = SessionState::disconnected;
+            status_.detail = "idle timeout";
+        }
+        return got;
+    }
+
+    void MoldUdpMarketDataAdapter::note_gap(std::uint64_t upto)
+    {
+        const std::uint64_t from = recovering() ? horizon_ : expected_;
+        if (upto <= from)
+            return;
+        ++stats_.gaps;
+        request_gap_fill(SequenceRange{from, upto - 1});
+        if (!rewind_.is_open())
+        {
+            // No one to ask: skip the gap.
+            stats_.missing += upto - expected_;
+            expected_ = upto;
+            return;
+        }
+        if (!recovering())
+        {
+            head_since_ = std::chrono::steady_clock::now();
+            status_.state = SessionState::recovering;
+        }
+        horizon_ = upto;
+    }
+
+    void MoldUdpMarketDataAdapter::deliver(MoldMessage &out, std::span<const std::byte> msg, std::uint64_t seq,
+                                           std::uint64_t ts)
+    {
+        expected_ = seq + 1;
+        ++stats_.messages;
+        status_.last_sequence = seq;
+        out = MoldMessage{msg, seq, ts};
+    }
+
+    bool MoldUdpMarketDataAdapter::accept(std::uint64_t seq, std::span<const std::byte> msg, std::uint64_t ts,
+                                          bool rewound, MoldMessage &out)
+    {
+        if (seq < expected_ || (seq < horizon_ && reorder_.has(seq)))
+        {
+            ++stats_.duplicates;
+            return false;
+        }
+        note_gap(seq);
+        if (!recovering())
+        {
+            deliver(out, msg, seq, ts);
+            return true;
+        }
+        // Held messages stay within one ring window of expected_; anything
+        // further out is asked for again once the window has moved.
+        if (seq - expected_ >= reorder_.capacity() || !reorder_.put(seq, msg, ts))
+        {
+            if (msg.size() > reorder_.slot_bytes())
+                ++stats_.malformed;
+            else
+                ++stats_.reorder_overflows;
+            rewind_.request(SequenceRange{seq, seq});
+        }
+        else if (rewound)
+            ++stats_.recovered;
+        horizon_ = std::max(horizon_, seq + 1);
+        stats_.reorder_peak = std::max<std::uint64_t>(stats_.reorder_peak, reorder_.size());
+        return false;
+    }
+
+    void MoldUdpMarketDataAdapter::give_up_head()
+    {
+        const std::uint64_t from = expected_;
+        while (expected_ < horizon_ && !reorder_.has(expected_))
+            ++expected_;
+        stats_.missing += expected_ - from;
+        rewind_.satisfied_below(expected_);
+        head_since_ = std::chrono::steady_clock::now();
+        if (!recovering())
+            status_.state = SessionState::established;
+    }
+
+    void MoldUdpMarketDataAdapter::drain_rewinder()
+    {
+        MoldMessage unused;
+        while (const std::size_t n = rewind_.receive(rewind_buf_))
+        {
+            const std::span<const std::byte> pkt{rewind_buf_.data(), n};
+            mold::PacketHeader h;
+            if (!mold::parse_header(pkt, h) || h.end_of_session())
+            {
+                ++stats_.malformed;
+                continue;
+            }
+            mold::MessageCursor c(pkt);
+            std::span<const std::byte> msg;
+            for (std::uint64_t seq = h.sequence; c.next(msg); ++seq)
+                (void)accept(seq, msg, realtime_ns(), true, unused);
+        }
+    }
+
+    bool MoldUdpMarketDataAdapter::next_message(MoldMessage &out)
+    {
+        for (;;)
+        {
+            if (recovering())
+            {
+                const auto now = std::chrono::steady_clock::now();
+                if (reorder_.has(expected_))
+                {
+                    std::uint64_t ts = 0;
+                    const std::uint64_t seq = expected_;
+                    const auto msg = reorder_.take(seq, ts);
+                    deliver(out, msg, seq, ts);
+                    rewind_.satisfied_below(expected_);
+                    head_since_ = now;
+                    if (!recovering())
+                        status_.state = SessionState::established;
+                    return true;
+                }
+                if (now - head_since_ > std::chrono::milliseconds(opts_.gap_timeout_ms))
+                {
+                    give_up_head();
+                    continue;
+                }
+            }
+
+            if (in_packet_)
+            {
+                std::span<const std::byte> msg;
+                if (cursor_.next(msg))
+                {
+                    if (accept(cursor_seq_++, msg, cursor_ts_, false, out))
+                        return true;
+                    continue;
+                }
+                in_packet_ = false;
+                pop_head();
+            }
+
+            if (recovering())
+            {
+                rewind_.pump(std::chrono::steady_clock::now());
+                drain_rewinder();
+                if (reorder_.has(expected_))
+                    continue;
+            }
+            else if (end_seen_)
+            {
+                status_.state = SessionState::closed;
+                status_.detail = "end of session";
+                return false;
+            }
+
+            if (status_.state != SessionState::established && status_.state != SessionState::recovering)
+                return false;
+            // Top the ring up without blocking while it runs low, so a burst
+            // lands in the ring rather than overflowing the socket buffer.
+            if (head_ == tail_ && recovering())
+            {
+                // Live data and retransmissions can both end the wait.
+                if (!fill(false))
+                {
+                    pollfd fds[2] = {{fd(), POLLIN, 0}, {rewind_.fd(), POLLIN, 0}};
+                    ::poll(fds, 2, 1);
+                    fill(false);
+                }
+                if (head_ == tail_)
+                    continue;
+            }
+            else if (head_ == tail_)
+                fill_wait();
+            else if (tail_ - head_ <= opts_.batch / 2)
+                fill(false);
+            if (head_ == tail_)
+                return false;
+
+            const Slot &s = slots_[head_ % opts_.ring_slots];
+            if (s.rx_ts_ns)
+            {
+                const std::uint64_t now = realtime_ns();
+                stats_.wake_ns.add(now > s.rx_ts_ns ? now - s.rx_ts_ns : 0);
+            }
+            const std::span<const std::byte> pkt{s.data, s.len};
+            mold::PacketHeader h;
+            if (s.truncated || !mold::parse_header(pkt, h))
+            {
+                ++stats_.malformed;
+                pop_head();
+                continue;
+            }
+            if (expected_ == 0)
+                expected_ = h.sequence;
+            if (!have_session_)
+            {
+                // Rewind requests name the session the feed is on.
+                rewind_.set_session(h.session);
+                have_session_ = true;
+            }
+            if (h.end_of_session() || h.heartbeat())
+            {
+                // Both carry the next sequence the server will send.
+                note_gap(h.sequence);
+                pop_head();
+                if (h.end_of_session())
+                    end_seen_ = true;
+                else
+                    ++stats_.heartbeats;
+                continue;
+            }
+            if (h.sequence + h.count <= expected_)
+            {
+                stats_.duplicates += h.count;
+                pop_head();
+                continue;
+            }
+            cursor_ = mold::MessageCursor(pkt);
+            cursor_seq_ = h.sequence;
+            cursor_ts_ = s.rx_ts_ns;
+            in_packet_ = true;
+        }
+    }
+
+    std::size_t MoldUdpMarketDataAdapter::read(std::span<std::byte> out)
+    {
+        std::size_t n = 0;
+        MoldMessage m;
+        while (has_pending_ || next_message(m))
+        {
+            if (has_pending_)
+                m = pending_;
+            if (m.payload.size() > out.size() - n)
+            {
+                if (n == 0)
+                {
+                    // Can never fit this buffer: drop it rather than stall.
+                    ++stats_.malformed;
+                    has_pending_ = false;
+                    continue;
+                }
+                pending_ = m;
+                has_pending_ = true;
+                break;
+            }
+            has_pending_ = false;
+            std::memcpy(out.data() + n, m.payload.data(), m.payload.size());
+            n += m.payload.size();
+        }
+        return n;
+    }
+
+    void MoldUdpMarketDataAdapter::request_gap_fill(const SequenceRange &missing)
+    {
+        rewind_.request(missing);
+        status_.detail = "gap " + std::to_string(missing.begin_inclusive) + "-" + std::to_string(missing.end_inclusive);
+    }
+
+} // namespace bqs::adapters
@@ -0,0 +1,62 @@
+#include "bqs/adapters/pacing.hpp"
+
+#include <thread>
+
+namespace bqs::adapters
+{
+
+    namespace
+    {
+        // Waits longer than this sleep for all but the last kSpinSlack; the
+        // scheduler wakes us late by tens of microseconds, spinning does not.
+        constexpr auto kSleepThreshold = std::chrono::microseconds(200);
+        constexpr auto kSpinSlack = std::chrono::microseconds(100);
+    } // namespace
+
+    Pacer::clock::time_point Pacer::due_at(std::uint64_t ts_ns) const noexcept
+    {
+        if (ts_ns <= ts0_)
+            return t0_;
+        const double scaled = static_cast<double>(ts_ns - ts0_) / cfg_.speed;
+        return t0_ + std::chrono::nanoseconds(static_cast<std::int64_t>(scaled));
+    }
+
+    std::size_t Pacer::due_bytes(const std::byte *data, std::size_t n, std::uint64_t first_index)
+    {
+        const std::size_t rb = cfg_.record_bytes;
+        if (!enabled() || n < rb)
+            return n;
+
+        const std::uint64_t ts = cfg_.timestamp(data, first_index);
+        if (!started_)
+        {
+            started_ = true;
+            ts0_ = ts;
+            t0_ = clock::now();
+        }
+
+        const auto due = due_at(ts);
+        auto now = clock::now();
+        if (now < due)
+        {
+            if (due - now > kSleepThreshold)
+            {
+                std::this_thread::sleep_for(due - now - kSpinSlack);
+                ++stats_.sleeps;
+            }
+            while ((now = clock::now()) < due)
+            {
+            }
+        }
+        const auto lag = std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count();
+        if (static_cast<std::uint64_t>(lag) > stats_.max_lag_ns)
+            stats_.max_lag_ns = static_cast<std::uint64_t>(lag);
+
+        // Release every further whole record that is already due.
+        std::size_t k = rb;
+        while (k + rb <= n && due_at(cfg_.timestamp(data + k, first_index + k / rb)) <= now)
+            k += rb;
+        return k;
+    }
+
+} // namespace bqs::adapters
@@ -0,0 +1,266 @@
+#include "bqs/adapters/rewind.hpp"
+#include "bqs/adapters/moldudp64.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace bqs::adapters
+{
+
+    namespace
+    {
+        bool parse_host_port(const std::string &ep, sockaddr_in &addr)
+        {
+            const auto colon = ep.rfind(':');
+            addr = sockaddr_in{};
+            addr.sin_family = AF_INET;
+            if (colon == std::string::npos || inet_pton(AF_INET, ep.substr(0, colon).c_str(), &addr.sin_addr) != 1)
+                return false;
+            const int port = std::atoi(ep.c_str() + colon + 1);
+            if (port <= 0 || port > 65535)
+                return false;
+            addr.sin_port = htons(static_cast<std::uint16_t>(port));
+            return true;
+        }
+    } // namespace
+
+    // --- RewindClient ---
+
+    bool RewindClient::open(const RewindOptions &opts, std::string &err)
+    {
+        close();
+        opts_ = opts;
+        opts_.max_per_request = std::max<std::uint16_t>(1, opts_.max_per_request);
+        opts_.max_outstanding = std::max<std::size_t>(1, opts_.max_outstanding);
+        sockaddr_in addr{};
+        if (!parse_host_port(opts_.server, addr))
+        {
+            err = "bad rewinder address '" + opts_.server + "'";
+            return false;
+        }
+        fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd_ < 0 || ::connect(fd_, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+            err = std::string("rewinder socket: ") + std::strerror(errno);
+            close();
+            return false;
+        }
+        wanted_.clear();
+        outstanding_.clear();
+        tokens_ = opts_.burst;
+        refilled_ = std::chrono::steady_clock::now();
+        stats_ = RewindStats{};
+        return true;
+    }
+
+    void RewindClient::close()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+    }
+
+    void RewindClient::set_session(const char (&session)[10]) { std::memcpy(session_, session, sizeof(session_)); }
+
+    void RewindClient::request(const SequenceRange &missing)
+    {
+        if (missing.begin_inclusive == 0 || missing.end_inclusive < missing.begin_inclusive)
+            return;
+        std::uint64_t b = missing.begin_inclusive, e = missing.end_inclusive;
+        auto it = wanted_.upper_bound(b);
+        if (it != wanted_.begin() && std::prev(it)->second + 1 >= b)
+            --it;
+        bool merged = false;
+        while (it != wanted_.end() && it->first <= e + 1)
+        {
+            b = std::min(b, it->first);
+            e = std::max(e, it->second);
+            it = wanted_.erase(it);
+            merged = true;
+        }
+        wanted_.emplace(b, e);
+        stats_.coalesced += merged ? 1 : 0;
+    }
+
+    void RewindClient::satisfied_below(std::uint64_t seq)
+    {
+        while (!wanted_.empty() && wanted_.begin()->first < seq)
+        {
+            const auto [b, e] = *wanted_.begin();
+            wanted_.erase(wanted_.begin());
+            if (e >= seq)
+                wanted_.emplace(seq, e);
+        }
+        std::erase_if(outstanding_, [seq](InFlight &f)
+                      {
+                          const std::uint64_t end = f.begin + f.count;
+                          if (end <= seq)
+                              return true;
+                          if (f.begin < seq)
+                          {
+                              f.count = static_cast<std::uint16_t>(end - seq);
+                              f.begin = seq;
+                          }
+                          return false; });
+    }
+
+    bool RewindClient::send(std::uint64_t begin, std::uint16_t count)
+    {
+        std::byte req[mold::kHeaderBytes];
+        std::memcpy(req, session_, mold::kSessionBytes);
+        mold::store_be64(req + 10, begin);
+        mold::store_be16(req + 18, count);
+        tokens_ -= 1.0;
+        ++stats_.requests;
+        return ::send(fd_, req, sizeof(req), 0) == static_cast<ssize_t>(sizeof(req));
+    }
+
+    void RewindClient::pump(std::chrono::steady_clock::time_point now)
+    {
+        if (fd_ < 0)
+            return;
+        tokens_ = std::min<double>(opts_.burst,
+                                   tokens_ + std::chrono::duration<double>(now - refilled_).count() * opts_.requests_per_sec);
+        refilled_ = now;
+
+        const auto retry_after = std::chrono::milliseconds(opts_.retry_ms);
+        for (auto it = outstanding_.begin(); it != outstanding_.end();)
+        {
+            if (now - it->sent < retry_after)
+            {
+                ++it;
+                continue;
+            }
+            if (it->tries > opts_.max_retries)
+            {
+                ++stats_.abandoned;
+                it = outstanding_.erase(it);
+                continue;
+            }
+            if (tokens_ < 1.0)
+            {
+                ++stats_.rate_limited;
+                return;
+            }
+            send(it->begin, it->count);
+            ++stats_.retries;
+            ++it->tries;
+            it->sent = now;
+            ++it;
+        }
+
+        while (outstanding_.size() < opts_.max_outstanding && !wanted_.empty())
+        {
+            if (tokens_ < 1.0)
+            {
+                ++stats_.rate_limited;
+                return;
+            }
+            const auto [b, e] = *wanted_.begin();
+            wanted_.erase(wanted_.begin());
+            const auto count = static_cast<std::uint16_t>(std::min<std::uint64_t>(opts_.max_per_request, e - b + 1));
+            if (b + count <= e)
+                wanted_.emplace(b + count, e);
+            send(b, count);
+            outstanding_.push_back(InFlight{b, count, now, 1});
+        }
+    }
+
+    std::size_t RewindClient::receive(std::span<std::byte> buf)
+    {
+        if (fd_ < 0)
+            return 0;
+        const ssize_t n = ::recv(fd_, buf.data(), buf.size(), MSG_DONTWAIT);
+        if (n <= 0)
+            return 0;
+        ++stats_.responses;
+        return static_cast<std::size_t>(n);
+    }
+
+    // --- RewindServer ---
+
+    RewindServer::RewindServer(std::span<const std::byte> capture, std::size_t record_bytes, std::string session,
+                               std::uint64_t first_seq)
+        : capture_(capture), record_bytes_(record_bytes), session_(std::move(session)), first_seq_(first_seq)
+    {
+    }
+
+    bool RewindServer::start(const std::string &bind_addr, std::uint16_t port, std::string &err)
+    {
+        stop();
+        sockaddr_in addr{};
+        if (!parse_host_port(bind_addr + ":" + std::to_string(port ? port : 1), addr))
+        {
+            err = "bad rewinder bind address '" + bind_addr + "'";
+            return false;
+        }
+        addr.sin_port = htons(port);
+        fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        socklen_t len = sizeof(addr);
+        if (fd_ < 0 || ::bind(fd_, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0 ||
+            ::getsockname(fd_, reinterpret_cast<sockaddr *>(&addr), &len) != 0)
+        {
+            err = std::string("rewinder bind: ") + std::strerror(errno);
+            if (fd_ >= 0)
+                ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        port_ = ntohs(addr.sin_port);
+        stop_ = false;
+        thread_ = std::thread([this]
+                              { serve(); });
+        return true;
+    }
+
+    void RewindServer::stop()
+    {
+        stop_ = true;
+        if (thread_.joinable())
+            thread_.join();
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+    }
+
+    void RewindServer::serve()
+    {
+        const std::uint64_t records = record_bytes_ ? capture_.size() / record_bytes_ : 0;
+        std::byte req[64];
+        std::byte pkt[mold::kMaxPacketBytes];
+        while (!stop_)
+        {
+            pollfd p{fd_, POLLIN, 0};
+            if (::poll(&p, 1, 20) <= 0)
+                continue;
+            sockaddr_in from{};
+            socklen_t flen = sizeof(from);
+            const ssize_t n = ::recvfrom(fd_, req, sizeof(req), 0, reinterpret_cast<sockaddr *>(&from), &flen);
+            if (n < static_cast<ssize_t>(mold::kHeaderBytes))
+                continue;
+            ++requests_;
+            if (std::uint32_t d = drop_next_.load(); d > 0 && drop_next_.compare_exchange_strong(d, d - 1))
+                continue;
+
+            mold::PacketHeader h;
+            (void)mold::parse_header({req, static_cast<std::size_t>(n)}, h);
+            std::uint64_t seq = std::max(h.sequence, first_seq_);
+            const std::uint64_t end = std::min(h.sequence + h.count, first_seq_ + records);
+            while (seq < end)
+            {
+                mold::PacketBuilder b({pkt, sizeof(pkt)}, session_, seq);
+                while (seq < end && b.add(capture_.subspan((seq - first_seq_) * record_bytes_, record_bytes_)))
+                    ++seq;
+                ::sendto(fd_, pkt, b.bytes().size(), 0, reinterpret_cast<const sockaddr *>(&from), flen);
+            }
+        }
+    }
+
+} // namespace bqs::adapters
@@ -0,0 +1,192 @@
+#include "bqs/adapters/tcp_order_flow.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace bqs::adapters
+{
+
+    namespace
+    {
+        bool parse_host_port(const std::string &ep, sockaddr_in &addr)
+        {
+            const auto colon = ep.rfind(':');
+            addr = sockaddr_in{};
+            addr.sin_family = AF_INET;
+            if (colon == std::string::npos || inet_pton(AF_INET, ep.substr(0, colon).c_str(), &addr.sin_addr) != 1)
+                return false;
+            const int port = std::atoi(ep.c_str() + colon + 1);
+            if (port <= 0 || port > 65535)
+                return false;
+            addr.sin_port = htons(static_cast<std::uint16_t>(port));
+            return true;
+        }
+    } // namespace
+
+    // --- TcpOrderSession ---
+
+    bool TcpOrderSession::open(const std::string &endpoint, const OrderFlowOptions &opts, std::string &err)
+    {
+        close();
+        sockaddr_in addr{};
+        if (!parse_host_port(endpoint, addr))
+        {
+            err = "bad order-entry endpoint '" + endpoint + "'";
+            return false;
+        }
+        fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0 || ::connect(fd_, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+            err = std::string("connect ") + endpoint + ": " + std::strerror(errno);
+            close();
+            return false;
+        }
+        const int on = opts.tcp_nodelay ? 1 : 0;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        buf_.assign(opts.send_buffer_bytes, std::byte{0});
+        head_ = tail_ = 0;
+        error_.clear();
+        stats_ = OrderFlowStats{};
+        return true;
+    }
+
+    void TcpOrderSession::close()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+    }
+
+    std::byte *TcpOrderSession::reserve(std::size_t n)
+    {
+        if (buf_.size() - tail_ >= n)
+            return buf_.data() + tail_;
+        if (!flush() || buf_.size() - queued() < n)
+            return nullptr;
+        // Slide what is still queued to the front.
+        std::memmove(buf_.data(), buf_.data() + head_, queued());
+        tail_ -= head_;
+        head_ = 0;
+        return buf_.data() + tail_;
+    }
+
+    bool TcpOrderSession::flush()
+    {
+        if (fd_ < 0)
+        {
+            error_ = "not connected";
+            return false;
+        }
+        while (head_ < tail_)
+        {
+            const ssize_t n = ::send(fd_, buf_.data() + head_, tail_ - head_, MSG_DONTWAIT | MSG_NOSIGNAL);
+            ++stats_.send_calls;
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    ++stats_.partial_sends;
+                    break;
+                }
+                error_ = std::string("send: ") + std::strerror(errno);
+                return false;
+            }
+            head_ += static_cast<std::size_t>(n);
+            stats_.bytes += static_cast<std::uint64_t>(n);
+        }
+        if (head_ == tail_)
+            head_ = tail_ = 0;
+        return true;
+    }
+
+    // --- TcpSink ---
+
+    bool TcpSink::start(std::uint16_t port, std::string &err)
+    {
+        stop();
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        const int on = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        socklen_t len = sizeof(addr);
+        if (listen_fd_ < 0 || ::bind(listen_fd_, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0 ||
+            ::listen(listen_fd_, 1) != 0 || ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &len) != 0)
+        {
+            err = std::string("sink listen: ") + std::strerror(errno);
+            if (listen_fd_ >= 0)
+                ::close(listen_fd_);
+            listen_fd_ = -1;
+            return false;
+        }
+        port_ = ntohs(addr.sin_port);
+        stop_ = false;
+        thread_ = std::thread([this]
+                              { serve(); });
+        return true;
+    }
+
+    void TcpSink::stop()
+    {
+        stop_ = true;
+        if (thread_.joinable())
+            thread_.join();
+        if (listen_fd_ >= 0)
+            ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
+
+    void TcpSink::serve()
+    {
+        int conn = -1;
+        std::byte buf[64 * 1024];
+        while (!stop_)
+        {
+            pollfd p{conn >= 0 ? conn : listen_fd_, POLLIN, 0};
+            if (::poll(&p, 1, 20) <= 0)
+                continue;
+            if (conn < 0)
+            {
+                conn = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+                continue;
+            }
+            const ssize_t n = ::recv(conn, buf, sizeof(buf), 0);
+            if (n <= 0)
+            {
+                ::close(conn);
+                conn = -1;
+                continue;
+            }
+            std::lock_guard lock(mu_);
+            data_.insert(data_.end(), buf, buf + n);
+        }
+        if (conn >= 0)
+            ::close(conn);
+    }
+
+    std::vector<std::byte> TcpSink::wait_for(std::size_t n, std::chrono::milliseconds timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;)
+        {
+            {
+                std::lock_guard lock(mu_);
+                if (data_.size() >= n || std::chrono::steady_clock::now() >= deadline)
+                    return data_;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+} // namespace bqs::adapters
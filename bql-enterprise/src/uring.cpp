@@ -0,0 +1,146 @@
+#include "bqs/adapters/uring.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace bqs::adapters
+{
+
+    namespace
+    {
+        std::uint32_t *at(void *base, std::uint32_t off) noexcept
+        {
+            return reinterpret_cast<std::uint32_t *>(static_cast<std::byte *>(base) + off);
+        }
+
+        std::uint32_t load_acquire(const std::uint32_t *p) noexcept
+        {
+            return std::atomic_ref<const std::uint32_t>(*p).load(std::memory_order_acquire);
+        }
+
+        void store_release(std::uint32_t *p, std::uint32_t v) noexcept
+        {
+            std::atomic_ref<std::uint32_t>(*p).store(v, std::memory_order_release);
+        }
+    } // namespace
+
+    bool IoUring::open(unsigned entries, std::string &err)
+    {
+        close();
+        io_uring_params p{};
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+        if (fd_ < 0)
+        {
+            err = std::string("io_uring_setup: ") + std::strerror(errno);
+            return false;
+        }
+        sq_map_bytes_ = p.sq_off.array + p.sq_entries * sizeof(std::uint32_t);
+        cq_map_bytes_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        // Since 5.4 both rings share one mapping.
+        const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single)
+            sq_map_bytes_ = cq_map_bytes_ = std::max(sq_map_bytes_, cq_map_bytes_);
+        auto map = [this](std::size_t bytes, std::uint64_t off)
+        {
+            void *m = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                             static_cast<off_t>(off));
+            return m == MAP_FAILED ? nullptr : m;
+        };
+        sq_map_ = map(sq_map_bytes_, IORING_OFF_SQ_RING);
+        cq_map_ = single ? sq_map_ : map(cq_map_bytes_, IORING_OFF_CQ_RING);
+        sqes_bytes_ = p.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = map(sqes_bytes_, IORING_OFF_SQES);
+        if (!sq_map_ || !cq_map_ || !sqes_)
+        {
+            err = std::string("io_uring mmap: ") + std::strerror(errno);
+            close();
+            return false;
+        }
+        sq_head_ = at(sq_map_, p.sq_off.head);
+        sq_tail_ = at(sq_map_, p.sq_off.tail);
+        sq_array_ = at(sq_map_, p.sq_off.array);
+        sq_mask_ = *at(sq_map_, p.sq_off.ring_mask);
+        cq_head_ = at(cq_map_, p.cq_off.head);
+        cq_tail_ = at(cq_map_, p.cq_off.tail);
+        cqes_ = static_cast<std::byte *>(cq_map_) + p.cq_off.cqes;
+        cq_mask_ = *at(cq_map_, p.cq_off.ring_mask);
+        return true;
+    }
+
+    void IoUring::close()
+    {
+        if (sqes_)
+            ::munmap(sqes_, sqes_bytes_);
+        if (cq_map_ && cq_map_ != sq_map_)
+            ::munmap(cq_map_, cq_map_bytes_);
+        if (sq_map_)
+            ::munmap(sq_map_, sq_map_bytes_);
+        sqes_ = cq_map_ = sq_map_ = nullptr;
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+        to_submit_ = 0;
+        registered_ = false;
+    }
+
+    bool IoUring::register_buffers(std::span<const iovec> bufs) noexcept
+    {
+        registered_ = ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, bufs.data(),
+                                static_cast<unsigned>(bufs.size())) == 0;
+        return registered_;
+    }
+
+    bool IoUring::read(int fd, void *buf, std::uint32_t len, std::uint64_t off, std::uint16_t buf_index,
+                       std::uint64_t user_data) noexcept
+    {
+        const std::uint32_t tail = *sq_tail_;
+        if (tail - load_acquire(sq_head_) > sq_mask_)
+            return false;
+        const std::uint32_t i = tail & sq_mask_;
+        io_uring_sqe &sqe = static_cast<io_uring_sqe *>(sqes_)[i];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = registered_ ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.off = off;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buf);
+        sqe.len = len;
+        sqe.buf_index = buf_index;
+        sqe.user_data = user_data;
+        sq_array_[i] = i;
+        store_release(sq_tail_, tail + 1);
+        ++to_submit_;
+        return true;
+    }
+
+    bool IoUring::submit_and_wait(unsigned min_complete) noexcept
+    {
+        long r;
+        do
+            r = ::syscall(__NR_io_uring_enter, fd_, to_submit_, min_complete, min_complete ? IORING_ENTER_GETEVENTS : 0,
+                          nullptr, 0);
+        while (r < 0 && errno == EINTR);
+        if (r < 0)
+            return false;
+        to_submit_ -= static_cast<unsigned>(r);
+        return true;
+    }
+
+    bool IoUring::peek(UringCompletion &out) noexcept
+    {
+        const std::uint32_t head = *cq_head_;
+        if (head == load_acquire(cq_tail_))
+            return false;
+        const io_uring_cqe &c = static_cast<const io_uring_cqe *>(cqes_)[head & cq_mask_];
+        out = UringCompletion{c.user_data, c.res};
+        store_release(cq_head_, head + 1);
+        return true;
+    }
+
+} // namespace bqs::adapters
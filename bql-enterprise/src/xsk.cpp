@@ -0,0 +1,321 @@
+#include "bqs/adapters/xsk.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+namespace bqs::adapters
+{
+
+    namespace
+    {
+        long sys_bpf(int cmd, bpf_attr &attr) noexcept { return ::syscall(__NR_bpf, cmd, &attr, sizeof(attr)); }
+
+        std::string errno_text(const char *what) { return std::string(what) + ": " + std::strerror(errno); }
+
+        // Just enough of the eBPF instruction set for the redirect program.
+        constexpr bpf_insn insn(std::uint8_t code, std::uint8_t dst, std::uint8_t src, std::int16_t off,
+                                std::int32_t imm) noexcept
+        {
+            bpf_insn i{};
+            i.code = code;
+            i.dst_reg = dst & 0xf;
+            i.src_reg = src & 0xf;
+            i.off = off;
+            i.imm = imm;
+            return i;
+        }
+        constexpr bpf_insn mov_reg(std::uint8_t dst, std::uint8_t src) noexcept
+        {
+            return insn(BPF_ALU64 | BPF_MOV | BPF_X, dst, src, 0, 0);
+        }
+        constexpr bpf_insn mov_imm(std::uint8_t dst, std::int32_t imm) noexcept
+        {
+            return insn(BPF_ALU64 | BPF_MOV | BPF_K, dst, 0, 0, imm);
+        }
+        constexpr bpf_insn add_imm(std::uint8_t dst, std::int32_t imm) noexcept
+        {
+            return insn(BPF_ALU64 | BPF_ADD | BPF_K, dst, 0, 0, imm);
+        }
+        constexpr bpf_insn load(std::uint8_t size, std::uint8_t dst, std::uint8_t src, std::int16_t off) noexcept
+        {
+            return insn(BPF_LDX | size | BPF_MEM, dst, src, off, 0);
+        }
+        constexpr bpf_insn jump_imm(std::uint8_t op, std::uint8_t dst, std::int32_t imm, std::int16_t off) noexcept
+        {
+            return insn(BPF_JMP | op | BPF_K, dst, 0, off, imm);
+        }
+        constexpr bpf_insn jump_reg(std::uint8_t op, std::uint8_t dst, std::uint8_t src, std::int16_t off) noexcept
+        {
+            return insn(BPF_JMP | op | BPF_X, dst, src, off, 0);
+        }
+
+        // Offsets into an untagged Ethernet + option-less IPv4 + UDP frame.
+        constexpr int kEtherType = 12, kIpVersionIhl = 14, kIpProto = 23, kUdpDstPort = 36, kUdpPayload = 42;
+        // struct xdp_md: data, data_end, data_meta, ingress_ifindex, rx_queue_index.
+        constexpr int kMdData = 0, kMdDataEnd = 4, kMdRxQueue = 16;
+    } // namespace
+
+    bool XskSocket::open(const XdpOptions &opts, std::uint16_t udp_port, std::string &err)
+    {
+        close();
+        auto fail = [&](std::string what)
+        {
+            err = std::move(what);
+            close();
+            return false;
+        };
+        if (!std::has_single_bit(opts.frames) || !std::has_single_bit(opts.frame_bytes) ||
+            !std::has_single_bit(opts.ring_size) || opts.frame_bytes < 2048)
+            return fail("xdp: frames, frame_bytes and ring_size must be powers of two (frame_bytes >= 2048)");
+        ifindex_ = ::if_nametoindex(opts.ifname.c_str());
+        if (ifindex_ == 0)
+            return fail(errno_text(("xdp: interface '" + opts.ifname + "'").c_str()));
+        queue_ = opts.queue;
+
+        fd_ = ::socket(AF_XDP, SOCK_RAW | SOCK_CLOEXEC, 0);
+        if (fd_ < 0)
+            return fail(errno_text("xdp: socket(AF_XDP)"));
+
+        // The UMEM: every frame the kernel may write into, registered once.
+        umem_bytes_ = std::size_t{opts.frames} * opts.frame_bytes;
+        void *umem = ::mmap(nullptr, umem_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (umem == MAP_FAILED)
+            return fail(errno_text("xdp: mmap umem"));
+        umem_ = static_cast<std::byte *>(umem);
+        frame_mask_ = ~std::uint64_t{opts.frame_bytes - 1};
+        xdp_umem_reg reg{};
+        reg.addr = reinterpret_cast<std::uint64_t>(umem_);
+        reg.len = umem_bytes_;
+        reg.chunk_size = opts.frame_bytes;
+        if (::setsockopt(fd_, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) != 0)
+            return fail(errno_text("xdp: XDP_UMEM_REG"));
+
+        const std::uint32_t fill_entries = opts.frames, comp_entries = 64, rx_entries = opts.ring_size;
+        if (::setsockopt(fd_, SOL_XDP, XDP_UMEM_FILL_RING, &fill_entries, sizeof(fill_entries)) != 0 ||
+            ::setsockopt(fd_, SOL_XDP, XDP_UMEM_COMPLETION_RING, &comp_entries, sizeof(comp_entries)) != 0 ||
+            ::setsockopt(fd_, SOL_XDP, XDP_RX_RING, &rx_entries, sizeof(rx_entries)) != 0)
+            return fail(errno_text("xdp: ring setup"));
+
+        xdp_mmap_offsets off{};
+        socklen_t optlen = sizeof(off);
+        if (::getsockopt(fd_, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen) != 0)
+            return fail(errno_text("xdp: XDP_MMAP_OFFSETS"));
+        auto map_ring = [&](Ring &r, const xdp_ring_offset &o, std::uint32_t entries, std::size_t entry_bytes,
+                            std::uint64_t pgoff)
+        {
+            r.map_bytes = o.desc + entries * entry_bytes;
+            void *m = ::mmap(nullptr, r.map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                             static_cast<off_t>(pgoff));
+            if (m == MAP_FAILED)
+                return false;
+            auto *base = static_cast<std::byte *>(m);
+            r.map = m;
+            r.producer = reinterpret_cast<std::uint32_t *>(base + o.producer);
+            r.consumer = reinterpret_cast<std::uint32_t *>(base + o.consumer);
+            r.flags = reinterpret_cast<std::uint32_t *>(base + o.flags);
+            r.desc = base + o.desc;
+            r.mask = entries - 1;
+            return true;
+        };
+        if (!map_ring(rx_, off.rx, rx_entries, sizeof(xdp_desc), XDP_PGOFF_RX_RING) ||
+            !map_ring(fill_, off.fr, fill_entries, sizeof(std::uint64_t), XDP_UMEM_PGOFF_FILL_RING))
+            return fail(errno_text("xdp: mmap rings"));
+
+        // Hand every frame to the kernel up front; the fill ring is as large
+        // as the UMEM, so release() never finds it full.
+        auto *fill = static_cast<std::uint64_t *>(fill_.desc);
+        for (std::uint32_t i = 0; i < opts.frames; ++i)
+            fill[i] = std::uint64_t{i} * opts.frame_bytes;
+        std::atomic_ref<std::uint32_t>(*fill_.producer).store(opts.frames, std::memory_order_release);
+
+        sockaddr_xdp sxdp{};
+        sxdp.sxdp_family = AF_XDP;
+        sxdp.sxdp_ifindex = ifindex_;
+        sxdp.sxdp_queue_id = queue_;
+        sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP | XDP_ZEROCOPY;
+        zero_copy_ = opts.zero_copy &&
+                     ::bind(fd_, reinterpret_cast<const sockaddr *>(&sxdp), sizeof(sxdp)) == 0;
+        if (!zero_copy_)
+        {
+            sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP | XDP_COPY;
+            if (::bind(fd_, reinterpret_cast<const sockaddr *>(&sxdp), sizeof(sxdp)) != 0)
+                return fail(errno_text("xdp: bind"));
+        }
+        return attach(udp_port, err) || fail(err);
+    }
+
+    bool XskSocket::attach(std::uint16_t udp_port, std::string &err)
+    {
+        // XSKMAP slot queue_ -> this socket.
+        bpf_attr attr{};
+        attr.map_type = BPF_MAP_TYPE_XSKMAP;
+        attr.key_size = sizeof(std::uint32_t);
+        attr.value_size = sizeof(std::uint32_t);
+        attr.max_entries = queue_ + 1;
+        map_fd_ = static_cast<int>(sys_bpf(BPF_MAP_CREATE, attr));
+        if (map_fd_ < 0)
+        {
+            err = errno_text("xdp: BPF_MAP_CREATE");
+            return false;
+        }
+        const std::uint32_t key = queue_, value = static_cast<std::uint32_t>(fd_);
+        attr = bpf_attr{};
+        attr.map_fd = static_cast<std::uint32_t>(map_fd_);
+        attr.key = reinterpret_cast<std::uint64_t>(&key);
+        attr.value = reinterpret_cast<std::uint64_t>(&value);
+        attr.flags = BPF_ANY;
+        if (sys_bpf(BPF_MAP_UPDATE_ELEM, attr) != 0)
+        {
+            err = errno_text("xdp: XSKMAP update");
+            return false;
+        }
+
+        // Frames too short, not IPv4/UDP (or with IP options), or for another
+        // port go to the kernel; the rest are redirected by RX queue.
+        const bpf_insn prog[] = {
+            mov_reg(BPF_REG_6, BPF_REG_1),
+            load(BPF_W, BPF_REG_2, BPF_REG_1, kMdData),
+            load(BPF_W, BPF_REG_3, BPF_REG_1, kMdDataEnd),
+            mov_reg(BPF_REG_4, BPF_REG_2),
+            add_imm(BPF_REG_4, kUdpPayload),
+            jump_reg(BPF_JGT, BPF_REG_4, BPF_REG_3, 14),
+            load(BPF_H, BPF_REG_5, BPF_REG_2, kEtherType),
+            jump_imm(BPF_JNE, BPF_REG_5, htons(0x0800), 12),
+            load(BPF_B, BPF_REG_5, BPF_REG_2, kIpVersionIhl),
+            jump_imm(BPF_JNE, BPF_REG_5, 0x45, 10),
+            load(BPF_B, BPF_REG_5, BPF_REG_2, kIpProto),
+            jump_imm(BPF_JNE, BPF_REG_5, IPPROTO_UDP, 8),
+            load(BPF_H, BPF_REG_5, BPF_REG_2, kUdpDstPort),
+            jump_imm(BPF_JNE, BPF_REG_5, htons(udp_port), 6),
+            load(BPF_W, BPF_REG_2, BPF_REG_6, kMdRxQueue),
+            insn(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, map_fd_),
+            insn(0, 0, 0, 0, 0),
+            mov_imm(BPF_REG_3, XDP_PASS),
+            insn(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map),
+            insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+            mov_imm(BPF_REG_0, XDP_PASS),
+            insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+        };
+        static constexpr char kLicense[] = "Dual BSD/GPL";
+        auto load_prog = [&](char *log, std::uint32_t log_size)
+        {
+            attr = bpf_attr{};
+            attr.prog_type = BPF_PROG_TYPE_XDP;
+            attr.insns = reinterpret_cast<std::uint64_t>(prog);
+            attr.insn_cnt = sizeof(prog) / sizeof(prog[0]);
+            attr.license = reinterpret_cast<std::uint64_t>(kLicense);
+            attr.log_buf = reinterpret_cast<std::uint64_t>(log);
+            attr.log_size = log_size;
+            attr.log_level = log ? 1 : 0;
+            attr.expected_attach_type = BPF_XDP;
+            return static_cast<int>(sys_bpf(BPF_PROG_LOAD, attr));
+        };
+        prog_fd_ = load_prog(nullptr, 0);
+        if (prog_fd_ < 0)
+        {
+            // Once more with the verifier log, to say why.
+            err = errno_text("xdp: BPF_PROG_LOAD");
+            std::string log(16384, '\0');
+            if (load_prog(log.data(), static_cast<std::uint32_t>(log.size())) < 0 && log[0])
+                err += " (" + log.substr(0, log.find('\0')) + ")";
+            return false;
+        }
+
+        // A link detaches by itself when its fd closes. Driver mode first;
+        // the generic hook works on any device, at skb cost.
+        for (const std::uint32_t mode : {XDP_FLAGS_DRV_MODE, XDP_FLAGS_SKB_MODE})
+        {
+            attr = bpf_attr{};
+            attr.link_create.prog_fd = static_cast<std::uint32_t>(prog_fd_);
+            attr.link_create.target_ifindex = ifindex_;
+            attr.link_create.attach_type = BPF_XDP;
+            attr.link_create.flags = mode;
+            link_fd_ = static_cast<int>(sys_bpf(BPF_LINK_CREATE, attr));
+            if (link_fd_ >= 0)
+            {
+                native_ = mode == XDP_FLAGS_DRV_MODE;
+                return true;
+            }
+        }
+        err = errno_text("xdp: attach");
+        return false;
+    }
+
+    void XskSocket::close()
+    {
+        for (int *fd : {&link_fd_, &prog_fd_, &map_fd_, &fd_})
+        {
+            if (*fd >= 0)
+                ::close(*fd);
+            *fd = -1;
+        }
+        for (Ring *r : {&rx_, &fill_})
+        {
+            if (r->map)
+                ::munmap(r->map, r->map_bytes);
+            *r = Ring{};
+        }
+        if (umem_)
+            ::munmap(umem_, umem_bytes_);
+        umem_ = nullptr;
+        umem_bytes_ = 0;
+        zero_copy_ = native_ = false;
+    }
+
+    std::size_t XskSocket::receive(XdpFrame *out, std::size_t n) noexcept
+    {
+        const std::uint32_t prod = std::atomic_ref<std::uint32_t>(*rx_.producer).load(std::memory_order_acquire);
+        const std::uint32_t cons = *rx_.consumer;
+        n = std::min<std::size_t>(n, prod - cons);
+        const auto *desc = static_cast<const xdp_desc *>(rx_.desc);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const xdp_desc &d = desc[(cons + i) & rx_.mask];
+            out[i] = XdpFrame{umem_ + d.addr, d.len, d.addr & frame_mask_};
+        }
+        if (n)
+            std::atomic_ref<std::uint32_t>(*rx_.consumer).store(cons + static_cast<std::uint32_t>(n), std::memory_order_release);
+        return n;
+    }
+
+    void XskSocket::release(std::uint64_t addr) noexcept
+    {
+        const std::uint32_t prod = *fill_.producer;
+        static_cast<std::uint64_t *>(fill_.desc)[prod & fill_.mask] = addr;
+        std::atomic_ref<std::uint32_t>(*fill_.producer).store(prod + 1, std::memory_order_release);
+    }
+
+    void XskSocket::wait(int timeout_ms) noexcept
+    {
+        pollfd p{fd_, POLLIN, 0};
+        ::poll(&p, 1, timeout_ms);
+    }
+
+    void XskSocket::kick() noexcept
+    {
+        if (std::atomic_ref<std::uint32_t>(*fill_.flags).load(std::memory_order_relaxed) & XDP_RING_NEED_WAKEUP)
+            ::recvfrom(fd_, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+    }
+
+} // namespace bqs::adapters
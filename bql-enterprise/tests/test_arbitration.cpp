@@ -0,0 +1,232 @@
+#include "bqs/adapters/arbitration.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bqs::adapters;
+
+namespace
+{
+    constexpr std::size_t kPayload = 64;
+    constexpr std::uint64_t kMessages = 3000;
+    constexpr std::uint16_t kPer = 10;
+
+    std::vector<std::byte> payload(std::uint64_t seq)
+    {
+        std::vector<std::byte> p(kPayload);
+        for (std::size_t i = 0; i < kPayload; ++i)
+            p[i] = static_cast<std::byte>(seq * 31 + i);
+        return p;
+    }
+
+    // One line of the feed: sends every packet except those `drop` selects,
+    // sleeping a random 0..jitter_us every few packets.
+    void run_line(const char *group, std::uint16_t port, int start_delay_us, int jitter_us, std::uint64_t seed,
+                  bool (*drop)(std::uint64_t), std::uint64_t messages = kMessages)
+    {
+        const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        in_addr lo{};
+        inet_pton(AF_INET, "127.0.0.1", &lo);
+        ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &lo, sizeof(lo));
+        sockaddr_in dst{};
+        dst.sin_family = AF_INET;
+        dst.sin_port = htons(port);
+        inet_pton(AF_INET, group, &dst.sin_addr);
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<int> jitter(0, jitter_us);
+        std::this_thread::sleep_for(std::chrono::microseconds(start_delay_us));
+
+        std::byte buf[mold::kMaxPacketBytes];
+        for (std::uint64_t first = 1, p = 0; first <= messages; first += kPer, ++p)
+        {
+            if (p % 4 == 3)
+                std::this_thread::sleep_for(std::chrono::microseconds(jitter(rng)));
+            if (drop(p))
+                continue;
+            mold::PacketBuilder b({buf, sizeof(buf)}, "TEST", first);
+            for (std::uint16_t k = 0; k < kPer; ++k)
+                b.add(payload(first + k));
+            ::sendto(fd, buf, b.bytes().size(), 0, reinterpret_cast<const sockaddr *>(&dst), sizeof(dst));
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+            mold::PacketBuilder b({buf, sizeof(buf)}, "TEST", messages + 1);
+            b.mark_end_of_session();
+            ::sendto(fd, buf, b.bytes().size(), 0, reinterpret_cast<const sockaddr *>(&dst), sizeof(dst));
+        }
+        ::close(fd);
+    }
+
+    AdapterConfig config(const std::string &endpoint)
+    {
+        AdapterConfig cfg;
+        cfg.name = "ab";
+        cfg.kind = FeedKind::itch;
+        cfg.endpoint = endpoint;
+        cfg.start_sequence = 1;
+        return cfg;
+    }
+
+    int fail(const std::string &what)
+    {
+        std::cerr << what << std::endl;
+        return 1;
+    }
+} // namespace
+
+int main()
+{
+    // Sliding window: bits come back per sequence and clear() frees slots
+    // for reuse one span later.
+    {
+        SequenceWindow w(100); // rounds up to 128
+        w.set(5, 50);
+        w.set(133, 1330);
+        if (w.span() != 128 || !w.seen(5) || !w.seen(133) || w.seen(6) || w.first_ts(133) != 1330)
+            return fail("sequence window set/seen");
+        w.clear(130, 134);
+        if (w.seen(5) || w.seen(133) || w.seen(130 + 128))
+            return fail("sequence window clear");
+        w.set(7, 0);
+        w.clear(0, 1000);
+        if (w.seen(7))
+            return fail("sequence window full clear");
+    }
+
+    // Line A starts first; B trails by 2 ms. Each line drops its own
+    // packets, and packet 210 is lost on both.
+    const std::uint16_t port = static_cast<std::uint16_t>(20000 + (::getpid() + 13) % 20000);
+    UdpFeedOptions lo;
+    lo.batch = 16;
+    ArbitrationOptions ao;
+    ao.gap_wait_us = 50'000;
+    ao.wait_ms = 200;
+    ArbitratedMarketDataAdapter rx(lo, ao);
+    rx.configure(config("239.192.7.9:" + std::to_string(port) + ",239.192.7.10:" + std::to_string(port)));
+    rx.connect();
+    if (rx.status().state != SessionState::established || !rx.status().detail.empty())
+        return fail("arbiter did not connect both lines: " + rx.status().detail);
+
+    std::thread a([&]
+                  { run_line("239.192.7.9", port, 0, 300, 1, [](std::uint64_t p)
+                             { return p % 23 == 3; }); });
+    std::thread b([&]
+                  { run_line("239.192.7.10", port, 2000, 300, 2, [](std::uint64_t p)
+                             { return p % 29 == 7; }); });
+
+    std::vector<bool> got(kMessages + 1, false);
+    std::uint64_t last = 0;
+    MoldMessage m;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while (rx.status().state == SessionState::established && std::chrono::steady_clock::now() < deadline)
+    {
+        if (!rx.next_message(m))
+            continue;
+        const auto want = payload(m.sequence);
+        if (m.sequence == 0 || m.sequence > kMessages || got[m.sequence] || m.sequence <= last ||
+            m.payload.size() != kPayload || std::memcmp(m.payload.data(), want.data(), kPayload) != 0)
+        {
+            a.join();
+            b.join();
+            return fail("bad or repeated message at sequence " + std::to_string(m.sequence));
+        }
+        got[m.sequence] = true;
+        last = m.sequence;
+    }
+    a.join();
+    b.join();
+
+    const ArbitrationStats &st = rx.stats();
+    const ArbitrationLineStats &la = st.line[0], &lb = st.line[1];
+    std::cout << "arbitration: emitted=" << st.emitted << " gaps=" << st.gaps << " missing=" << st.missing
+              << " A wins=" << la.wins << " (" << st.win_rate(0) * 100 << "%) B wins=" << lb.wins
+              << " B lag p50_us=" << double(lb.lag_ns.quantile(0.5)) / 1e3
+              << " A lag p50_us=" << double(la.lag_ns.quantile(0.5)) / 1e3 << " line losses A="
+              << rx.line(0).stats().missing << " B=" << rx.line(1).stats().missing << std::endl;
+    if (rx.status().state != SessionState::closed)
+        return fail("arbiter did not end cleanly: " + rx.status().detail);
+    for (std::uint64_t s = 1; s <= kMessages; ++s)
+        if (got[s] != (s < 2101 || s > 2110))
+            return fail("sequence " + std::to_string(s) + (got[s] ? " should have been lost" : " missing"));
+    if (st.emitted != kMessages - kPer || st.gaps != 1 || st.missing != kPer || st.late != 0)
+        return fail("unexpected hole accounting");
+    if (la.wins + lb.wins != st.emitted || lb.wins == 0 || st.win_rate(0) <= 0.5)
+        return fail("unexpected win counts");
+    if (lb.duplicates == 0 || lb.lag_ns.n != lb.duplicates)
+        return fail("trailing line lag not recorded");
+
+    // B trails by 30 ms and A loses packet 5, so the hole is given up after
+    // 1 ms. B's copy of it then arrives behind later sequences: it must be
+    // dropped, not emitted out of order.
+    {
+        const std::uint16_t p2 = port + 1;
+        constexpr std::uint64_t kShort = 300;
+        ArbitrationOptions quick = ao;
+        quick.gap_wait_us = 1000;
+        ArbitratedMarketDataAdapter late(lo, quick);
+        late.configure(config("239.192.7.9:" + std::to_string(p2) + ",239.192.7.10:" + std::to_string(p2)));
+        late.connect();
+        std::thread la2([&]
+                        { run_line("239.192.7.9", p2, 0, 0, 3, [](std::uint64_t p)
+                                   { return p == 5; }, kShort); });
+        std::thread lb2([&]
+                        { run_line("239.192.7.10", p2, 30'000, 0, 4, [](std::uint64_t)
+                                   { return false; }, kShort); });
+        std::uint64_t prev = 0, n = 0;
+        bool ordered = true;
+        const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < until && (late.stats().late < kPer || n < kShort - kPer))
+        {
+            if (!late.next_message(m))
+                continue;
+            if (m.sequence <= prev)
+            {
+                ordered = false;
+                break;
+            }
+            prev = m.sequence;
+            ++n;
+        }
+        la2.join();
+        lb2.join();
+        const ArbitrationStats &ls = late.stats();
+        if (!ordered || n != kShort - kPer || ls.late != kPer || ls.missing != kPer || ls.gaps != 1)
+            return fail("late hole fill: emitted=" + std::to_string(n) + " late=" + std::to_string(ls.late) +
+                        " missing=" + std::to_string(ls.missing));
+    }
+
+    // read() drops a message that can never fit the caller's buffer, and
+    // counts it.
+    {
+        const std::uint16_t p3 = port + 2;
+        constexpr std::uint64_t kShort = 30;
+        ArbitratedMarketDataAdapter small(lo, ao);
+        small.configure(config("239.192.7.9:" + std::to_string(p3)));
+        small.connect();
+        std::thread sa([&]
+                       { run_line("239.192.7.9", p3, 0, 0, 5, [](std::uint64_t)
+                                  { return false; }, kShort); });
+        std::byte tiny[kPayload / 2];
+        std::size_t bytes = 0;
+        const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (small.status().state == SessionState::established && std::chrono::steady_clock::now() < until)
+            bytes += small.read({tiny, sizeof(tiny)});
+        sa.join();
+        if (bytes != 0 || small.stats().malformed != kShort)
+            return fail("oversized messages: read " + std::to_string(bytes) + " bytes, malformed=" +
+                        std::to_string(small.stats().malformed));
+    }
+
+    std::cout << "a/b arbitration ok" << std::endl;
+    return 0;
+}
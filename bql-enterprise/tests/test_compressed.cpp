@@ -0,0 +1,153 @@
+#include "bqs/adapters/codec.hpp"
+#include "bqs/adapters/file_adapters.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace bqs::adapters;
+
+namespace
+{
+    constexpr std::size_t kRecord = 48;
+    constexpr std::uint64_t kRecords = 20000;
+
+    int fail(const std::string &what)
+    {
+        std::cerr << what << std::endl;
+        return 1;
+    }
+
+    void write_file(const char *path, std::span<const std::byte> bytes)
+    {
+        std::ofstream(path, std::ios::binary)
+            .write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    // Reads the whole decompressed stream frame by frame, checking no frame
+    // splits a record; returns an error text or empty.
+    std::string drain(CompressedFileMarketDataAdapter &a, std::span<const std::byte> want)
+    {
+        std::vector<std::byte> got;
+        for (auto f = a.next_frame(); !f.empty(); f = a.next_frame())
+        {
+            if (f.size() % kRecord != 0 && got.size() + f.size() != want.size())
+                return "frame of " + std::to_string(f.size()) + " bytes split a record";
+            got.insert(got.end(), f.begin(), f.end());
+        }
+        if (a.status().state != SessionState::closed)
+            return "did not close: " + a.status().detail;
+        if (got.size() != want.size() || std::memcmp(got.data(), want.data(), got.size()) != 0)
+            return "stream mismatch (" + std::to_string(got.size()) + " of " + std::to_string(want.size()) + " bytes)";
+        return {};
+    }
+} // namespace
+
+int main()
+{
+    // Compressible but not trivially so: a counter with a little noise.
+    std::vector<std::byte> data(kRecords * kRecord + 20);
+    for (std::size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<std::byte>((i / kRecord) * 7 + (i % kRecord == 5 ? i * 131 : i % 11));
+    const char *path = "bqs_compressed_test.bin";
+
+    const std::byte raw[] = {std::byte{0x01}, std::byte{0x02}, std::byte{0x03}, std::byte{0x04}};
+    if (detect_codec(std::span<const std::byte>(raw)) != Codec::none)
+        return fail("raw bytes detected as compressed");
+
+    AdapterConfig cfg;
+    cfg.name = "packed";
+    cfg.endpoint = path;
+    for (const Codec c : {Codec::zstd, Codec::lz4})
+    {
+        if (!codec_available(c))
+        {
+            // The reader must say so rather than hand out compressed bytes.
+            const std::byte magic[] = {std::byte{0x28}, std::byte{0xB5}, std::byte{0x2F}, std::byte{0xFD},
+                                       std::byte{0x04}, std::byte{0x22}, std::byte{0x4D}, std::byte{0x18}};
+            write_file(path, std::span<const std::byte>(magic).subspan(c == Codec::zstd ? 0 : 4, 4));
+            CompressedFileMarketDataAdapter a;
+            a.configure(cfg);
+            a.connect();
+            if (a.status().state != SessionState::disconnected || a.status().detail.find("no ") == std::string::npos)
+                return fail(std::string(codec_name(c)) + " unavailable but connect said: " + a.status().detail);
+            std::cout << codec_name(c) << ": not in this build, refused" << std::endl;
+            continue;
+        }
+
+        // Frames of 10000 bytes: every frame boundary cuts a record.
+        std::vector<std::byte> packed;
+        std::string err;
+        if (!encode_frames(c, data, 10000, 1, packed, err))
+            return fail(err);
+        write_file(path, packed);
+        if (detect_codec(std::string(path)) != c)
+            return fail(std::string(codec_name(c)) + " not detected");
+        std::vector<CompressedFrame> frames;
+        if (!scan_frames(c, packed, frames, err) || frames.size() != (data.size() + 9999) / 10000)
+            return fail(std::string(codec_name(c)) + " scan: " + err);
+
+        // Parallel: several workers, a window smaller than the frame count,
+        // records reassembled across frames, and a start offset that skips
+        // whole frames and part of the next.
+        for (const std::uint64_t start : {std::uint64_t{0}, std::uint64_t{kRecord * 500}})
+        {
+            FileSourceOptions o;
+            o.start_offset = start;
+            o.decode_threads = 3;
+            o.decode_window = 4;
+            o.pacing.record_bytes = kRecord;
+            CompressedFileMarketDataAdapter a(o);
+            a.configure(cfg);
+            a.connect();
+            if (a.status().state != SessionState::established || a.size_bytes() != data.size())
+                return fail(std::string(codec_name(c)) + " did not connect: " + a.status().detail);
+            const std::string e = drain(a, std::span<const std::byte>(data).subspan(start));
+            if (!e.empty())
+                return fail(std::string(codec_name(c)) + " parallel: " + e);
+            const DecodeStats &st = a.decode_stats();
+            if (!st.parallel || st.threads != 3 || a.status().last_sequence != data.size())
+                return fail(std::string(codec_name(c)) + " parallel stats");
+            std::cout << codec_name(c) << " parallel start=" << start << ": frames=" << st.frames
+                      << " units=" << st.units << " waits=" << st.waits << " ratio="
+                      << double(data.size()) / double(st.compressed_bytes) << std::endl;
+        }
+
+        // One frame: streamed by a single worker in small units.
+        packed.clear();
+        if (!encode_frames(c, data, data.size(), 1, packed, err))
+            return fail(err);
+        write_file(path, packed);
+        {
+            FileSourceOptions o;
+            o.read_bytes = 5000;
+            o.pacing.record_bytes = kRecord;
+            CompressedFileMarketDataAdapter a(o);
+            a.configure(cfg);
+            a.connect();
+            const std::string e = drain(a, data);
+            if (!e.empty())
+                return fail(std::string(codec_name(c)) + " stream: " + e);
+            const DecodeStats &st = a.decode_stats();
+            if (st.parallel || st.units != (data.size() + 4999) / 5000)
+                return fail(std::string(codec_name(c)) + " stream stats");
+            std::cout << codec_name(c) << " stream: units=" << st.units << " waits=" << st.waits << std::endl;
+        }
+
+        // A cut-off file is refused at connect, not half-replayed.
+        write_file(path, std::span<const std::byte>(packed).first(packed.size() - 7));
+        {
+            CompressedFileMarketDataAdapter a;
+            a.configure(cfg);
+            a.connect();
+            if (a.status().state != SessionState::disconnected)
+                return fail(std::string(codec_name(c)) + " truncated file accepted");
+        }
+    }
+    std::remove(path);
+    std::cout << "compressed capture reader ok" << std::endl;
+    return 0;
+}
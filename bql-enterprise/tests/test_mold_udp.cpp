@@ -0,0 +1,204 @@
+#include "bqs/adapters/mold_udp_adapter.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bqs::adapters;
+
+namespace
+{
+    constexpr std::size_t kPayload = 64;
+
+    std::vector<std::byte> payload(std::uint64_t seq)
+    {
+        std::vector<std::byte> p(kPayload);
+        for (std::size_t i = 0; i < kPayload; ++i)
+            p[i] = static_cast<std::byte>(seq * 31 + i);
+        return p;
+    }
+
+    struct Sender
+    {
+        int fd{-1};
+        sockaddr_in dst{};
+
+        Sender(const char *group, std::uint16_t port)
+        {
+            fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+            in_addr lo{};
+            inet_pton(AF_INET, "127.0.0.1", &lo);
+            ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &lo, sizeof(lo));
+            dst.sin_family = AF_INET;
+            dst.sin_port = htons(port);
+            inet_pton(AF_INET, group, &dst.sin_addr);
+        }
+        ~Sender() { ::close(fd); }
+
+        // Packet carrying sequences [first, first + n); n == 0 is a heartbeat.
+        void send(std::uint64_t first, std::uint16_t n, bool eos = false)
+        {
+            std::byte buf[mold::kMaxPacketBytes];
+            mold::PacketBuilder b({buf, sizeof(buf)}, "TEST", first);
+            for (std::uint16_t k = 0; k < n; ++k)
+                b.add(payload(first + k));
+            if (eos)
+                b.mark_end_of_session();
+            ::sendto(fd, buf, b.bytes().size(), 0, reinterpret_cast<const sockaddr *>(&dst), sizeof(dst));
+        }
+    };
+
+    int fail(const std::string &what)
+    {
+        std::cerr << what << std::endl;
+        return 1;
+    }
+} // namespace
+
+int main()
+{
+    // Header round trip.
+    {
+        std::byte buf[64];
+        mold::PacketBuilder b({buf, sizeof(buf)}, "ABCDEFGHIJKL", 0x0102030405060708ull);
+        const std::byte m[3] = {std::byte{1}, std::byte{2}, std::byte{3}};
+        b.add(m);
+        mold::PacketHeader h;
+        std::span<const std::byte> got;
+        mold::MessageCursor c(b.bytes());
+        if (!mold::parse_header(b.bytes(), h) || h.sequence != 0x0102030405060708ull || h.count != 1 ||
+            std::memcmp(h.session, "ABCDEFGHIJ", 10) != 0 || !c.next(got) || got.size() != 3 || c.next(got))
+            return fail("MoldUDP64 framing round trip failed");
+    }
+
+    const std::uint16_t port = static_cast<std::uint16_t>(20000 + ::getpid() % 20000);
+    const char *group = "239.192.7.7";
+    UdpFeedOptions o;
+    o.wait_ms = 200;
+    o.batch = 8;
+    o.ring_slots = 16;
+    MoldUdpMarketDataAdapter rx(o);
+    AdapterConfig cfg;
+    cfg.name = "mold";
+    cfg.kind = FeedKind::itch;
+    cfg.endpoint = std::string(group) + ":" + std::to_string(port);
+    cfg.start_sequence = 1;
+    rx.configure(cfg);
+    rx.connect();
+    if (rx.status().state != SessionState::established)
+        return fail("receiver did not connect: " + rx.status().detail);
+
+    Sender tx(group, port);
+    tx.send(1, 2);
+    tx.send(3, 2);
+    tx.send(3, 2);  // duplicate packet
+    tx.send(7, 2);  // gap 5-6
+    tx.send(8, 2);  // 8 duplicate, 9 new
+    tx.send(10, 0); // heartbeat: next is 10
+    tx.send(12, 1); // gap 10-11
+    tx.send(13, 0, true);
+
+    const std::uint64_t expect[] = {1, 2, 3, 4, 7, 8, 9, 12};
+    std::size_t k = 0;
+    MoldMessage m;
+    while (rx.next_message(m))
+    {
+        if (k >= std::size(expect) || m.sequence != expect[k])
+            return fail("unexpected sequence " + std::to_string(m.sequence));
+        const auto want = payload(m.sequence);
+        if (m.payload.size() != kPayload || std::memcmp(m.payload.data(), want.data(), kPayload) != 0)
+            return fail("payload mismatch at sequence " + std::to_string(m.sequence));
+        if (m.rx_ts_ns == 0)
+            return fail("no kernel receive timestamp");
+        ++k;
+    }
+    const UdpFeedStats &st = rx.stats();
+    if (k != std::size(expect) || rx.status().state != SessionState::closed)
+        return fail("session did not end cleanly after " + std::to_string(k) + " messages: " + rx.status().detail);
+    if (st.gaps != 2 || st.missing != 4 || st.duplicates != 3 || st.heartbeats != 1 || st.packets != 8)
+        return fail("unexpected stats: gaps=" + std::to_string(st.gaps) + " missing=" + std::to_string(st.missing) +
+                    " duplicates=" + std::to_string(st.duplicates) + " heartbeats=" + std::to_string(st.heartbeats) +
+                    " packets=" + std::to_string(st.packets));
+    if (rx.status().last_sequence != 12)
+        return fail("last_sequence not tracked");
+
+    // read() copies payloads back to back across packets and keeps a message
+    // that does not fit for the next call.
+    rx.connect();
+    tx.send(1, 3);
+    tx.send(4, 3, false);
+    tx.send(7, 0, true);
+    std::vector<std::byte> out(kPayload * 4), all;
+    while (std::size_t n = rx.read(out))
+        all.insert(all.end(), out.begin(), out.begin() + static_cast<std::ptrdiff_t>(n));
+    if (all.size() != 6 * kPayload)
+        return fail("read() delivered " + std::to_string(all.size()) + " bytes");
+    for (std::uint64_t s = 1; s <= 6; ++s)
+        if (std::memcmp(all.data() + (s - 1) * kPayload, payload(s).data(), kPayload) != 0)
+            return fail("read() payload mismatch at sequence " + std::to_string(s));
+
+    // Busy-poll mode: a paced sender thread, a spinning receiver. Every
+    // datagram lands in the batch-size and wake-latency histograms, and an
+    // idle feed still returns after wait_ms.
+    {
+        UdpFeedOptions bo = o;
+        bo.mode = ReceiveMode::busy_poll;
+        bo.spin_polls = 200;
+        bo.wait_ms = 50;
+        MoldUdpMarketDataAdapter busy(bo);
+        busy.configure(cfg);
+        busy.connect();
+        if (busy.status().state != SessionState::established)
+            return fail("busy-poll receiver did not connect: " + busy.status().detail);
+        constexpr std::uint64_t kPackets = 200, kPer = 5;
+        std::thread sender([&]
+                           {
+                               for (std::uint64_t p = 0; p < kPackets; ++p)
+                               {
+                                   tx.send(1 + p * kPer, kPer);
+                                   if (p % 8 == 7)
+                                       std::this_thread::sleep_for(std::chrono::microseconds(200));
+                               }
+                               tx.send(1 + kPackets * kPer, 0, true); });
+        std::uint64_t next = 1;
+        while (busy.status().state == SessionState::established)
+        {
+            while (busy.next_message(m))
+            {
+                if (m.sequence != next++)
+                {
+                    sender.join();
+                    return fail("busy-poll receiver out of sequence at " + std::to_string(m.sequence));
+                }
+            }
+        }
+        sender.join();
+        const UdpFeedStats &bs = busy.stats();
+        if (next != 1 + kPackets * kPer || bs.gaps != 0)
+            return fail("busy-poll receiver lost messages: next=" + std::to_string(next));
+        if (bs.batch_size.n != bs.batches || bs.batch_size.sum != bs.packets || bs.wake_ns.n != bs.packets ||
+            bs.empty_polls == 0)
+            return fail("busy-poll histograms incomplete");
+        std::cout << "busy-poll: batches=" << bs.batches << " mean_batch=" << bs.batch_size.mean()
+                  << " wake_p50_ns=" << bs.wake_ns.quantile(0.5) << " wake_p99_ns=" << bs.wake_ns.quantile(0.99)
+                  << " empty_polls=" << bs.empty_polls << " yields=" << bs.yields << std::endl;
+
+        busy.connect();
+        const auto t0 = std::chrono::steady_clock::now();
+        const bool got = busy.next_message(m);
+        const auto waited = std::chrono::steady_clock::now() - t0;
+        if (got || waited < std::chrono::milliseconds(40) || busy.stats().yields == 0)
+            return fail("idle busy-poll receiver did not back off and time out");
+    }
+
+    std::cout << "moldudp64 receiver ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,228 @@
+#include "bqs/adapters/order_codecs.hpp"
+#include "bqs/adapters/tcp_order_flow.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace bqs::adapters;
+
+// Counts heap allocations made by this thread, to prove the typed send path
+// does not allocate.
+namespace
+{
+    thread_local std::uint64_t g_allocs = 0;
+}
+
+void *operator new(std::size_t n)
+{
+    ++g_allocs;
+    if (void *p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+    NewOrder make_order(std::uint64_t i)
+    {
+        NewOrder o;
+        o.cl_ord_id = 1000 + i;
+        o.transact_ns = 1'760'000'000'123'456'789ull + i * 1'000'000;
+        o.price = 1'012'500 + static_cast<std::int64_t>(i % 100) * 100; // 101.2500 and up
+        o.qty = 100 + static_cast<std::uint32_t>(i % 7);
+        std::memcpy(o.symbol.data(), "MSFT", 4);
+        o.side = i % 2 ? OrderSide::sell : OrderSide::buy;
+        o.type = i % 5 == 0 ? OrderType::market : OrderType::limit;
+        o.tif = i % 3 == 0 ? TimeInForce::ioc : TimeInForce::day;
+        return o;
+    }
+
+    bool same(const NewOrder &a, const NewOrder &b)
+    {
+        return a.cl_ord_id == b.cl_ord_id && a.transact_ns == b.transact_ns && a.price == b.price && a.qty == b.qty &&
+               a.symbol == b.symbol && a.side == b.side && a.type == b.type && a.tif == b.tif;
+    }
+
+    std::string_view field(std::string_view msg, std::string_view tag)
+    {
+        std::string key;
+        key.reserve(tag.size() + 2);
+        key += '\x01';
+        key += tag;
+        key += '=';
+        const auto at = msg.find(key);
+        if (at == std::string_view::npos)
+            return {};
+        const auto from = at + key.size();
+        return msg.substr(from, msg.find('\x01', from) - from);
+    }
+
+    // Checks BodyLength and CheckSum of the FIX message at the front of s;
+    // returns its length, or 0 if it is malformed.
+    std::size_t check_fix(std::string_view s)
+    {
+        if (s.substr(0, 12) != std::string_view("8=FIX.4.4\x01"
+                                                "9=",
+                                                12))
+            return 0;
+        const auto soh = s.find('\x01', 12);
+        const std::size_t body = std::strtoull(std::string(s.substr(12, soh - 12)).c_str(), nullptr, 10);
+        const std::size_t trailer = soh + 1 + body;
+        if (trailer + 7 > s.size() || s.substr(trailer, 3) != "10=" || s[trailer + 6] != '\x01')
+            return 0;
+        unsigned sum = 0;
+        for (std::size_t i = 0; i < trailer; ++i)
+            sum += static_cast<unsigned char>(s[i]);
+        if (std::to_string(sum % 256 + 1000).substr(1) != s.substr(trailer + 3, 3))
+            return 0;
+        return trailer + 7;
+    }
+
+    int fail(const std::string &what)
+    {
+        std::cerr << what << std::endl;
+        return 1;
+    }
+} // namespace
+
+int main()
+{
+    // SBE round trip.
+    {
+        std::byte buf[SbeNewOrderCodec::kMaxBytes];
+        const NewOrder o = make_order(3);
+        NewOrder back;
+        std::size_t used = 0;
+        if (SbeNewOrderCodec{}.encode(o, buf) != sizeof(buf) || !SbeNewOrderCodec::decode(buf, back, used) ||
+            used != sizeof(buf) || !same(o, back))
+            return fail("SBE round trip failed");
+        buf[7] = std::byte{0x7F}; // corrupt blockLength
+        if (SbeNewOrderCodec::decode(buf, back, used))
+            return fail("SBE decode accepted a bad header");
+    }
+
+    // FIX: framing, checksum and field rendering.
+    {
+        FixNewOrderCodec codec("BQLTEST", "VENUE", 7);
+        char buf[FixNewOrderCodec::kMaxBytes];
+        NewOrder o = make_order(1);
+        o.transact_ns = 1'709'210'096'789'000'000ull; // 2024-02-29 12:34:56.789 UTC
+        o.price = -25'000;                             // -2.5
+        const std::size_t n = codec.encode(o, reinterpret_cast<std::byte *>(buf));
+        const std::string_view msg(buf, n);
+        if (check_fix(msg) != n)
+            return fail("FIX BodyLength/CheckSum wrong: " + std::string(msg));
+        if (field(msg, "35") != "D" || field(msg, "49") != "BQLTEST" || field(msg, "56") != "VENUE" ||
+            field(msg, "34") != "7" || field(msg, "11") != "1001" || field(msg, "55") != "MSFT" ||
+            field(msg, "54") != "2" || field(msg, "38") != "101" || field(msg, "40") != "2" ||
+            field(msg, "44") != "-2.5000" || field(msg, "59") != "0" ||
+            field(msg, "60") != "20240229-12:34:56.789" || field(msg, "52") != field(msg, "60"))
+            return fail("FIX fields wrong: " + std::string(msg));
+        o.type = OrderType::market;
+        const std::string_view mkt(buf, codec.encode(o, reinterpret_cast<std::byte *>(buf)));
+        if (!check_fix(mkt) || !field(mkt, "44").empty() || field(mkt, "34") != "8" || codec.next_seq() != 9)
+            return fail("FIX market order wrong: " + std::string(mkt));
+    }
+
+    // Typed sends over TCP to a local sink, with no heap traffic on the
+    // sending thread.
+    constexpr std::uint64_t kOrders = 2000;
+    {
+        TcpSink sink;
+        std::string err;
+        if (!sink.start(0, err))
+            return fail(err);
+        TcpOrderFlowAdapter<SbeNewOrderCodec> tx;
+        AdapterConfig cfg;
+        cfg.name = "sbe";
+        cfg.kind = FeedKind::other;
+        cfg.endpoint = sink.endpoint();
+        tx.configure(cfg);
+        tx.connect();
+        if (tx.status().state != SessionState::established)
+            return fail("connect failed: " + tx.status().detail);
+        std::vector<NewOrder> orders;
+        for (std::uint64_t i = 0; i < kOrders; ++i)
+            orders.push_back(make_order(i));
+        const std::uint64_t before = g_allocs;
+        for (const NewOrder &o : orders)
+            tx.send(o);
+        if (g_allocs != before)
+            return fail("send(NewOrder) allocated " + std::to_string(g_allocs - before) + " times");
+        tx.send_raw("not an order");
+        tx.disconnect();
+
+        const auto got = sink.wait_for(kOrders * SbeNewOrderCodec::kMaxBytes + 12, std::chrono::seconds(5));
+        std::span<const std::byte> rest(got);
+        for (std::uint64_t i = 0; i < kOrders; ++i)
+        {
+            NewOrder back;
+            std::size_t used = 0;
+            if (!SbeNewOrderCodec::decode(rest, back, used) || !same(back, orders[i]))
+                return fail("sink got a bad SBE order at " + std::to_string(i));
+            rest = rest.subspan(used);
+        }
+        if (rest.size() != 12 || std::memcmp(rest.data(), "not an order", 12) != 0)
+            return fail("send_raw payload missing");
+        if (tx.stats().orders != kOrders || tx.stats().raw_messages != 1 || tx.stats().bytes != got.size())
+            return fail("unexpected SBE session stats");
+    }
+    {
+        TcpSink sink;
+        std::string err;
+        if (!sink.start(0, err))
+            return fail(err);
+        OrderFlowOptions opts;
+        opts.flush_each = false;
+        opts.send_buffer_bytes = 16 * 1024; // forces flushes from reserve()
+        TcpOrderFlowAdapter<FixNewOrderCodec> tx(FixNewOrderCodec("BQL", "SINK"), opts);
+        AdapterConfig cfg;
+        cfg.endpoint = sink.endpoint();
+        tx.configure(cfg);
+        tx.connect();
+        const std::uint64_t before = g_allocs;
+        for (std::uint64_t i = 0; i < kOrders; ++i)
+            tx.send(make_order(i));
+        if (!tx.flush() || g_allocs != before)
+            return fail("FIX send path failed or allocated");
+        const std::uint64_t bytes = tx.stats().bytes;
+        tx.disconnect();
+
+        const auto got = sink.wait_for(bytes, std::chrono::seconds(5));
+        std::string_view s(reinterpret_cast<const char *>(got.data()), got.size());
+        for (std::uint64_t i = 0; i < kOrders; ++i)
+        {
+            const std::size_t n = check_fix(s);
+            if (n == 0 || field(s.substr(0, n), "11") != std::to_string(1000 + i))
+                return fail("sink got a bad FIX order at " + std::to_string(i));
+            s.remove_prefix(n);
+        }
+        if (!s.empty() || tx.stats().rejected != 0)
+            return fail("FIX stream has trailing bytes or rejects");
+    }
+
+    // No venue listening: connect reports it.
+    {
+        TcpOrderFlowAdapter<SbeNewOrderCodec> tx;
+        AdapterConfig cfg;
+        cfg.endpoint = "127.0.0.1:1";
+        tx.configure(cfg);
+        tx.connect();
+        if (tx.status().state != SessionState::disconnected || tx.status().detail.empty())
+            return fail("connect to a closed port did not fail");
+        tx.send(make_order(0));
+        if (tx.stats().orders != 0)
+            return fail("send on a closed session was queued");
+    }
+
+    std::cout << "order entry ok" << std::endl;
+    return 0;
+}
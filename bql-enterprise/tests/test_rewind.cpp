@@ -0,0 +1,224 @@
+#include "bqs/adapters/mold_udp_adapter.hpp"
+#include "bqs/adapters/reorder_ring.hpp"
+#include "bqs/adapters/rewind.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bqs::adapters;
+
+namespace
+{
+    constexpr std::size_t kPayload = 64;
+    constexpr std::uint64_t kMessages = 3000;
+    constexpr std::uint16_t kPer = 10;
+
+    void fill_payload(std::byte *p, std::uint64_t seq)
+    {
+        for (std::size_t i = 0; i < kPayload; ++i)
+            p[i] = static_cast<std::byte>(seq * 31 + i);
+    }
+
+    struct Sender
+    {
+        int fd{-1};
+        sockaddr_in dst{};
+
+        Sender(const char *group, std::uint16_t port)
+        {
+            fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+            in_addr lo{};
+            inet_pton(AF_INET, "127.0.0.1", &lo);
+            ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &lo, sizeof(lo));
+            dst.sin_family = AF_INET;
+            dst.sin_port = htons(port);
+            inet_pton(AF_INET, group, &dst.sin_addr);
+        }
+        ~Sender() { ::close(fd); }
+
+        void send(const std::vector<std::byte> &capture, std::uint64_t first, std::uint16_t n, bool eos = false)
+        {
+            std::byte buf[mold::kMaxPacketBytes];
+            mold::PacketBuilder b({buf, sizeof(buf)}, "TEST", first);
+            for (std::uint16_t k = 0; k < n; ++k)
+                b.add({capture.data() + (first + k - 1) * kPayload, kPayload});
+            if (eos)
+                b.mark_end_of_session();
+            ::sendto(fd, buf, b.bytes().size(), 0, reinterpret_cast<const sockaddr *>(&dst), sizeof(dst));
+        }
+    };
+
+    int fail(const std::string &what)
+    {
+        std::cerr << what << std::endl;
+        return 1;
+    }
+} // namespace
+
+int main()
+{
+    // Reorder ring: out-of-order puts come back by sequence; duplicates and
+    // oversized messages are refused.
+    {
+        ReorderRing r(5, 8); // rounds up to 8 slots
+        const std::byte a[4] = {std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}};
+        const std::byte big[9] = {};
+        if (r.capacity() != 8 || !r.put(12, a, 7) || r.put(12, a, 7) || r.put(13, big, 0) || !r.has(12) || r.has(11))
+            return fail("reorder ring put/has");
+        std::uint64_t ts = 0;
+        const auto v = r.take(12, ts);
+        if (v.size() != 4 || ts != 7 || std::memcmp(v.data(), a, 4) != 0 || r.has(12) || r.size() != 0)
+            return fail("reorder ring take");
+    }
+
+    std::vector<std::byte> capture(kMessages * kPayload);
+    for (std::uint64_t s = 1; s <= kMessages; ++s)
+        fill_payload(capture.data() + (s - 1) * kPayload, s);
+    RewindServer server(capture, kPayload, "TEST");
+    std::string err;
+    if (!server.start("127.0.0.1", 0, err))
+        return fail(err);
+    const std::string server_ep = "127.0.0.1:" + std::to_string(server.port());
+
+    // Coalescing: overlapping and adjacent ranges become one wanted range,
+    // which pump() cuts into max_per_request chunks.
+    {
+        RewindOptions ro;
+        ro.server = server_ep;
+        ro.max_per_request = 4;
+        ro.max_outstanding = 100;
+        RewindClient c;
+        if (!c.open(ro, err))
+            return fail(err);
+        c.request({5, 10});
+        c.request({11, 12}); // adjacent
+        c.request({8, 9});   // inside
+        c.request({20, 21}); // separate
+        if (c.stats().coalesced != 2)
+            return fail("expected 2 coalesced ranges, got " + std::to_string(c.stats().coalesced));
+        c.satisfied_below(7); // 7-12 and 20-21 left: 2 + 1 requests
+        c.pump(std::chrono::steady_clock::now());
+        if (c.stats().requests != 3)
+            return fail("expected 3 chunked requests, got " + std::to_string(c.stats().requests));
+        c.satisfied_below(22);
+        if (!c.idle())
+            return fail("client not idle after everything was satisfied");
+
+        // Token bucket: a burst of 2 allows two sends, then pump() waits.
+        ro.burst = 2;
+        ro.requests_per_sec = 1.0;
+        ro.max_per_request = 1;
+        if (!c.open(ro, err))
+            return fail(err);
+        c.request({1, 5});
+        c.pump(std::chrono::steady_clock::now());
+        if (c.stats().requests != 2 || c.stats().rate_limited == 0)
+            return fail("rate limit not applied");
+    }
+
+    // Live feed with dropped packets: everything still arrives, in order,
+    // through a rewinder that also ignores the first request it gets.
+    const std::uint16_t port = static_cast<std::uint16_t>(20000 + (::getpid() + 7) % 20000);
+    const char *group = "239.192.7.8";
+    UdpFeedOptions o;
+    o.wait_ms = 200;
+    o.rewind.server = server_ep;
+    o.rewind.retry_ms = 20;
+    o.reorder_slots = 1024;
+    o.gap_timeout_ms = 2000;
+    MoldUdpMarketDataAdapter rx(o);
+    AdapterConfig cfg;
+    cfg.name = "mold";
+    cfg.kind = FeedKind::itch;
+    cfg.endpoint = std::string(group) + ":" + std::to_string(port);
+    cfg.start_sequence = 1;
+    rx.configure(cfg);
+    rx.connect();
+    if (rx.status().state != SessionState::established)
+        return fail("receiver did not connect: " + rx.status().detail);
+    server.drop_next(1);
+
+    Sender tx(group, port);
+    std::uint64_t dropped = 0;
+    std::thread sender([&]
+                       {
+                           for (std::uint64_t first = 1, p = 0; first <= kMessages; first += kPer, ++p)
+                           {
+                               // Lose every 37th packet and a run of three.
+                               if (p % 37 == 5 || (p >= 150 && p < 153))
+                               {
+                                   dropped += kPer;
+                                   continue;
+                               }
+                               tx.send(capture, first, kPer);
+                               if (p % 16 == 15)
+                                   std::this_thread::sleep_for(std::chrono::microseconds(300));
+                           }
+                           tx.send(capture, kMessages + 1, 0, true); });
+
+    std::uint64_t next = 1;
+    bool saw_recovering = false;
+    MoldMessage m;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while ((rx.status().state == SessionState::established || rx.status().state == SessionState::recovering) &&
+           std::chrono::steady_clock::now() < deadline)
+    {
+        saw_recovering |= rx.status().state == SessionState::recovering;
+        if (!rx.next_message(m))
+            continue;
+        if (m.sequence != next || m.payload.size() != kPayload ||
+            std::memcmp(m.payload.data(), capture.data() + (next - 1) * kPayload, kPayload) != 0)
+        {
+            sender.join();
+            return fail("out of sequence or corrupt at " + std::to_string(m.sequence) + ", expected " +
+                        std::to_string(next));
+        }
+        ++next;
+    }
+    sender.join();
+    const UdpFeedStats &st = rx.stats();
+    const RewindStats &rs = rx.rewind_stats();
+    std::cout << "rewind: gaps=" << st.gaps << " recovered=" << st.recovered << " missing=" << st.missing
+              << " reorder_peak=" << st.reorder_peak << " requests=" << rs.requests << " retries=" << rs.retries
+              << " coalesced=" << rs.coalesced << std::endl;
+    if (next != kMessages + 1 || rx.status().state != SessionState::closed)
+        return fail("delivered " + std::to_string(next - 1) + " of " + std::to_string(kMessages) + ": " +
+                    rx.status().detail);
+    if (!saw_recovering || st.gaps == 0 || st.missing != 0 || st.recovered < dropped || rs.retries == 0)
+        return fail("recovery stats unexpected");
+
+    // With the rewinder unreachable the head gap is given up after
+    // gap_timeout_ms and later messages flow again.
+    server.stop();
+    o.gap_timeout_ms = 100;
+    o.rewind.max_retries = 1;
+    MoldUdpMarketDataAdapter lone(o);
+    lone.configure(cfg);
+    lone.connect();
+    tx.send(capture, 1, 2);
+    tx.send(capture, 5, 2); // 3-4 never arrive
+    tx.send(capture, 7, 0, true);
+    const std::uint64_t expect[] = {1, 2, 5, 6};
+    std::size_t k = 0;
+    while (lone.status().state == SessionState::established || lone.status().state == SessionState::recovering)
+    {
+        if (!lone.next_message(m))
+            continue;
+        if (k >= std::size(expect) || m.sequence != expect[k++])
+            return fail("after give-up: unexpected sequence " + std::to_string(m.sequence));
+    }
+    if (k != std::size(expect) || lone.stats().missing != 2 || lone.status().state != SessionState::closed)
+        return fail("gap was not given up cleanly");
+
+    std::cout << "rewind recovery ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include "bqs/adapters/mold_udp_adapter.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bqs::adapters;
+
+namespace
+{
+    constexpr std::size_t kPayload = 48;
+    constexpr std::uint16_t kPer = 8;
+
+    std::vector<std::byte> payload(std::uint64_t seq)
+    {
+        std::vector<std::byte> p(kPayload);
+        for (std::size_t i = 0; i < kPayload; ++i)
+            p[i] = static_cast<std::byte>(seq * 17 + i);
+        return p;
+    }
+
+    void send_feed(const char *iface, const char *group, std::uint16_t port, std::uint64_t messages)
+    {
+        const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        in_addr ifa{};
+        inet_pton(AF_INET, iface, &ifa);
+        ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &ifa, sizeof(ifa));
+        sockaddr_in dst{};
+        dst.sin_family = AF_INET;
+        dst.sin_port = htons(port);
+        inet_pton(AF_INET, group, &dst.sin_addr);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::byte buf[mold::kMaxPacketBytes];
+        for (std::uint64_t first = 1, p = 0; first <= messages; first += kPer, ++p)
+        {
+            mold::PacketBuilder b({buf, sizeof(buf)}, "TEST", first);
+            for (std::uint16_t k = 0; k < kPer; ++k)
+                b.add(payload(first + k));
+            ::sendto(fd, buf, b.bytes().size(), 0, reinterpret_cast<const sockaddr *>(&dst), sizeof(dst));
+            if (p % 16 == 15)
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+            mold::PacketBuilder b({buf, sizeof(buf)}, "TEST", messages + 1);
+            b.mark_end_of_session();
+            ::sendto(fd, buf, b.bytes().size(), 0, reinterpret_cast<const sockaddr *>(&dst), sizeof(dst));
+        }
+        ::close(fd);
+    }
+
+    // Receives the whole feed; returns an error text or empty.
+    std::string receive_feed(MoldUdpMarketDataAdapter &rx, std::uint64_t messages)
+    {
+        std::uint64_t next = 1;
+        MoldMessage m;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+        while (rx.status().state == SessionState::established && std::chrono::steady_clock::now() < deadline)
+        {
+            if (!rx.next_message(m))
+                continue;
+            const auto want = payload(m.sequence);
+            if (m.sequence != next || m.payload.size() != kPayload ||
+                std::memcmp(m.payload.data(), want.data(), kPayload) != 0)
+                return "bad message at sequence " + std::to_string(m.sequence) + ", expected " + std::to_string(next);
+            ++next;
+        }
+        if (rx.status().state != SessionState::closed)
+            return "feed did not end: " + rx.status().detail;
+        if (next != messages + 1)
+            return "received " + std::to_string(next - 1) + " of " + std::to_string(messages);
+        return {};
+    }
+
+    int fail(const std::string &what)
+    {
+        std::cerr << what << std::endl;
+        return 1;
+    }
+
+    int run(const std::string &cmd) { return std::system((cmd + " >/dev/null 2>&1").c_str()); }
+} // namespace
+
+int main()
+{
+    const std::uint16_t port = static_cast<std::uint16_t>(20000 + (::getpid() + 29) % 20000);
+    AdapterConfig cfg;
+    cfg.name = "xdp";
+    cfg.kind = FeedKind::itch;
+    cfg.endpoint = "239.192.7.21:" + std::to_string(port);
+    cfg.start_sequence = 1;
+
+    // No such interface: AF_XDP is refused, and the adapter says so and
+    // carries on with recvmmsg.
+    {
+        UdpFeedOptions o;
+        o.xdp.ifname = "bqsnone0";
+        MoldUdpMarketDataAdapter rx(o);
+        rx.configure(cfg);
+        rx.connect();
+        if (rx.status().state != SessionState::established || rx.stats().xdp || rx.xdp_error().empty())
+            return fail("fallback connect: " + rx.status().detail + " / " + rx.xdp_error());
+        std::thread tx([&] { send_feed("127.0.0.1", "239.192.7.21", port, 800); });
+        const std::string err = receive_feed(rx, 800);
+        tx.join();
+        if (!err.empty())
+            return fail("fallback: " + err);
+        std::cout << "recvmmsg fallback ok (" << rx.xdp_error() << ")" << std::endl;
+    }
+
+    // The real path needs a veth pair and CAP_NET_ADMIN/CAP_BPF; skip
+    // rather than fail where the sandbox has neither.
+    const std::string a = "bqx" + std::to_string(::getpid() % 100000) + "a";
+    const std::string b = "bqx" + std::to_string(::getpid() % 100000) + "b";
+    const std::string net = "10.213." + std::to_string(::getpid() % 250) + ".";
+    if (run("ip link add " + a + " type veth peer name " + b) != 0)
+    {
+        std::cout << "veth unavailable; AF_XDP path skipped" << std::endl;
+        return 0;
+    }
+    struct Cleanup
+    {
+        std::string dev;
+        ~Cleanup() { run("ip link del " + dev); }
+    } cleanup{a};
+    if (run("ip addr add " + net + "1/24 dev " + a) != 0 || run("ip addr add " + net + "2/24 dev " + b) != 0 ||
+        run("ip link set " + a + " up") != 0 || run("ip link set " + b + " up") != 0)
+        return fail("veth setup failed");
+
+    // A UMEM far smaller than the feed: frames must come back through the
+    // fill ring for it to get through.
+    constexpr std::uint64_t kMessages = 40000;
+    UdpFeedOptions o;
+    o.interface = net + "2";
+    o.batch = 32;
+    o.ring_slots = 64;
+    o.xdp.ifname = b;
+    o.xdp.frames = 256;
+    o.xdp.ring_size = 128;
+    MoldUdpMarketDataAdapter rx(o);
+    rx.configure(cfg);
+    rx.connect();
+    if (rx.status().state != SessionState::established)
+        return fail("xdp connect: " + rx.status().detail);
+    if (!rx.stats().xdp)
+    {
+        std::cout << "AF_XDP unavailable (" << rx.xdp_error() << "); path skipped" << std::endl;
+        return 0;
+    }
+    std::thread tx([&] { send_feed((net + "1").c_str(), "239.192.7.21", port, kMessages); });
+    const std::string err = receive_feed(rx, kMessages);
+    tx.join();
+    if (!err.empty())
+        return fail("xdp: " + err);
+    const UdpFeedStats &st = rx.stats();
+    std::cout << "af_xdp: packets=" << st.packets << " zero_copy=" << st.xdp_zero_copy
+              << " batch_p50=" << st.batch_size.quantile(0.5) << " malformed=" << st.malformed
+              << " foreign=" << st.xdp_foreign << std::endl;
+    if (st.packets < kMessages / kPer || st.packets <= o.xdp.frames)
+        return fail("frames were not recycled");
+    std::cout << "af_xdp receive ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Compresses a capture as a run of independent zstd or LZ4 frames, each
+// recording its decompressed size, so CompressedFileMarketDataAdapter can
+// decode them in parallel. A plain `zstd capture.bin` is one frame and can
+// only be streamed.
+#include "bqs/adapters/codec.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace bqa = bqs::adapters;
+
+namespace
+{
+    struct Options
+    {
+        std::string input;
+        std::string output;
+        bqa::Codec codec{bqa::Codec::zstd};
+        std::size_t frame_bytes{8u << 20};
+        int level{3};
+    };
+
+    void usage()
+    {
+        std::cout << "bqs_capture_pack - compress a capture into independently decodable frames\n\n"
+                  << "  --input <path>        Capture to compress\n"
+                  << "  --output <path>       Compressed file to write\n"
+                  << "  --codec zstd|lz4      Frame format (default zstd)\n"
+                  << "  --frame-mb <n>        Uncompressed bytes per frame, in MiB (default 8)\n"
+                  << "  --level <n>           Compression level (default 3; lz4: 0 fast, 3+ HC)\n";
+    }
+
+    bool parse(int argc, char **argv, Options &o)
+    {
+        bool level_set = false;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string a = argv[i];
+            if (a == "--help" || a == "-h")
+                return false;
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << a << "\n";
+                return false;
+            }
+            const std::string v = argv[++i];
+            if (a == "--input")
+                o.input = v;
+            else if (a == "--output")
+                o.output = v;
+            else if (a == "--codec" && (v == "zstd" || v == "lz4"))
+                o.codec = v == "zstd" ? bqa::Codec::zstd : bqa::Codec::lz4;
+            else if (a == "--frame-mb")
+                o.frame_bytes = std::strtoull(v.c_str(), nullptr, 10) << 20;
+            else if (a == "--level")
+            {
+                o.level = std::atoi(v.c_str());
+                level_set = true;
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << a << " " << v << "\n";
+                return false;
+            }
+        }
+        if (!level_set && o.codec == bqa::Codec::lz4)
+            o.level = 0;
+        if (o.input.empty() || o.output.empty() || o.frame_bytes == 0)
+        {
+            std::cerr << "Need --input, --output and a non-zero --frame-mb\n";
+            return false;
+        }
+        return true;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options o;
+    if (!parse(argc, argv, o))
+    {
+        usage();
+        return 1;
+    }
+    if (!bqa::codec_available(o.codec))
+    {
+        std::cerr << "this build has no " << bqa::codec_name(o.codec) << " support\n";
+        return 1;
+    }
+
+    std::ifstream f(o.input, std::ios::binary);
+    if (!f)
+    {
+        std::cerr << "cannot read " << o.input << "\n";
+        return 1;
+    }
+    std::vector<char> raw((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    const auto in = std::as_bytes(std::span(raw));
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::byte> packed;
+    std::string err;
+    if (!bqa::encode_frames(o.codec, in, o.frame_bytes, o.level, packed, err))
+    {
+        std::cerr << "compress: " << err << "\n";
+        return 1;
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::ofstream out(o.output, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(packed.data()), static_cast<std::streamsize>(packed.size()));
+    if (!out)
+    {
+        std::cerr << "cannot write " << o.output << "\n";
+        return 1;
+    }
+    std::cout << bqa::codec_name(o.codec) << " frames=" << (in.size() + o.frame_bytes - 1) / o.frame_bytes
+              << " in=" << in.size() << " out=" << packed.size()
+              << " ratio=" << (packed.empty() ? 0.0 : double(in.size()) / double(packed.size()))
+              << " secs=" << secs << "\n";
+    return 0;
+}
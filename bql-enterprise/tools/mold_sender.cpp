@@ -0,0 +1,290 @@
+// Loopback MoldUDP64 sender: blasts a capture of fixed-size records to a
+// multicast group so receive throughput, drops and gap handling can be
+// exercised on one box.
+#include "bqs/adapters/moldudp64.hpp"
+#include "bqs/adapters/rewind.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mold = bqs::adapters::mold;
+
+namespace
+{
+    struct Options
+    {
+        std::string input{"data/golden/itch_1m.bin"};
+        std::string group{"239.192.0.1:31001"};
+        std::string iface{"127.0.0.1"};
+        double rate{0.0}; // messages per second; 0 = as fast as possible
+        std::size_t record_bytes{64};
+        std::size_t per_packet{0}; // 0 = as many as fit
+        std::string session{"BQLTEST001"};
+        std::uint64_t start_seq{1};
+        double drop_ppm{0.0};
+        std::uint64_t seed{1};
+        int delay_ms{0};
+        int jitter_us{0};
+        std::size_t batch{32};
+        bool end_of_session{true};
+        int serve_rewind{-1}; // rewinder port; -1 = none
+        int linger_ms{1000};
+    };
+
+    void usage()
+    {
+        std::cout << "bqs_mold_sender - MoldUDP64 multicast test sender\n\n"
+                  << "  --input <path>        Capture of fixed-size records (default data/golden/itch_1m.bin)\n"
+                  << "  --group <addr:port>   Multicast group (default 239.192.0.1:31001)\n"
+                  << "  --iface <addr>        Outgoing interface (default 127.0.0.1)\n"
+                  << "  --rate <msgs/s>       Target message rate (default 0 = unthrottled)\n"
+                  << "  --record-bytes <n>    Message size (default 64)\n"
+                  << "  --per-packet <n>      Messages per packet (default: fill 1472 bytes)\n"
+                  << "  --session <name>      Session id (10 chars)\n"
+                  << "  --start-seq <n>       First sequence number (default 1)\n"
+                  << "  --drop-ppm <x>        Deliberately skip packets (parts per million)\n"
+                  << "  --seed <n>            Seed for --drop-ppm\n"
+                  << "  --delay-ms <n>        Wait before sending (lets receivers join)\n"
+                  << "  --jitter-us <n>       Sleep a random 0..n us before each sendmmsg batch\n"
+                  << "  --batch <n>           Packets per sendmmsg (default 32)\n"
+                  << "  --no-eos              Do not send end-of-session\n"
+                  << "  --serve-rewind <port> Answer gap-fill requests on 127.0.0.1:<port>\n"
+                  << "  --linger-ms <n>       Keep the rewinder up this long after sending (default 1000)\n";
+    }
+
+    bool parse(int argc, char **argv, Options &o)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string a = argv[i];
+            auto val = [&]() -> const char *
+            { return i + 1 < argc ? argv[++i] : nullptr; };
+            const char *v = nullptr;
+            if (a == "--help" || a == "-h")
+                return false;
+            if (a == "--no-eos")
+            {
+                o.end_of_session = false;
+                continue;
+            }
+            if (!(v = val()))
+            {
+                std::cerr << "Missing value for " << a << "\n";
+                return false;
+            }
+            if (a == "--input")
+                o.input = v;
+            else if (a == "--group")
+                o.group = v;
+            else if (a == "--iface")
+                o.iface = v;
+            else if (a == "--rate")
+                o.rate = std::strtod(v, nullptr);
+            else if (a == "--record-bytes")
+                o.record_bytes = std::strtoull(v, nullptr, 10);
+            else if (a == "--per-packet")
+                o.per_packet = std::strtoull(v, nullptr, 10);
+            else if (a == "--session")
+                o.session = v;
+            else if (a == "--start-seq")
+                o.start_seq = std::strtoull(v, nullptr, 10);
+            else if (a == "--drop-ppm")
+                o.drop_ppm = std::strtod(v, nullptr);
+            else if (a == "--seed")
+                o.seed = std::strtoull(v, nullptr, 10);
+            else if (a == "--delay-ms")
+                o.delay_ms = std::atoi(v);
+            else if (a == "--jitter-us")
+                o.jitter_us = std::atoi(v);
+            else if (a == "--batch")
+                o.batch = std::strtoull(v, nullptr, 10);
+            else if (a == "--serve-rewind")
+                o.serve_rewind = std::atoi(v);
+            else if (a == "--linger-ms")
+                o.linger_ms = std::atoi(v);
+            else
+            {
+                std::cerr << "Unknown argument: " << a << "\n";
+                return false;
+            }
+        }
+        const std::size_t fit = (mold::kMaxPacketBytes - mold::kHeaderBytes) / (2 + o.record_bytes);
+        if (o.record_bytes == 0 || fit == 0 || o.rate < 0 || o.drop_ppm < 0 || o.batch == 0 || o.start_seq == 0 ||
+            o.serve_rewind > 65535 || o.linger_ms < 0 || o.jitter_us < 0)
+        {
+            std::cerr << "Invalid option value\n";
+            return false;
+        }
+        if (o.per_packet == 0 || o.per_packet > fit)
+            o.per_packet = fit;
+        return true;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options o;
+    if (!parse(argc, argv, o))
+    {
+        usage();
+        return 1;
+    }
+
+    std::ifstream f(o.input, std::ios::binary);
+    std::vector<std::byte> data;
+    if (f)
+    {
+        std::vector<char> raw((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        data.resize(raw.size());
+        std::memcpy(data.data(), raw.data(), raw.size());
+    }
+    if (!f || data.size() < o.record_bytes)
+    {
+        std::cerr << "could not read " << o.input << "\n";
+        return 2;
+    }
+
+    sockaddr_in dst{};
+    dst.sin_family = AF_INET;
+    const auto colon = o.group.rfind(':');
+    in_addr iface{};
+    if (colon == std::string::npos || inet_pton(AF_INET, o.group.substr(0, colon).c_str(), &dst.sin_addr) != 1 ||
+        inet_pton(AF_INET, o.iface.c_str(), &iface) != 1)
+    {
+        std::cerr << "bad --group or --iface\n";
+        return 1;
+    }
+    dst.sin_port = htons(static_cast<std::uint16_t>(std::atoi(o.group.c_str() + colon + 1)));
+
+    const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    const int loop = 1, ttl = 1, sndbuf = 8 << 20;
+    if (fd < 0 || ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) != 0)
+    {
+        std::cerr << "socket setup failed: " << std::strerror(errno) << "\n";
+        return 2;
+    }
+    ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+    // Serves the whole capture, including the packets --drop-ppm skips.
+    const std::size_t records = data.size() / o.record_bytes;
+    bqs::adapters::RewindServer rewinder({data.data(), records * o.record_bytes}, o.record_bytes, o.session,
+                                         o.start_seq);
+    if (o.serve_rewind >= 0)
+    {
+        std::string err;
+        if (!rewinder.start("127.0.0.1", static_cast<std::uint16_t>(o.serve_rewind), err))
+        {
+            std::cerr << err << "\n";
+            return 2;
+        }
+        std::cerr << "rewinder on 127.0.0.1:" << rewinder.port() << "\n";
+    }
+    if (o.delay_ms > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(o.delay_ms));
+
+    std::vector<std::byte> pkts(o.batch * mold::kMaxPacketBytes);
+    std::vector<iovec> iov(o.batch);
+    std::vector<mmsghdr> msgs(o.batch);
+    std::mt19937_64 rng(o.seed);
+    std::uniform_real_distribution<double> u(0.0, 1e6);
+    std::uniform_int_distribution<int> jitter(0, o.jitter_us);
+
+    std::uint64_t sent_pkts = 0, dropped_pkts = 0;
+    std::size_t next = 0;
+    auto flush = [&](std::size_t n)
+    {
+        std::size_t off = 0;
+        while (off < n)
+        {
+            const int k = ::sendmmsg(fd, msgs.data() + off, static_cast<unsigned>(n - off), 0);
+            if (k < 0)
+            {
+                if (errno == EINTR || errno == ENOBUFS || errno == EAGAIN)
+                    continue;
+                return false;
+            }
+            off += static_cast<std::size_t>(k);
+        }
+        sent_pkts += n;
+        return true;
+    };
+
+    const auto t0 = std::chrono::steady_clock::now();
+    while (next < records)
+    {
+        std::size_t n = 0;
+        while (n < o.batch && next < records)
+        {
+            std::span<std::byte> buf{pkts.data() + n * mold::kMaxPacketBytes, mold::kMaxPacketBytes};
+            mold::PacketBuilder b(buf, o.session, o.start_seq + next);
+            while (b.count() < o.per_packet && next < records)
+            {
+                b.add({data.data() + next * o.record_bytes, o.record_bytes});
+                ++next;
+            }
+            if (o.drop_ppm > 0 && u(rng) < o.drop_ppm)
+            {
+                ++dropped_pkts;
+                continue;
+            }
+            iov[n] = iovec{buf.data(), b.bytes().size()};
+            msgs[n].msg_hdr = msghdr{};
+            msgs[n].msg_hdr.msg_name = &dst;
+            msgs[n].msg_hdr.msg_namelen = sizeof(dst);
+            msgs[n].msg_hdr.msg_iov = &iov[n];
+            msgs[n].msg_hdr.msg_iovlen = 1;
+            ++n;
+        }
+        if (o.rate > 0)
+        {
+            const auto due = t0 + std::chrono::duration<double>(static_cast<double>(next) / o.rate);
+            std::this_thread::sleep_until(std::chrono::time_point_cast<std::chrono::steady_clock::duration>(due));
+        }
+        if (o.jitter_us > 0)
+            std::this_thread::sleep_for(std::chrono::microseconds(jitter(rng)));
+        if (!flush(n))
+        {
+            std::cerr << "sendmmsg failed: " << std::strerror(errno) << "\n";
+            return 2;
+        }
+    }
+
+    if (o.end_of_session)
+    {
+        // Repeated, as the spec recommends, since any one copy may be lost.
+        for (int k = 0; k < 3; ++k)
+        {
+            std::span<std::byte> buf{pkts.data(), mold::kMaxPacketBytes};
+            mold::PacketBuilder b(buf, o.session, o.start_seq + records);
+            b.mark_end_of_session();
+            ::sendto(fd, buf.data(), b.bytes().size(), 0, reinterpret_cast<const sockaddr *>(&dst), sizeof(dst));
+        }
+    }
+    const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cerr << "sent messages=" << records << " packets=" << sent_pkts << " skipped_packets=" << dropped_pkts
+              << " elapsed_s=" << s << " msgs_per_s=" << static_cast<double>(records) / s << "\n";
+    if (o.serve_rewind >= 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(o.linger_ms));
+        std::cerr << "rewind requests=" << rewinder.requests() << "\n";
+    }
+    ::close(fd);
+    return 0;
+}
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+#include "breaker.hpp"
+#include "detectors.hpp"
+#include "order_book.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace lob
+{
+    // Binary book snapshot ("BQLSNAP", version 1).
+    //
+    // Layout: SnapshotHeader, SnapshotSection[section_count], then section
+    // payloads. Everything is little-endian and every payload starts on a
+    // 64-byte boundary, so a mapped file is used in place with no parsing.
+    // Each book contributes a Bids, Asks and Orders section. Levels are
+    // stored best-first; a level's orders are the contiguous run
+    // [first_order, first_order + count) of its book's Orders section, in
+    // queue (time priority) order. Checkpoints add one Engine section with
+    // the replay position and detector/breaker state; plain book snapshots
+    // omit it and readers ignore section kinds they do not know.
+    inline constexpr char kSnapshotMagic[8] = {'B', 'Q', 'L', 'S', 'N', 'A', 'P', '\0'};
+    inline constexpr uint32_t kSnapshotVersion = 1;
+    inline constexpr size_t kSnapshotAlign = 64;
+
+    enum class SectionKind : uint32_t
+    {
+        Bids = 1,
+        Asks = 2,
+        Orders = 3,
+        Engine = 4
+    };
+
+    struct SnapshotHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_bytes;
+        uint32_t section_count;
+        uint32_t book_count;
+        uint64_t msg_index;   // events applied before the snapshot was taken
+        uint64_t file_bytes;
+        uint64_t payload_fnv; // FNV-1a over everything after the section table
+        uint8_t reserved[16];
+    };
+    static_assert(sizeof(SnapshotHeader) == 64);
+
+    struct SnapshotSection
+    {
+        uint32_t kind;
+        uint32_t book;
+        uint64_t offset;
+        uint64_t count;
+        uint64_t bytes;
+    };
+    static_assert(sizeof(SnapshotSection) == 32);
+
+    struct SnapshotLevel
+    {
+        int64_t px;
+        uint64_t qty;
+        uint32_t count;
+        uint32_t first_order;
+    };
+    static_assert(sizeof(SnapshotLevel) == 24);
+
+    struct SnapshotOrder
+    {
+        uint64_t id;
+        int64_t px;
+        uint32_t qty;
+        uint8_t side;
+        uint8_t pad[3];
+    };
+    static_assert(sizeof(SnapshotOrder) == 24);
+
+    struct SnapshotEngine
+    {
+        uint64_t input_offset; // byte offset of the next unread event
+        uint64_t input_bytes;  // size of the capture the checkpoint was cut from
+        uint64_t input_fnv;    // running FNV-1a state over [0, input_offset)
+        DetectorState detectors;
+        uint8_t breaker;
+        uint8_t latched;
+        uint8_t pad[6];
+    };
+    static_assert(sizeof(SnapshotEngine) == 112);
+
+    // Serializes books (book i = symbol i) into a snapshot image.
+    // Pass engine to produce a resumable checkpoint. write_snapshot writes to
+    // a temporary file and renames it, so readers never see a partial file.
+    std::vector<uint8_t> encode_snapshot(std::span<const OrderBook> books, uint64_t msg_index,
+                                         const SnapshotEngine *engine = nullptr);
+    bool write_snapshot(const std::string &path, std::span<const OrderBook> books, uint64_t msg_index,
+                        const SnapshotEngine *engine = nullptr);
+
+    // Read-only mmap of a snapshot file. open() validates the header and
+    // section bounds only; payload bytes are not touched until accessed.
+    class SnapshotView
+    {
+    public:
+        SnapshotView() = default;
+        ~SnapshotView();
+        SnapshotView(const SnapshotView &) = delete;
+        SnapshotView &operator=(const SnapshotView &) = delete;
+        SnapshotView(SnapshotView &&o) noexcept;
+        SnapshotView &operator=(SnapshotView &&o) noexcept;
+
+        bool open(const std::string &path, std::string &err);
+        void close();
+        // Recomputes payload_fnv; optional because it touches every page.
+        bool verify() const;
+
+        const SnapshotHeader &header() const { return *reinterpret_cast<const SnapshotHeader *>(base_); }
+        uint32_t book_count() const { return header().book_count; }
+        std::span<const SnapshotLevel> bids(uint32_t book) const;
+        std::span<const SnapshotLevel> asks(uint32_t book) const;
+        std::span<const SnapshotOrder> orders(uint32_t book) const;
+        // Null for plain book snapshots.
+        const SnapshotEngine *engine() const;
+
+    private:
+        const SnapshotSection *find(SectionKind kind, uint32_t book) const;
+
+        const uint8_t *base_{nullptr};
+        size_t size_{0};
+    };
+
+    // Rebuilds live books from a mapped snapshot. books.size() must equal
+    // view.book_count(); existing book contents are discarded. The view is
+    // read in place, but each order is re-added through OrderBook::add, so
+    // restoring costs O(orders) index and level inserts.
+    bool restore_snapshot(const SnapshotView &view, std::span<OrderBook> books);
+} // namespace lob
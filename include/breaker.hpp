@@ -31,7 +31,10 @@ public:
   explicit Breaker(const BreakerThresholds &t);
   BreakerState state() const;
   bool publish_allowed() const;
+  bool latched() const;
   void clear_latch();
+  // Reinstates a checkpointed state (including the latch) verbatim.
+  void restore(BreakerState s, bool latched);
   BreakerState step(const DetectorReadings &r);
   static std::string to_string(BreakerState s);
 
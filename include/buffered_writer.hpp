@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lob
+{
+    // Append-only file writer with a large user-space buffer. Producers encode
+    // straight into the buffer via reserve()/commit(), and the buffer is
+    // drained with plain write(2) calls of several MiB, which keeps the
+    // syscall rate negligible at hundreds of MB/s.
+    class BufferedWriter
+    {
+    public:
+        static constexpr size_t kDefaultBuffer = 8u << 20;
+
+        explicit BufferedWriter(size_t buffer_bytes = kDefaultBuffer) : buf_(buffer_bytes) {}
+        ~BufferedWriter() { close(); }
+        BufferedWriter(const BufferedWriter &) = delete;
+        BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+        bool open(const std::string &path);
+        bool is_open() const { return fd_ >= 0; }
+        // Flushes and closes; returns false if any write failed.
+        bool close();
+        bool flush();
+
+        // Returns space for at least n bytes, flushing first if needed, or
+        // nullptr when the flush fails or n exceeds the buffer size. Call
+        // commit() with the bytes actually used.
+        uint8_t *reserve(size_t n)
+        {
+            if (n > buf_.size() || (buf_.size() - used_ < n && !flush()))
+                return nullptr;
+            return buf_.data() + used_;
+        }
+        void commit(size_t n) { used_ += n; }
+        bool write(const void *p, size_t n);
+
+        uint64_t bytes_written() const { return total_ + used_; }
+        bool ok() const { return ok_; }
+
+    private:
+        std::vector<uint8_t> buf_;
+        size_t used_{0};
+        uint64_t total_{0};
+        int fd_{-1};
+        bool ok_{true};
+    };
+} // namespace lob
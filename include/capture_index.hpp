@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace lob
+{
+    // Capture seek index ("BQLIDX", version 1), written next to a capture
+    // (<capture>.idx) by build_index so replay can seek by time and symbol
+    // instead of reading the whole file.
+    //
+    // Layout: IndexHeader, IndexSymbol[symbol_count], IndexSample[sample_count],
+    // then one posting list per symbol: the ascending uint32 event indices of
+    // that symbol's events, at IndexSymbol::postings_offset. Little-endian,
+    // every table 64-byte aligned; a mapped file is used in place. A sample
+    // is taken every `stride` events and records that event's byte offset and
+    // timestamp. Capture timestamps are non-decreasing, so samples bracket any
+    // time to within one stride.
+    inline constexpr char kIndexMagic[8] = {'B', 'Q', 'L', 'I', 'D', 'X', '\0', '\0'};
+    inline constexpr uint32_t kIndexVersion = 1;
+    inline constexpr uint32_t kDefaultIndexStride = 1024;
+
+    struct IndexHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_bytes;
+        uint32_t event_bytes;
+        uint32_t stride;
+        uint32_t symbol_count;
+        uint32_t reserved;
+        uint64_t event_count;
+        uint64_t capture_bytes;
+        uint64_t capture_fnv; // FNV-1a over the first and last 4 KiB of the capture
+        uint64_t file_bytes;
+    };
+    static_assert(sizeof(IndexHeader) == 64);
+
+    struct IndexSymbol
+    {
+        uint64_t first_offset; // byte offset of the symbol's first event (if count)
+        uint64_t last_offset;
+        uint64_t count;
+        uint64_t postings_offset;
+    };
+    static_assert(sizeof(IndexSymbol) == 32);
+
+    struct IndexSample
+    {
+        uint64_t offset;
+        uint64_t ts_ns;
+    };
+    static_assert(sizeof(IndexSample) == 16);
+
+    // Cheap identity check of a capture against an index: its size and the
+    // hash of its first and last 4 KiB.
+    uint64_t capture_fingerprint(std::span<const uint8_t> capture);
+
+    // Scans a capture of fixed-size events once and builds its index image.
+    // Fails (empty, err set) past 2^32 events or on a trailing partial event.
+    std::vector<uint8_t> build_capture_index(std::span<const uint8_t> capture, uint32_t stride, std::string &err);
+    // Writes via a temporary file and rename, like write_snapshot.
+    bool write_capture_index(const std::string &path, std::span<const uint8_t> image);
+
+    // Read-only mmap of an index file. open() validates the header and table
+    // bounds; matches() ties it to a capture.
+    class CaptureIndexView
+    {
+    public:
+        CaptureIndexView() = default;
+        ~CaptureIndexView();
+        CaptureIndexView(const CaptureIndexView &) = delete;
+        CaptureIndexView &operator=(const CaptureIndexView &) = delete;
+
+        bool open(const std::string &path, std::string &err);
+        void close();
+        bool matches(std::span<const uint8_t> capture) const;
+
+        const IndexHeader &header() const { return *reinterpret_cast<const IndexHeader *>(base_); }
+        std::span<const IndexSymbol> symbols() const;
+        std::span<const IndexSample> samples() const;
+        std::span<const uint32_t> postings(uint32_t symbol) const;
+
+        // Index of the first event with ts_ns >= t (event_count if none):
+        // a binary search over the samples, then at most one stride of
+        // events decoded from the capture.
+        uint64_t seek_time(std::span<const uint8_t> capture, uint64_t t) const;
+
+    private:
+        const uint8_t *base_{nullptr};
+        size_t size_{0};
+    };
+} // namespace lob
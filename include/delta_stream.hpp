@@ -0,0 +1,217 @@
+#pragma once
+// SPDX-License-Identifier: Apache-2.0
+
+#include "buffered_writer.hpp"
+#include "order_book.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace lob
+{
+
+    // Book delta stream ("BQLDELT", version 1).
+    //
+    // A 32-byte DeltaStreamHeader followed by one record per message that
+    // changed at least one level:
+    //   varint  msg_index - previous record's msg_index (first: - base_index)
+    //   varint  ts_ns - previous record's ts_ns (first: - base_ts_ns)
+    //   varint  change count
+    //   per change:
+    //     varint  (symbol << 1) | side
+    //     zigzag  px - previous px emitted for this symbol/side
+    //     zigzag  signed qty change at the level
+    //     varint  resting order count after the change (0 = level removed)
+    // Consumers keep a price->qty map per symbol/side and apply qty changes.
+    inline constexpr char kDeltaMagic[8] = {'B', 'Q', 'L', 'D', 'E', 'L', 'T', '\0'};
+    inline constexpr uint32_t kDeltaVersion = 1;
+
+    struct DeltaStreamHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t symbols;
+        uint64_t base_index;
+        uint64_t base_ts_ns;
+    };
+    static_assert(sizeof(DeltaStreamHeader) == 32);
+
+    inline uint64_t zigzag(int64_t v) noexcept
+    {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+    inline int64_t unzigzag(uint64_t v) noexcept
+    {
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+
+    inline uint8_t *put_varint(uint8_t *p, uint64_t v) noexcept
+    {
+        while (v >= 0x80)
+        {
+            *p++ = static_cast<uint8_t>(v) | 0x80;
+            v >>= 7;
+        }
+        *p++ = static_cast<uint8_t>(v);
+        return p;
+    }
+
+    // Returns nullptr on truncated or overlong input.
+    inline const uint8_t *get_varint(const uint8_t *p, const uint8_t *end, uint64_t &v) noexcept
+    {
+        v = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7)
+        {
+            const uint8_t b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return p;
+        }
+        return nullptr;
+    }
+
+    class DeltaEncoder
+    {
+    public:
+        static constexpr size_t kMaxChangeBytes = 4 * 10;
+        static constexpr size_t kMaxHeaderBytes = 3 * 10;
+
+        explicit DeltaEncoder(BufferedWriter &out) : out_(out) {}
+
+        bool begin(uint32_t symbols, uint64_t base_index, uint64_t base_ts_ns)
+        {
+            DeltaStreamHeader h{};
+            std::memcpy(h.magic, kDeltaMagic, sizeof(h.magic));
+            h.version = kDeltaVersion;
+            h.symbols = symbols;
+            h.base_index = base_index;
+            h.base_ts_ns = base_ts_ns;
+            last_index_ = base_index;
+            last_ts_ = base_ts_ns;
+            last_px_.assign(size_t(symbols) * 2, 0);
+            return out_.write(&h, sizeof(h));
+        }
+
+        // Encodes one message's level changes for one symbol straight into
+        // the writer's buffer.
+        bool on_message(uint64_t msg_index, uint64_t ts_ns, uint16_t symbol, const std::vector<LevelDelta> &ds)
+        {
+            if (ds.empty())
+                return true;
+            uint8_t *const start = out_.reserve(kMaxHeaderBytes + ds.size() * kMaxChangeBytes);
+            if (!start)
+                return false;
+            uint8_t *p = start;
+            p = put_varint(p, msg_index - last_index_);
+            p = put_varint(p, ts_ns - last_ts_);
+            p = put_varint(p, ds.size());
+            for (const auto &d : ds)
+            {
+                const size_t key = size_t(symbol) * 2 + static_cast<size_t>(d.side);
+                p = put_varint(p, (uint64_t(symbol) << 1) | static_cast<uint64_t>(d.side));
+                p = put_varint(p, zigzag(d.px - last_px_[key]));
+                p = put_varint(p, zigzag(d.qty_change));
+                p = put_varint(p, d.count);
+                last_px_[key] = d.px;
+            }
+            out_.commit(static_cast<size_t>(p - start));
+            last_index_ = msg_index;
+            last_ts_ = ts_ns;
+            ++records_;
+            return true;
+        }
+
+        uint64_t records() const { return records_; }
+
+    private:
+        BufferedWriter &out_;
+        uint64_t last_index_{0};
+        uint64_t last_ts_{0};
+        std::vector<int64_t> last_px_;
+        uint64_t records_{0};
+    };
+
+    // Decoded form of one level change, for consumers and tests.
+    struct DecodedDelta
+    {
+        uint64_t msg_index;
+        uint64_t ts_ns;
+        uint16_t symbol;
+        Side side;
+        int64_t px;
+        int64_t qty_change;
+        uint32_t count;
+    };
+
+    // Walks an in-memory delta stream. next() yields one level change at a
+    // time and returns false at the end of the stream or on malformed input
+    // (check error()).
+    class DeltaDecoder
+    {
+    public:
+        bool open(const uint8_t *data, size_t n)
+        {
+            if (n < sizeof(DeltaStreamHeader))
+                return false;
+            std::memcpy(&hdr_, data, sizeof(hdr_));
+            if (std::memcmp(hdr_.magic, kDeltaMagic, sizeof(hdr_.magic)) != 0 || hdr_.version != kDeltaVersion)
+                return false;
+            p_ = data + sizeof(hdr_);
+            end_ = data + n;
+            index_ = hdr_.base_index;
+            ts_ = hdr_.base_ts_ns;
+            last_px_.assign(size_t(hdr_.symbols) * 2, 0);
+            return true;
+        }
+
+        bool next(DecodedDelta &out)
+        {
+            if (pending_ == 0)
+            {
+                if (p_ == end_)
+                    return false;
+                uint64_t di = 0, dt = 0;
+                if (!(p_ = get_varint(p_, end_, di)) || !(p_ = get_varint(p_, end_, dt)) ||
+                    !(p_ = get_varint(p_, end_, pending_)) || pending_ == 0)
+                    return fail();
+                index_ += di;
+                ts_ += dt;
+            }
+            uint64_t key = 0, px = 0, dq = 0, count = 0;
+            if (!(p_ = get_varint(p_, end_, key)) || !(p_ = get_varint(p_, end_, px)) ||
+                !(p_ = get_varint(p_, end_, dq)) || !(p_ = get_varint(p_, end_, count)) ||
+                key >= last_px_.size())
+                return fail();
+            int64_t &last = last_px_[key];
+            last += unzigzag(px);
+            out = DecodedDelta{index_, ts_, static_cast<uint16_t>(key >> 1), static_cast<Side>(key & 1),
+                               last, unzigzag(dq), static_cast<uint32_t>(count)};
+            --pending_;
+            return true;
+        }
+
+        const DeltaStreamHeader &header() const { return hdr_; }
+        bool error() const { return error_; }
+
+    private:
+        bool fail()
+        {
+            error_ = true;
+            p_ = end_;
+            pending_ = 0;
+            return false;
+        }
+
+        DeltaStreamHeader hdr_{};
+        const uint8_t *p_{nullptr};
+        const uint8_t *end_{nullptr};
+        uint64_t index_{0};
+        uint64_t ts_{0};
+        uint64_t pending_{0};
+        std::vector<int64_t> last_px_;
+        bool error_{false};
+    };
+
+} // namespace lob
@@ -3,6 +3,14 @@
 #include "breaker.hpp"
 #include <cstdint>
 namespace lob {
+// Plain copy of the detector accumulators, used by checkpoints.
+struct DetectorState {
+  double a{0.2};
+  uint64_t total{0}, gaps{0}, corrupt{0};
+  double burst_ms{0.0}, skew_ppm{0.0};
+  double s_gap{0.0}, s_corr{0.0}, s_skew{0.0}, s_burst{0.0};
+};
+
 class Detectors {
 public:
   explicit Detectors(double a = 0.2) : a_(a) {}
@@ -30,6 +38,23 @@ public:
         a_ * rs + (1 - a_) * s_skew_, a_ * rb + (1 - a_) * s_burst_};
   }
 
+  DetectorState state() const {
+    return DetectorState{a_,        total_, gaps_,  corrupt_, burst_ms_,
+                         skew_ppm_, s_gap_, s_corr_, s_skew_, s_burst_};
+  }
+  void restore(const DetectorState &s) {
+    a_ = s.a;
+    total_ = s.total;
+    gaps_ = s.gaps;
+    corrupt_ = s.corrupt;
+    burst_ms_ = s.burst_ms;
+    skew_ppm_ = s.skew_ppm;
+    s_gap_ = s.s_gap;
+    s_corr_ = s.s_corr;
+    s_skew_ = s.s_skew;
+    s_burst_ = s.s_burst;
+  }
+
 private:
   double a_;
   uint64_t total_{0}, gaps_{0}, corrupt_{0};
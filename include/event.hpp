@@ -0,0 +1,95 @@
+#pragma once
+// SPDX-License-Identifier: Apache-2.0
+
+#include "order_book.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace lob
+{
+
+    // Capture framing: the replay harness consumes fixed 64-byte events
+    // (one cache line each), which is also what gen_synth writes.
+    inline constexpr size_t kEventSize = 64;
+
+    // Decode parameters for the synthetic ITCH-like event layout. Every byte
+    // pattern decodes to a valid message, so random fixtures drive a live book.
+    inline constexpr uint32_t kSymbolCount = 8;
+    inline constexpr uint64_t kOrderRefSpace = 1ull << 16;
+    inline constexpr int64_t kBasePriceTicks = 100'000;
+
+    enum class MsgType : uint8_t
+    {
+        Add = 0,
+        Execute = 1,
+        Cancel = 2,
+        Delete = 3
+    };
+
+    struct Event
+    {
+        uint64_t ts_ns{0};
+        uint64_t ref{0};
+        int64_t px{0};
+        uint32_t qty{0};
+        uint16_t symbol{0};
+        MsgType type{MsgType::Add};
+        Side side{Side::Bid};
+    };
+
+    inline uint64_t load_le64(const uint8_t *p) noexcept
+    {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::big)
+            v = __builtin_bswap64(v);
+        return v;
+    }
+
+    // Event layout (little-endian 64-bit words):
+    //   w0[1:0]  message type      w0[2]   side
+    //   w1       order reference (mod kOrderRefSpace); symbol = ref % kSymbolCount
+    //   w2[7:0]  price offset in ticks from kBasePriceTicks (bids below, asks at/above)
+    //   w2[63:8] sub-microsecond timestamp jitter
+    //   w3       quantity (1..1000)
+    // Timestamps advance 1 µs per event so they are monotonic and derivable
+    // from the event index alone, which keeps seeks stateless.
+    inline Event decode_event(const uint8_t *p, uint64_t index) noexcept
+    {
+        const uint64_t w0 = load_le64(p);
+        const uint64_t w1 = load_le64(p + 8);
+        const uint64_t w2 = load_le64(p + 16);
+        const uint64_t w3 = load_le64(p + 24);
+        Event e;
+        e.type = static_cast<MsgType>(w0 & 0x3u);
+        e.side = static_cast<Side>((w0 >> 2) & 0x1u);
+        e.ref = w1 & (kOrderRefSpace - 1);
+        e.symbol = static_cast<uint16_t>(e.ref % kSymbolCount);
+        const int64_t off = static_cast<int64_t>(w2 & 0xFFu);
+        e.px = e.side == Side::Bid ? kBasePriceTicks - 1 - off : kBasePriceTicks + off;
+        e.qty = static_cast<uint32_t>(1 + w3 % 1000);
+        e.ts_ns = index * 1000 + (w2 >> 8) % 1000;
+        return e;
+    }
+
+    // Applies one decoded event to its book. Returns false when the event
+    // references an order that is not resting (or re-adds a live id).
+    inline bool apply_event(OrderBook &book, const Event &e)
+    {
+        switch (e.type)
+        {
+        case MsgType::Add:
+            return book.add(e.ref, e.side, e.px, e.qty);
+        case MsgType::Execute:
+        case MsgType::Cancel:
+            return book.reduce(e.ref, e.qty);
+        case MsgType::Delete:
+            return book.erase(e.ref);
+        }
+        return false;
+    }
+
+} // namespace lob
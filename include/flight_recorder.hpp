@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+#include "breaker.hpp"
+#include "event.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lob
+{
+    // Flight recorder: an always-on ring of the last N decoded messages,
+    // each with the detector readings and breaker state it produced, so a
+    // breaker trip can be explained after the fact.
+    //
+    // The ring has a single writer (the replay thread) and is overwritten
+    // oldest-first; a record is one 64-byte line of plain stores and nothing
+    // is ever locked or allocated. Dumps are taken from a fork()ed copy
+    // (ForkSnapshotter), which freezes the ring at a message boundary, so
+    // no reader ever races the writer.
+    //
+    // Dump file ("BQLFLT", version 1): FlightHeader, then `count` records
+    // oldest first. Little-endian.
+    inline constexpr char kFlightMagic[8] = {'B', 'Q', 'L', 'F', 'L', 'T', '\0', '\0'};
+    inline constexpr uint32_t kFlightVersion = 1;
+    inline constexpr size_t kDefaultFlightRecords = 4096;
+
+    enum class FlightTrigger : uint32_t
+    {
+        escalation = 1, // breaker entered Feeder or worse
+        signal = 2,     // SIGUSR1
+    };
+
+    struct alignas(64) FlightRecord
+    {
+        uint64_t msg_index;
+        uint64_t ts_ns;
+        uint64_t ref;
+        int64_t px; // 0 for types that carry no price
+        uint32_t qty;
+        uint16_t symbol;
+        uint8_t type;
+        uint8_t side;
+        uint8_t breaker; // BreakerState after this message
+        uint8_t applied; // 1 when the book accepted it
+        uint16_t reserved;
+        float gap_ppm, corrupt_ppm, skew_ppm, burst_ms; // readings the breaker stepped on
+        uint32_t reserved2;
+    };
+    static_assert(sizeof(FlightRecord) == 64);
+
+    struct FlightHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_bytes;
+        uint32_t capacity;
+        uint32_t count;
+        uint32_t trigger; // FlightTrigger
+        uint8_t from;     // breaker state before the triggering message
+        uint8_t to;       // and after it
+        uint16_t reserved;
+        uint64_t trigger_msg; // msg_index of the newest record
+        uint64_t recorded;    // records ever written; recorded - count were overwritten
+        uint64_t reserved2[2];
+    };
+    static_assert(sizeof(FlightHeader) == 64);
+
+    class FlightRecorder
+    {
+    public:
+        // capacity is rounded up to a power of two; 0 disables recording.
+        explicit FlightRecorder(size_t capacity = kDefaultFlightRecords)
+            : ring_(capacity ? std::bit_ceil(capacity) : 0), mask_(ring_.empty() ? 0 : ring_.size() - 1)
+        {
+        }
+
+        bool enabled() const noexcept { return !ring_.empty(); }
+        size_t capacity() const noexcept { return ring_.size(); }
+        size_t size() const noexcept { return static_cast<size_t>(std::min<uint64_t>(head_, ring_.size())); }
+        uint64_t recorded() const noexcept { return head_; }
+
+        // Only when enabled().
+        void record(uint64_t msg_index, const Event &e, bool applied, const DetectorReadings &r,
+                    BreakerState s) noexcept
+        {
+            FlightRecord &f = ring_[head_++ & mask_];
+            f.msg_index = msg_index;
+            f.ts_ns = e.ts_ns;
+            f.ref = e.ref;
+            f.px = e.px;
+            f.qty = e.qty;
+            f.symbol = e.symbol;
+            f.type = static_cast<uint8_t>(e.type);
+            f.side = static_cast<uint8_t>(e.side);
+            f.breaker = static_cast<uint8_t>(s);
+            f.applied = applied ? 1 : 0;
+            f.gap_ppm = static_cast<float>(r.gap_rate);
+            f.corrupt_ppm = static_cast<float>(r.corrupt_rate);
+            f.skew_ppm = static_cast<float>(r.skew_ppm);
+            f.burst_ms = static_cast<float>(r.burst_ms);
+        }
+
+        // i-th oldest record still in the ring (i < size()).
+        const FlightRecord &at(size_t i) const noexcept { return ring_[(head_ - size() + i) & mask_]; }
+
+        // Writes the ring oldest first via a temporary file and rename.
+        bool write(const std::string &path, FlightTrigger trigger, BreakerState from, BreakerState to,
+                   std::string &err) const;
+
+    private:
+        std::vector<FlightRecord> ring_;
+        size_t mask_;
+        uint64_t head_{0};
+    };
+
+    // SIGUSR1 (or sig) sets a flag that take_flight_request() consumes, so
+    // the replay loop can poll it once per message with a single load.
+    bool install_flight_signal(int sig, std::string &err);
+    bool take_flight_request() noexcept;
+} // namespace lob
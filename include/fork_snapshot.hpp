@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <sys/types.h>
+#include <vector>
+
+namespace lob
+{
+    // Parent-side cost of forked snapshots: fork() wall time (page-table
+    // copy, grows with resident size) and the minor faults the parent takes
+    // while children are alive.
+    //
+    // The fault counts are RUSAGE_SELF minor faults, not copy-on-write
+    // breaks alone: they also include whatever ordinary faults the process
+    // takes in the window (pool growth, first touches). A window opens at
+    // the fork and closes when the child is reaped, so callers should
+    // reap(false) regularly while children are in flight; cow_faults_total
+    // counts time with several children alive once, cow_faults_max is the
+    // largest single child's window. Compare against a run without dumps to
+    // isolate the copy-on-write share.
+    struct ForkStats
+    {
+        uint64_t forked{0};
+        uint64_t inline_runs{0}; // jobs run in the parent because fork() failed
+        uint64_t failed{0};
+        uint64_t fork_ns_total{0};
+        uint64_t fork_ns_max{0};
+        uint64_t cow_faults_total{0};
+        uint64_t cow_faults_max{0};
+
+        uint64_t jobs() const { return forked + inline_runs; }
+        // Mean over forks that succeeded; inline runs paid no fork.
+        double fork_ms_mean() const { return forked ? double(fork_ns_total) / double(forked) / 1e6 : 0.0; }
+    };
+
+    // Runs state dumps in a fork()ed child so the replay thread only pays for
+    // the fork itself: the child sees a copy-on-write image of the engine
+    // frozen at the message boundary and serializes it while the parent keeps
+    // processing. Children exit with _exit() so parent stdio buffers are
+    // never flushed twice.
+    //
+    // Only the forking thread exists in the child. If the process has other
+    // threads (compressed-input decode workers, the rewinder), any lock one
+    // of them held at fork() stays held in the child forever. glibc re-arms
+    // malloc's own locks across fork(), so jobs may allocate there, but a job
+    // must not touch anything those threads lock (their queues, shared
+    // streams) and must not rely on another allocator being fork-safe.
+    class ForkSnapshotter
+    {
+    public:
+        explicit ForkSnapshotter(size_t max_in_flight = 2) : max_in_flight_(max_in_flight) {}
+        ~ForkSnapshotter() { reap(true); }
+        ForkSnapshotter(const ForkSnapshotter &) = delete;
+        ForkSnapshotter &operator=(const ForkSnapshotter &) = delete;
+
+        // Forks and runs job in the child. When max_in_flight children are
+        // still writing, blocks on the oldest first. If fork() fails the job
+        // runs inline. Returns false if the job could not be started or, for
+        // inline runs, failed.
+        bool spawn(const std::function<bool()> &job);
+
+        // Collects this instance's finished children; with wait_all, blocks
+        // until none remain. Without children it returns immediately.
+        void reap(bool wait_all);
+
+        size_t in_flight() const { return children_.size(); }
+        uint64_t completed() const { return stats_.jobs() - stats_.failed; }
+        uint64_t failed() const { return stats_.failed; }
+        const ForkStats &stats() const { return stats_; }
+
+    private:
+        struct Child
+        {
+            pid_t pid;
+            uint64_t minflt_at_fork;
+        };
+        void collect(pid_t pid, int status);
+        void erase(std::vector<Child>::iterator it);
+
+        size_t max_in_flight_;
+        std::vector<Child> children_;
+        uint64_t window_minflt_{0}; // minor faults when the first live child was forked
+        ForkStats stats_;
+    };
+} // namespace lob
@@ -0,0 +1,283 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#endif
+
+// Huge-page backed storage for the large, randomly accessed arrays of a
+// replay: the input buffer, the order pools and level arrays of each book,
+// and the latency sample vector. With 4 KiB pages a multi-GB working set
+// needs far more dTLB entries than the core has, so nearly every random
+// access also walks the page table.
+//
+// Allocations of at least kHugePageSize try, in order, an explicit
+// MAP_HUGETLB mapping with 1 GiB pages (allocations of 1 GiB or more),
+// then 2 MiB pages (both need a reserved pool, vm.nr_hugepages or
+// hugepages-1048576kB/nr_hugepages), then a 2 MiB aligned anonymous
+// mapping advised MADV_HUGEPAGE for transparent huge pages. Smaller
+// allocations, and every allocation under HugePagePolicy::off, go to
+// operator new exactly as std::allocator would.
+//
+// With set_huge_page_node(n) every mapping is also mbind()-ed to prefer
+// node n before its first touch, so the pages land next to the core that
+// replays them wherever the allocating thread happens to run. Heap blocks
+// get no binding; they are first-touched by the (pinned) engine thread.
+namespace lob
+{
+    enum class HugePagePolicy : uint8_t
+    {
+        off = 0,       // plain operator new
+        automatic = 1, // huge pages where the kernel has them, else 4 KiB
+        on = 2,        // as automatic, but replay refuses to start without any
+    };
+
+    inline const char *to_string(HugePagePolicy p) noexcept
+    {
+        return p == HugePagePolicy::on ? "on" : p == HugePagePolicy::automatic ? "auto" : "off";
+    }
+
+    inline bool parse_huge_page_policy(std::string_view s, HugePagePolicy &out) noexcept
+    {
+        if (s == "off")
+            out = HugePagePolicy::off;
+        else if (s == "auto")
+            out = HugePagePolicy::automatic;
+        else if (s == "on")
+            out = HugePagePolicy::on;
+        else
+            return false;
+        return true;
+    }
+
+    // How one mapping ended up backed. thp is what was asked for; whether
+    // the kernel actually used huge pages is only known from smaps.
+    enum class PageBacking : uint8_t
+    {
+        hugetlb_1g = 0,
+        hugetlb_2m = 1,
+        thp = 2,
+    };
+    inline constexpr size_t kPageBackings = 3;
+    inline constexpr size_t kHugePageSize = size_t{2} << 20;
+    inline constexpr size_t kGiantPageSize = size_t{1} << 30;
+
+    namespace detail
+    {
+        struct HugeRegion
+        {
+            void *p;
+            size_t bytes; // mapped length
+            PageBacking backing;
+            bool bound; // mbind()-ed to the preferred node
+        };
+
+        // Process-wide: the policy is set once at startup, and mappings are
+        // few and large, so a mutex around the registry costs nothing.
+        struct HugePageState
+        {
+            std::atomic<HugePagePolicy> policy{HugePagePolicy::off};
+            std::atomic<int> node{-1};
+            std::mutex m;
+            std::vector<HugeRegion> live;
+            std::array<uint64_t, kPageBackings> bytes{};
+            std::array<uint64_t, kPageBackings> peak{};
+            uint64_t bound{0}, bound_peak{0};
+        };
+
+        inline HugePageState &huge_page_state()
+        {
+            static HugePageState s;
+            return s;
+        }
+
+#ifdef __linux__
+        inline void *map_huge(size_t bytes, PageBacking &backing, size_t &len)
+        {
+            constexpr int kProt = PROT_READ | PROT_WRITE;
+            constexpr int kAnon = MAP_PRIVATE | MAP_ANONYMOUS;
+            if (bytes >= kGiantPageSize)
+            {
+                len = (bytes + kGiantPageSize - 1) & ~(kGiantPageSize - 1);
+                void *p = ::mmap(nullptr, len, kProt, kAnon | MAP_HUGETLB | (30 << MAP_HUGE_SHIFT), -1, 0);
+                if (p != MAP_FAILED)
+                {
+                    backing = PageBacking::hugetlb_1g;
+                    return p;
+                }
+            }
+            len = (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+            void *p = ::mmap(nullptr, len, kProt, kAnon | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT), -1, 0);
+            if (p != MAP_FAILED)
+            {
+                backing = PageBacking::hugetlb_2m;
+                return p;
+            }
+            // THP only maps whole, aligned 2 MiB extents: over-map by one
+            // huge page and trim both ends to the aligned window.
+            void *raw = ::mmap(nullptr, len + kHugePageSize, kProt, kAnon, -1, 0);
+            if (raw == MAP_FAILED)
+                return nullptr;
+            const auto a = reinterpret_cast<uintptr_t>(raw);
+            const uintptr_t lo = (a + kHugePageSize - 1) & ~uintptr_t(kHugePageSize - 1);
+            if (lo > a)
+                ::munmap(raw, lo - a);
+            if (a + len + kHugePageSize > lo + len)
+                ::munmap(reinterpret_cast<void *>(lo + len), a + len + kHugePageSize - lo - len);
+            p = reinterpret_cast<void *>(lo);
+            if (::madvise(p, len, MADV_HUGEPAGE) != 0)
+            {
+                ::munmap(p, len);
+                return nullptr;
+            }
+            backing = PageBacking::thp;
+            return p;
+        }
+
+        // MPOL_PREFERRED rather than MPOL_BIND: a full node spills over
+        // instead of failing the fault.
+        inline bool bind_node(void *p, size_t len, int node) noexcept
+        {
+            if (node < 0 || node >= 64)
+                return false;
+            const unsigned long mask = 1ul << node;
+            return ::syscall(SYS_mbind, p, len, MPOL_PREFERRED, &mask, 65ul, 0u) == 0;
+        }
+#endif
+    } // namespace detail
+
+    inline void set_huge_page_policy(HugePagePolicy p) noexcept
+    {
+        detail::huge_page_state().policy.store(p, std::memory_order_relaxed);
+    }
+
+    inline HugePagePolicy huge_page_policy() noexcept
+    {
+        return detail::huge_page_state().policy.load(std::memory_order_relaxed);
+    }
+
+    // NUMA node later mappings prefer; -1 (the default) leaves placement to
+    // the kernel's first-touch policy.
+    inline void set_huge_page_node(int node) noexcept
+    {
+        detail::huge_page_state().node.store(node, std::memory_order_relaxed);
+    }
+
+    // Storage for at least `bytes` bytes; throws std::bad_alloc like
+    // operator new. Release with huge_page_free(p, bytes).
+    inline void *huge_page_alloc(size_t bytes)
+    {
+#ifdef __linux__
+        if (bytes >= kHugePageSize && huge_page_policy() != HugePagePolicy::off)
+        {
+            PageBacking backing{};
+            size_t len = 0;
+            if (void *p = detail::map_huge(bytes, backing, len))
+            {
+                auto &s = detail::huge_page_state();
+                const bool bound = detail::bind_node(p, len, s.node.load(std::memory_order_relaxed));
+                std::lock_guard<std::mutex> g(s.m);
+                s.live.push_back({p, len, backing, bound});
+                const auto k = static_cast<size_t>(backing);
+                s.peak[k] = std::max(s.peak[k], s.bytes[k] += len);
+                if (bound)
+                    s.bound_peak = std::max(s.bound_peak, s.bound += len);
+                return p;
+            }
+        }
+#endif
+        return ::operator new(bytes);
+    }
+
+    inline void huge_page_free(void *p, size_t bytes) noexcept
+    {
+#ifdef __linux__
+        // Only allocations this large can have been mapped; the policy may
+        // have changed since, so the registry decides.
+        if (p && bytes >= kHugePageSize)
+        {
+            auto &s = detail::huge_page_state();
+            std::unique_lock<std::mutex> g(s.m);
+            const auto it = std::find_if(s.live.begin(), s.live.end(),
+                                         [p](const detail::HugeRegion &r) { return r.p == p; });
+            if (it != s.live.end())
+            {
+                const detail::HugeRegion r = *it;
+                s.live.erase(it);
+                s.bytes[static_cast<size_t>(r.backing)] -= r.bytes;
+                if (r.bound)
+                    s.bound -= r.bytes;
+                g.unlock();
+                ::munmap(r.p, r.bytes);
+                return;
+            }
+        }
+#else
+        (void)bytes;
+#endif
+        ::operator delete(p);
+    }
+
+    // std::allocator replacement routing large blocks through
+    // huge_page_alloc(). Stateless, so containers swap and move freely.
+    template <class T>
+    struct HugePageAllocator
+    {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        using value_type = T;
+
+        HugePageAllocator() noexcept = default;
+        template <class U>
+        HugePageAllocator(const HugePageAllocator<U> &) noexcept
+        {
+        }
+
+        T *allocate(size_t n) { return static_cast<T *>(huge_page_alloc(n * sizeof(T))); }
+        void deallocate(T *p, size_t n) noexcept { huge_page_free(p, n * sizeof(T)); }
+
+        template <class U>
+        bool operator==(const HugePageAllocator<U> &) const noexcept
+        {
+            return true;
+        }
+    };
+
+    template <class T>
+    using HugeVector = std::vector<T, HugePageAllocator<T>>;
+
+    // What the policy actually obtained, for telemetry. Byte counts are the
+    // peak mapped per backing; thp_backed_bytes is how much of the live
+    // THP-advised memory the kernel really backs with huge pages
+    // (AnonHugePages in /proc/self/smaps) at the time of the call.
+    // page_size is the largest page size backing any of it: 1 GiB, 2 MiB,
+    // or the base page size when nothing was huge. node_bound_bytes is the
+    // peak mapped with a preference for node.
+    struct HugePageReport
+    {
+        HugePagePolicy policy{HugePagePolicy::off};
+        uint64_t hugetlb_1g_bytes{0}, hugetlb_2m_bytes{0}, thp_bytes{0}, thp_backed_bytes{0};
+        uint64_t page_size{4096};
+        int node{-1};
+        uint64_t node_bound_bytes{0};
+    };
+    HugePageReport huge_page_report();
+
+    // Whether any huge pages can be had at all: a non-empty hugetlb pool or
+    // THP not disabled. why says what is missing when not.
+    bool huge_pages_available(std::string &why);
+} // namespace lob
@@ -0,0 +1,143 @@
+#pragma once
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "order_book.hpp"
+
+namespace lob
+{
+
+    enum class OrderType : uint8_t
+    {
+        Limit = 0,    // match what crosses, rest the remainder
+        Market = 1,   // match at any price, never rests
+        IOC = 2,      // match up to the limit, cancel the remainder
+        FOK = 3,      // fill completely up to the limit or do nothing
+        PostOnly = 4, // rest only; rejected if it would cross
+    };
+
+    enum class OrderStatus : uint8_t
+    {
+        Rested = 0,    // nothing (or part) filled, the remainder rests
+        Filled = 1,    // fully filled
+        Cancelled = 2, // IOC/market/FOK remainder dropped (may have fills)
+        Rejected = 3,  // bad id/qty, post-only cross, FOK short, unknown id
+    };
+
+    struct OrderRequest
+    {
+        uint64_t id{0};
+        int64_t px{0}; // ignored for Market
+        uint32_t qty{0};
+        Side side{Side::Bid};
+        OrderType type{OrderType::Limit};
+    };
+
+    struct Fill
+    {
+        uint64_t taker_id{0};
+        uint64_t maker_id{0};
+        int64_t px{0};
+        uint32_t qty{0};
+        Side taker_side{Side::Bid};
+    };
+
+    struct MatchResult
+    {
+        OrderStatus status{OrderStatus::Rejected};
+        uint32_t filled{0};
+        uint32_t resting{0}; // quantity left on the book under the order's id
+    };
+
+    // Price-time priority matching on one OrderBook.
+    //
+    // An incoming order trades against the opposite side best level first
+    // and, within a level, oldest order first, always at the resting order's
+    // price. Fills of the last call are in fills() until the next call. The
+    // fill buffer and the book's pools are sized up front by reserve(), so a
+    // warmed-up engine matches without allocating; only resting a new order
+    // touches the book's id index.
+    //
+    // replace() keeps queue priority only when the price is unchanged and
+    // the quantity shrinks; otherwise the order is cancelled and re-entered
+    // as a limit order at the back of its new level, matching first if it
+    // now crosses.
+    class MatchingEngine
+    {
+    public:
+        explicit MatchingEngine(size_t max_orders = 0, size_t max_fills = 1024) { reserve(max_orders, max_fills); }
+
+        void reserve(size_t max_orders, size_t max_fills)
+        {
+            book_.reserve(max_orders);
+            fills_.reserve(max_fills);
+        }
+
+        MatchResult submit(const OrderRequest &o)
+        {
+            fills_.clear();
+            if (o.qty == 0 || book_.contains(o.id))
+                return {};
+            const bool market = o.type == OrderType::Market;
+            const int64_t limit = market ? (o.side == Side::Bid ? std::numeric_limits<int64_t>::max()
+                                                                : std::numeric_limits<int64_t>::min())
+                                         : o.px;
+            if (o.type == OrderType::PostOnly && book_.available(o.side, limit, 1) != 0)
+                return {};
+            if (o.type == OrderType::FOK && book_.available(o.side, limit, o.qty) < o.qty)
+                return {};
+
+            const uint32_t filled = static_cast<uint32_t>(book_.match(
+                o.side, limit, o.qty, [this, &o](uint64_t maker, int64_t px, uint32_t q)
+                { fills_.push_back(Fill{o.id, maker, px, q, o.side}); }));
+            MatchResult r{OrderStatus::Filled, filled, 0};
+            if (filled == o.qty)
+                return r;
+            if (o.type == OrderType::Limit || o.type == OrderType::PostOnly)
+            {
+                book_.add(o.id, o.side, o.px, o.qty - filled);
+                r.status = OrderStatus::Rested;
+                r.resting = o.qty - filled;
+            }
+            else
+                r.status = OrderStatus::Cancelled;
+            return r;
+        }
+
+        bool cancel(uint64_t id)
+        {
+            fills_.clear();
+            return book_.erase(id);
+        }
+
+        MatchResult replace(uint64_t id, int64_t px, uint32_t qty)
+        {
+            fills_.clear();
+            const uint32_t slot = book_.slot_of(id);
+            if (slot == OrderBook::kNil || qty == 0)
+                return {};
+            const uint32_t open = book_.order_qty(slot);
+            if (px == book_.order_px(slot) && qty <= open)
+            {
+                if (qty < open)
+                    book_.reduce(id, open - qty);
+                return {OrderStatus::Rested, 0, qty};
+            }
+            const Side side = book_.order_side(slot);
+            book_.erase(id);
+            return submit(OrderRequest{id, px, qty, side, OrderType::Limit});
+        }
+
+        std::span<const Fill> fills() const noexcept { return fills_; }
+        const OrderBook &book() const noexcept { return book_; }
+
+    private:
+        OrderBook book_;
+        std::vector<Fill> fills_;
+    };
+
+} // namespace lob
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+#include "huge_pages.hpp"
+#include "stage_timer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace lob
+{
+    // Per-message trace ("BQLTRC", version 1), written by replay --trace-out
+    // so tail events can be joined offline against message type, symbol and
+    // book depth (numpy, pandas, duckdb; see scripts/trace_frame.py).
+    //
+    // Layout: TraceHeader, TraceColumn[column_count], then each column's
+    // row_count values back to back at TraceColumn::offset. Little-endian,
+    // every column 64-byte aligned; TraceColumn::dtype is the numpy type
+    // string, so a column maps straight onto an array. Columns, in order:
+    // msg_index, type, symbol, flags, total_ns, one <stage>_ns per
+    // kStageNames, bid_levels, ask_levels, orders. total_ns is the event's
+    // whole interval, as fed to the latency percentiles; the stage columns
+    // are filled only on rows flagged kTraceStaged and are 0 elsewhere.
+    // Depth columns are the event's book after the event.
+    inline constexpr char kTraceMagic[8] = {'B', 'Q', 'L', 'T', 'R', 'C', '\0', '\0'};
+    inline constexpr uint32_t kTraceVersion = 1;
+    inline constexpr uint32_t kTraceColumnCount = 8 + kStageCount;
+
+    // flags bits. Rows with kTraceStaged or kTracePerf carry instrumentation
+    // reads in total_ns and are the ones left out of the percentiles.
+    inline constexpr uint8_t kTraceApplied = 1; // the book accepted the message
+    inline constexpr uint8_t kTraceStaged = 2;  // stage-timed event
+    inline constexpr uint8_t kTracePerf = 4;    // perf-counter sampled event
+
+    struct TraceHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_bytes;
+        uint32_t column_count;
+        uint32_t reserved;
+        uint64_t row_count;
+        uint64_t dropped; // events past the buffer's capacity, not recorded
+        uint64_t first_msg; // msg_index of row 0
+        uint64_t file_bytes;
+        uint64_t reserved2;
+    };
+    static_assert(sizeof(TraceHeader) == 64);
+
+    struct TraceColumn
+    {
+        char name[16];
+        char dtype[4]; // "|u1", "<u2", "<u4" or "<u8"
+        uint32_t width;
+        uint64_t offset;
+    };
+    static_assert(sizeof(TraceColumn) == 32);
+
+    // Preallocated column buffer. Every column is sized for `capacity` rows
+    // up front (and thereby faulted in), so record() is a handful of plain
+    // stores; rows past capacity are only counted. Nothing is formatted
+    // until write().
+    class MessageTrace
+    {
+    public:
+        explicit MessageTrace(size_t capacity)
+            : msg_index_(capacity), type_(capacity), symbol_(capacity), flags_(capacity), total_ns_(capacity),
+              bid_levels_(capacity), ask_levels_(capacity), orders_(capacity)
+        {
+            for (auto &c : stage_ns_)
+                c.resize(capacity);
+        }
+
+        void record(uint64_t msg_index, uint8_t type, uint16_t symbol, uint8_t flags, uint64_t total_ns,
+                    const std::array<uint32_t, kStageCount> &stage_ns, size_t bid_levels, size_t ask_levels,
+                    size_t orders) noexcept
+        {
+            if (rows_ == msg_index_.size())
+            {
+                ++dropped_;
+                return;
+            }
+            const size_t r = rows_++;
+            msg_index_[r] = msg_index;
+            type_[r] = type;
+            symbol_[r] = symbol;
+            flags_[r] = flags;
+            total_ns_[r] = saturate(total_ns);
+            for (size_t s = 0; s < kStageCount; ++s)
+                stage_ns_[s][r] = stage_ns[s];
+            bid_levels_[r] = saturate(bid_levels);
+            ask_levels_[r] = saturate(ask_levels);
+            orders_[r] = saturate(orders);
+        }
+
+        size_t rows() const noexcept { return rows_; }
+        size_t capacity() const noexcept { return msg_index_.size(); }
+        uint64_t dropped() const noexcept { return dropped_; }
+
+        // Writes the recorded rows via a temporary file and rename, like
+        // write_capture_index; file_bytes is the size written.
+        bool write(const std::string &path, uint64_t &file_bytes, std::string &err) const;
+
+        static uint32_t saturate(uint64_t v) noexcept
+        {
+            return static_cast<uint32_t>(std::min<uint64_t>(v, std::numeric_limits<uint32_t>::max()));
+        }
+
+    private:
+        HugeVector<uint64_t> msg_index_;
+        HugeVector<uint8_t> type_;
+        HugeVector<uint16_t> symbol_;
+        HugeVector<uint8_t> flags_;
+        HugeVector<uint32_t> total_ns_;
+        std::array<HugeVector<uint32_t>, kStageCount> stage_ns_;
+        HugeVector<uint32_t> bid_levels_;
+        HugeVector<uint32_t> ask_levels_;
+        HugeVector<uint32_t> orders_;
+        size_t rows_{0};
+        uint64_t dropped_{0};
+    };
+} // namespace lob
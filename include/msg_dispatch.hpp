@@ -0,0 +1,133 @@
+#pragma once
+// SPDX-License-Identifier: Apache-2.0
+
+#include "event.hpp"
+#include "order_book.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lob
+{
+
+    // Compile-time message dispatch. Each wire type has a constexpr layout
+    // saying which payload fields it carries beyond the common header
+    // (type, reference/symbol, timestamp) and a handler instantiated for it
+    // alone, so a message decodes only its own fields and applies with no
+    // runtime field tests. MsgDispatch<Ts...> lists the types a build
+    // handles; anything else is rejected without being decoded, and its
+    // handler is never instantiated.
+    // BasicMsgDispatch takes the target and the handler family as
+    // parameters, for consumers other than an OrderBook.
+
+    inline constexpr size_t kMsgTypeCount = 4;
+
+    struct MsgLayout
+    {
+        bool side;  // w0[2]
+        bool price; // w2[7:0], relative to the side's base
+        bool qty;   // w3
+    };
+
+    template <MsgType T>
+    inline constexpr MsgLayout kMsgLayout{T == MsgType::Add, T == MsgType::Add, T != MsgType::Delete};
+
+    // Header fields every type carries: enough to pick the book, stamp a
+    // delta record and dispatch.
+    inline Event decode_header(const uint8_t *p, uint64_t index) noexcept
+    {
+        Event e;
+        e.type = static_cast<MsgType>(load_le64(p) & 0x3u);
+        e.ref = load_le64(p + 8) & (kOrderRefSpace - 1);
+        e.symbol = static_cast<uint16_t>(e.ref % kSymbolCount);
+        e.ts_ns = index * 1000 + (load_le64(p + 16) >> 8) % 1000;
+        return e;
+    }
+
+    // The fields of T's layout, decoded exactly as decode_event() does.
+    template <MsgType T>
+    inline void decode_body(const uint8_t *p, Event &e) noexcept
+    {
+        constexpr MsgLayout L = kMsgLayout<T>;
+        if constexpr (L.side)
+            e.side = static_cast<Side>((load_le64(p) >> 2) & 0x1u);
+        if constexpr (L.price)
+        {
+            const int64_t off = static_cast<int64_t>(load_le64(p + 16) & 0xFFu);
+            e.px = e.side == Side::Bid ? kBasePriceTicks - 1 - off : kBasePriceTicks + off;
+        }
+        if constexpr (L.qty)
+            e.qty = static_cast<uint32_t>(1 + load_le64(p + 24) % 1000);
+    }
+
+    template <MsgType T>
+    struct MsgHandler;
+
+    template <>
+    struct MsgHandler<MsgType::Add>
+    {
+        static bool apply(OrderBook &b, const Event &e) { return b.add(e.ref, e.side, e.px, e.qty); }
+    };
+
+    template <>
+    struct MsgHandler<MsgType::Execute>
+    {
+        static bool apply(OrderBook &b, const Event &e) { return b.reduce(e.ref, e.qty); }
+    };
+
+    template <>
+    struct MsgHandler<MsgType::Cancel>
+    {
+        static bool apply(OrderBook &b, const Event &e) { return b.reduce(e.ref, e.qty); }
+    };
+
+    template <>
+    struct MsgHandler<MsgType::Delete>
+    {
+        static bool apply(OrderBook &b, const Event &e) { return b.erase(e.ref); }
+    };
+
+    template <class Target, template <MsgType> class Handler, MsgType... Ts>
+    struct BasicMsgDispatch
+    {
+        static_assert(sizeof...(Ts) > 0 && sizeof...(Ts) <= kMsgTypeCount);
+
+        static constexpr bool handles(MsgType t) noexcept { return ((t == Ts) || ...); }
+
+        // Decodes the body of e's type into e and applies it to b: a chain of
+        // compares in the listed order, each case inlined. False for types
+        // outside Ts and for events the book rejects. (bench_dispatch keeps a
+        // jump-table variant for comparison; its out-of-line calls measured
+        // ~30% slower on decode and dispatch.)
+        static bool apply(Target &b, const uint8_t *p, Event &e) { return chain<Ts...>(b, p, e); }
+
+    private:
+        template <MsgType T>
+        static bool step(Target &b, const uint8_t *p, Event &e)
+        {
+            decode_body<T>(p, e);
+            return Handler<T>::apply(b, e);
+        }
+
+        template <MsgType T, MsgType... Rest>
+        static bool chain(Target &b, const uint8_t *p, Event &e)
+        {
+            if (e.type == T)
+                return step<T>(b, p, e);
+            if constexpr (sizeof...(Rest) > 0)
+                return chain<Rest...>(b, p, e);
+            else
+                return false;
+        }
+    };
+
+    template <MsgType... Ts>
+    using MsgDispatch = BasicMsgDispatch<OrderBook, MsgHandler, Ts...>;
+
+    // Every wire type. The golden capture carries the four in equal shares
+    // (24.8-25.3% each over data/golden/itch_1m.bin), so the order is not
+    // tuned; a build for a skewed feed should list its most frequent type
+    // first.
+    using FullDispatch = MsgDispatch<MsgType::Add, MsgType::Delete, MsgType::Cancel, MsgType::Execute>;
+
+} // namespace lob
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lob
+{
+    // One memory node as the kernel lists it under /sys/devices/system/node.
+    struct NumaNode
+    {
+        int id{0};
+        std::vector<int> cpus;
+        uint64_t mem_bytes{0};
+    };
+
+    // Nodes in id order. Empty on kernels without NUMA support (and on
+    // non-Linux), where node_of_cpu() is always -1.
+    struct NumaTopology
+    {
+        std::vector<NumaNode> nodes;
+
+        int node_of_cpu(int cpu) const noexcept;
+    };
+
+    // Reads nodeN/cpulist and nodeN/meminfo for every online node under
+    // root; tests point it at a fake tree.
+    NumaTopology discover_numa(const std::string &root = "/sys/devices/system/node");
+
+    // Parses a kernel cpulist such as "0-3,8,10-11" into out (appended).
+    bool parse_cpulist(std::string_view s, std::vector<int> &out);
+
+    // Fraction of the resident pages in [p, p + len) that sit on node,
+    // from up to `samples` pages spread evenly over the range (move_pages
+    // in query mode). -1 when it cannot be determined.
+    double fraction_on_node(const void *p, size_t len, int node, size_t samples = 256);
+} // namespace lob
@@ -1,43 +1,482 @@
 #pragma once
 // SPDX-License-Identifier: Apache-2.0
 
+#include "huge_pages.hpp"
+#include "order_index.hpp"
+
 #include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <vector>
 
 namespace lob
 {
 
-    // Lightweight structure-of-arrays book used by some experimental tools.
-    struct OrderBook
+    enum class Side : uint8_t
+    {
+        Bid = 0,
+        Ask = 1
+    };
+
+    // One price level. Resting orders form an intrusive FIFO through the order
+    // pool (head = oldest) so price-time priority survives every mutation.
+    struct Level
+    {
+        int64_t px{0};
+        uint64_t qty{0};
+        uint32_t count{0};
+        uint32_t head{std::numeric_limits<uint32_t>::max()};
+        uint32_t tail{std::numeric_limits<uint32_t>::max()};
+        uint32_t reserved{0};
+    };
+
+    // Aggregated (market-by-price) level as published to L2 consumers.
+    struct L2Level
     {
-        std::vector<double> prices;
-        std::vector<uint32_t> qtys;
-        std::vector<uint64_t> ids;
+        int64_t px{0};
+        uint64_t qty{0};
+        uint32_t count{0};
+        uint32_t reserved{0};
+    };
+
+    // One changed level: new aggregate qty/count plus the signed qty change
+    // that produced it. qty == 0 means the level was removed.
+    struct LevelDelta
+    {
+        int64_t px{0};
+        uint64_t qty{0};
+        int64_t qty_change{0};
+        uint32_t count{0};
+        Side side{Side::Bid};
+        uint8_t reserved[3]{};
+    };
+
+    // L3 order book for a single instrument.
+    //
+    // Orders live in a structure-of-arrays pool addressed by slot; freed slots
+    // are recycled so a warmed-up book does not allocate. Levels are kept in a
+    // sorted vector per side with the best level at the back (bids ascending,
+    // asks descending): flow concentrates near the touch, so inserts and
+    // erases there shift almost nothing.
+    //
+    // An L2 view rides along: the top kL2Depth levels per side are cached
+    // best-first in a fixed array and patched on every mutation from the
+    // level's rank, never by rescanning, so depth() is a single memcpy. With
+    // record_deltas(true) every level change is also appended to deltas()
+    // for the caller to publish and clear once per message.
+    //
+    // Orders are found by id through an open-addressing OrderIndex, whose
+    // probe line can be prefetched ahead of the message (prefetch_index,
+    // prefetch_order). Pools, level arrays and the index use
+    // HugePageAllocator: once one grows past 2 MiB it follows the process
+    // huge-page policy (huge_pages.hpp).
+    class OrderBook
+    {
+    public:
+        static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+        static constexpr size_t kL2Depth = 10;
 
         void reserve(size_t n)
         {
-            prices.reserve(n);
-            qtys.reserve(n);
-            ids.reserve(n);
+            ids_.reserve(n);
+            prices_.reserve(n);
+            qtys_.reserve(n);
+            next_.reserve(n);
+            prev_.reserve(n);
+            sides_.reserve(n);
+            free_.reserve(n);
+            index_.reserve(n);
+        }
+
+        // Writes one byte back into every 4 KiB page of the pools' and level
+        // arrays' reserved capacity, so a latency-critical run (replay
+        // --realtime) does not fault on the first add() that reaches a page.
+        void prefault() noexcept
+        {
+            touch(ids_);
+            touch(prices_);
+            touch(qtys_);
+            touch(next_);
+            touch(prev_);
+            touch(sides_);
+            touch(free_);
+            touch(bids_);
+            touch(asks_);
+            touch(deltas_);
+        }
+
+        // Rests a new order at the tail of its level. Rejects duplicate ids and
+        // zero quantities.
+        bool add(uint64_t id, Side side, int64_t px, uint32_t qty)
+        {
+            if (qty == 0 || index_.contains(id))
+                return false;
+            const uint32_t slot = alloc_slot();
+            ids_[slot] = id;
+            prices_[slot] = px;
+            qtys_[slot] = qty;
+            sides_[slot] = side;
+            next_[slot] = kNil;
+
+            auto &lv = levels(side);
+            auto it = find_level(side, px);
+            const bool fresh = it == lv.end() || it->px != px;
+            if (fresh)
+                it = lv.insert(it, Level{px, 0, 0, kNil, kNil, 0});
+            prev_[slot] = it->tail;
+            if (it->tail != kNil)
+                next_[it->tail] = slot;
+            else
+                it->head = slot;
+            it->tail = slot;
+            it->qty += qty;
+            ++it->count;
+            index_.insert(id, slot);
+            if (fresh)
+                l2_insert(side, it);
+            else
+                l2_update(side, it, qty);
+            return true;
+        }
+
+        // Removes up to qty from a resting order (execution or partial
+        // cancel); the order leaves the book when nothing remains.
+        bool reduce(uint64_t id, uint32_t qty)
+        {
+            const uint32_t slot = index_.find(id);
+            if (slot == kNil)
+                return false;
+            if (qty >= qtys_[slot])
+            {
+                unlink(slot);
+                index_.erase(id);
+                return true;
+            }
+            qtys_[slot] -= qty;
+            auto it = find_level(sides_[slot], prices_[slot]);
+            it->qty -= qty;
+            l2_update(sides_[slot], it, -static_cast<int64_t>(qty));
+            return true;
+        }
+
+        bool erase(uint64_t id)
+        {
+            const uint32_t slot = index_.find(id);
+            if (slot == kNil)
+                return false;
+            unlink(slot);
+            index_.erase(id);
+            return true;
+        }
+
+        // Executes up to qty against the side opposite `aggressor`, best
+        // level first and oldest order first within a level, stopping at the
+        // first level priced worse than limit. Calls on_fill(maker_id, px,
+        // qty) for each execution and returns the quantity filled. Filled
+        // makers are unlinked from the level's head in place; nothing is
+        // allocated once the book is warm.
+        template <class OnFill>
+        uint64_t match(Side aggressor, int64_t limit, uint64_t qty, OnFill &&on_fill)
+        {
+            const Side side = aggressor == Side::Bid ? Side::Ask : Side::Bid;
+            auto &lv = levels(side);
+            uint64_t left = qty;
+            while (left != 0 && !lv.empty())
+            {
+                auto it = lv.end() - 1;
+                const int64_t px = it->px;
+                if (aggressor == Side::Bid ? px > limit : px < limit)
+                    break;
+                while (left != 0)
+                {
+                    const uint32_t slot = it->head;
+                    const uint32_t q = static_cast<uint32_t>(std::min<uint64_t>(left, qtys_[slot]));
+                    on_fill(ids_[slot], px, q);
+                    left -= q;
+                    it->qty -= q;
+                    if (q < qtys_[slot])
+                    {
+                        qtys_[slot] -= q;
+                        l2_update(side, it, -static_cast<int64_t>(q));
+                        break;
+                    }
+                    index_.erase(ids_[slot]);
+                    it->head = next_[slot];
+                    qtys_[slot] = 0;
+                    free_.push_back(slot);
+                    if (--it->count == 0)
+                    {
+                        lv.pop_back();
+                        l2_erase(side, 0, px, q);
+                        break;
+                    }
+                    prev_[it->head] = kNil;
+                    l2_update(side, it, -static_cast<int64_t>(q));
+                }
+            }
+            return qty - left;
+        }
+
+        // Quantity resting on the side opposite `aggressor` at prices no
+        // worse than limit, counted up to cap (levels are walked best-first
+        // and the walk stops once cap is reached).
+        uint64_t available(Side aggressor, int64_t limit, uint64_t cap) const noexcept
+        {
+            const auto &lv = levels(aggressor == Side::Bid ? Side::Ask : Side::Bid);
+            uint64_t n = 0;
+            for (auto it = lv.rbegin(); it != lv.rend() && n < cap; ++it)
+            {
+                if (aggressor == Side::Bid ? it->px > limit : it->px < limit)
+                    break;
+                n += it->qty;
+            }
+            return n;
+        }
+
+        void clear() noexcept
+        {
+            ids_.clear();
+            prices_.clear();
+            qtys_.clear();
+            next_.clear();
+            prev_.clear();
+            sides_.clear();
+            free_.clear();
+            index_.clear();
+            bids_.clear();
+            asks_.clear();
+            top_n_ = {0, 0};
+            deltas_.clear();
+        }
+
+        size_t size() const noexcept { return index_.size(); }
+        bool contains(uint64_t id) const noexcept { return index_.contains(id); }
+
+        // Levels in storage order (best level last).
+        const HugeVector<Level> &bids() const noexcept { return bids_; }
+        const HugeVector<Level> &asks() const noexcept { return asks_; }
+        const HugeVector<Level> &levels(Side s) const noexcept { return s == Side::Bid ? bids_ : asks_; }
+
+        // Copies up to n best-first aggregated levels into out; returns the
+        // number written (at most kL2Depth).
+        size_t depth(Side s, L2Level *out, size_t n) const noexcept
+        {
+            const size_t k = std::min<size_t>(n, top_n_[idx(s)]);
+            std::memcpy(out, top_[idx(s)].data(), k * sizeof(L2Level));
+            return k;
+        }
+
+        void record_deltas(bool on)
+        {
+            record_deltas_ = on;
+            deltas_.clear();
+        }
+        const std::vector<LevelDelta> &deltas() const noexcept { return deltas_; }
+        void clear_deltas() noexcept { deltas_.clear(); }
+
+        // Slot of a resting order, or kNil.
+        uint32_t slot_of(uint64_t id) const noexcept { return index_.find(id); }
+
+        // Lookahead hints for a message that is still a few events away
+        // (replay --prefetch-distance). prefetch_index() requests the index
+        // line that id hashes to; prefetch_order(), issued once that line
+        // has had time to arrive, looks the slot up and requests the order's
+        // pool entries that reduce()/erase() read. Neither changes the book.
+        void prefetch_index(uint64_t id) const noexcept { index_.prefetch(id); }
+        void prefetch_order(uint64_t id) const noexcept
+        {
+            const uint32_t s = index_.find(id);
+            if (s == kNil)
+                return;
+            __builtin_prefetch(&qtys_[s], 1);
+            __builtin_prefetch(&prices_[s]);
+            __builtin_prefetch(&sides_[s]);
+            __builtin_prefetch(&prev_[s]);
+            __builtin_prefetch(&next_[s]);
+        }
+
+        // Per-slot accessors for walking a level's FIFO from Level::head.
+        uint64_t order_id(uint32_t slot) const noexcept { return ids_[slot]; }
+        uint32_t order_qty(uint32_t slot) const noexcept { return qtys_[slot]; }
+        int64_t order_px(uint32_t slot) const noexcept { return prices_[slot]; }
+        Side order_side(uint32_t slot) const noexcept { return sides_[slot]; }
+        uint32_t next(uint32_t slot) const noexcept { return next_[slot]; }
+
+        // FNV-1a over both sides best-first, including every order in queue
+        // order. Two books with equal digests have identical priority state.
+        uint64_t digest() const noexcept
+        {
+            uint64_t h = 1469598103934665603ull;
+            auto mix = [&h](uint64_t v)
+            {
+                for (int i = 0; i < 8; ++i)
+                {
+                    h ^= (v >> (i * 8)) & 0xFFu;
+                    h *= 1099511628211ull;
+                }
+            };
+            for (const auto *side : {&bids_, &asks_})
+            {
+                mix(side->size());
+                for (auto it = side->rbegin(); it != side->rend(); ++it)
+                {
+                    mix(static_cast<uint64_t>(it->px));
+                    mix(it->qty);
+                    mix(it->count);
+                    for (uint32_t s = it->head; s != kNil; s = next_[s])
+                    {
+                        mix(ids_[s]);
+                        mix(qtys_[s]);
+                    }
+                }
+            }
+            return h;
+        }
+
+    private:
+        static constexpr size_t idx(Side s) noexcept { return static_cast<size_t>(s); }
+        HugeVector<Level> &levels(Side s) noexcept { return s == Side::Bid ? bids_ : asks_; }
+
+        size_t rank(Side side, HugeVector<Level>::const_iterator it) const noexcept
+        {
+            return static_cast<size_t>(levels(side).end() - 1 - it);
+        }
+
+        void emit(Side side, int64_t px, uint64_t qty, int64_t change, uint32_t count)
+        {
+            if (record_deltas_)
+                deltas_.push_back(LevelDelta{px, qty, change, count, side, {}});
+        }
+
+        // Level at it changed qty/count in place by change.
+        void l2_update(Side side, HugeVector<Level>::const_iterator it, int64_t change)
+        {
+            const size_t r = rank(side, it);
+            if (r < kL2Depth)
+                top_[idx(side)][r] = L2Level{it->px, it->qty, it->count, 0};
+            emit(side, it->px, it->qty, change, it->count);
+        }
+
+        // Level at it was just inserted: shift the cached tail down one rank.
+        void l2_insert(Side side, HugeVector<Level>::const_iterator it)
+        {
+            const size_t r = rank(side, it);
+            auto &top = top_[idx(side)];
+            uint32_t &n = top_n_[idx(side)];
+            if (r < kL2Depth)
+            {
+                const size_t keep = std::min<size_t>(n, kL2Depth - 1);
+                if (keep > r)
+                    std::memmove(&top[r + 1], &top[r], (keep - r) * sizeof(L2Level));
+                top[r] = L2Level{it->px, it->qty, it->count, 0};
+                n = static_cast<uint32_t>(std::min<size_t>(n + 1, kL2Depth));
+            }
+            emit(side, it->px, it->qty, static_cast<int64_t>(it->qty), it->count);
+        }
+
+        // Level of rank r was erased: shift the cached tail up one rank and
+        // pull the new rank kL2Depth-1 level (if any) from the sorted vector.
+        void l2_erase(Side side, size_t r, int64_t px, uint64_t removed)
+        {
+            auto &top = top_[idx(side)];
+            uint32_t &n = top_n_[idx(side)];
+            if (r < n)
+            {
+                std::memmove(&top[r], &top[r + 1], (n - r - 1) * sizeof(L2Level));
+                const auto &lv = levels(side);
+                if (lv.size() >= kL2Depth)
+                {
+                    const Level &l = lv[lv.size() - kL2Depth];
+                    top[kL2Depth - 1] = L2Level{l.px, l.qty, l.count, 0};
+                }
+                else
+                    --n;
+            }
+            emit(side, px, 0, -static_cast<int64_t>(removed), 0);
+        }
+
+        template <class V>
+        static void touch(V &v) noexcept
+        {
+            auto *p = reinterpret_cast<volatile unsigned char *>(v.data());
+            const size_t n = v.capacity() * sizeof(typename V::value_type);
+            for (size_t i = 0; i < n; i += 4096)
+                p[i] = p[i];
+        }
+
+        // First level not strictly better than px in storage order.
+
+        HugeVector<Level>::iterator find_level(Side side, int64_t px)
+        {
+            auto &lv = levels(side);
+            if (side == Side::Bid)
+                return std::lower_bound(lv.begin(), lv.end(), px,
+                                        [](const Level &l, int64_t p)
+                                        { return l.px < p; });
+            return std::lower_bound(lv.begin(), lv.end(), px,
+                                    [](const Level &l, int64_t p)
+                                    { return l.px > p; });
         }
 
-        inline void add(uint64_t id, uint32_t qty, double px) noexcept
+        uint32_t alloc_slot()
         {
-            prices.push_back(px);
-            qtys.push_back(qty);
-            ids.push_back(id);
+            if (!free_.empty())
+            {
+                const uint32_t s = free_.back();
+                free_.pop_back();
+                return s;
+            }
+            ids_.push_back(0);
+            prices_.push_back(0);
+            qtys_.push_back(0);
+            next_.push_back(kNil);
+            prev_.push_back(kNil);
+            sides_.push_back(Side::Bid);
+            return static_cast<uint32_t>(ids_.size() - 1);
         }
 
-        inline void clear() noexcept
+        void unlink(uint32_t slot)
         {
-            prices.clear();
-            qtys.clear();
-            ids.clear();
+            const Side side = sides_[slot];
+            auto it = find_level(side, prices_[slot]);
+            if (prev_[slot] != kNil)
+                next_[prev_[slot]] = next_[slot];
+            else
+                it->head = next_[slot];
+            if (next_[slot] != kNil)
+                prev_[next_[slot]] = prev_[slot];
+            else
+                it->tail = prev_[slot];
+            it->qty -= qtys_[slot];
+            if (--it->count == 0)
+            {
+                const size_t r = rank(side, it);
+                const int64_t px = it->px;
+                levels(side).erase(it);
+                l2_erase(side, r, px, qtys_[slot]);
+            }
+            else
+                l2_update(side, it, -static_cast<int64_t>(qtys_[slot]));
+            qtys_[slot] = 0;
+            free_.push_back(slot);
         }
 
-        size_t size() const noexcept { return prices.size(); }
+        HugeVector<uint64_t> ids_;
+        HugeVector<int64_t> prices_;
+        HugeVector<uint32_t> qtys_;
+        HugeVector<uint32_t> next_;
+        HugeVector<uint32_t> prev_;
+        HugeVector<Side> sides_;
+        HugeVector<uint32_t> free_;
+        OrderIndex index_;
+        HugeVector<Level> bids_;
+        HugeVector<Level> asks_;
+        std::array<std::array<L2Level, kL2Depth>, 2> top_{};
+        std::array<uint32_t, 2> top_n_{0, 0};
+        std::vector<LevelDelta> deltas_;
+        bool record_deltas_{false};
     };
 
 } // namespace lob
@@ -0,0 +1,143 @@
+#pragma once
+// SPDX-License-Identifier: Apache-2.0
+
+#include "huge_pages.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace lob
+{
+
+    // Order id -> pool slot map for OrderBook.
+    //
+    // Open addressing with linear probing over a power-of-two table of
+    // 16-byte entries kept at most half full. Deletion shifts the rest of the
+    // probe run back instead of leaving tombstones, so a lookup is one
+    // Fibonacci hash and, nearly always, one cache line. That line's address
+    // depends on the id alone, which is what lets prefetch() request it a few
+    // messages before the lookup happens; a node-based map can only do that
+    // for the bucket array, not for the node it points to.
+    class OrderIndex
+    {
+    public:
+        static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+
+        uint32_t find(uint64_t id) const noexcept
+        {
+            if (table_.empty())
+                return kNil;
+            for (size_t i = home(id);; i = (i + 1) & mask_)
+            {
+                const Entry &e = table_[i];
+                if (e.slot == kNil || e.id == id)
+                    return e.slot;
+            }
+        }
+
+        bool contains(uint64_t id) const noexcept { return find(id) != kNil; }
+
+        // Maps id to slot; false (and no change) when id is already present.
+        bool insert(uint64_t id, uint32_t slot)
+        {
+            if ((size_ + 1) * 2 > table_.size())
+                rehash(table_.empty() ? kMinCapacity : table_.size() * 2);
+            size_t i = home(id);
+            for (; table_[i].slot != kNil; i = (i + 1) & mask_)
+                if (table_[i].id == id)
+                    return false;
+            table_[i] = Entry{id, slot, 0};
+            ++size_;
+            return true;
+        }
+
+        bool erase(uint64_t id) noexcept
+        {
+            if (table_.empty())
+                return false;
+            size_t i = home(id);
+            for (; table_[i].id != id; i = (i + 1) & mask_)
+                if (table_[i].slot == kNil)
+                    return false;
+            if (table_[i].slot == kNil)
+                return false;
+            // Pull back every later entry of the run whose home is not in
+            // (i, j]; the hole then ends the run.
+            for (size_t j = (i + 1) & mask_; table_[j].slot != kNil; j = (j + 1) & mask_)
+                if (((j - home(table_[j].id)) & mask_) >= ((j - i) & mask_))
+                {
+                    table_[i] = table_[j];
+                    i = j;
+                }
+            table_[i].slot = kNil;
+            --size_;
+            return true;
+        }
+
+        // Sizes the table so n ids fit without rehashing.
+        void reserve(size_t n)
+        {
+            size_t cap = kMinCapacity;
+            while (cap < n * 2)
+                cap *= 2;
+            if (cap > table_.size())
+                rehash(cap);
+        }
+
+        // Keeps the table's capacity, like the pools' clear().
+        void clear() noexcept
+        {
+            for (Entry &e : table_)
+                e.slot = kNil;
+            size_ = 0;
+        }
+
+        size_t size() const noexcept { return size_; }
+        size_t capacity() const noexcept { return table_.size(); }
+
+        // Requests the cache line find(id) will start probing at.
+        void prefetch(uint64_t id) const noexcept
+        {
+            if (!table_.empty())
+                __builtin_prefetch(&table_[home(id)], 1);
+        }
+
+    private:
+        struct Entry
+        {
+            uint64_t id{0};
+            uint32_t slot{kNil};
+            uint32_t reserved{0};
+        };
+
+        static constexpr size_t kMinCapacity = 16;
+
+        size_t home(uint64_t id) const noexcept
+        {
+            return static_cast<size_t>((id * 0x9E3779B97F4A7C15ull) >> shift_);
+        }
+
+        void rehash(size_t cap)
+        {
+            HugeVector<Entry> old(cap);
+            old.swap(table_);
+            mask_ = cap - 1;
+            shift_ = 64u - static_cast<unsigned>(__builtin_ctzll(cap));
+            for (const Entry &e : old)
+                if (e.slot != kNil)
+                {
+                    size_t i = home(e.id);
+                    while (table_[i].slot != kNil)
+                        i = (i + 1) & mask_;
+                    table_[i] = e;
+                }
+        }
+
+        HugeVector<Entry> table_;
+        size_t mask_{0};
+        unsigned shift_{64};
+        size_t size_{0};
+    };
+
+} // namespace lob
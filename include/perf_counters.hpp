@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace lob
+{
+    // One counter for perf_event_open: the perf type/config pair and the
+    // name it is reported under (bench.jsonl keys, metrics.prom labels).
+    struct PerfEventSpec
+    {
+        const char *name;
+        uint32_t type;
+        uint64_t config;
+    };
+
+    inline constexpr size_t kMaxPerfCounters = 8;
+
+    // cycles, instructions, L1D read misses, LLC misses, branch misses and
+    // dTLB read misses, in that order. IPC is instructions / cycles.
+    std::span<const PerfEventSpec> hardware_perf_events();
+
+    // node_loads and node_misses: reads that went to memory, and those of
+    // them served by a remote node. Kept out of hardware_perf_events() so
+    // the six-counter group still fits the PMU in one schedule.
+    std::span<const PerfEventSpec> numa_perf_events();
+
+    // Counter values at one instant, in PerfCounterGroup::open() order and
+    // already scaled for multiplexing (time enabled / time running).
+    struct PerfReading
+    {
+        std::array<uint64_t, kMaxPerfCounters> value{};
+    };
+
+    // A group of counters for the calling thread, user space only
+    // (exclude_kernel, so it works at perf_event_paranoid <= 2), read
+    // together with one read() of the group leader. The first spec is the
+    // leader: if it cannot be opened the group is unavailable and error()
+    // says why (no PMU, paranoid level, seccomp, non-Linux). Later specs
+    // the PMU does not support are dropped individually; available(i)
+    // reports which ones made it.
+    class PerfCounterGroup
+    {
+    public:
+        PerfCounterGroup() { fds_.fill(-1); }
+        ~PerfCounterGroup();
+        PerfCounterGroup(const PerfCounterGroup &) = delete;
+        PerfCounterGroup &operator=(const PerfCounterGroup &) = delete;
+
+        bool open(std::span<const PerfEventSpec> events);
+        void close();
+
+        // Counters start disabled; enable() resets and starts them.
+        bool enable();
+        bool disable();
+        bool read(PerfReading &out) const;
+
+        bool active() const noexcept { return leader_ >= 0; }
+        const std::string &error() const noexcept { return error_; }
+        size_t size() const noexcept { return count_; }
+        const char *name(size_t i) const noexcept { return specs_[i].name; }
+        bool available(size_t i) const noexcept { return fds_[i] >= 0; }
+        // time running / time enabled at the last read(); below 1 when the
+        // kernel multiplexed the group with other users of the PMU.
+        double running_fraction() const noexcept { return running_fraction_; }
+
+    private:
+        std::array<PerfEventSpec, kMaxPerfCounters> specs_{};
+        std::array<int, kMaxPerfCounters> fds_{};
+        size_t count_{0};
+        size_t opened_{0};
+        int leader_{-1};
+        std::string error_;
+        mutable double running_fraction_{1.0};
+    };
+
+    // Accumulates counter deltas over regions. The read cost between two
+    // back-to-back reads is measured once by calibrate() and subtracted from
+    // every region so short stages are not dominated by it.
+    struct PerfRegion
+    {
+        std::array<uint64_t, kMaxPerfCounters> total{};
+        uint64_t samples{0};
+
+        void add(const PerfReading &from, const PerfReading &to, const PerfReading &overhead, size_t n) noexcept
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                const uint64_t d = to.value[i] - from.value[i];
+                total[i] += d > overhead.value[i] ? d - overhead.value[i] : 0;
+            }
+            ++samples;
+        }
+    };
+
+    // Minimum per-counter delta of an empty region over a few tries.
+    PerfReading calibrate(const PerfCounterGroup &g);
+} // namespace lob
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Startup steps for a latency-critical run (replay --realtime): lock every
+// page, fault the hot buffers in before the loop instead of during it,
+// optionally run under SCHED_FIFO, and check that the pinned core is kept
+// free of other work (isolcpus / nohz_full on the kernel command line).
+namespace lob
+{
+    // mlockall(MCL_CURRENT | MCL_FUTURE): resident now, and every later
+    // mapping (heap growth, new huge-page blocks) is populated when made.
+    bool lock_all_memory(std::string &err);
+
+    // Stops glibc from returning heap to the kernel and from serving large
+    // blocks with fresh mmaps, then grows the heap by `bytes` and touches
+    // it, so later allocations are carved from resident memory.
+    void reserve_heap(size_t bytes);
+
+    // SCHED_FIFO at priority (1..99) for the calling thread.
+    bool set_fifo_priority(int priority, std::string &err);
+
+    // Whether cpu appears in root/<list>, a cpulist such as "isolated" or
+    // "nohz_full" under /sys/devices/system/cpu. False if the file is absent.
+    bool cpu_listed(const char *list, int cpu, const std::string &root = "/sys/devices/system/cpu");
+
+    // Minor and major page faults of the calling thread so far.
+    struct FaultCounts
+    {
+        uint64_t minor{0}, major{0};
+    };
+    FaultCounts thread_faults();
+
+    // Writes each 4 KiB page of [p, p + len) back with its own value: the
+    // page becomes resident and private without changing its contents.
+    inline void prefault(void *p, size_t len) noexcept
+    {
+        auto *b = static_cast<volatile unsigned char *>(p);
+        for (size_t i = 0; i < len; i += 4096)
+            b[i] = b[i];
+    }
+} // namespace lob
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Per-stage replay timers. Build with LOB_STAGE_TIMERS=0 (CMake
+// -DENABLE_STAGE_TIMERS=OFF) and StageLap compiles to nothing: no clock
+// reads, no histogram writes. Replay times the stages of every
+// LOB_STAGE_TIMER_STRIDE-th event; a clock read costs about as much as a
+// short stage, so timing every event would double per-event latency.
+#ifndef LOB_STAGE_TIMERS
+#define LOB_STAGE_TIMERS 1
+#endif
+#ifndef LOB_STAGE_TIMER_STRIDE
+#define LOB_STAGE_TIMER_STRIDE 8
+#endif
+
+namespace lob
+{
+    inline constexpr bool kStageTimers = LOB_STAGE_TIMERS != 0;
+    inline constexpr uint64_t kStageTimerStride = LOB_STAGE_TIMER_STRIDE;
+    static_assert(kStageTimerStride > 0);
+
+    // The stages of one replayed event, in loop order. decode includes the
+    // digest update over the raw bytes.
+    enum class Stage : uint8_t
+    {
+        decode = 0,
+        book = 1,
+        detectors = 2,
+        breaker = 3,
+        publish = 4,
+    };
+    inline constexpr size_t kStageCount = 5;
+    inline constexpr const char *kStageNames[kStageCount] = {"decode", "book", "detectors", "breaker", "publish"};
+
+    // Log-linear nanosecond histogram: exact below 16 ns, then 16 buckets
+    // per power of two (at most 1/16 relative error) up to 2^40 ns. Fixed
+    // size, so recording never allocates.
+    class LatencyHistogram
+    {
+    public:
+        static constexpr unsigned kSubBits = 4;
+        static constexpr unsigned kSub = 1u << kSubBits;
+        static constexpr size_t kBuckets = (40 - kSubBits + 1) * kSub;
+
+        void record(uint64_t ns) noexcept
+        {
+            ++counts_[index(ns)];
+            ++count_;
+            sum_ += ns;
+        }
+
+        uint64_t count() const noexcept { return count_; }
+        uint64_t sum() const noexcept { return sum_; }
+
+        // Upper edge of the bucket holding the q-quantile (0 if empty).
+        uint64_t quantile(double q) const noexcept
+        {
+            if (count_ == 0)
+                return 0;
+            const uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count_ - 1)) + 1;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < kBuckets; ++i)
+                if ((seen += counts_[i]) >= rank)
+                    return upper(i);
+            return upper(kBuckets - 1);
+        }
+
+        static size_t index(uint64_t ns) noexcept
+        {
+            if (ns < kSub)
+                return static_cast<size_t>(ns);
+            const unsigned e = std::min(63u - static_cast<unsigned>(std::countl_zero(ns)), 39u);
+            const uint64_t sub = (ns >> (e - kSubBits)) & (kSub - 1);
+            return std::min<size_t>((e - kSubBits + 1) * kSub + sub, kBuckets - 1);
+        }
+
+        static uint64_t upper(size_t i) noexcept
+        {
+            if (i < kSub)
+                return i;
+            const unsigned e = static_cast<unsigned>(i / kSub) + kSubBits - 1;
+            return ((kSub + i % kSub + 1) << (e - kSubBits)) - 1;
+        }
+
+    private:
+        std::array<uint64_t, kBuckets> counts_{};
+        uint64_t count_{0};
+        uint64_t sum_{0};
+    };
+
+    using StageHistograms = std::array<LatencyHistogram, kStageCount>;
+
+    // Times consecutive stages of one event from a shared start stamp: each
+    // mark() closes the stage that just ran, opens the next and returns the
+    // closed stage's nanoseconds, so five stages cost five clock reads. An
+    // inactive lap reads no clock and returns 0.
+    template <bool Enabled = kStageTimers>
+    class BasicStageLap
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        BasicStageLap(StageHistograms &h, clock::time_point start, bool active = true) noexcept
+            : h_(h), last_(start), active_(active)
+        {
+        }
+
+        uint64_t mark(Stage s) noexcept
+        {
+            if constexpr (Enabled)
+            {
+                if (!active_)
+                    return 0;
+                const auto now = clock::now();
+                const auto ns = static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_).count());
+                h_[static_cast<size_t>(s)].record(ns);
+                last_ = now;
+                return ns;
+            }
+            return 0;
+        }
+
+    private:
+        StageHistograms &h_;
+        clock::time_point last_;
+        bool active_;
+    };
+    using StageLap = BasicStageLap<>;
+} // namespace lob
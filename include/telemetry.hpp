@@ -3,11 +3,23 @@
 #include "breaker.hpp"
 #include <cstdint>
 #include <string>
+#include <vector>
 namespace lob
 {
+    // One replay stage's latency distribution (stage timers, in ns).
+    struct StageLatency
+    {
+        std::string stage;
+        uint64_t count{0};
+        double mean_ns{0.0}, p50_ns{0.0}, p99_ns{0.0}, p999_ns{0.0};
+        uint64_t sum_ns{0};
+    };
+
     struct TelemetrySnapshot
     {
         std::string input_path, golden_digest_hex, actual_digest_hex;
+        std::string book_digest_hex; // end-state digest over all books
+        uint64_t book_orders{0};
         bool determinism_pass{false};
         double p50_ms{0.0}, p95_ms{0.0}, p99_ms{0.0};
         double p999_ms{0.0};  // p99.9  — tail beyond p99
@@ -16,6 +28,58 @@ namespace lob
         bool p999_valid{false};
         bool p9999_valid{false};
         int cpu_pin{-1};
+        // Forked state dumps (checkpoints / --snapshot-at). cow_faults counts
+        // parent minor faults while dump children were alive.
+        uint64_t snapshots{0}, snapshot_failures{0};
+        double fork_ms_mean{0.0}, fork_ms_max{0.0};
+        uint64_t cow_faults{0}, cow_faults_max{0};
+        // Live feed receive path (replay --adapter mold). The histograms are
+        // log2 bucket counts: bucket i holds values in [2^(i-1), 2^i).
+        bool feed_active{false};
+        uint64_t feed_packets{0}, feed_gaps{0}, feed_missing{0}, feed_kernel_drops{0};
+        uint64_t feed_recovered{0}, feed_rewind_requests{0};
+        double feed_batch_mean{0.0};
+        double feed_wake_p50_us{0.0}, feed_wake_p99_us{0.0}, feed_wake_max_us{0.0};
+        std::vector<uint64_t> feed_batch_hist, feed_wake_ns_hist;
+        uint64_t feed_batch_sum{0}, feed_wake_ns_sum{0};
+        // Per-stage latency; empty when stage timers are compiled out.
+        std::vector<StageLatency> stages;
+        // Hardware counters (replay --perf-counters) per message, for the
+        // whole replay loop and for each stage of sampled messages. A
+        // negative value means the PMU did not provide that counter.
+        bool perf_requested{false};
+        std::string perf_error; // why counters are unavailable, if they are
+        double perf_ipc{0.0}, perf_running{1.0};
+        uint64_t perf_stage_samples{0};
+        std::vector<std::string> perf_names, perf_stages;
+        std::vector<double> perf_per_msg, perf_stage_ipc;
+        std::vector<std::vector<double>> perf_stage_per_msg; // [stage][counter]
+        // Huge-page policy (replay --hugepages; empty when not reported) and
+        // what it obtained: the largest page size backing the large arrays,
+        // peak bytes mapped MAP_HUGETLB and THP-advised, and how much of the
+        // advised memory the kernel really backed with huge pages.
+        std::string hugepages;
+        uint64_t hugepage_size{0};
+        uint64_t hugepage_hugetlb_bytes{0}, hugepage_thp_bytes{0}, hugepage_thp_backed_bytes{0};
+        // NUMA placement: nodes discovered, the node of the --cpu-pin core
+        // (-1 unpinned or unknown), bytes mapped preferring it, the fraction
+        // of input pages found on it, and node misses / node loads from perf
+        // counters. The last two are negative when they could not be measured.
+        int numa_nodes{0}, numa_node{-1};
+        uint64_t numa_bound_bytes{0};
+        double numa_input_local{-1.0}, numa_remote_ratio{-1.0};
+        // --realtime: memory locked, SCHED_FIFO priority obtained (0 = none),
+        // whether the --cpu-pin core is in isolcpus / nohz_full, and what
+        // failed. Page faults of the replay thread are sampled right before
+        // and after the hot loop on every run.
+        bool rt_requested{false}, rt_locked{false}, rt_isolated{false}, rt_nohz_full{false};
+        int rt_fifo_priority{0};
+        std::string rt_error;
+        uint64_t faults_minor_before{0}, faults_minor_after{0}, faults_major_before{0}, faults_major_after{0};
+        // --prefetch-distance: events of order-index lookahead (0 = off).
+        int prefetch_distance{0};
+        // Flight-recorder ring size (0 = off) and dumps taken this run.
+        uint64_t flight_records{0}, flight_dumps{0};
         DetectorReadings readings{};
         BreakerState breaker{};
         bool publish_allowed{true};
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Reader for replay --trace-out files (BQLTRC columnar traces).
+
+A trace is a 64-byte header, a table of 32-byte column descriptors and one
+64-byte aligned little-endian array per column (see
+include/message_trace.hpp). This script summarises where the tail lives
+and can export the rows for other tools:
+
+Usage:
+    python scripts/trace_frame.py trace.bin [--top N] [--quantile Q] [--csv OUT]
+
+In Python, ``load(path)`` returns a dict of column name -> array.array, and
+``to_dataframe(path)`` returns a pandas DataFrame (needs numpy and pandas;
+columns are zero-copy views of the file). duckdb reads the --csv export
+directly: ``SELECT * FROM 'trace.csv'``.
+"""
+
+from __future__ import annotations
+
+import argparse
+import array
+import struct
+import sys
+from pathlib import Path
+from typing import Dict, List, Tuple
+
+MAGIC = b"BQLTRC\0\0"
+HEADER = struct.Struct("<8sIIII5Q")
+COLUMN = struct.Struct("<16s4sIQ")
+TYPECODES = {1: "B", 2: "H", 4: "I", 8: "Q"}
+MSG_TYPES = ("add", "execute", "cancel", "delete")
+APPLIED, STAGED, PERF = 1, 2, 4
+
+
+def read_layout(buf) -> Tuple[dict, List[Tuple[str, str, int, int]]]:
+    """Header fields and (name, dtype, width, offset) per column of any buffer."""
+    if len(buf) < HEADER.size:
+        raise ValueError("file shorter than a trace header")
+    magic, version, header_bytes, column_count, _, rows, dropped, first, file_bytes, _ = HEADER.unpack_from(buf)
+    if magic != MAGIC or version != 1:
+        raise ValueError("not a version 1 BQLTRC trace")
+    if file_bytes != len(buf):
+        raise ValueError(f"truncated trace: {len(buf)} of {file_bytes} bytes")
+    cols = []
+    for c in range(column_count):
+        name, dtype, width, offset = COLUMN.unpack_from(buf, header_bytes + c * COLUMN.size)
+        cols.append((name.rstrip(b"\0").decode(), dtype.rstrip(b"\0").decode(), width, offset))
+    return {"rows": rows, "dropped": dropped, "first_msg": first}, cols
+
+
+def load(path: str) -> Dict[str, array.array]:
+    buf = Path(path).read_bytes()
+    header, cols = read_layout(buf)
+    rows = header["rows"]
+    out = {}
+    for name, _, width, offset in cols:
+        a = array.array(TYPECODES[width])
+        a.frombytes(buf[offset : offset + rows * width])
+        if sys.byteorder != "little":
+            a.byteswap()
+        out[name] = a
+    return out
+
+
+def to_dataframe(path: str):
+    import numpy as np
+    import pandas as pd
+
+    mm = np.memmap(path, dtype=np.uint8, mode="r")
+    header, cols = read_layout(mm)
+    rows = header["rows"]
+    data = {
+        name: np.frombuffer(mm, dtype=np.dtype(dtype), count=rows, offset=offset) for name, dtype, _, offset in cols
+    }
+    return pd.DataFrame(data)
+
+
+def quantile(sorted_values: List[int], q: float) -> int:
+    if not sorted_values:
+        return 0
+    return sorted_values[min(len(sorted_values) - 1, int(q * (len(sorted_values) - 1)))]
+
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("trace")
+    ap.add_argument("--top", type=int, default=10, help="slowest rows to list (default 10)")
+    ap.add_argument("--quantile", type=float, default=0.9999, help="tail cut per message type (default 0.9999)")
+    ap.add_argument("--csv", help="also write every row as CSV")
+    args = ap.parse_args(argv)
+
+    cols = load(args.trace)
+    n = len(cols["msg_index"])
+    # Stage-timed and perf-sampled rows carry instrumentation reads; like the
+    # replay percentiles, the summary leaves them out.
+    plain = [r for r in range(n) if not cols["flags"][r] & (STAGED | PERF)]
+    print(f"rows={n} plain={len(plain)}")
+    for t, name in enumerate(MSG_TYPES):
+        lat = sorted(cols["total_ns"][r] for r in plain if cols["type"][r] == t)
+        if lat:
+            print(
+                f"{name:8s} n={len(lat):9d} p50={quantile(lat, 0.5)}ns p99={quantile(lat, 0.99)}ns "
+                f"p{args.quantile * 100:g}={quantile(lat, args.quantile)}ns max={lat[-1]}ns"
+            )
+    print(f"slowest {args.top}:")
+    print("msg_index type symbol total_ns bid_levels ask_levels orders")
+    for r in sorted(plain, key=lambda r: cols["total_ns"][r], reverse=True)[: args.top]:
+        print(
+            cols["msg_index"][r],
+            MSG_TYPES[cols["type"][r]],
+            cols["symbol"][r],
+            cols["total_ns"][r],
+            cols["bid_levels"][r],
+            cols["ask_levels"][r],
+            cols["orders"][r],
+        )
+    if args.csv:
+        names = list(cols)
+        with open(args.csv, "w", encoding="utf-8") as f:
+            f.write(",".join(names) + "\n")
+            for r in range(n):
+                f.write(",".join(str(cols[c][r]) for c in names) + "\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,281 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "book_snapshot.hpp"
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lob
+{
+    static size_t align_up(size_t v) { return (v + kSnapshotAlign - 1) & ~(kSnapshotAlign - 1); }
+
+    static uint64_t fnv1a(const uint8_t *p, size_t n)
+    {
+        uint64_t h = 1469598103934665603ull;
+        for (size_t i = 0; i < n; ++i)
+        {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    static void flatten_side(const OrderBook &b, const HugeVector<Level> &side,
+                             std::vector<SnapshotLevel> &levels, std::vector<SnapshotOrder> &orders)
+    {
+        for (auto it = side.rbegin(); it != side.rend(); ++it)
+        {
+            SnapshotLevel l{it->px, it->qty, it->count, static_cast<uint32_t>(orders.size())};
+            levels.push_back(l);
+            const uint8_t side_id = &side == &b.bids() ? 0 : 1;
+            for (uint32_t s = it->head; s != OrderBook::kNil; s = b.next(s))
+            {
+                SnapshotOrder o{};
+                o.id = b.order_id(s);
+                o.px = b.order_px(s);
+                o.qty = b.order_qty(s);
+                o.side = side_id;
+                orders.push_back(o);
+            }
+        }
+    }
+
+    std::vector<uint8_t> encode_snapshot(std::span<const OrderBook> books, uint64_t msg_index,
+                                         const SnapshotEngine *engine)
+    {
+        struct Pending
+        {
+            SnapshotSection sec;
+            std::vector<uint8_t> bytes;
+        };
+        std::vector<Pending> pending;
+        auto push = [&](SectionKind k, uint32_t book, const void *data, size_t count, size_t elem)
+        {
+            Pending p{};
+            p.sec.kind = static_cast<uint32_t>(k);
+            p.sec.book = book;
+            p.sec.count = count;
+            p.sec.bytes = count * elem;
+            p.bytes.assign(static_cast<const uint8_t *>(data),
+                           static_cast<const uint8_t *>(data) + p.sec.bytes);
+            pending.push_back(std::move(p));
+        };
+        if (engine)
+            push(SectionKind::Engine, 0, engine, 1, sizeof(SnapshotEngine));
+        for (uint32_t i = 0; i < books.size(); ++i)
+        {
+            std::vector<SnapshotLevel> bids, asks;
+            std::vector<SnapshotOrder> orders;
+            flatten_side(books[i], books[i].bids(), bids, orders);
+            flatten_side(books[i], books[i].asks(), asks, orders);
+            push(SectionKind::Bids, i, bids.data(), bids.size(), sizeof(SnapshotLevel));
+            push(SectionKind::Asks, i, asks.data(), asks.size(), sizeof(SnapshotLevel));
+            push(SectionKind::Orders, i, orders.data(), orders.size(), sizeof(SnapshotOrder));
+        }
+
+        const size_t table_end = sizeof(SnapshotHeader) + pending.size() * sizeof(SnapshotSection);
+        size_t off = align_up(table_end);
+        for (auto &p : pending)
+        {
+            p.sec.offset = off;
+            off = align_up(off + p.sec.bytes);
+        }
+
+        std::vector<uint8_t> out(off, 0);
+        SnapshotHeader h{};
+        std::memcpy(h.magic, kSnapshotMagic, sizeof(h.magic));
+        h.version = kSnapshotVersion;
+        h.header_bytes = sizeof(SnapshotHeader);
+        h.section_count = static_cast<uint32_t>(pending.size());
+        h.book_count = static_cast<uint32_t>(books.size());
+        h.msg_index = msg_index;
+        h.file_bytes = out.size();
+        for (size_t i = 0; i < pending.size(); ++i)
+        {
+            std::memcpy(out.data() + sizeof(SnapshotHeader) + i * sizeof(SnapshotSection),
+                        &pending[i].sec, sizeof(SnapshotSection));
+            if (!pending[i].bytes.empty())
+                std::memcpy(out.data() + pending[i].sec.offset, pending[i].bytes.data(), pending[i].bytes.size());
+        }
+        h.payload_fnv = fnv1a(out.data() + table_end, out.size() - table_end);
+        std::memcpy(out.data(), &h, sizeof(h));
+        return out;
+    }
+
+    bool write_snapshot(const std::string &path, std::span<const OrderBook> books, uint64_t msg_index,
+                        const SnapshotEngine *engine)
+    {
+        if constexpr (std::endian::native != std::endian::little)
+            return false;
+        const auto img = encode_snapshot(books, msg_index, engine);
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            if (!f)
+                return false;
+            f.write(reinterpret_cast<const char *>(img.data()), static_cast<std::streamsize>(img.size()));
+            if (!f.good())
+                return false;
+        }
+        return std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
+
+    SnapshotView::~SnapshotView() { close(); }
+
+    SnapshotView::SnapshotView(SnapshotView &&o) noexcept : base_(o.base_), size_(o.size_)
+    {
+        o.base_ = nullptr;
+        o.size_ = 0;
+    }
+
+    SnapshotView &SnapshotView::operator=(SnapshotView &&o) noexcept
+    {
+        if (this != &o)
+        {
+            close();
+            base_ = o.base_;
+            size_ = o.size_;
+            o.base_ = nullptr;
+            o.size_ = 0;
+        }
+        return *this;
+    }
+
+    void SnapshotView::close()
+    {
+        if (base_)
+            ::munmap(const_cast<uint8_t *>(base_), size_);
+        base_ = nullptr;
+        size_ = 0;
+    }
+
+    bool SnapshotView::open(const std::string &path, std::string &err)
+    {
+        close();
+        err.clear();
+        if constexpr (std::endian::native != std::endian::little)
+        {
+            err = "snapshot format is little-endian only";
+            return false;
+        }
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            err = "open failed: " + path;
+            return false;
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader))
+        {
+            ::close(fd);
+            err = "snapshot too small: " + path;
+            return false;
+        }
+        void *p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+        {
+            err = "mmap failed: " + path;
+            return false;
+        }
+        base_ = static_cast<const uint8_t *>(p);
+        size_ = static_cast<size_t>(st.st_size);
+
+        const auto &h = header();
+        if (std::memcmp(h.magic, kSnapshotMagic, sizeof(h.magic)) != 0)
+            err = "bad snapshot magic";
+        else if (h.version != kSnapshotVersion)
+            err = "unsupported snapshot version " + std::to_string(h.version);
+        else if (h.header_bytes != sizeof(SnapshotHeader) || h.file_bytes != size_)
+            err = "snapshot size mismatch";
+        else if (sizeof(SnapshotHeader) + size_t(h.section_count) * sizeof(SnapshotSection) > size_)
+            err = "snapshot section table truncated";
+        if (err.empty())
+        {
+            const auto *sec = reinterpret_cast<const SnapshotSection *>(base_ + sizeof(SnapshotHeader));
+            for (uint32_t i = 0; i < h.section_count && err.empty(); ++i)
+            {
+                if (sec[i].offset % kSnapshotAlign != 0 || sec[i].offset > size_ ||
+                    sec[i].bytes > size_ - sec[i].offset || sec[i].book >= h.book_count)
+                    err = "snapshot section out of bounds";
+            }
+        }
+        if (!err.empty())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool SnapshotView::verify() const
+    {
+        if (!base_)
+            return false;
+        const size_t table_end = sizeof(SnapshotHeader) + size_t(header().section_count) * sizeof(SnapshotSection);
+        return fnv1a(base_ + table_end, size_ - table_end) == header().payload_fnv;
+    }
+
+    const SnapshotSection *SnapshotView::find(SectionKind kind, uint32_t book) const
+    {
+        const auto *sec = reinterpret_cast<const SnapshotSection *>(base_ + sizeof(SnapshotHeader));
+        for (uint32_t i = 0; i < header().section_count; ++i)
+            if (sec[i].kind == static_cast<uint32_t>(kind) && sec[i].book == book)
+                return &sec[i];
+        return nullptr;
+    }
+
+    template <typename T>
+    static std::span<const T> section_span(const uint8_t *base, const SnapshotSection *s)
+    {
+        if (!s || s->bytes != s->count * sizeof(T))
+            return {};
+        return {reinterpret_cast<const T *>(base + s->offset), static_cast<size_t>(s->count)};
+    }
+
+    std::span<const SnapshotLevel> SnapshotView::bids(uint32_t book) const
+    {
+        return section_span<SnapshotLevel>(base_, find(SectionKind::Bids, book));
+    }
+    std::span<const SnapshotLevel> SnapshotView::asks(uint32_t book) const
+    {
+        return section_span<SnapshotLevel>(base_, find(SectionKind::Asks, book));
+    }
+    std::span<const SnapshotOrder> SnapshotView::orders(uint32_t book) const
+    {
+        return section_span<SnapshotOrder>(base_, find(SectionKind::Orders, book));
+    }
+
+    const SnapshotEngine *SnapshotView::engine() const
+    {
+        const auto *s = find(SectionKind::Engine, 0);
+        if (!s || s->bytes != sizeof(SnapshotEngine))
+            return nullptr;
+        return reinterpret_cast<const SnapshotEngine *>(base_ + s->offset);
+    }
+
+    bool restore_snapshot(const SnapshotView &view, std::span<OrderBook> books)
+    {
+        if (books.size() != view.book_count())
+            return false;
+        for (uint32_t i = 0; i < books.size(); ++i)
+        {
+            auto &b = books[i];
+            b.clear();
+            const auto orders = view.orders(i);
+            b.reserve(orders.size());
+            // Orders are stored in queue order per level, so re-adding them in
+            // sequence reproduces both the levels and time priority.
+            for (const auto &o : orders)
+            {
+                if (!b.add(o.id, o.side ? Side::Ask : Side::Bid, o.px, o.qty))
+                    return false;
+            }
+        }
+        return true;
+    }
+} // namespace lob
@@ -7,6 +7,11 @@ BreakerState Breaker::state() const { return st_; }
 bool Breaker::publish_allowed() const {
   return st_ == BreakerState::Fuse || st_ == BreakerState::Local;
 }
+bool Breaker::latched() const { return latched_; }
+void Breaker::restore(BreakerState s, bool latched) {
+  st_ = s;
+  latched_ = latched;
+}
 void Breaker::clear_latch() {
   latched_ = false;
   if (st_ != BreakerState::Kill)
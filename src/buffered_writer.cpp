@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "buffered_writer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace lob
+{
+    bool BufferedWriter::open(const std::string &path)
+    {
+        close();
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        ok_ = fd_ >= 0;
+        used_ = 0;
+        total_ = 0;
+        return ok_;
+    }
+
+    bool BufferedWriter::flush()
+    {
+        size_t off = 0;
+        while (off < used_ && fd_ >= 0)
+        {
+            ssize_t n = ::write(fd_, buf_.data() + off, used_ - off);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                ok_ = false;
+                break;
+            }
+            off += static_cast<size_t>(n);
+        }
+        total_ += off;
+        used_ = 0;
+        return ok_;
+    }
+
+    bool BufferedWriter::write(const void *p, size_t n)
+    {
+        const auto *src = static_cast<const uint8_t *>(p);
+        while (n > 0)
+        {
+            if (used_ == buf_.size() && !flush())
+                return false;
+            const size_t k = std::min(n, buf_.size() - used_);
+            std::memcpy(buf_.data() + used_, src, k);
+            used_ += k;
+            src += k;
+            n -= k;
+        }
+        return true;
+    }
+
+    bool BufferedWriter::close()
+    {
+        if (fd_ < 0)
+            return ok_;
+        flush();
+        if (::close(fd_) != 0)
+            ok_ = false;
+        fd_ = -1;
+        return ok_;
+    }
+} // namespace lob
@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "capture_index.hpp"
+#include "event.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lob
+{
+    static constexpr size_t kIndexAlign = 64;
+    static constexpr size_t kFingerprintBytes = 4096;
+
+    static size_t align_up(size_t v) { return (v + kIndexAlign - 1) & ~(kIndexAlign - 1); }
+
+    static uint64_t fnv1a(uint64_t h, const uint8_t *p, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    uint64_t capture_fingerprint(std::span<const uint8_t> capture)
+    {
+        const size_t n = std::min(capture.size(), kFingerprintBytes);
+        uint64_t h = fnv1a(1469598103934665603ull, capture.data(), n);
+        return fnv1a(h, capture.data() + capture.size() - n, n);
+    }
+
+    std::vector<uint8_t> build_capture_index(std::span<const uint8_t> capture, uint32_t stride, std::string &err)
+    {
+        if (capture.size() % kEventSize != 0)
+        {
+            err = "capture size is not a whole number of " + std::to_string(kEventSize) + "-byte events";
+            return {};
+        }
+        const uint64_t n = capture.size() / kEventSize;
+        if (n > UINT32_MAX)
+        {
+            err = "capture has more than 2^32 events";
+            return {};
+        }
+        stride = std::max<uint32_t>(stride, 1);
+
+        std::vector<IndexSymbol> symbols(kSymbolCount);
+        std::vector<std::vector<uint32_t>> postings(kSymbolCount);
+        std::vector<IndexSample> samples;
+        samples.reserve(static_cast<size_t>(n / stride + 1));
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            const uint64_t off = i * kEventSize;
+            const Event ev = decode_event(capture.data() + off, i);
+            if (i % stride == 0)
+                samples.push_back(IndexSample{off, ev.ts_ns});
+            IndexSymbol &s = symbols[ev.symbol];
+            if (s.count++ == 0)
+                s.first_offset = off;
+            s.last_offset = off;
+            postings[ev.symbol].push_back(static_cast<uint32_t>(i));
+        }
+
+        size_t at = align_up(sizeof(IndexHeader) + symbols.size() * sizeof(IndexSymbol));
+        const size_t samples_at = at;
+        at = align_up(at + samples.size() * sizeof(IndexSample));
+        for (uint32_t s = 0; s < kSymbolCount; ++s)
+        {
+            symbols[s].postings_offset = at;
+            at = align_up(at + postings[s].size() * sizeof(uint32_t));
+        }
+
+        std::vector<uint8_t> img(at, 0);
+        IndexHeader h{};
+        std::memcpy(h.magic, kIndexMagic, sizeof(h.magic));
+        h.version = kIndexVersion;
+        h.header_bytes = sizeof(IndexHeader);
+        h.event_bytes = static_cast<uint32_t>(kEventSize);
+        h.stride = stride;
+        h.symbol_count = kSymbolCount;
+        h.event_count = n;
+        h.capture_bytes = capture.size();
+        h.capture_fnv = capture_fingerprint(capture);
+        h.file_bytes = img.size();
+        std::memcpy(img.data(), &h, sizeof(h));
+        std::memcpy(img.data() + sizeof(h), symbols.data(), symbols.size() * sizeof(IndexSymbol));
+        std::memcpy(img.data() + samples_at, samples.data(), samples.size() * sizeof(IndexSample));
+        for (uint32_t s = 0; s < kSymbolCount; ++s)
+            std::memcpy(img.data() + symbols[s].postings_offset, postings[s].data(),
+                        postings[s].size() * sizeof(uint32_t));
+        return img;
+    }
+
+    bool write_capture_index(const std::string &path, std::span<const uint8_t> image)
+    {
+        if constexpr (std::endian::native != std::endian::little)
+            return false;
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            if (!f)
+                return false;
+            f.write(reinterpret_cast<const char *>(image.data()), static_cast<std::streamsize>(image.size()));
+            if (!f.good())
+                return false;
+        }
+        return std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
+
+    CaptureIndexView::~CaptureIndexView() { close(); }
+
+    void CaptureIndexView::close()
+    {
+        if (base_)
+            ::munmap(const_cast<uint8_t *>(base_), size_);
+        base_ = nullptr;
+        size_ = 0;
+    }
+
+    bool CaptureIndexView::open(const std::string &path, std::string &err)
+    {
+        close();
+        if constexpr (std::endian::native != std::endian::little)
+        {
+            err = "index format is little-endian only";
+            return false;
+        }
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            err = "open failed: " + path;
+            return false;
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(IndexHeader))
+        {
+            ::close(fd);
+            err = "index too small: " + path;
+            return false;
+        }
+        void *p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+        {
+            err = "mmap failed: " + path;
+            return false;
+        }
+        base_ = static_cast<const uint8_t *>(p);
+        size_ = static_cast<size_t>(st.st_size);
+
+        const auto &h = header();
+        const size_t tables = sizeof(IndexHeader) + size_t(h.symbol_count) * sizeof(IndexSymbol);
+        if (std::memcmp(h.magic, kIndexMagic, sizeof(h.magic)) != 0)
+            err = "bad index magic";
+        else if (h.version != kIndexVersion)
+            err = "unsupported index version " + std::to_string(h.version);
+        else if (h.header_bytes != sizeof(IndexHeader) || h.file_bytes != size_ || h.event_bytes != kEventSize ||
+                 h.stride == 0 || tables > size_)
+            err = "index size mismatch";
+        else if (align_up(tables) + samples().size_bytes() > size_)
+            err = "index sample table truncated";
+        for (uint32_t s = 0; err.empty() && s < h.symbol_count; ++s)
+        {
+            const IndexSymbol &sym = symbols()[s];
+            if (sym.postings_offset % kIndexAlign != 0 || sym.postings_offset > size_ ||
+                sym.count > (size_ - sym.postings_offset) / sizeof(uint32_t))
+                err = "index postings out of bounds";
+        }
+        if (!err.empty())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool CaptureIndexView::matches(std::span<const uint8_t> capture) const
+    {
+        return capture.size() == header().capture_bytes && capture_fingerprint(capture) == header().capture_fnv;
+    }
+
+    std::span<const IndexSymbol> CaptureIndexView::symbols() const
+    {
+        return {reinterpret_cast<const IndexSymbol *>(base_ + sizeof(IndexHeader)), header().symbol_count};
+    }
+
+    std::span<const IndexSample> CaptureIndexView::samples() const
+    {
+        const auto &h = header();
+        const size_t at = align_up(sizeof(IndexHeader) + size_t(h.symbol_count) * sizeof(IndexSymbol));
+        return {reinterpret_cast<const IndexSample *>(base_ + at),
+                static_cast<size_t>((h.event_count + h.stride - 1) / h.stride)};
+    }
+
+    std::span<const uint32_t> CaptureIndexView::postings(uint32_t symbol) const
+    {
+        if (symbol >= header().symbol_count)
+            return {};
+        const IndexSymbol &s = symbols()[symbol];
+        return {reinterpret_cast<const uint32_t *>(base_ + s.postings_offset), static_cast<size_t>(s.count)};
+    }
+
+    uint64_t CaptureIndexView::seek_time(std::span<const uint8_t> capture, uint64_t t) const
+    {
+        const auto smp = samples();
+        const uint64_t n = header().event_count;
+        const auto it = std::lower_bound(smp.begin(), smp.end(), t,
+                                         [](const IndexSample &s, uint64_t v) { return s.ts_ns < v; });
+        const uint64_t j = static_cast<uint64_t>(it - smp.begin());
+        if (j == 0)
+            return 0;
+        // The answer lies after sample j - 1 and no later than sample j.
+        const uint64_t stride = header().stride;
+        const uint64_t end = std::min(n, j * stride);
+        for (uint64_t i = (j - 1) * stride + 1; i < end; ++i)
+            if (decode_event(capture.data() + i * kEventSize, i).ts_ns >= t)
+                return i;
+        return end;
+    }
+} // namespace lob
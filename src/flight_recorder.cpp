@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "flight_recorder.hpp"
+#include <bit>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace lob
+{
+    static volatile std::sig_atomic_t g_flight_request = 0;
+
+    static void on_flight_signal(int) { g_flight_request = 1; }
+
+    bool install_flight_signal(int sig, std::string &err)
+    {
+        struct sigaction sa{};
+        sa.sa_handler = on_flight_signal;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESTART;
+        if (::sigaction(sig, &sa, nullptr) == 0)
+            return true;
+        err = std::string("sigaction failed: ") + std::strerror(errno);
+        return false;
+    }
+
+    bool take_flight_request() noexcept
+    {
+        if (!g_flight_request)
+            return false;
+        g_flight_request = 0;
+        return true;
+    }
+
+    bool FlightRecorder::write(const std::string &path, FlightTrigger trigger, BreakerState from, BreakerState to,
+                               std::string &err) const
+    {
+        if constexpr (std::endian::native != std::endian::little)
+        {
+            err = "flight dumps are little-endian only";
+            return false;
+        }
+        FlightHeader h{};
+        std::memcpy(h.magic, kFlightMagic, sizeof(h.magic));
+        h.version = kFlightVersion;
+        h.record_bytes = sizeof(FlightRecord);
+        h.capacity = static_cast<uint32_t>(capacity());
+        h.count = static_cast<uint32_t>(size());
+        h.trigger = static_cast<uint32_t>(trigger);
+        h.from = static_cast<uint8_t>(from);
+        h.to = static_cast<uint8_t>(to);
+        h.trigger_msg = size() ? at(size() - 1).msg_index : 0;
+        h.recorded = head_;
+
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            if (!f)
+            {
+                err = "cannot create " + tmp + ": " + std::strerror(errno);
+                return false;
+            }
+            f.write(reinterpret_cast<const char *>(&h), sizeof(h));
+            // Oldest first: the tail of the ring past the write position,
+            // then its head.
+            const size_t n = size(), start = static_cast<size_t>((head_ - n) & mask_);
+            const size_t first = std::min(n, ring_.size() - start);
+            f.write(reinterpret_cast<const char *>(ring_.data() + start),
+                    static_cast<std::streamsize>(first * sizeof(FlightRecord)));
+            f.write(reinterpret_cast<const char *>(ring_.data()),
+                    static_cast<std::streamsize>((n - first) * sizeof(FlightRecord)));
+            if (!f.good())
+            {
+                err = "write to " + tmp + " failed";
+                return false;
+            }
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0)
+        {
+            err = "rename to " + path + " failed: " + std::strerror(errno);
+            return false;
+        }
+        return true;
+    }
+} // namespace lob
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "fork_snapshot.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace lob
+{
+    static uint64_t self_minflt()
+    {
+        struct rusage ru{};
+        ::getrusage(RUSAGE_SELF, &ru);
+        return static_cast<uint64_t>(ru.ru_minflt);
+    }
+
+    bool ForkSnapshotter::spawn(const std::function<bool()> &job)
+    {
+        reap(false);
+        while (max_in_flight_ > 0 && children_.size() >= max_in_flight_)
+        {
+            int status = 0;
+            pid_t oldest = children_.front().pid;
+            if (::waitpid(oldest, &status, 0) == oldest)
+                collect(oldest, status);
+            else
+            {
+                ++stats_.failed;
+                erase(children_.begin());
+            }
+        }
+
+        const uint64_t minflt = self_minflt();
+        const auto t0 = std::chrono::steady_clock::now();
+        pid_t pid = ::fork();
+        if (pid == 0)
+            ::_exit(job() ? 0 : 1);
+        const auto fork_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count());
+        if (pid < 0)
+        {
+            ++stats_.inline_runs;
+            const bool ok = job();
+            if (!ok)
+                ++stats_.failed;
+            return ok;
+        }
+        ++stats_.forked;
+        stats_.fork_ns_total += fork_ns;
+        stats_.fork_ns_max = std::max(stats_.fork_ns_max, fork_ns);
+        if (children_.empty())
+            window_minflt_ = minflt;
+        children_.push_back(Child{pid, minflt});
+        return true;
+    }
+
+    void ForkSnapshotter::reap(bool wait_all)
+    {
+        // Waits on this instance's own pids only: waitpid(-1) would also
+        // collect children of other snapshotters in the process.
+        for (size_t i = 0; i < children_.size();)
+        {
+            int status = 0;
+            const pid_t pid = children_[i].pid;
+            const pid_t r = ::waitpid(pid, &status, wait_all ? 0 : WNOHANG);
+            if (r == 0)
+                ++i;
+            else if (r == pid)
+                collect(pid, status);
+            else if (errno != EINTR)
+            {
+                // Reaped behind our back (e.g. SIGCHLD ignored); the outcome is lost.
+                ++stats_.failed;
+                erase(children_.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+        }
+    }
+
+    void ForkSnapshotter::collect(pid_t pid, int status)
+    {
+        auto it = std::find_if(children_.begin(), children_.end(),
+                               [pid](const Child &c)
+                               { return c.pid == pid; });
+        if (it == children_.end())
+            return;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            ++stats_.failed;
+        erase(it);
+    }
+
+    // Closes the child's fault window, and the shared one once no child is
+    // left, so faults taken while several children overlap count once.
+    void ForkSnapshotter::erase(std::vector<Child>::iterator it)
+    {
+        const uint64_t now = self_minflt();
+        stats_.cow_faults_max = std::max(stats_.cow_faults_max, now - it->minflt_at_fork);
+        children_.erase(it);
+        if (children_.empty())
+            stats_.cow_faults_total += now - window_minflt_;
+    }
+} // namespace lob
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "huge_pages.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace lob
+{
+#ifdef __linux__
+    static uint64_t read_u64(const char *path, uint64_t fallback)
+    {
+        std::ifstream f(path);
+        uint64_t v = 0;
+        return f >> v ? v : fallback;
+    }
+
+    // The bracketed mode in /sys/kernel/mm/transparent_hugepage/enabled.
+    static std::string thp_mode()
+    {
+        std::ifstream f("/sys/kernel/mm/transparent_hugepage/enabled");
+        std::string line;
+        std::getline(f, line);
+        const auto l = line.find('['), r = line.find(']');
+        return l != std::string::npos && r > l ? line.substr(l + 1, r - l - 1) : std::string();
+    }
+
+    // AnonHugePages over the smaps entries overlapping any of the ranges.
+    static uint64_t anon_huge_bytes(const std::vector<detail::HugeRegion> &ranges)
+    {
+        std::ifstream f("/proc/self/smaps");
+        std::string line;
+        bool hit = false;
+        uint64_t total = 0;
+        while (std::getline(f, line))
+        {
+            unsigned long long lo = 0, hi = 0;
+            if (std::sscanf(line.c_str(), "%llx-%llx ", &lo, &hi) == 2 && line.find(':') > line.find(' '))
+            {
+                hit = false;
+                for (const auto &r : ranges)
+                {
+                    const auto p = reinterpret_cast<uintptr_t>(r.p);
+                    hit |= lo < p + r.bytes && p < hi;
+                }
+            }
+            else if (hit && line.rfind("AnonHugePages:", 0) == 0)
+            {
+                std::istringstream in(line.substr(14));
+                uint64_t kb = 0;
+                in >> kb;
+                total += kb * 1024;
+            }
+        }
+        return total;
+    }
+
+    HugePageReport huge_page_report()
+    {
+        auto &s = detail::huge_page_state();
+        HugePageReport r;
+        std::vector<detail::HugeRegion> thp;
+        {
+            std::lock_guard<std::mutex> g(s.m);
+            r.hugetlb_1g_bytes = s.peak[static_cast<size_t>(PageBacking::hugetlb_1g)];
+            r.hugetlb_2m_bytes = s.peak[static_cast<size_t>(PageBacking::hugetlb_2m)];
+            r.thp_bytes = s.peak[static_cast<size_t>(PageBacking::thp)];
+            r.node_bound_bytes = s.bound_peak;
+            for (const auto &m : s.live)
+                if (m.backing == PageBacking::thp)
+                    thp.push_back(m);
+        }
+        r.policy = huge_page_policy();
+        r.node = s.node.load(std::memory_order_relaxed);
+        r.thp_backed_bytes = thp.empty() ? 0 : anon_huge_bytes(thp);
+        if (r.hugetlb_1g_bytes)
+            r.page_size = kGiantPageSize;
+        else if (r.hugetlb_2m_bytes)
+            r.page_size = kHugePageSize;
+        else if (r.thp_backed_bytes)
+            r.page_size = read_u64("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", kHugePageSize);
+        else
+            r.page_size = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+        return r;
+    }
+
+    bool huge_pages_available(std::string &why)
+    {
+        if (read_u64("/sys/kernel/mm/hugepages/hugepages-2048kB/free_hugepages", 0) ||
+            read_u64("/sys/kernel/mm/hugepages/hugepages-1048576kB/free_hugepages", 0))
+            return true;
+        const std::string mode = thp_mode();
+        if (mode == "always" || mode == "madvise")
+            return true;
+        why = "no free hugetlb pages (vm.nr_hugepages=" +
+              std::to_string(read_u64("/proc/sys/vm/nr_hugepages", 0)) + ") and transparent huge pages are " +
+              (mode.empty() ? std::string("not supported") : mode);
+        return false;
+    }
+#else
+    HugePageReport huge_page_report()
+    {
+        HugePageReport r;
+        r.policy = huge_page_policy();
+        r.node = detail::huge_page_state().node.load(std::memory_order_relaxed);
+        return r;
+    }
+
+    bool huge_pages_available(std::string &why)
+    {
+        why = "huge pages are Linux-only";
+        return false;
+    }
+#endif
+} // namespace lob
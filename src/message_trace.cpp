@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "message_trace.hpp"
+#include <bit>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace lob
+{
+    static constexpr size_t kTraceAlign = 64;
+
+    static size_t align_up(size_t v) { return (v + kTraceAlign - 1) & ~(kTraceAlign - 1); }
+
+    namespace
+    {
+        struct ColumnData
+        {
+            const char *name;
+            const char *dtype;
+            const void *data;
+            uint32_t width;
+        };
+
+        template <class T>
+        ColumnData column(const char *name, const HugeVector<T> &v)
+        {
+            static_assert(sizeof(T) <= 8);
+            constexpr const char *dtypes[] = {"", "|u1", "<u2", "", "<u4", "", "", "", "<u8"};
+            return {name, dtypes[sizeof(T)], v.data(), static_cast<uint32_t>(sizeof(T))};
+        }
+    } // namespace
+
+    bool MessageTrace::write(const std::string &path, uint64_t &file_bytes, std::string &err) const
+    {
+        if constexpr (std::endian::native != std::endian::little)
+        {
+            err = "trace files are little-endian only";
+            return false;
+        }
+        std::string stage_names[kStageCount];
+        std::vector<ColumnData> cols = {column("msg_index", msg_index_), column("type", type_),
+                                        column("symbol", symbol_), column("flags", flags_),
+                                        column("total_ns", total_ns_)};
+        for (size_t s = 0; s < kStageCount; ++s)
+        {
+            stage_names[s] = std::string(kStageNames[s]) + "_ns";
+            cols.push_back(column(stage_names[s].c_str(), stage_ns_[s]));
+        }
+        cols.push_back(column("bid_levels", bid_levels_));
+        cols.push_back(column("ask_levels", ask_levels_));
+        cols.push_back(column("orders", orders_));
+
+        TraceHeader h{};
+        std::memcpy(h.magic, kTraceMagic, sizeof(h.magic));
+        h.version = kTraceVersion;
+        h.header_bytes = sizeof(TraceHeader);
+        h.column_count = static_cast<uint32_t>(cols.size());
+        h.row_count = rows_;
+        h.dropped = dropped_;
+        h.first_msg = rows_ ? msg_index_[0] : 0;
+        std::vector<TraceColumn> table(cols.size());
+        size_t off = align_up(sizeof(TraceHeader) + table.size() * sizeof(TraceColumn));
+        for (size_t c = 0; c < cols.size(); ++c)
+        {
+            std::strncpy(table[c].name, cols[c].name, sizeof(table[c].name) - 1);
+            std::memcpy(table[c].dtype, cols[c].dtype, 4);
+            table[c].width = cols[c].width;
+            table[c].offset = off;
+            off = align_up(off + rows_ * cols[c].width);
+        }
+        h.file_bytes = off;
+
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            if (!f)
+            {
+                err = "cannot create " + tmp + ": " + std::strerror(errno);
+                return false;
+            }
+            static const char pad[kTraceAlign] = {};
+            f.write(reinterpret_cast<const char *>(&h), sizeof(h));
+            f.write(reinterpret_cast<const char *>(table.data()),
+                    static_cast<std::streamsize>(table.size() * sizeof(TraceColumn)));
+            size_t at = sizeof(h) + table.size() * sizeof(TraceColumn);
+            for (size_t c = 0; c < cols.size(); ++c)
+            {
+                f.write(pad, static_cast<std::streamsize>(table[c].offset - at));
+                const size_t n = rows_ * cols[c].width;
+                f.write(static_cast<const char *>(cols[c].data), static_cast<std::streamsize>(n));
+                at = table[c].offset + n;
+            }
+            f.write(pad, static_cast<std::streamsize>(h.file_bytes - at));
+            if (!f.good())
+            {
+                err = "write to " + tmp + " failed";
+                return false;
+            }
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0)
+        {
+            err = "rename to " + path + " failed: " + std::strerror(errno);
+            return false;
+        }
+        file_bytes = h.file_bytes;
+        return true;
+    }
+} // namespace lob
@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "numa_topology.hpp"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace lob
+{
+    int NumaTopology::node_of_cpu(int cpu) const noexcept
+    {
+        for (const NumaNode &n : nodes)
+            if (std::find(n.cpus.begin(), n.cpus.end(), cpu) != n.cpus.end())
+                return n.id;
+        return -1;
+    }
+
+    bool parse_cpulist(std::string_view s, std::vector<int> &out)
+    {
+        while (!s.empty() && (s.back() == '\n' || s.back() == ' '))
+            s.remove_suffix(1);
+        while (!s.empty())
+        {
+            const size_t comma = s.find(',');
+            const std::string_view item = s.substr(0, comma);
+            s = comma == std::string_view::npos ? std::string_view() : s.substr(comma + 1);
+            int lo = 0, hi = 0;
+            const char *end = item.data() + item.size();
+            auto r = std::from_chars(item.data(), end, lo);
+            if (r.ec != std::errc() || lo < 0)
+                return false;
+            hi = lo;
+            if (r.ptr != end)
+            {
+                if (*r.ptr != '-')
+                    return false;
+                r = std::from_chars(r.ptr + 1, end, hi);
+                if (r.ec != std::errc() || r.ptr != end || hi < lo)
+                    return false;
+            }
+            for (int c = lo; c <= hi; ++c)
+                out.push_back(c);
+        }
+        return true;
+    }
+
+    NumaTopology discover_numa(const std::string &root)
+    {
+        NumaTopology t;
+        std::ifstream online(root + "/online");
+        std::string list;
+        std::vector<int> ids;
+        if (!std::getline(online, list) || !parse_cpulist(list, ids))
+            return t;
+        for (int id : ids)
+        {
+            const std::string dir = root + "/node" + std::to_string(id);
+            NumaNode n;
+            n.id = id;
+            std::ifstream cpus(dir + "/cpulist");
+            std::string line;
+            if (std::getline(cpus, line))
+                parse_cpulist(line, n.cpus);
+            // "Node 0 MemTotal:       16318480 kB"
+            std::ifstream mem(dir + "/meminfo");
+            while (std::getline(mem, line))
+            {
+                const auto at = line.find("MemTotal:");
+                if (at == std::string::npos)
+                    continue;
+                std::istringstream in(line.substr(at + 9));
+                uint64_t kb = 0;
+                in >> kb;
+                n.mem_bytes = kb * 1024;
+                break;
+            }
+            t.nodes.push_back(std::move(n));
+        }
+        return t;
+    }
+
+    double fraction_on_node(const void *p, size_t len, int node, size_t samples)
+    {
+#ifdef __linux__
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t pages = len / page;
+        if (!p || pages == 0 || node < 0)
+            return -1.0;
+        samples = std::min(samples, pages);
+        std::vector<void *> at(samples);
+        std::vector<int> status(samples, -1);
+        const auto base = reinterpret_cast<uintptr_t>(p) & ~uintptr_t(page - 1);
+        for (size_t i = 0; i < samples; ++i)
+            at[i] = reinterpret_cast<void *>(base + (i * pages / samples) * page);
+        // nodes == nullptr: report each page's node in status, move nothing.
+        if (::syscall(SYS_move_pages, 0, samples, at.data(), nullptr, status.data(), 0) != 0)
+            return -1.0;
+        size_t resident = 0, local = 0;
+        for (int s : status)
+            if (s >= 0)
+            {
+                ++resident;
+                local += s == node;
+            }
+        return resident ? double(local) / double(resident) : -1.0;
+#else
+        (void)p;
+        (void)len;
+        (void)node;
+        (void)samples;
+        return -1.0;
+#endif
+    }
+} // namespace lob
@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "perf_counters.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace lob
+{
+#ifdef __linux__
+    static constexpr uint64_t cache_event(uint64_t cache, uint64_t op, uint64_t result)
+    {
+        return cache | (op << 8) | (result << 16);
+    }
+
+    static constexpr PerfEventSpec kHardwareEvents[] = {
+        {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {"l1d_misses", PERF_TYPE_HW_CACHE,
+         cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        {"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {"dtlb_misses", PERF_TYPE_HW_CACHE,
+         cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    };
+
+    std::span<const PerfEventSpec> hardware_perf_events() { return kHardwareEvents; }
+
+    static constexpr PerfEventSpec kNumaEvents[] = {
+        {"node_loads", PERF_TYPE_HW_CACHE,
+         cache_event(PERF_COUNT_HW_CACHE_NODE, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_ACCESS)},
+        {"node_misses", PERF_TYPE_HW_CACHE,
+         cache_event(PERF_COUNT_HW_CACHE_NODE, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    };
+
+    std::span<const PerfEventSpec> numa_perf_events() { return kNumaEvents; }
+
+    static std::string paranoid_level()
+    {
+        std::ifstream f("/proc/sys/kernel/perf_event_paranoid");
+        std::string v;
+        f >> v;
+        return v.empty() ? "?" : v;
+    }
+
+    PerfCounterGroup::~PerfCounterGroup() { close(); }
+
+    void PerfCounterGroup::close()
+    {
+        for (size_t i = 0; i < count_; ++i)
+            if (fds_[i] >= 0)
+                ::close(fds_[i]);
+        fds_.fill(-1);
+        count_ = opened_ = 0;
+        leader_ = -1;
+    }
+
+    bool PerfCounterGroup::open(std::span<const PerfEventSpec> events)
+    {
+        close();
+        error_.clear();
+        count_ = std::min(events.size(), kMaxPerfCounters);
+        for (size_t i = 0; i < count_; ++i)
+        {
+            specs_[i] = events[i];
+            perf_event_attr a{};
+            a.size = sizeof(a);
+            a.type = events[i].type;
+            a.config = events[i].config;
+            a.disabled = i == 0;
+            a.exclude_kernel = 1;
+            a.exclude_hv = 1;
+            a.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            const long fd = ::syscall(SYS_perf_event_open, &a, 0, -1, i == 0 ? -1 : leader_, PERF_FLAG_FD_CLOEXEC);
+            fds_[i] = static_cast<int>(fd);
+            if (fd >= 0)
+            {
+                ++opened_;
+                if (i == 0)
+                    leader_ = static_cast<int>(fd);
+                continue;
+            }
+            if (i == 0)
+            {
+                const int e = errno;
+                if (e == EACCES || e == EPERM)
+                    error_ = "perf_event_open not permitted (perf_event_paranoid=" + paranoid_level() +
+                             "; needs <= 2 or CAP_PERFMON)";
+                else if (e == ENOENT || e == EOPNOTSUPP || e == ENODEV)
+                    error_ = std::string("no hardware PMU for ") + events[0].name + " (virtualized?)";
+                else if (e == ENOSYS)
+                    error_ = "perf_event_open not supported by this kernel";
+                else
+                    error_ = std::string("perf_event_open failed: ") + std::strerror(e);
+                close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool PerfCounterGroup::enable()
+    {
+        return leader_ >= 0 && ::ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP) == 0 &&
+               ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == 0;
+    }
+
+    bool PerfCounterGroup::disable()
+    {
+        return leader_ >= 0 && ::ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP) == 0;
+    }
+
+    bool PerfCounterGroup::read(PerfReading &out) const
+    {
+        // { nr, time_enabled, time_running, value[nr] } for the opened members.
+        uint64_t buf[3 + kMaxPerfCounters];
+        if (leader_ < 0 || ::read(leader_, buf, sizeof(buf)) < static_cast<ssize_t>((3 + opened_) * sizeof(uint64_t)))
+            return false;
+        const uint64_t enabled = buf[1], running = buf[2];
+        running_fraction_ = enabled ? double(running) / double(enabled) : 1.0;
+        size_t v = 3;
+        for (size_t i = 0; i < count_; ++i)
+        {
+            if (fds_[i] < 0)
+            {
+                out.value[i] = 0;
+                continue;
+            }
+            out.value[i] = running && running < enabled
+                               ? static_cast<uint64_t>(double(buf[v]) * double(enabled) / double(running))
+                               : buf[v];
+            ++v;
+        }
+        return true;
+    }
+#else
+    std::span<const PerfEventSpec> hardware_perf_events() { return {}; }
+    std::span<const PerfEventSpec> numa_perf_events() { return {}; }
+
+    PerfCounterGroup::~PerfCounterGroup() = default;
+    void PerfCounterGroup::close() {}
+    bool PerfCounterGroup::open(std::span<const PerfEventSpec>)
+    {
+        error_ = "perf_event_open is Linux-only";
+        return false;
+    }
+    bool PerfCounterGroup::enable() { return false; }
+    bool PerfCounterGroup::disable() { return false; }
+    bool PerfCounterGroup::read(PerfReading &) const { return false; }
+#endif
+
+    PerfReading calibrate(const PerfCounterGroup &g)
+    {
+        PerfReading best;
+        best.value.fill(std::numeric_limits<uint64_t>::max());
+        PerfReading a, b;
+        for (int k = 0; k < 64 && g.active(); ++k)
+        {
+            if (!g.read(a) || !g.read(b))
+                break;
+            for (size_t i = 0; i < g.size(); ++i)
+                best.value[i] = std::min(best.value[i], b.value[i] - a.value[i]);
+        }
+        for (auto &v : best.value)
+            if (v == std::numeric_limits<uint64_t>::max())
+                v = 0;
+        return best;
+    }
+} // namespace lob
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "realtime.hpp"
+#include "numa_topology.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#ifdef __linux__
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#endif
+
+namespace lob
+{
+#ifdef __linux__
+    bool lock_all_memory(std::string &err)
+    {
+        if (::mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+            return true;
+        const int e = errno;
+        err = std::string("mlockall failed: ") + std::strerror(e);
+        if (e == ENOMEM || e == EPERM)
+            err += " (raise RLIMIT_MEMLOCK, e.g. ulimit -l unlimited, or grant CAP_IPC_LOCK)";
+        return false;
+    }
+
+    void reserve_heap(size_t bytes)
+    {
+        ::mallopt(M_TRIM_THRESHOLD, -1);
+        ::mallopt(M_MMAP_MAX, 0);
+        ::mallopt(M_TOP_PAD, static_cast<int>(std::min<size_t>(bytes, 1u << 30)));
+        if (void *p = std::malloc(bytes))
+        {
+            prefault(p, bytes);
+            std::free(p);
+        }
+    }
+
+    bool set_fifo_priority(int priority, std::string &err)
+    {
+        sched_param sp{};
+        sp.sched_priority = priority;
+        const int rc = ::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &sp);
+        if (rc == 0)
+            return true;
+        err = std::string("SCHED_FIFO priority ") + std::to_string(priority) + " failed: " + std::strerror(rc);
+        if (rc == EPERM)
+            err += " (needs CAP_SYS_NICE or RLIMIT_RTPRIO)";
+        return false;
+    }
+
+    FaultCounts thread_faults()
+    {
+        rusage ru{};
+        ::getrusage(RUSAGE_THREAD, &ru);
+        return {static_cast<uint64_t>(ru.ru_minflt), static_cast<uint64_t>(ru.ru_majflt)};
+    }
+#else
+    bool lock_all_memory(std::string &err)
+    {
+        err = "mlockall is not supported on this platform";
+        return false;
+    }
+
+    void reserve_heap(size_t) {}
+
+    bool set_fifo_priority(int, std::string &err)
+    {
+        err = "SCHED_FIFO is not supported on this platform";
+        return false;
+    }
+
+    FaultCounts thread_faults() { return {}; }
+#endif
+
+    bool cpu_listed(const char *list, int cpu, const std::string &root)
+    {
+        std::ifstream f(root + "/" + list);
+        std::string line;
+        std::vector<int> cpus;
+        if (cpu < 0 || !std::getline(f, line) || !parse_cpulist(line, cpus))
+            return false;
+        return std::find(cpus.begin(), cpus.end(), cpu) != cpus.end();
+    }
+} // namespace lob
@@ -1,31 +1,65 @@
 // SPDX-License-Identifier: Apache-2.0
+#include "book_snapshot.hpp"
 #include "breaker.hpp"
+#include "buffered_writer.hpp"
+#include "capture_index.hpp"
+#include "delta_stream.hpp"
 #include "detectors.hpp"
+#include "event.hpp"
+#include "flight_recorder.hpp"
+#include "fork_snapshot.hpp"
+#include "huge_pages.hpp"
+#include "message_trace.hpp"
+#include "msg_dispatch.hpp"
+#include "numa_topology.hpp"
+#include "perf_counters.hpp"
+#include "realtime.hpp"
+#include "stage_timer.hpp"
 #include "telemetry.hpp"
+#include <algorithm>
 #include <cerrno>
 #include <cmath>
+#include <csignal>
 #include <cstdint>
 #include <cstdlib>
+#include <array>
 #include <fstream>
 #include <iostream>
 #include <limits>
 #include <vector>
 #include <chrono>
 #include <optional>
+#include <span>
+#include <cstring>
 #include <unordered_map>
+#ifdef BQL_WITH_ENTERPRISE
+#include "bqs/adapters/file_adapters.hpp"
+#include "bqs/adapters/arbitration.hpp"
+#include "bqs/adapters/mold_udp_adapter.hpp"
+#endif
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #ifdef __linux__
 #include <pthread.h>
 #include <sched.h>
-#include <cstring>
 #endif
 using namespace lob;
 
-static uint64_t fnv1a(const std::vector<uint8_t> &v)
+static constexpr uint64_t kFnvOffset = 1469598103934665603ull;
+
+// Message types this replay build handles. A build for
+// a feed that never carries some type lists fewer: those are rejected
+// without being decoded, and their handlers are not compiled in.
+using ReplayDispatch = FullDispatch;
+
+// Streaming FNV-1a: the state after a prefix is all a resumed run needs.
+static inline uint64_t fnv1a_update(uint64_t h, const uint8_t *p, size_t n)
 {
-    uint64_t h = 1469598103934665603ull;
-    for (uint8_t b : v)
+    for (size_t i = 0; i < n; ++i)
     {
-        h ^= b;
+        h ^= p[i];
         h *= 1099511628211ull;
     }
     return h;
@@ -49,18 +83,23 @@ static size_t get_max_bytes()
     return static_cast<size_t>(v);
 }
 
-static bool read_all(const std::string &p, std::vector<uint8_t> &out)
+// Reads [offset, EOF) of p into out; total receives the full file size.
+static bool read_all(const std::string &p, HugeVector<uint8_t> &out, uint64_t offset, uint64_t &total)
 {
     std::ifstream f(p, std::ios::binary);
     if (!f)
         return false;
     f.seekg(0, std::ios::end);
     auto n = f.tellg();
-    f.seekg(0, std::ios::beg);
+    if (n < 0 || static_cast<uint64_t>(n) < offset)
+        return false;
+    total = static_cast<uint64_t>(n);
+    f.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+    n -= static_cast<std::streamoff>(offset);
 
     const std::streamsize max_size =
         static_cast<std::streamsize>(get_max_bytes());
-    if (n < 0 || n > max_size)
+    if (n > max_size)
     {
         std::cerr << "File size invalid or too large (max " << max_size
                   << " bytes)\n";
@@ -71,6 +110,15 @@ static bool read_all(const std::string &p, std::vector<uint8_t> &out)
     return f.read(reinterpret_cast<char *>(out.data()), n).good();
 }
 
+// zstd or LZ4 frame magic at the start of a capture read as raw events.
+static bool compressed_magic(const HugeVector<uint8_t> &b)
+{
+    if (b.size() < 4)
+        return false;
+    const uint32_t m = uint32_t(b[0]) | uint32_t(b[1]) << 8 | uint32_t(b[2]) << 16 | uint32_t(b[3]) << 24;
+    return m == 0xFD2FB528u || m == 0x184D2204u;
+}
+
 struct ReplayOptions
 {
     std::string input = "data/golden/itch_1m.bin";
@@ -79,6 +127,38 @@ struct ReplayOptions
     double skew_ppm = 0.0;
     double burst_ms = 0.0;
     int cpu_pin = -1;
+    std::string snapshot_in;
+    std::string snapshot_out;
+    int checkpoint_every = 0;
+    std::vector<uint64_t> snapshot_at;
+    std::string checkpoint_dir;
+    std::string resume_from;
+    std::string deltas_out;
+    std::string adapter;
+    double pace = 0.0;
+    std::string rx_mode = "blocking";
+    int busy_poll_us = 0;
+    std::string rewinder;
+    std::string xdp_iface;
+    int xdp_queue = 0;
+    std::string mcast_if = "127.0.0.1";
+    int arb_wait_us = 500;
+    int uring_depth = 4;
+    bool direct_io = false;
+    int decode_threads = 0;
+    int symbol = -1;
+    uint64_t from_ns = 0;
+    uint64_t to_ns = std::numeric_limits<uint64_t>::max();
+    std::string index_path;
+    bool perf_counters = false;
+    bool verbose = false;
+    HugePagePolicy hugepages = HugePagePolicy::automatic;
+    bool realtime = false;
+    int rt_priority = 0;
+    int prefetch_distance = 0;
+    std::string trace_out;
+    int trace_rows = 0;
+    int flight_records = static_cast<int>(kDefaultFlightRecords);
     bool help = false;
 };
 
@@ -92,7 +172,46 @@ static void print_help()
               << "  --corrupt-ppm <value> Corrupt rate in parts per million (default 0)\n"
               << "  --skew-ppm <value>    Skew rate in parts per million (default 0)\n"
               << "  --burst-ms <value>    Burst duration in milliseconds (default 0)\n"
-              << "  --cpu-pin <core>      Pin main thread to CPU core (Linux-only; default -1)\n\n"
+              << "  --cpu-pin <core>      Pin main thread to CPU core (Linux-only; default -1)\n"
+              << "  --snapshot-in <path>  Load books from a binary snapshot and continue --input after its events\n"
+              << "  --snapshot-out <path> Write a binary book snapshot after replaying\n"
+              << "  --checkpoint-every <n> Write a resumable checkpoint every n events (forked writer)\n"
+              << "  --snapshot-at <n,...> Fork a state dump after each listed event index\n"
+              << "  --checkpoint-dir <path> Checkpoint directory (default $ART_DIR/checkpoints)\n"
+              << "  --resume-from <path>  Resume --input from a checkpoint's byte offset\n"
+              << "  --deltas-out <path>   Write the varint-encoded L2 level-delta stream\n"
+              << "  --symbol <n>          Replay only symbol n, seeking with the capture index\n"
+              << "  --from <t> / --to <t> With --symbol: capture-time window, e.g. 60s, 1500ms, 250us, 10ns\n"
+              << "  --index <path>        With --symbol: index from build_index (default <input>.idx)\n"
+              << "  --perf-counters       Count cycles, instructions and cache/branch/TLB misses (perf_event_open)\n"
+              << "  --verbose             Also print stage, huge-page, NUMA and fault summaries to stderr\n"
+              << "  --hugepages <mode>    Huge pages for the input buffer and book pools: auto (default), on, off\n"
+              << "  --realtime            Lock memory, pre-fault hot buffers, report isolcpus/nohz_full of --cpu-pin\n"
+              << "  --rt-priority <n>     With --realtime: run the replay thread SCHED_FIFO at priority n (1..99)\n"
+              << "  --prefetch-distance <k> Prefetch order-index lines k events ahead (0..256, default 0 = off)\n"
+              << "  --trace-out <path>    Write a per-message columnar latency trace (BQLTRC) after the run\n"
+              << "  --trace-rows <n>      With --trace-out: rows to preallocate (default: every input event,\n"
+              << "                        4194304 for live adapters); later events are counted, not traced\n"
+              << "  --flight-records <n>  Flight-recorder ring size, dumped to $ART_DIR/flight when the breaker\n"
+              << "                        reaches Feeder or worse and on SIGUSR1 (default 4096, 0 = off)\n"
+#ifdef BQL_WITH_ENTERPRISE
+              << "  --adapter <kind>      Drive --input through a BQS market-data adapter:\n"
+              << "                        file, mmap, mold (--input is a MoldUDP64 group:port) or\n"
+              << "                        ab (--input is groupA:port,groupB:port; A/B line arbitration)\n"
+              << "                        or uring (io_uring reads, several in flight)\n"
+              << "  --pace <x>            With file/mmap: replay at x times recorded speed (0 = unpaced)\n"
+              << "  --rx-mode <mode>      With mold: blocking (default) or busy (spin on recvmmsg)\n"
+              << "  --busy-poll-us <n>    With mold: set SO_BUSY_POLL/SO_PREFER_BUSY_POLL (default 0 = off)\n"
+              << "  --rewinder <addr:port> With mold: recover gaps from this MoldUDP64 rewinder\n"
+              << "  --mcast-if <addr>     With mold/ab: local address to join the group on (default 127.0.0.1)\n"
+              << "  --xdp <ifname>        With mold: receive through AF_XDP on ifname (recvmmsg if unavailable)\n"
+              << "  --xdp-queue <n>       With --xdp: RX queue to bind (default 0)\n"
+              << "  --arb-wait-us <n>     With ab: how long a hole on one line waits for the other (default 500)\n"
+              << "  --uring-depth <n>     With uring: 1 MiB reads kept in flight (default 4)\n"
+              << "  --direct              With uring: read with O_DIRECT, bypassing the page cache\n"
+              << "  --decode-threads <n>  zstd/lz4 --input (detected): decompression threads (default 0 = per CPU)\n"
+#endif
+              << "\n"
               << "Exit Codes:\n"
               << "  0 - Success\n"
               << "  1 - Invalid argument\n"
@@ -131,6 +250,55 @@ static std::optional<int> parse_int(const std::string &s)
     return static_cast<int>(v);
 }
 
+// Comma-separated event indices, returned sorted and de-duplicated.
+static std::optional<std::vector<uint64_t>> parse_index_list(const std::string &s)
+{
+    std::vector<uint64_t> out;
+    size_t pos = 0;
+    while (pos <= s.size())
+    {
+        const size_t comma = std::min(s.find(',', pos), s.size());
+        const std::string item = s.substr(pos, comma - pos);
+        errno = 0;
+        char *end = nullptr;
+        unsigned long long v = std::strtoull(item.c_str(), &end, 10);
+        if (item.empty() || item[0] == '-' || end == item.c_str() || *end != '\0' || errno == ERANGE || v == 0)
+            return std::nullopt;
+        out.push_back(v);
+        pos = comma + 1;
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+// Capture time: an integer with an optional ns (default), us, ms, s or m suffix.
+static std::optional<uint64_t> parse_time_ns(const std::string &s)
+{
+    errno = 0;
+    char *end = nullptr;
+    if (s.empty() || s[0] == '-')
+        return std::nullopt;
+    const unsigned long long v = std::strtoull(s.c_str(), &end, 10);
+    if (end == s.c_str() || errno == ERANGE)
+        return std::nullopt;
+    const std::string unit(end);
+    uint64_t scale = 0;
+    if (unit.empty() || unit == "ns")
+        scale = 1;
+    else if (unit == "us")
+        scale = 1'000;
+    else if (unit == "ms")
+        scale = 1'000'000;
+    else if (unit == "s")
+        scale = 1'000'000'000;
+    else if (unit == "m")
+        scale = 60'000'000'000;
+    if (scale == 0 || v > std::numeric_limits<uint64_t>::max() / scale)
+        return std::nullopt;
+    return uint64_t(v) * scale;
+}
+
 static bool validate_cpu_pin(int cpu)
 {
     if (cpu < 0)
@@ -169,6 +337,211 @@ static bool parse_args(int argc, char **argv, ReplayOptions &out)
             if (!consume_value(out.input))
                 return false;
         }
+        else if (arg == "--snapshot-in")
+        {
+            if (!consume_value(out.snapshot_in))
+                return false;
+        }
+        else if (arg == "--snapshot-out")
+        {
+            if (!consume_value(out.snapshot_out))
+                return false;
+        }
+        else if (arg == "--checkpoint-dir")
+        {
+            if (!consume_value(out.checkpoint_dir))
+                return false;
+        }
+        else if (arg == "--resume-from")
+        {
+            if (!consume_value(out.resume_from))
+                return false;
+        }
+        else if (arg == "--deltas-out")
+        {
+            if (!consume_value(out.deltas_out))
+                return false;
+        }
+        else if (arg == "--trace-out")
+        {
+            if (!consume_value(out.trace_out))
+                return false;
+        }
+        else if (arg == "--flight-records")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_int(v);
+            if (!parsed || *parsed < 0 || *parsed > (1 << 24))
+            {
+                std::cerr << "Invalid value for --flight-records: " << v << " (expected 0..16777216)\n";
+                return false;
+            }
+            out.flight_records = *parsed;
+        }
+        else if (arg == "--trace-rows")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_int(v);
+            if (!parsed || *parsed < 1)
+            {
+                std::cerr << "Invalid value for --trace-rows: " << v << "\n";
+                return false;
+            }
+            out.trace_rows = *parsed;
+        }
+#ifdef BQL_WITH_ENTERPRISE
+        else if (arg == "--adapter")
+        {
+            if (!consume_value(out.adapter))
+                return false;
+            if (out.adapter != "file" && out.adapter != "mmap" && out.adapter != "mold" && out.adapter != "ab" &&
+                out.adapter != "uring")
+            {
+                std::cerr << "Invalid value for --adapter: " << out.adapter
+                          << " (expected file, mmap, mold, ab or uring)\n";
+                return false;
+            }
+        }
+        else if (arg == "--rx-mode")
+        {
+            if (!consume_value(out.rx_mode))
+                return false;
+            if (out.rx_mode != "blocking" && out.rx_mode != "busy")
+            {
+                std::cerr << "Invalid value for --rx-mode: " << out.rx_mode << " (expected blocking or busy)\n";
+                return false;
+            }
+        }
+        else if (arg == "--busy-poll-us")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_int(v);
+            if (!parsed || *parsed < 0)
+            {
+                std::cerr << "Invalid value for --busy-poll-us: " << v << "\n";
+                return false;
+            }
+            out.busy_poll_us = *parsed;
+        }
+        else if (arg == "--rewinder")
+        {
+            if (!consume_value(out.rewinder))
+                return false;
+        }
+        else if (arg == "--mcast-if")
+        {
+            if (!consume_value(out.mcast_if))
+                return false;
+        }
+        else if (arg == "--xdp")
+        {
+            if (!consume_value(out.xdp_iface))
+                return false;
+        }
+        else if (arg == "--xdp-queue")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_int(v);
+            if (!parsed || *parsed < 0)
+            {
+                std::cerr << "Invalid value for --xdp-queue: " << v << "\n";
+                return false;
+            }
+            out.xdp_queue = *parsed;
+        }
+        else if (arg == "--uring-depth")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_int(v);
+            if (!parsed || *parsed < 1 || *parsed > 256)
+            {
+                std::cerr << "Invalid value for --uring-depth: " << v << " (expected 1..256)\n";
+                return false;
+            }
+            out.uring_depth = *parsed;
+        }
+        else if (arg == "--direct")
+        {
+            out.direct_io = true;
+        }
+        else if (arg == "--decode-threads")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_int(v);
+            if (!parsed || *parsed < 0 || *parsed > 256)
+            {
+                std::cerr << "Invalid value for --decode-threads: " << v << " (expected 0..256)\n";
+                return false;
+            }
+            out.decode_threads = *parsed;
+        }
+        else if (arg == "--arb-wait-us")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_int(v);
+            if (!parsed || *parsed < 0)
+            {
+                std::cerr << "Invalid value for --arb-wait-us: " << v << "\n";
+                return false;
+            }
+            out.arb_wait_us = *parsed;
+        }
+        else if (arg == "--pace")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_double(v);
+            if (!parsed)
+            {
+                std::cerr << "Invalid value for --pace: " << v << "\n";
+                return false;
+            }
+            if (!validate_nonneg_finite("--pace", *parsed))
+                return false;
+            out.pace = *parsed;
+        }
+#endif
+        else if (arg == "--snapshot-at")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_index_list(v);
+            if (!parsed)
+            {
+                std::cerr << "Invalid value for --snapshot-at: " << v << "\n";
+                return false;
+            }
+            out.snapshot_at = std::move(*parsed);
+        }
+        else if (arg == "--checkpoint-every")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_int(v);
+            if (!parsed || *parsed <= 0)
+            {
+                std::cerr << "Invalid value for --checkpoint-every: " << v << "\n";
+                return false;
+            }
+            out.checkpoint_every = *parsed;
+        }
         else if (arg == "--gap-ppm")
         {
             std::string v;
@@ -229,6 +602,86 @@ static bool parse_args(int argc, char **argv, ReplayOptions &out)
                 return false;
             out.burst_ms = *parsed;
         }
+        else if (arg == "--symbol")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_int(v);
+            if (!parsed || *parsed < 0 || *parsed >= int(kSymbolCount))
+            {
+                std::cerr << "Invalid value for --symbol: " << v << " (expected 0.." << kSymbolCount - 1 << ")\n";
+                return false;
+            }
+            out.symbol = *parsed;
+        }
+        else if (arg == "--from" || arg == "--to")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_time_ns(v);
+            if (!parsed)
+            {
+                std::cerr << "Invalid value for " << arg << ": " << v << "\n";
+                return false;
+            }
+            (arg == "--from" ? out.from_ns : out.to_ns) = *parsed;
+        }
+        else if (arg == "--index")
+        {
+            if (!consume_value(out.index_path))
+                return false;
+        }
+        else if (arg == "--perf-counters")
+        {
+            out.perf_counters = true;
+        }
+        else if (arg == "--verbose")
+        {
+            out.verbose = true;
+        }
+        else if (arg == "--realtime")
+        {
+            out.realtime = true;
+        }
+        else if (arg == "--rt-priority")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_int(v);
+            if (!parsed || *parsed < 1 || *parsed > 99)
+            {
+                std::cerr << "Invalid value for --rt-priority: " << v << " (expected 1..99)\n";
+                return false;
+            }
+            out.rt_priority = *parsed;
+        }
+        else if (arg == "--prefetch-distance")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            auto parsed = parse_int(v);
+            if (!parsed || *parsed < 0 || *parsed > 256)
+            {
+                std::cerr << "Invalid value for --prefetch-distance: " << v << " (expected 0..256)\n";
+                return false;
+            }
+            out.prefetch_distance = *parsed;
+        }
+        else if (arg == "--hugepages")
+        {
+            std::string v;
+            if (!consume_value(v))
+                return false;
+            if (!parse_huge_page_policy(v, out.hugepages))
+            {
+                std::cerr << "Invalid value for --hugepages: " << v << " (expected auto, on or off)\n";
+                return false;
+            }
+        }
         else if (arg == "--cpu-pin")
         {
             std::string v;
@@ -250,9 +703,133 @@ static bool parse_args(int argc, char **argv, ReplayOptions &out)
             return false;
         }
     }
+    if (!out.resume_from.empty() && !out.snapshot_in.empty())
+    {
+        std::cerr << "--resume-from and --snapshot-in are mutually exclusive\n";
+        return false;
+    }
+    if (out.rt_priority > 0 && !out.realtime)
+    {
+        std::cerr << "--rt-priority requires --realtime\n";
+        return false;
+    }
+    if (out.trace_rows > 0 && out.trace_out.empty())
+    {
+        std::cerr << "--trace-rows requires --trace-out\n";
+        return false;
+    }
+    if (out.symbol < 0 && (out.from_ns != 0 || out.to_ns != std::numeric_limits<uint64_t>::max() ||
+                           !out.index_path.empty()))
+    {
+        std::cerr << "--from, --to and --index require --symbol\n";
+        return false;
+    }
+    if (out.symbol >= 0 && (out.from_ns > out.to_ns || !out.adapter.empty() || !out.resume_from.empty() ||
+                            !out.snapshot_in.empty() || out.checkpoint_every > 0 || !out.snapshot_at.empty() ||
+                            !out.deltas_out.empty() || out.perf_counters || out.realtime || !out.trace_out.empty()))
+    {
+        std::cerr << "--symbol needs --from <= --to and reads --input directly (no adapter, resume, "
+                     "snapshot, delta, perf-counter, realtime or trace options)\n";
+        return false;
+    }
+    if (out.pace > 0.0 && out.adapter != "file" && out.adapter != "mmap")
+    {
+        std::cerr << "--pace requires --adapter file or mmap\n";
+        return false;
+    }
     return true;
 }
 
+// --symbol: replays one symbol's events in [from, to] straight from the
+// capture index's posting list. A book depends only on its own symbol's
+// events, so applying that symbol's events before `from` rebuilds its exact
+// state at `from` without reading any other symbol's bytes; nothing past
+// `to` is touched at all.
+static int run_symbol_window(const ReplayOptions &opt)
+{
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    const std::string index_path = opt.index_path.empty() ? opt.input + ".idx" : opt.index_path;
+    CaptureIndexView idx;
+    std::string err;
+    if (!idx.open(index_path, err))
+    {
+        std::cerr << "Blanc LOB Engine: could not load index " << index_path << ": " << err
+                  << " (build it with build_index --input " << opt.input << ")\n";
+        return 2;
+    }
+    const int fd = ::open(opt.input.c_str(), O_RDONLY);
+    struct stat st{};
+    if (fd < 0 || ::fstat(fd, &st) != 0)
+    {
+        if (fd >= 0)
+            ::close(fd);
+        std::cerr << "Blanc LOB Engine: could not read " << opt.input << "\n";
+        return 2;
+    }
+    const size_t n = static_cast<size_t>(st.st_size);
+    void *map = n ? ::mmap(nullptr, n, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+    ::close(fd);
+    if (map == MAP_FAILED)
+    {
+        std::cerr << "Blanc LOB Engine: could not map " << opt.input << "\n";
+        return 2;
+    }
+    const std::span<const uint8_t> cap(static_cast<const uint8_t *>(map), n);
+    if (!idx.matches(cap))
+    {
+        if (map)
+            ::munmap(map, n);
+        std::cerr << "Blanc LOB Engine: index " << index_path << " was not built from " << opt.input << "\n";
+        return 2;
+    }
+    // Postings are read in order but sparsely.
+    if (map)
+        ::madvise(map, n, MADV_RANDOM);
+
+    const uint64_t events = idx.header().event_count;
+    const uint64_t first = idx.seek_time(cap, opt.from_ns);
+    const uint64_t end =
+        opt.to_ns == std::numeric_limits<uint64_t>::max() ? events : idx.seek_time(cap, opt.to_ns + 1);
+    const auto post = idx.postings(static_cast<uint32_t>(opt.symbol));
+    const auto lo = std::lower_bound(post.begin(), post.end(), first);
+    const auto hi = std::lower_bound(lo, post.end(), end);
+
+    OrderBook book;
+    for (auto it = post.begin(); it != lo; ++it)
+    {
+        const uint8_t *p = cap.data() + uint64_t(*it) * kEventSize;
+        Event ev = decode_header(p, *it);
+        ReplayDispatch::apply(book, p, ev);
+    }
+    const auto warm = clock::now();
+    uint64_t d = kFnvOffset;
+    for (auto it = lo; it != hi; ++it)
+    {
+        const uint8_t *p = cap.data() + uint64_t(*it) * kEventSize;
+        d = fnv1a_update(d, p, kEventSize);
+        Event ev = decode_header(p, *it);
+        ReplayDispatch::apply(book, p, ev);
+    }
+    const auto done = clock::now();
+    if (map)
+        ::munmap(map, n);
+
+    L2Level bid{}, ask{};
+    const bool has_bid = book.depth(Side::Bid, &bid, 1) == 1;
+    const bool has_ask = book.depth(Side::Ask, &ask, 1) == 1;
+    const auto used = static_cast<uint64_t>(hi - post.begin());
+    std::cout << "window symbol=" << opt.symbol << " from_ns=" << opt.from_ns << " to_ns=" << opt.to_ns
+              << " first_event=" << first << " end_event=" << end << " warmup_events=" << (lo - post.begin())
+              << " events=" << (hi - lo) << " bytes_read=" << used * kEventSize << " capture_bytes=" << n
+              << " digest_fnv=0x" << hex64(d) << " symbol_book_digest=0x" << hex64(book.digest())
+              << " book_orders=" << book.size() << " best_bid=" << (has_bid ? std::to_string(bid.px) : "-")
+              << " best_ask=" << (has_ask ? std::to_string(ask.px) : "-")
+              << " warmup_ms=" << std::chrono::duration<double, std::milli>(warm - start).count()
+              << " window_ms=" << std::chrono::duration<double, std::milli>(done - warm).count() << std::endl;
+    return 0;
+}
+
 int main(int argc, char **argv)
 {
     ReplayOptions opt;
@@ -267,17 +844,57 @@ int main(int argc, char **argv)
         print_help();
         return 0;
     }
+    // Set before anything large is allocated: the input buffer, the book
+    // pools and the latency samples all take their pages from it.
+    if (opt.hugepages == HugePagePolicy::on)
+    {
+        std::string why;
+        if (!huge_pages_available(why))
+        {
+            std::cerr << "Blanc LOB Engine: --hugepages on: " << why << "\n";
+            return 2;
+        }
+    }
+    set_huge_page_policy(opt.hugepages);
+    if (opt.symbol >= 0)
+        return run_symbol_window(opt);
 
-    std::vector<uint8_t> buf;
-    if (!read_all(opt.input, buf))
+    // A checkpoint pins the input position, so it is opened before reading.
+    SnapshotView resume;
+    const SnapshotEngine *resume_state = nullptr;
+    if (!opt.resume_from.empty())
     {
-        std::cerr << "Blanc LOB Engine: could not read " << opt.input << "\n";
-        return 2;
+        std::string err;
+        if (!resume.open(opt.resume_from, err) || !(resume_state = resume.engine()))
+        {
+            std::cerr << "Blanc LOB Engine: could not load checkpoint " << opt.resume_from
+                      << ": " << (err.empty() ? "no engine state" : err) << "\n";
+            return 2;
+        }
     }
+    // So does a book snapshot: its books already reflect the first
+    // msg_index events of --input, so the replay continues after them.
+    SnapshotView start_snap;
+    if (!opt.snapshot_in.empty())
+    {
+        std::string err;
+        if (!start_snap.open(opt.snapshot_in, err))
+        {
+            std::cerr << "Blanc LOB Engine: could not load snapshot " << opt.snapshot_in << ": " << err << "\n";
+            return 2;
+        }
+    }
+    uint64_t input_base = 0;
+    if (resume_state)
+        input_base = resume_state->input_offset;
+    else if (!opt.snapshot_in.empty())
+        input_base = start_snap.engine() ? start_snap.engine()->input_offset
+                                         : start_snap.header().msg_index * kEventSize;
 
-    using clock = std::chrono::steady_clock;
-    auto start = clock::now();
-    // Set CPU affinity as requested (best-effort; Linux-only)
+    // Set CPU affinity as requested (best-effort; Linux-only). Done before
+    // the input is loaded so every buffer is first touched from the pinned
+    // core, and its NUMA node becomes the preferred node of every huge-page
+    // mapping (input buffer, book pools) from here on.
     if (opt.cpu_pin >= 0)
     {
 #ifdef __linux__
@@ -301,31 +918,576 @@ int main(int argc, char **argv)
         (void)opt.cpu_pin; // no-op on non-Linux platforms
 #endif
     }
+    const NumaTopology numa = discover_numa();
+    const int numa_node = opt.cpu_pin >= 0 ? numa.node_of_cpu(opt.cpu_pin) : -1;
+    set_huge_page_node(numa_node);
+
+    HugeVector<uint8_t> buf;
+    uint64_t input_bytes = 0;
+#ifdef BQL_WITH_ENTERPRISE
+    // Adapter mode pulls the capture through the enterprise adapter contract
+    // instead of loading it up front; mmap frames are decoded in place, and
+    // so are uring frames, in the read buffers as each read completes. A
+    // live MoldUDP64 feed has no known size: it runs until end of session,
+    // and a resumed run starts at the checkpoint's next sequence number.
+    // The ab adapter arbitrates two such feeds carrying the same session.
+    // A zstd or LZ4 capture is recognised by its frame magic and always
+    // read through the compressed adapter, so offsets, the digest and
+    // checkpoints all refer to the decompressed events.
+    namespace bqa = bqs::adapters;
+    const bool file_input = opt.adapter.empty() || opt.adapter == "file" || opt.adapter == "mmap" ||
+                            opt.adapter == "uring";
+    const bqa::Codec codec = file_input ? bqa::detect_codec(opt.input) : bqa::Codec::none;
+    std::optional<bqa::FileMarketDataAdapter> file_src;
+    std::optional<bqa::MmapMarketDataAdapter> mmap_src;
+    std::optional<bqa::UringFileMarketDataAdapter> uring_src;
+    std::optional<bqa::CompressedFileMarketDataAdapter> packed_src;
+    std::optional<bqa::MoldUdpMarketDataAdapter> mold_src;
+    std::optional<bqa::ArbitratedMarketDataAdapter> ab_src;
+    bqa::IMarketDataAdapter *src = nullptr;
+    if (!opt.adapter.empty() || codec != bqa::Codec::none)
+    {
+        bqa::UdpFeedOptions uo;
+        uo.idle_timeout_ms = 5000;
+        uo.mode = opt.rx_mode == "busy" ? bqa::ReceiveMode::busy_poll : bqa::ReceiveMode::blocking;
+        uo.busy_poll_us = opt.busy_poll_us;
+        uo.rewind.server = opt.rewinder;
+        uo.reorder_slot_bytes = kEventSize;
+        uo.interface = opt.mcast_if;
+        // Both lines of an ab feed would contend for the one queue.
+        if (opt.adapter == "mold")
+        {
+            uo.xdp.ifname = opt.xdp_iface;
+            uo.xdp.queue = static_cast<uint32_t>(opt.xdp_queue);
+        }
+        bqa::FileSourceOptions so;
+        so.start_offset = input_base;
+        so.pacing.speed = opt.pace;
+        so.pacing.record_bytes = kEventSize;
+        so.pacing.timestamp = [](const std::byte *rec, uint64_t index)
+        { return decode_event(reinterpret_cast<const uint8_t *>(rec), index).ts_ns; };
+        if (codec != bqa::Codec::none)
+        {
+            so.decode_threads = static_cast<unsigned>(opt.decode_threads);
+            src = &packed_src.emplace(so);
+        }
+        else if (opt.adapter == "mmap")
+            src = &mmap_src.emplace(so);
+        else if (opt.adapter == "uring")
+        {
+            so.queue_depth = static_cast<unsigned>(opt.uring_depth);
+            so.direct = opt.direct_io;
+            src = &uring_src.emplace(so);
+        }
+        else if (opt.adapter == "mold")
+            src = &mold_src.emplace(uo);
+        else if (opt.adapter == "ab")
+        {
+            bqa::ArbitrationOptions ao;
+            ao.gap_wait_us = opt.arb_wait_us;
+            src = &ab_src.emplace(uo, ao);
+        }
+        else
+            src = &file_src.emplace(so);
+        bqa::AdapterConfig cfg;
+        cfg.name = "replay";
+        cfg.kind = bqa::FeedKind::itch;
+        cfg.endpoint = opt.input;
+        cfg.start_sequence = input_base / kEventSize + 1;
+        src->configure(cfg);
+        src->connect();
+        if (src->status().state != bqa::SessionState::established)
+        {
+            std::cerr << "Blanc LOB Engine: could not read " << opt.input << ": " << src->status().detail << "\n";
+            return 2;
+        }
+        if (mold_src && !mold_src->xdp_error().empty())
+            std::cerr << "Blanc LOB Engine: AF_XDP unavailable, using recvmmsg: " << mold_src->xdp_error() << "\n";
+        if (uring_src && !uring_src->uring_error().empty())
+            std::cerr << "Blanc LOB Engine: io_uring unavailable, using pread: " << uring_src->uring_error() << "\n";
+        if (mmap_src)
+            input_bytes = mmap_src->size_bytes();
+        else if (uring_src)
+            input_bytes = uring_src->size_bytes();
+        else if (file_src)
+            input_bytes = file_src->size_bytes();
+        else if (packed_src)
+            input_bytes = packed_src->size_bytes();
+    }
+    // Compressed frames need not record their size; then it is known only
+    // at the end, as for a live feed, and checkpoints cut from it carry none.
+    const bool live_input = mold_src.has_value() || ab_src.has_value();
+    const bool sized_input = !live_input && !(packed_src && input_bytes == 0);
+    const bool load_input = !src;
+#else
+    const bool sized_input = true;
+    const bool load_input = true;
+#endif
+    if (load_input && !read_all(opt.input, buf, input_base, input_bytes))
+    {
+        std::cerr << "Blanc LOB Engine: could not read " << opt.input;
+        if (input_base > 0)
+            std::cerr << " from byte offset " << input_base;
+        std::cerr << "\n";
+        return 2;
+    }
+    if (load_input && input_base == 0 && compressed_magic(buf))
+    {
+        std::cerr << "Blanc LOB Engine: " << opt.input
+                  << " is zstd/lz4 compressed; decompress it first or use an enterprise build\n";
+        return 2;
+    }
+    const SnapshotEngine *start_state = resume_state ? resume_state
+                                        : opt.snapshot_in.empty() ? nullptr
+                                                                  : start_snap.engine();
+    if (start_state && sized_input && start_state->input_bytes && input_bytes != start_state->input_bytes)
+    {
+        std::cerr << "Blanc LOB Engine: checkpoint was cut from a " << start_state->input_bytes
+                  << "-byte capture, " << opt.input << " has " << input_bytes << " bytes\n";
+        return 2;
+    }
+
+    const char *env_artdir = std::getenv("ART_DIR");
+    std::string out_dir = env_artdir && *env_artdir ? std::string(env_artdir) : std::string("artifacts");
+    ensure_dir(out_dir);
+
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    // Books are indexed by symbol. A snapshot restores them (and the event
+    // index, which drives decoded timestamps) so a replay can start mid-day.
+    std::array<OrderBook, kSymbolCount> books;
+    uint64_t msg_index = 0;
+    uint64_t d = kFnvOffset;
+    Detectors det;
+    Breaker br(BreakerThresholds{});
+    if (resume_state)
+    {
+        restore_snapshot(resume, books);
+        msg_index = resume.header().msg_index;
+        d = resume_state->input_fnv;
+        det.restore(resume_state->detectors);
+        br.restore(static_cast<BreakerState>(resume_state->breaker), resume_state->latched != 0);
+    }
+    else if (!opt.snapshot_in.empty())
+    {
+        if (!restore_snapshot(start_snap, books))
+        {
+            std::cerr << "Blanc LOB Engine: could not restore snapshot " << opt.snapshot_in << "\n";
+            return 2;
+        }
+        msg_index = start_snap.header().msg_index;
+    }
+
+    det.inject_ppm(opt.gap_ppm, opt.corrupt_ppm, opt.skew_ppm, opt.burst_ms);
+
+    // Checkpoints and --snapshot-at dumps are cut on absolute event indices
+    // so boundaries line up across resumed runs. Gates are evaluated at each
+    // boundary so the dump carries the breaker decision for that point.
+    ForkSnapshotter checkpointer;
+    std::string ckpt_dir = opt.checkpoint_dir.empty() ? out_dir + "/checkpoints" : opt.checkpoint_dir;
+    if (opt.checkpoint_every > 0 || !opt.snapshot_at.empty())
+        ensure_dir(ckpt_dir);
+    auto next_snapshot = std::lower_bound(opt.snapshot_at.begin(), opt.snapshot_at.end(), msg_index + 1);
+    auto dump_state = [&](uint64_t consumed, const char *prefix)
+    {
+        det.on_message(consumed);
+        br.step(det.readings());
+        SnapshotEngine eng{};
+        eng.input_offset = consumed;
+        eng.input_bytes = input_bytes;
+        eng.input_fnv = d;
+        eng.detectors = det.state();
+        eng.breaker = static_cast<uint8_t>(br.state());
+        eng.latched = br.latched() ? 1 : 0;
+        char name[48];
+        std::snprintf(name, sizeof(name), "/%s_%012llu.snap", prefix, (unsigned long long)msg_index);
+        const std::string path = ckpt_dir + name;
+        // The child serializes its copy-on-write view of the engine.
+        checkpointer.spawn([&, eng, path]
+                           { return write_snapshot(path, books, msg_index, &eng); });
+    };
+
+    // Flight recorder: every event is recorded once the breaker has stepped
+    // on it. Escalation to Feeder or worse (which latches, so this fires
+    // once per rung) and SIGUSR1 dump the ring from a forked child, so the
+    // loop pays for a fork, not for the write.
+    FlightRecorder flight(static_cast<size_t>(opt.flight_records));
+    ForkSnapshotter flight_dumper;
+    const std::string flight_dir = out_dir + "/flight";
+    BreakerState flight_state = br.state();
+    uint64_t flight_dumps = 0;
+    if (flight.enabled())
+    {
+        std::string err;
+        if (!install_flight_signal(SIGUSR1, err))
+            std::cerr << "Warning: flight recorder: " << err << "\n";
+    }
+    auto dump_flight = [&](FlightTrigger why, BreakerState from, BreakerState to)
+    {
+        ensure_dir(flight_dir);
+        char name[64];
+        std::snprintf(name, sizeof(name), "/flight_%012llu_%s.bin", (unsigned long long)msg_index,
+                      why == FlightTrigger::escalation ? "escalation" : "signal");
+        const std::string path = flight_dir + name;
+        ++flight_dumps;
+        flight_dumper.spawn([&, path, why, from, to]
+                            {
+                                std::string err;
+                                return flight.write(path, why, from, to, err);
+                            });
+    };
+
+    // Level deltas are encoded straight into a multi-MiB buffer right after
+    // each event, so the stream costs a few bytes per change and almost no
+    // syscalls.
+    BufferedWriter delta_file;
+    DeltaEncoder deltas(delta_file);
+    const bool publish_deltas = !opt.deltas_out.empty();
+    if (publish_deltas)
+    {
+        if (!delta_file.open(opt.deltas_out) ||
+            !deltas.begin(kSymbolCount, msg_index, msg_index * 1000))
+        {
+            std::cerr << "Blanc LOB Engine: could not open delta stream " << opt.deltas_out << "\n";
+            return 2;
+        }
+        for (auto &b : books)
+            b.record_deltas(true);
+    }
+
+    // --perf-counters: one counter group covers the whole replay loop, and
+    // every kPerfStageStride-th event is split into the same stages as the
+    // stage timers by reading the group at each stage boundary. Those reads
+    // are syscalls, so sampled events stay out of the latency percentiles.
+    static constexpr uint64_t kPerfStageStride = 64;
+    PerfCounterGroup perf;
+    PerfReading perf_cost, perf_begin, perf_end, perf_at[kStageCount + 1];
+    std::array<PerfRegion, kStageCount> perf_stage{};
+    bool perf_on = false;
+    if (opt.perf_counters)
+    {
+        perf_on = perf.open(hardware_perf_events()) && perf.enable();
+        if (perf_on)
+            perf_cost = calibrate(perf);
+        else
+            std::cerr << "Warning: perf counters unavailable: "
+                      << (perf.error().empty() ? std::string("could not enable the counter group") : perf.error())
+                      << "\n";
+    }
+    // Local vs remote memory reads over the whole loop, in a group of their
+    // own; most virtual PMUs and single-node boxes have no such events.
+    PerfCounterGroup numa_perf;
+    PerfReading numa_begin, numa_end;
+    const bool numa_perf_on = opt.perf_counters && numa_perf.open(numa_perf_events()) && numa_perf.size() == 2 &&
+                              numa_perf.available(1) && numa_perf.enable();
+    const uint64_t first_msg = msg_index;
 
-    // Per-event timing — synthetic: treat each 64-byte chunk as one "event"
-    // to produce a realistic latency sample vector for tail percentile computation.
-    constexpr size_t kEventSize = 64;
-    std::vector<double> event_latencies_ms;
+    // Per-event timing: each 64-byte event is hashed into the running digest
+    // and decoded, applied to its book, counted by the detectors, gated by
+    // the breaker, and its level deltas encoded. On every
+    // kStageTimerStride-th event stage timers split that interval instead;
+    // their clock reads would inflate it, so those events (like perf-sampled
+    // ones) stay out of the per-event percentiles.
+    HugeVector<double> event_latencies_ms;
+    if (input_bytes > input_base)
+        event_latencies_ms.reserve(static_cast<size_t>((input_bytes - input_base) / kEventSize));
+    StageHistograms stage_ns;
+    uint64_t consumed = input_base;
+    // --trace-out: one columnar row per event, stored after the event's
+    // interval closes, so tracing adds stores but no clock reads or
+    // formatting to what is measured. Sized for the whole input up front.
+    std::optional<MessageTrace> trace;
+    if (!opt.trace_out.empty())
+    {
+        size_t rows = opt.trace_rows > 0 ? static_cast<size_t>(opt.trace_rows) : size_t{1} << 22;
+        if (opt.trace_rows == 0 && sized_input && input_bytes > input_base)
+            rows = static_cast<size_t>((input_bytes - input_base) / kEventSize);
+        trace.emplace(rows);
+    }
+    // --prefetch-distance k: the header of the event k ahead is decoded far
+    // enough to pick its book and order id, and the id's index line is
+    // requested. k/2 events ahead, once that line has normally arrived, the
+    // order's pool entries are requested too (executions, cancels and
+    // deletes only: an add's id is not resting yet). Adds probe the index
+    // for duplicates, so they get the first stage. Events whose lookahead
+    // falls past the end of the current chunk are not prefetched.
+    const size_t ahead = static_cast<size_t>(opt.prefetch_distance) * kEventSize;
+    const size_t ahead_order = static_cast<size_t>(opt.prefetch_distance / 2) * kEventSize;
+    auto prefetch = [&](const uint8_t *p, size_t i, size_t n)
     {
-        const size_t n_events = buf.size() > 0 ? (buf.size() + kEventSize - 1) / kEventSize : 1;
-        event_latencies_ms.reserve(n_events);
-        for (size_t i = 0; i < buf.size(); i += kEventSize)
+        if (i + ahead + kEventSize <= n)
         {
+            const Event e = decode_header(p + i + ahead, 0);
+            books[e.symbol].prefetch_index(e.ref);
+        }
+        if (ahead_order != 0 && i + ahead_order + kEventSize <= n)
+        {
+            const Event e = decode_header(p + i + ahead_order, 0);
+            if (e.type != MsgType::Add)
+                books[e.symbol].prefetch_order(e.ref);
+        }
+    };
+    // Runs every whole event in [p, p + n) and returns the bytes used.
+    auto run_events = [&](const uint8_t *p, size_t n) -> size_t
+    {
+        size_t i = 0;
+        for (; i + kEventSize <= n; i += kEventSize)
+        {
+            const bool staged = perf_on && msg_index % kPerfStageStride == 0;
+            const bool timed = kStageTimers && !staged && msg_index % kStageTimerStride == 0;
             auto t0 = clock::now();
-            // Touch each byte to simulate event processing and prevent elision
-            volatile uint8_t sink = 0;
-            const size_t end_i = std::min(i + kEventSize, buf.size());
-            for (size_t j = i; j < end_i; ++j)
-                sink ^= buf[j];
-            (void)sink;
+            StageLap lap(stage_ns, t0, timed);
+            std::array<uint32_t, kStageCount> lap_ns;
+            auto boundary = [&](Stage s)
+            {
+                lap_ns[static_cast<size_t>(s)] = MessageTrace::saturate(lap.mark(s));
+                if (staged)
+                    perf.read(perf_at[static_cast<size_t>(s) + 1]);
+            };
+            if (staged)
+                perf.read(perf_at[0]);
+            d = fnv1a_update(d, p + i, kEventSize);
+            if (ahead != 0)
+                prefetch(p, i, n);
+            // Only the header is decoded up front; each type's own fields are
+            // decoded inside its dispatch step, so they count toward book.
+            Event ev = decode_header(p + i, msg_index);
+            boundary(Stage::decode);
+            const bool applied = ReplayDispatch::apply(books[ev.symbol], p + i, ev);
+            boundary(Stage::book);
+            det.on_message(consumed + kEventSize);
+            boundary(Stage::detectors);
+            const DetectorReadings readings = det.readings();
+            const BreakerState state = br.step(readings);
+            if (flight.enabled())
+            {
+                flight.record(msg_index, ev, applied, readings, state);
+                const bool escalated = state > flight_state && state >= BreakerState::Feeder;
+                if (escalated || take_flight_request())
+                    dump_flight(escalated ? FlightTrigger::escalation : FlightTrigger::signal, flight_state, state);
+                flight_state = state;
+            }
+            boundary(Stage::breaker);
+            if (publish_deltas)
+            {
+                deltas.on_message(msg_index, ev.ts_ns, ev.symbol, books[ev.symbol].deltas());
+                books[ev.symbol].clear_deltas();
+            }
+            ++msg_index;
+            boundary(Stage::publish);
+            if (staged)
+                for (size_t k = 0; k < kStageCount; ++k)
+                    perf_stage[k].add(perf_at[k], perf_at[k + 1], perf_cost, perf.size());
             auto t1 = clock::now();
-            event_latencies_ms.push_back(
-                std::chrono::duration<double, std::milli>(t1 - t0).count());
+            if (!staged && !timed)
+                event_latencies_ms.push_back(
+                    std::chrono::duration<double, std::milli>(t1 - t0).count());
+            if (trace)
+            {
+                const OrderBook &bk = books[ev.symbol];
+                const uint8_t flags = (applied ? kTraceApplied : 0) | (timed ? kTraceStaged : 0) |
+                                      (staged ? kTracePerf : 0);
+                trace->record(msg_index - 1, static_cast<uint8_t>(ev.type), ev.symbol, flags,
+                              static_cast<uint64_t>(
+                                  std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()),
+                              lap_ns, bk.bids().size(), bk.asks().size(), bk.size());
+            }
+            consumed += kEventSize;
+            if (opt.checkpoint_every > 0 && msg_index % static_cast<uint64_t>(opt.checkpoint_every) == 0)
+                dump_state(consumed, "ckpt");
+            if (next_snapshot != opt.snapshot_at.end() && *next_snapshot == msg_index)
+            {
+                dump_state(consumed, "snap");
+                ++next_snapshot;
+            }
+            // Reap finished dump children promptly so their fault windows
+            // end when they exit, not at the next dump or after the loop.
+            if ((msg_index & 255) == 0)
+            {
+                if (checkpointer.in_flight())
+                    checkpointer.reap(false);
+                if (flight_dumper.in_flight())
+                    flight_dumper.reap(false);
+            }
+        }
+        return i;
+    };
+    // --realtime: everything the loop touches is resident and locked before
+    // it starts. The heap is pre-grown (and never trimmed) so pool growth
+    // and order-index tables are carved from locked memory. Books are not
+    // reserved up front: an order index sized for the worst case spreads
+    // its entries over far more cache lines and costs more than the rare
+    // regrowth. Fault counts of this thread around the loop are recorded
+    // on every run, so the effect is measurable.
+    std::string rt_error;
+    bool rt_locked = false, rt_fifo = false;
+    if (opt.realtime)
+    {
+        const uint64_t events = input_bytes > input_base ? (input_bytes - input_base) / kEventSize : 0;
+        reserve_heap(static_cast<size_t>(std::clamp<uint64_t>(events * kEventSize / 2, 16u << 20, 1u << 30)));
+        rt_locked = lock_all_memory(rt_error);
+        prefault(buf.data(), buf.size());
+        prefault(event_latencies_ms.data(), event_latencies_ms.capacity() * sizeof(double));
+        for (auto &b : books)
+            b.prefault();
+        std::string err;
+        if (opt.rt_priority > 0 && !(rt_fifo = set_fifo_priority(opt.rt_priority, err)))
+            rt_error += (rt_error.empty() ? "" : "; ") + err;
+        if (!rt_error.empty())
+            std::cerr << "Warning: --realtime: " << rt_error << "\n";
+        if (opt.cpu_pin < 0)
+            std::cerr << "Warning: --realtime without --cpu-pin: the replay thread may migrate\n";
+    }
+    const FaultCounts faults_before = thread_faults();
+    if (perf_on)
+        perf.read(perf_begin);
+    if (numa_perf_on)
+        numa_perf.read(numa_begin);
+#ifdef BQL_WITH_ENTERPRISE
+    // Frames are whole events except possibly the last one, so only the
+    // final frame can leave trailing bytes.
+    auto run_frames = [&](auto &frames)
+    {
+        for (auto f = frames.next_frame(); !f.empty(); f = frames.next_frame())
+        {
+            const auto *p = reinterpret_cast<const uint8_t *>(f.data());
+            const size_t k = run_events(p, f.size());
+            d = fnv1a_update(d, p + k, f.size() - k);
         }
+    };
+    if (mmap_src)
+        run_frames(*mmap_src);
+    else if (uring_src)
+    {
+        run_frames(*uring_src);
+        const auto &rs = uring_src->read_stats();
+        std::cerr << "uring reads=" << rs.reads << " waits=" << rs.waits << " registered=" << rs.registered
+                  << " o_direct=" << rs.direct << "\n";
+    }
+    else if (packed_src)
+    {
+        run_frames(*packed_src);
+        const auto &ds = packed_src->decode_stats();
+        input_bytes = packed_src->size_bytes();
+        std::cerr << "decompress codec=" << bqa::codec_name(ds.codec) << " frames=" << ds.frames
+                  << " threads=" << ds.threads << " parallel=" << ds.parallel << " units=" << ds.units
+                  << " waits=" << ds.waits << " ratio="
+                  << (ds.compressed_bytes ? double(input_bytes) / double(ds.compressed_bytes) : 0.0) << "\n";
+    }
+    else if (src)
+    {
+        std::vector<uint8_t> chunk(1u << 20);
+        size_t have = 0;
+        for (;;)
+        {
+            const size_t n = src->read(std::as_writable_bytes(std::span(chunk).subspan(have)));
+            if (n == 0)
+            {
+                // A live feed returns 0 while idle; only a closed session ends it.
+                const auto st = src->status().state;
+                if (st == bqa::SessionState::established || st == bqa::SessionState::recovering)
+                    continue;
+                break;
+            }
+            have += n;
+            const size_t k = run_events(chunk.data(), have);
+            std::memmove(chunk.data(), chunk.data() + k, have - k);
+            have -= k;
+        }
+        d = fnv1a_update(d, chunk.data(), have);
+    }
+    if (mold_src)
+    {
+        const auto &fs = mold_src->stats();
+        input_bytes = consumed;
+        std::cerr << "feed packets=" << fs.packets << " messages=" << fs.messages << " gaps=" << fs.gaps
+                  << " missing=" << fs.missing << " recovered=" << fs.recovered
+                  << " rewind_requests=" << mold_src->rewind_stats().requests << " duplicates=" << fs.duplicates
+                  << " kernel_drops=" << fs.kernel_drops << " batch_mean=" << fs.batch_size.mean()
+                  << " wake_p99_us=" << double(fs.wake_ns.quantile(0.99)) / 1e3
+                  << " rx=" << (fs.xdp ? (fs.xdp_zero_copy ? "af_xdp_zc" : "af_xdp") : "recvmmsg") << "\n";
+    }
+    if (ab_src)
+    {
+        const auto &as = ab_src->stats();
+        input_bytes = consumed;
+        std::cerr << "arbitration messages=" << as.emitted << " gaps=" << as.gaps << " missing=" << as.missing
+                  << " late=" << as.late;
+        for (int i = 0; i < 2; ++i)
+            std::cerr << " " << char('A' + i) << "_wins=" << as.line[i].wins << " " << char('A' + i)
+                      << "_win_rate=" << as.win_rate(i) << " " << char('A' + i)
+                      << "_lag_p50_us=" << double(as.line[i].lag_ns.quantile(0.5)) / 1e3 << " "
+                      << char('A' + i) << "_missing=" << ab_src->line(i).stats().missing;
+        std::cerr << "\n";
+    }
+    if (src && src->status().state != bqa::SessionState::closed)
+    {
+        std::cerr << "Blanc LOB Engine: adapter stopped early: " << src->status().detail << "\n";
+        return 2;
+    }
+    if (!src)
+#endif
+    {
+        const size_t i = run_events(buf.data(), buf.size());
+        // Trailing bytes that do not form a whole event still count toward the digest.
+        d = fnv1a_update(d, buf.data() + i, buf.size() - i);
+    }
+    if (perf_on)
+    {
+        perf.read(perf_end);
+        perf.disable();
+    }
+    if (numa_perf_on)
+    {
+        numa_perf.read(numa_end);
+        numa_perf.disable();
+    }
+    const FaultCounts faults_after = thread_faults();
+    checkpointer.reap(true);
+    if (next_snapshot != opt.snapshot_at.end())
+    {
+        std::cerr << "Warning: --snapshot-at past the last event (" << msg_index << "), not written:";
+        for (; next_snapshot != opt.snapshot_at.end(); ++next_snapshot)
+            std::cerr << " " << *next_snapshot;
+        std::cerr << "\n";
     }
+    if (publish_deltas)
+    {
+        if (!delta_file.close())
+            std::cerr << "Warning: delta stream " << opt.deltas_out << " incomplete\n";
+        std::cerr << "deltas records=" << deltas.records() << " bytes=" << delta_file.bytes_written()
+                  << " path=" << opt.deltas_out << "\n";
+    }
+    if (trace)
+    {
+        uint64_t trace_bytes = 0;
+        std::string err;
+        if (!trace->write(opt.trace_out, trace_bytes, err))
+            std::cerr << "Warning: trace " << opt.trace_out << " not written: " << err << "\n";
+        else
+            std::cerr << "trace rows=" << trace->rows() << " dropped=" << trace->dropped()
+                      << " bytes=" << trace_bytes << " path=" << opt.trace_out << "\n";
+    }
+    flight_dumper.reap(true);
+    if (flight_dumps > 0)
+        std::cerr << "flight dumps written=" << flight_dumper.completed() << " failed=" << flight_dumper.failed()
+                  << " dir=" << flight_dir << "\n";
+    if (checkpointer.stats().jobs() > 0)
+        std::cerr << "state dumps written=" << checkpointer.completed()
+                  << " failed=" << checkpointer.failed() << " dir=" << ckpt_dir << "\n";
+
+    uint64_t book_digest = kFnvOffset;
+    uint64_t book_orders = 0;
+    for (const auto &b : books)
+    {
+        book_digest = (book_digest ^ b.digest()) * 1099511628211ull;
+        book_orders += b.size();
+    }
+    if (!opt.snapshot_out.empty() && !write_snapshot(opt.snapshot_out, books, msg_index))
+        std::cerr << "Warning: could not write snapshot " << opt.snapshot_out << "\n";
 
     // Compute percentiles from sorted copy
-    auto percentile = [](std::vector<double> v, double pct) -> double
+    auto percentile = [](HugeVector<double> v, double pct) -> double
     {
         if (v.empty())
             return 0.0;
@@ -337,21 +1499,165 @@ int main(int argc, char **argv)
         return v[lo] * (1.0 - frac) + v[hi] * frac;
     };
 
-    uint64_t d = fnv1a(buf);
-    Detectors det;
-    det.on_message(buf.size());
-    det.inject_ppm(opt.gap_ppm, opt.corrupt_ppm, opt.skew_ppm, opt.burst_ms);
-    Breaker br(BreakerThresholds{});
+    det.on_message(input_bytes);
     auto st = br.step(det.readings());
 
-    const char *env_artdir = std::getenv("ART_DIR");
-    std::string out_dir = env_artdir && *env_artdir ? std::string(env_artdir) : std::string("artifacts");
-    ensure_dir(out_dir);
     TelemetrySnapshot t;
     t.input_path = opt.input;
     t.golden_digest_hex = "<sha256-file>";
     t.actual_digest_hex = hex64(d);
+    t.book_digest_hex = hex64(book_digest);
+    t.book_orders = book_orders;
     t.cpu_pin = opt.cpu_pin;
+    const ForkStats &fs = checkpointer.stats();
+    t.snapshots = fs.jobs();
+    t.snapshot_failures = fs.failed;
+    t.fork_ms_mean = fs.fork_ms_mean();
+    t.fork_ms_max = double(fs.fork_ns_max) / 1e6;
+    t.cow_faults = fs.cow_faults_total;
+    t.cow_faults_max = fs.cow_faults_max;
+#ifdef BQL_WITH_ENTERPRISE
+    if (mold_src)
+    {
+        const auto &fd = mold_src->stats();
+        t.feed_active = true;
+        t.feed_packets = fd.packets;
+        t.feed_gaps = fd.gaps;
+        t.feed_missing = fd.missing;
+        t.feed_recovered = fd.recovered;
+        t.feed_rewind_requests = mold_src->rewind_stats().requests;
+        t.feed_kernel_drops = fd.kernel_drops;
+        t.feed_batch_mean = fd.batch_size.mean();
+        t.feed_wake_p50_us = double(fd.wake_ns.quantile(0.50)) / 1e3;
+        t.feed_wake_p99_us = double(fd.wake_ns.quantile(0.99)) / 1e3;
+        t.feed_wake_max_us = double(fd.wake_ns.max) / 1e3;
+        t.feed_batch_hist.assign(fd.batch_size.counts.begin(), fd.batch_size.counts.end());
+        t.feed_wake_ns_hist.assign(fd.wake_ns.counts.begin(), fd.wake_ns.counts.end());
+        t.feed_batch_sum = fd.batch_size.sum;
+        t.feed_wake_ns_sum = fd.wake_ns.sum;
+    }
+#endif
+    if constexpr (kStageTimers)
+    {
+        for (size_t k = 0; k < kStageCount; ++k)
+        {
+            const LatencyHistogram &h = stage_ns[k];
+            StageLatency s;
+            s.stage = kStageNames[k];
+            s.count = h.count();
+            s.sum_ns = h.sum();
+            s.mean_ns = h.count() ? double(h.sum()) / double(h.count()) : 0.0;
+            s.p50_ns = double(h.quantile(0.50));
+            s.p99_ns = double(h.quantile(0.99));
+            s.p999_ns = double(h.quantile(0.999));
+            t.stages.push_back(s);
+        }
+        if (opt.verbose)
+        {
+            std::cerr << "stages";
+            for (const StageLatency &s : t.stages)
+                std::cerr << " " << s.stage << "_p50_ns=" << s.p50_ns << " " << s.stage << "_p99_ns=" << s.p99_ns;
+            std::cerr << "\n";
+        }
+    }
+    if (opt.perf_counters)
+    {
+        t.perf_requested = true;
+        if (!perf_on)
+            t.perf_error = perf.error().empty() ? "could not enable the counter group" : perf.error();
+        else
+        {
+            // Whole loop less the user-space cost of the stage reads.
+            const uint64_t msgs = std::max<uint64_t>(msg_index - first_msg, 1);
+            const uint64_t reads = perf_stage[0].samples * (kStageCount + 1);
+            PerfRegion loop;
+            loop.add(perf_begin, perf_end, PerfReading{}, perf.size());
+            int cycles = -1, instructions = -1;
+            for (size_t i = 0; i < perf.size(); ++i)
+            {
+                const uint64_t cost = std::min(loop.total[i], perf_cost.value[i] * reads);
+                t.perf_names.push_back(perf.name(i));
+                t.perf_per_msg.push_back(perf.available(i) ? double(loop.total[i] - cost) / double(msgs) : -1.0);
+                if (t.perf_names.back() == "cycles")
+                    cycles = static_cast<int>(i);
+                else if (t.perf_names.back() == "instructions")
+                    instructions = static_cast<int>(i);
+            }
+            auto ipc = [&](const std::vector<double> &v)
+            { return cycles >= 0 && instructions >= 0 && v[cycles] > 0 ? v[instructions] / v[cycles] : 0.0; };
+            t.perf_ipc = ipc(t.perf_per_msg);
+            t.perf_running = perf.running_fraction();
+            t.perf_stage_samples = perf_stage[0].samples;
+            for (size_t k = 0; k < kStageCount; ++k)
+            {
+                std::vector<double> v;
+                for (size_t i = 0; i < perf.size(); ++i)
+                    v.push_back(!perf.available(i)   ? -1.0
+                                : perf_stage[k].samples ? double(perf_stage[k].total[i]) / double(perf_stage[k].samples)
+                                                        : 0.0);
+                t.perf_stages.push_back(kStageNames[k]);
+                t.perf_stage_ipc.push_back(ipc(v));
+                t.perf_stage_per_msg.push_back(std::move(v));
+            }
+            std::cerr << "perf ipc=" << t.perf_ipc << " running=" << t.perf_running;
+            for (size_t i = 0; i < t.perf_names.size(); ++i)
+                if (t.perf_per_msg[i] >= 0)
+                    std::cerr << " " << t.perf_names[i] << "_per_msg=" << t.perf_per_msg[i];
+            std::cerr << " stage_samples=" << t.perf_stage_samples << "\n";
+        }
+    }
+    {
+        // Read while the input buffer and books are still mapped, so smaps
+        // shows what the kernel actually gave the THP-advised ranges.
+        const HugePageReport hp = huge_page_report();
+        t.hugepages = to_string(hp.policy);
+        t.hugepage_size = hp.page_size;
+        t.hugepage_hugetlb_bytes = hp.hugetlb_1g_bytes + hp.hugetlb_2m_bytes;
+        t.hugepage_thp_bytes = hp.thp_bytes;
+        t.hugepage_thp_backed_bytes = hp.thp_backed_bytes;
+        if (opt.verbose || opt.hugepages == HugePagePolicy::on)
+            std::cerr << "hugepages policy=" << t.hugepages << " page_size=" << t.hugepage_size
+                      << " hugetlb_bytes=" << t.hugepage_hugetlb_bytes << " thp_bytes=" << t.hugepage_thp_bytes
+                      << " thp_backed_bytes=" << t.hugepage_thp_backed_bytes << "\n";
+
+        t.numa_nodes = static_cast<int>(numa.nodes.size());
+        t.numa_node = numa_node;
+        t.numa_bound_bytes = hp.node_bound_bytes;
+        t.numa_input_local = fraction_on_node(buf.data(), buf.size(), numa_node);
+        if (numa_perf_on)
+        {
+            const uint64_t loads = numa_end.value[0] - numa_begin.value[0];
+            const uint64_t misses = numa_end.value[1] - numa_begin.value[1];
+            t.numa_remote_ratio = loads ? double(misses) / double(loads) : 0.0;
+        }
+        t.rt_requested = opt.realtime;
+        t.rt_locked = rt_locked;
+        t.rt_fifo_priority = rt_fifo ? opt.rt_priority : 0;
+        t.rt_isolated = cpu_listed("isolated", opt.cpu_pin);
+        t.rt_nohz_full = cpu_listed("nohz_full", opt.cpu_pin);
+        t.rt_error = rt_error;
+        t.prefetch_distance = opt.prefetch_distance;
+        t.flight_records = flight.capacity();
+        t.flight_dumps = flight_dumps;
+        t.faults_minor_before = faults_before.minor;
+        t.faults_major_before = faults_before.major;
+        t.faults_minor_after = faults_after.minor;
+        t.faults_major_after = faults_after.major;
+        if (opt.verbose || opt.realtime)
+        {
+            std::cerr << "faults loop_minor=" << faults_after.minor - faults_before.minor
+                      << " loop_major=" << faults_after.major - faults_before.major;
+            if (opt.realtime)
+                std::cerr << " realtime mlock=" << (rt_locked ? "yes" : "no") << " fifo=" << t.rt_fifo_priority
+                          << " isolated=" << (t.rt_isolated ? "yes" : "no")
+                          << " nohz_full=" << (t.rt_nohz_full ? "yes" : "no");
+            std::cerr << "\n";
+        }
+        if (opt.verbose || opt.cpu_pin >= 0)
+            std::cerr << "numa nodes=" << t.numa_nodes << " node=" << t.numa_node
+                      << " bound_bytes=" << t.numa_bound_bytes << " input_local=" << t.numa_input_local
+                      << " remote_ratio=" << t.numa_remote_ratio << "\n";
+    }
     t.readings = det.readings();
     t.breaker = st;
     t.publish_allowed = br.publish_allowed();
@@ -371,6 +1677,8 @@ int main(int argc, char **argv)
     std::cout << "digest_fnv=0x" << std::hex << d
               << " breaker=" << Breaker::to_string(st)
               << " publish=" << (br.publish_allowed() ? "YES" : "NO")
+              << " book_digest=0x" << hex64(book_digest)
+              << " book_orders=" << std::dec << book_orders
               << " elapsed_ms=" << std::dec << elapsed_ms
               << " samples=" << t.sample_count
               << " p50=" << t.p50_ms << "ms"
@@ -27,6 +27,61 @@ namespace lob
                 o << c;
         }
     }
+    // Cumulative Prometheus histogram from log2 bucket counts, trimmed after
+    // the last non-empty bucket.
+    static void prom_log2_histogram(std::ostream &o, const char *name, const std::vector<uint64_t> &counts,
+                                    uint64_t sum)
+    {
+        size_t last = counts.size();
+        while (last > 0 && counts[last - 1] == 0)
+            --last;
+        uint64_t cum = 0;
+        for (size_t i = 0; i < last; ++i)
+        {
+            cum += counts[i];
+            o << name << "_bucket{le=\"" << ((1ull << i) - 1) << "\"} " << cum << "\n";
+        }
+        o << name << "_bucket{le=\"+Inf\"} " << cum << "\n"
+          << name << "_sum " << sum << "\n"
+          << name << "_count " << cum << "\n";
+    }
+    // bench.jsonl stays one flat object per run, so per-stage and per-counter
+    // values are spelled into the key: stage_<stage>_p99_ns,
+    // perf_<counter>_per_msg, perf_<stage>_<counter>_per_msg. Counters the
+    // PMU did not provide are left out.
+    static void json_stages(std::ostream &o, const TelemetrySnapshot &t)
+    {
+        for (const StageLatency &s : t.stages)
+            o << "\"stage_" << s.stage << "_count\":" << s.count << ",\"stage_" << s.stage
+              << "_mean_ns\":" << s.mean_ns << ",\"stage_" << s.stage << "_p50_ns\":" << s.p50_ns << ",\"stage_"
+              << s.stage << "_p99_ns\":" << s.p99_ns << ",\"stage_" << s.stage << "_p999_ns\":" << s.p999_ns << ",";
+    }
+    static void json_perf(std::ostream &o, const TelemetrySnapshot &t)
+    {
+        if (!t.perf_requested)
+            return;
+        o << "\"perf_available\":" << (t.perf_error.empty() ? "true" : "false") << ",";
+        if (!t.perf_error.empty())
+        {
+            o << "\"perf_error\":\"";
+            esc(o, t.perf_error);
+            o << "\",";
+            return;
+        }
+        o << "\"perf_ipc\":" << t.perf_ipc << ",\"perf_running\":" << t.perf_running << ",";
+        for (size_t i = 0; i < t.perf_names.size(); ++i)
+            if (t.perf_per_msg[i] >= 0)
+                o << "\"perf_" << t.perf_names[i] << "_per_msg\":" << t.perf_per_msg[i] << ",";
+        o << "\"perf_stage_samples\":" << t.perf_stage_samples << ",";
+        for (size_t s = 0; s < t.perf_stages.size(); ++s)
+        {
+            o << "\"perf_" << t.perf_stages[s] << "_ipc\":" << t.perf_stage_ipc[s] << ",";
+            for (size_t i = 0; i < t.perf_names.size(); ++i)
+                if (t.perf_stage_per_msg[s][i] >= 0)
+                    o << "\"perf_" << t.perf_stages[s] << "_" << t.perf_names[i]
+                      << "_per_msg\":" << t.perf_stage_per_msg[s][i] << ",";
+        }
+    }
     bool write_jsonl(const std::string &path, const TelemetrySnapshot &t)
     {
         std::ofstream f(path, std::ios::app);
@@ -38,6 +93,8 @@ namespace lob
         f << "\","
           << "\"golden\":\"" << t.golden_digest_hex << "\","
           << "\"actual\":\"" << t.actual_digest_hex << "\","
+          << "\"book\":\"" << t.book_digest_hex << "\","
+          << "\"book_orders\":" << t.book_orders << ","
           << "\"determinism\":" << (t.determinism_pass ? "true" : "false") << ","
           << "\"p50_ms\":" << t.p50_ms << ",\"p95_ms\":" << t.p95_ms
           << ",\"p99_ms\":" << t.p99_ms
@@ -51,7 +108,56 @@ namespace lob
           << "\"skew_ppm\":" << t.readings.skew_ppm << ","
           << "\"burst_ms\":" << t.readings.burst_ms << ","
           << "\"cpu_pin\":" << t.cpu_pin << ","
-          << "\"breaker\":\"" << Breaker::to_string(t.breaker) << "\","
+          << "\"snapshots\":" << t.snapshots << ","
+          << "\"snapshot_failures\":" << t.snapshot_failures << ","
+          << "\"fork_ms_mean\":" << t.fork_ms_mean << ","
+          << "\"fork_ms_max\":" << t.fork_ms_max << ","
+          << "\"cow_faults\":" << t.cow_faults << ","
+          << "\"cow_faults_max\":" << t.cow_faults_max << ","
+          << "\"feed_packets\":" << t.feed_packets << ","
+          << "\"feed_gaps\":" << t.feed_gaps << ","
+          << "\"feed_missing\":" << t.feed_missing << ","
+          << "\"feed_recovered\":" << t.feed_recovered << ","
+          << "\"feed_rewind_requests\":" << t.feed_rewind_requests << ","
+          << "\"feed_kernel_drops\":" << t.feed_kernel_drops << ","
+          << "\"feed_batch_mean\":" << t.feed_batch_mean << ","
+          << "\"feed_wake_p50_us\":" << t.feed_wake_p50_us << ","
+          << "\"feed_wake_p99_us\":" << t.feed_wake_p99_us << ","
+          << "\"feed_wake_max_us\":" << t.feed_wake_max_us << ",";
+        json_stages(f, t);
+        json_perf(f, t);
+        if (!t.hugepages.empty())
+            f << "\"hugepages\":\"" << t.hugepages << "\","
+              << "\"hugepage_size\":" << t.hugepage_size << ","
+              << "\"hugepage_hugetlb_bytes\":" << t.hugepage_hugetlb_bytes << ","
+              << "\"hugepage_thp_bytes\":" << t.hugepage_thp_bytes << ","
+              << "\"hugepage_thp_backed_bytes\":" << t.hugepage_thp_backed_bytes << ",";
+        f << "\"numa_nodes\":" << t.numa_nodes << ",\"numa_node\":" << t.numa_node << ","
+          << "\"numa_bound_bytes\":" << t.numa_bound_bytes << ",";
+        if (t.numa_input_local >= 0)
+            f << "\"numa_input_local\":" << t.numa_input_local << ",";
+        if (t.numa_remote_ratio >= 0)
+            f << "\"numa_remote_ratio\":" << t.numa_remote_ratio << ",";
+        f << "\"faults_minor_before\":" << t.faults_minor_before << ","
+          << "\"faults_minor_after\":" << t.faults_minor_after << ","
+          << "\"faults_major_before\":" << t.faults_major_before << ","
+          << "\"faults_major_after\":" << t.faults_major_after << ","
+          << "\"prefetch_distance\":" << t.prefetch_distance << ","
+          << "\"flight_records\":" << t.flight_records << ",\"flight_dumps\":" << t.flight_dumps << ",";
+        if (t.rt_requested)
+        {
+            f << "\"realtime\":true,\"rt_mlock\":" << (t.rt_locked ? "true" : "false") << ","
+              << "\"rt_fifo_priority\":" << t.rt_fifo_priority << ","
+              << "\"rt_isolated\":" << (t.rt_isolated ? "true" : "false") << ","
+              << "\"rt_nohz_full\":" << (t.rt_nohz_full ? "true" : "false") << ",";
+            if (!t.rt_error.empty())
+            {
+                f << "\"rt_error\":\"";
+                esc(f, t.rt_error);
+                f << "\",";
+            }
+        }
+        f << "\"breaker\":\"" << Breaker::to_string(t.breaker) << "\","
           << "\"publish\":" << (t.publish_allowed ? "true" : "false") << "}\n";
         return true;
     }
@@ -66,6 +172,7 @@ namespace lob
           << "lob_p999_ms " << t.p999_ms << "\n"
           << "lob_p9999_ms " << t.p9999_ms << "\n"
           << "lob_samples " << t.sample_count << "\n"
+          << "lob_book_orders " << t.book_orders << "\n"
           << "lob_p999_valid " << (t.p999_valid ? 1 : 0) << "\n"
           << "lob_p9999_valid " << (t.p9999_valid ? 1 : 0) << "\n"
           << "lob_gap_ppm " << t.readings.gap_rate << "\n"
@@ -73,7 +180,83 @@ namespace lob
           << "lob_skew_ppm " << t.readings.skew_ppm << "\n"
           << "lob_burst_ms " << t.readings.burst_ms << "\n"
           << "lob_cpu_pin " << t.cpu_pin << "\n"
+          << "lob_snapshots_total " << t.snapshots << "\n"
+          << "lob_snapshot_failures_total " << t.snapshot_failures << "\n"
+          << "lob_snapshot_fork_ms_mean " << t.fork_ms_mean << "\n"
+          << "lob_snapshot_fork_ms_max " << t.fork_ms_max << "\n"
+          << "lob_snapshot_cow_faults_total " << t.cow_faults << "\n"
+          << "lob_snapshot_cow_faults_max " << t.cow_faults_max << "\n"
           << "lob_publish_allowed " << (t.publish_allowed ? 1 : 0) << "\n";
+        if (t.feed_active)
+        {
+            f << "lob_feed_packets_total " << t.feed_packets << "\n"
+              << "lob_feed_gaps_total " << t.feed_gaps << "\n"
+              << "lob_feed_missing_total " << t.feed_missing << "\n"
+              << "lob_feed_recovered_total " << t.feed_recovered << "\n"
+              << "lob_feed_rewind_requests_total " << t.feed_rewind_requests << "\n"
+              << "lob_feed_kernel_drops_total " << t.feed_kernel_drops << "\n";
+            prom_log2_histogram(f, "lob_feed_batch_size", t.feed_batch_hist, t.feed_batch_sum);
+            prom_log2_histogram(f, "lob_feed_wake_ns", t.feed_wake_ns_hist, t.feed_wake_ns_sum);
+        }
+        if (!t.stages.empty())
+        {
+            f << "# TYPE lob_stage_latency_ns summary\n";
+            for (const StageLatency &s : t.stages)
+            {
+                const std::string l = "lob_stage_latency_ns{stage=\"" + s.stage + "\"";
+                f << l << ",quantile=\"0.5\"} " << s.p50_ns << "\n"
+                  << l << ",quantile=\"0.99\"} " << s.p99_ns << "\n"
+                  << l << ",quantile=\"0.999\"} " << s.p999_ns << "\n"
+                  << "lob_stage_latency_ns_sum{stage=\"" << s.stage << "\"} " << s.sum_ns << "\n"
+                  << "lob_stage_latency_ns_count{stage=\"" << s.stage << "\"} " << s.count << "\n";
+            }
+        }
+        if (t.perf_requested)
+        {
+            f << "lob_perf_available " << (t.perf_error.empty() ? 1 : 0) << "\n";
+            if (t.perf_error.empty())
+            {
+                f << "lob_perf_ipc " << t.perf_ipc << "\n"
+                  << "lob_perf_running_fraction " << t.perf_running << "\n";
+                for (size_t i = 0; i < t.perf_names.size(); ++i)
+                    if (t.perf_per_msg[i] >= 0)
+                        f << "lob_perf_per_msg{counter=\"" << t.perf_names[i] << "\"} " << t.perf_per_msg[i] << "\n";
+                for (size_t s = 0; s < t.perf_stages.size(); ++s)
+                {
+                    f << "lob_perf_stage_ipc{stage=\"" << t.perf_stages[s] << "\"} " << t.perf_stage_ipc[s] << "\n";
+                    for (size_t i = 0; i < t.perf_names.size(); ++i)
+                        if (t.perf_stage_per_msg[s][i] >= 0)
+                            f << "lob_perf_stage_per_msg{stage=\"" << t.perf_stages[s] << "\",counter=\""
+                              << t.perf_names[i] << "\"} " << t.perf_stage_per_msg[s][i] << "\n";
+                }
+            }
+        }
+        if (!t.hugepages.empty())
+        {
+            f << "lob_hugepage_policy{policy=\"" << t.hugepages << "\"} 1\n"
+              << "lob_hugepage_size_bytes " << t.hugepage_size << "\n"
+              << "lob_hugepage_bytes{backing=\"hugetlb\"} " << t.hugepage_hugetlb_bytes << "\n"
+              << "lob_hugepage_bytes{backing=\"thp_advised\"} " << t.hugepage_thp_bytes << "\n"
+              << "lob_hugepage_bytes{backing=\"thp_backed\"} " << t.hugepage_thp_backed_bytes << "\n";
+        }
+        f << "lob_numa_nodes " << t.numa_nodes << "\n"
+          << "lob_numa_node " << t.numa_node << "\n"
+          << "lob_numa_bound_bytes " << t.numa_bound_bytes << "\n";
+        if (t.numa_input_local >= 0)
+            f << "lob_numa_input_local_ratio " << t.numa_input_local << "\n";
+        if (t.numa_remote_ratio >= 0)
+            f << "lob_numa_remote_ratio " << t.numa_remote_ratio << "\n";
+        f << "lob_loop_page_faults{kind=\"minor\"} " << t.faults_minor_after - t.faults_minor_before << "\n"
+          << "lob_loop_page_faults{kind=\"major\"} " << t.faults_major_after - t.faults_major_before << "\n"
+          << "lob_prefetch_distance " << t.prefetch_distance << "\n"
+          << "lob_flight_dumps " << t.flight_dumps << "\n";
+        if (t.rt_requested)
+        {
+            f << "lob_realtime_mlock " << (t.rt_locked ? 1 : 0) << "\n"
+              << "lob_realtime_fifo_priority " << t.rt_fifo_priority << "\n"
+              << "lob_realtime_cpu_isolated " << (t.rt_isolated ? 1 : 0) << "\n"
+              << "lob_realtime_cpu_nohz_full " << (t.rt_nohz_full ? 1 : 0) << "\n";
+        }
         return true;
     }
     std::string now_iso8601()
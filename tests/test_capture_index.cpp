@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: Apache-2.0
+// Capture index: seeks must land where a linear scan would, and per-symbol
+// windowed replays must rebuild exactly the books of a full replay.
+#include "capture_index.hpp"
+#include "event.hpp"
+#include "test_util.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+int main()
+{
+  using namespace lob;
+  using namespace lob::test;
+  const std::string golden = GOLDEN_INPUT_PATH;
+  const std::string index = "capture_index_test.idx";
+  std::ifstream f(golden, std::ios::binary);
+  const std::vector<uint8_t> cap((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+  const uint64_t events = cap.size() / kEventSize;
+
+  int rc = -1;
+  const std::string built =
+      run(std::string(BUILD_INDEX_BIN_PATH) + " --input " + golden + " --out " + index + " --stride 500", rc);
+  if (rc != 0)
+    return fail("build_index failed:\n" + built);
+
+  CaptureIndexView view;
+  std::string err;
+  if (!view.open(index, err) || !view.matches(cap) || view.header().event_count != events)
+    return fail("index did not open or match: " + err);
+
+  // Time seeks agree with a linear scan, including exact event times,
+  // times between events, and times before and after the capture.
+  std::vector<uint64_t> ts(events);
+  for (uint64_t i = 0; i < events; ++i)
+    ts[i] = decode_event(cap.data() + i * kEventSize, i).ts_ns;
+  for (const uint64_t t : {uint64_t{0}, ts[1], ts[499], ts[500], ts[501] + 1, ts[77777], ts[events - 1],
+                           ts[events - 1] + 1, uint64_t{1} << 62})
+  {
+    uint64_t want = 0;
+    while (want < events && ts[want] < t)
+      ++want;
+    if (view.seek_time(cap, t) != want)
+      return fail("seek_time(" + std::to_string(t) + ") = " + std::to_string(view.seek_time(cap, t)) +
+                  ", expected " + std::to_string(want));
+  }
+
+  // Postings cover every event once, each under its own symbol.
+  uint64_t posted = 0;
+  for (uint32_t s = 0; s < view.header().symbol_count; ++s)
+  {
+    const auto post = view.postings(s);
+    posted += post.size();
+    for (const uint32_t i : post)
+      if (decode_event(cap.data() + uint64_t(i) * kEventSize, i).symbol != s)
+        return fail("posting under the wrong symbol");
+    if (!post.empty() && (view.symbols()[s].first_offset != uint64_t(post.front()) * kEventSize ||
+                          view.symbols()[s].last_offset != uint64_t(post.back()) * kEventSize))
+      return fail("symbol first/last offsets disagree with postings");
+  }
+  if (posted != events)
+    return fail("postings do not cover the capture");
+
+  // Replaying each symbol alone over the whole capture gives back the full
+  // run's books, folded the same way replay folds them.
+  const ReplayRun full = replay_golden("capture_index_art");
+  if (full.rc != 0)
+    return fail("full replay failed:\n" + full.out);
+  uint64_t folded = 1469598103934665603ull;
+  uint64_t orders = 0;
+  for (uint32_t s = 0; s < kSymbolCount; ++s)
+  {
+    const ReplayRun w = replay_golden("capture_index_art", "--symbol " + std::to_string(s) + " --index " + index);
+    if (w.rc != 0)
+      return fail("symbol window failed:\n" + w.out);
+    folded = (folded ^ std::stoull(field(w.out, "symbol_book_digest"), nullptr, 16)) * 1099511628211ull;
+    orders += std::stoull(field(w.out, "book_orders"));
+  }
+  char hex[24];
+  std::snprintf(hex, sizeof(hex), "0x%016llx", static_cast<unsigned long long>(folded));
+  if (field(full.out, "book_digest") != hex || field(full.out, "book_orders") != std::to_string(orders))
+    return fail(std::string("per-symbol books fold to ") + hex + ", full run has " + field(full.out, "book_digest"));
+
+  // A one-millisecond window replays exactly that symbol's events in it.
+  const ReplayRun w = replay_golden("capture_index_art", "--symbol 5 --from 60ms --to 61ms --index " + index);
+  uint64_t want = 0;
+  for (uint64_t i = 0; i < events; ++i)
+    want += ts[i] >= 60'000'000 && ts[i] <= 61'000'000 &&
+            decode_event(cap.data() + i * kEventSize, i).symbol == 5;
+  if (w.rc != 0 || field(w.out, "events") != std::to_string(want))
+    return fail("window replayed " + field(w.out, "events") + " events, expected " + std::to_string(want) + ":\n" +
+                w.out);
+
+  // An index built from another capture is refused.
+  {
+    std::vector<uint8_t> other(cap);
+    other.back() ^= 1;
+    std::ofstream("capture_index_other.bin", std::ios::binary)
+        .write(reinterpret_cast<const char *>(other.data()), static_cast<std::streamsize>(other.size()));
+  }
+  run(std::string(REPLAY_BIN_PATH) + " --input capture_index_other.bin --symbol 0 --index " + index, rc);
+  std::remove("capture_index_other.bin");
+  std::remove(index.c_str());
+  if (rc == 0)
+    return fail("index for another capture was accepted");
+
+  std::cout << "capture index ok: window " << field(w.out, "events") << " events, read "
+            << field(w.out, "bytes_read") << " of " << cap.size() << " bytes" << std::endl;
+  return 0;
+}
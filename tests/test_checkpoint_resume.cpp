@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: Apache-2.0
+// Checkpoint/restart: a run resumed from any periodic checkpoint must end with
+// the same input digest and book state as an uninterrupted run, and a run
+// started from a book snapshot with the same book state. Dumps taken with
+// --snapshot-at resume the same way.
+#include "test_util.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main()
+{
+  using namespace lob::test;
+  namespace fs = std::filesystem;
+  const fs::path dir = "ckpt_test_art/checkpoints";
+  std::error_code ec;
+  fs::remove_all("ckpt_test_art", ec);
+
+  const ReplayRun full = replay_golden("ckpt_test_art");
+  if (full.rc != 0)
+  {
+    std::cerr << "uninterrupted run failed:\n" << full.out << std::endl;
+    return 1;
+  }
+
+  const ReplayRun ckpt = replay_golden("ckpt_test_art", "--checkpoint-every 25000 --burst-ms 3");
+  if (ckpt.rc != 0 || field(ckpt.out, "digest_fnv") != field(full.out, "digest_fnv"))
+  {
+    std::cerr << "checkpointing run diverged:\n" << ckpt.out << std::endl;
+    return 2;
+  }
+
+  int resumed = 0;
+  for (const auto &entry : fs::directory_iterator(dir, ec))
+  {
+    const ReplayRun r = replay_golden("ckpt_test_art", "--burst-ms 3 --resume-from " + entry.path().string());
+    if (r.rc != 0)
+    {
+      std::cerr << "resume from " << entry.path() << " failed:\n" << r.out << std::endl;
+      return 3;
+    }
+    for (const char *key : {"digest_fnv", "book_digest", "book_orders", "breaker"})
+    {
+      if (field(r.out, key) != field(ckpt.out, key))
+      {
+        std::cerr << key << " mismatch resuming from " << entry.path() << ": got "
+                  << field(r.out, key) << " expected " << field(ckpt.out, key) << std::endl;
+        return 4;
+      }
+    }
+    // A checkpoint is also a book snapshot; --snapshot-in seeks past the
+    // events it already holds instead of applying them twice.
+    const ReplayRun s = replay_golden("ckpt_test_art", "--burst-ms 3 --snapshot-in " + entry.path().string());
+    if (s.rc != 0 || field(s.out, "book_digest") != field(ckpt.out, "book_digest") ||
+        field(s.out, "book_orders") != field(ckpt.out, "book_orders"))
+    {
+      std::cerr << "--snapshot-in " << entry.path() << " diverged:\n" << s.out << std::endl;
+      return 6;
+    }
+    ++resumed;
+  }
+  if (resumed < 4)
+  {
+    std::cerr << "expected at least 4 checkpoints, found " << resumed << std::endl;
+    return 5;
+  }
+
+  // A plain end-of-run snapshot of the first 25000 events continues the full
+  // capture from event 25000.
+  {
+    std::ifstream in(GOLDEN_INPUT_PATH, std::ios::binary);
+    std::vector<char> head(25000 * 64);
+    in.read(head.data(), static_cast<std::streamsize>(head.size()));
+    std::ofstream("ckpt_test_art/head.bin", std::ios::binary).write(head.data(), in.gcount());
+  }
+  const ReplayRun head =
+      replay_golden("ckpt_test_art", "--input ckpt_test_art/head.bin --snapshot-out ckpt_test_art/head.snap");
+  const ReplayRun rest = replay_golden("ckpt_test_art", "--snapshot-in ckpt_test_art/head.snap");
+  if (head.rc != 0 || rest.rc != 0 || field(rest.out, "book_digest") != field(full.out, "book_digest") ||
+      field(rest.out, "book_orders") != field(full.out, "book_orders"))
+  {
+    std::cerr << "--snapshot-in of a plain snapshot diverged:\n" << head.out << rest.out << std::endl;
+    return 7;
+  }
+  const ReplayRun shorter = replay_golden("ckpt_test_art", "--input ckpt_test_art/head.bin --snapshot-in " +
+                                                               (dir / "ckpt_000000100000.snap").string());
+  if (shorter.rc == 0)
+  {
+    std::cerr << "--snapshot-in accepted an input shorter than the snapshot:\n" << shorter.out << std::endl;
+    return 8;
+  }
+
+  // One-off dumps at chosen indices resume like periodic checkpoints, and
+  // the run reports what the forks cost; indices past the end are named.
+  const ReplayRun at = replay_golden("ckpt_test_art", "--snapshot-at 30000,90000,200000");
+  if (at.rc != 0 || field(at.out, "digest_fnv") != field(full.out, "digest_fnv") ||
+      at.out.find("--snapshot-at past the last event (125000), not written: 200000") == std::string::npos)
+  {
+    std::cerr << "--snapshot-at run failed:\n" << at.out << std::endl;
+    return 9;
+  }
+  auto metric = [&](const std::string &name)
+  {
+    const auto pos = at.prom.find("\n" + name + " ");
+    return pos == std::string::npos ? -1.0 : std::stod(at.prom.substr(pos + name.size() + 2));
+  };
+  if (metric("lob_snapshots_total") != 2 || metric("lob_snapshot_failures_total") != 0 ||
+      metric("lob_snapshot_fork_ms_max") <= 0 || metric("lob_snapshot_fork_ms_mean") <= 0 ||
+      metric("lob_snapshot_cow_faults_max") < 0 ||
+      metric("lob_snapshot_cow_faults_max") > metric("lob_snapshot_cow_faults_total"))
+  {
+    std::cerr << "--snapshot-at fork telemetry:\n" << at.prom << std::endl;
+    return 10;
+  }
+  for (const char *name : {"snap_000000030000.snap", "snap_000000090000.snap"})
+  {
+    const ReplayRun r = replay_golden("ckpt_test_art", "--resume-from " + (dir / name).string());
+    if (!fs::exists(dir / name) || r.rc != 0 || field(r.out, "digest_fnv") != field(full.out, "digest_fnv") ||
+        field(r.out, "book_digest") != field(full.out, "book_digest"))
+    {
+      std::cerr << "resume from " << name << " diverged:\n" << r.out << std::endl;
+      return 11;
+    }
+  }
+
+  fs::remove_all("ckpt_test_art", ec);
+  std::cout << "checkpoint resume matched uninterrupted run from " << resumed << " checkpoints" << std::endl;
+  return 0;
+}
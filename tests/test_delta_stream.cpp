@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: Apache-2.0
+// Delta stream round trip: random flow over every symbol is encoded through
+// a small BufferedWriter (forcing many flushes), read back, decoded, and the
+// rebuilt per-symbol level maps must equal the books. Also bounds the
+// encoded size per change.
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "delta_stream.hpp"
+#include "event.hpp"
+
+using namespace lob;
+
+namespace
+{
+  struct Mirrored
+  {
+    uint64_t qty{0};
+    uint32_t count{0};
+  };
+
+  bool mirror_matches(const std::map<int64_t, Mirrored> &mirror, const OrderBook &b, Side s)
+  {
+    const auto &lv = b.levels(s);
+    if (mirror.size() != lv.size())
+      return false;
+    for (const auto &l : lv)
+    {
+      auto it = mirror.find(l.px);
+      if (it == mirror.end() || it->second.qty != l.qty || it->second.count != l.count)
+        return false;
+    }
+    return true;
+  }
+} // namespace
+
+int main()
+{
+  const char *path = "delta_stream_test.bin";
+  constexpr uint64_t kMessages = 300'000;
+  constexpr uint64_t kBase = 7;
+  OrderBook books[kSymbolCount];
+  uint64_t changes = 0;
+  {
+    // A reservation larger than the buffer cannot be honoured by a flush.
+    BufferedWriter small(64);
+    if (!small.open(path) || !small.reserve(64) || small.reserve(65))
+    {
+      std::cerr << "reserve beyond the buffer size was not refused" << std::endl;
+      return 1;
+    }
+  }
+  {
+    BufferedWriter out(4096);
+    DeltaEncoder enc(out);
+    if (!out.open(path) || !enc.begin(kSymbolCount, kBase, kBase * 1000))
+    {
+      std::cerr << "could not open " << path << std::endl;
+      return 1;
+    }
+    for (auto &b : books)
+      b.record_deltas(true);
+
+    std::mt19937_64 rng(0xDE17A5ULL);
+    uint8_t ev[kEventSize];
+    for (uint64_t i = kBase; i < kBase + kMessages; ++i)
+    {
+      for (size_t w = 0; w < kEventSize / 8; ++w)
+      {
+        uint64_t v = rng();
+        std::memcpy(ev + w * 8, &v, 8);
+      }
+      const Event e = decode_event(ev, i);
+      OrderBook &b = books[e.symbol];
+      apply_event(b, e);
+      changes += b.deltas().size();
+      if (!enc.on_message(i, e.ts_ns, e.symbol, b.deltas()))
+      {
+        std::cerr << "encode failed at message " << i << std::endl;
+        return 2;
+      }
+      b.clear_deltas();
+    }
+    if (!out.close())
+    {
+      std::cerr << "write failed" << std::endl;
+      return 2;
+    }
+  }
+
+  std::ifstream in(path, std::ios::binary);
+  std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  DeltaDecoder dec;
+  if (!dec.open(bytes.data(), bytes.size()) || dec.header().symbols != kSymbolCount)
+  {
+    std::cerr << "bad delta stream header" << std::endl;
+    return 3;
+  }
+
+  std::map<int64_t, Mirrored> mirror[kSymbolCount][2];
+  DecodedDelta d{};
+  uint64_t decoded = 0, last_index = 0;
+  while (dec.next(d))
+  {
+    if (d.msg_index < last_index || d.msg_index >= kBase + kMessages || d.symbol >= kSymbolCount)
+    {
+      std::cerr << "record out of range at change " << decoded << std::endl;
+      return 4;
+    }
+    last_index = d.msg_index;
+    auto &m = mirror[d.symbol][static_cast<size_t>(d.side)][d.px];
+    m.qty = static_cast<uint64_t>(static_cast<int64_t>(m.qty) + d.qty_change);
+    m.count = d.count;
+    if (d.count == 0)
+    {
+      if (m.qty != 0)
+      {
+        std::cerr << "removed level kept qty " << m.qty << " at change " << decoded << std::endl;
+        return 4;
+      }
+      mirror[d.symbol][static_cast<size_t>(d.side)].erase(d.px);
+    }
+    ++decoded;
+  }
+  if (dec.error() || decoded != changes)
+  {
+    std::cerr << "decoded " << decoded << " of " << changes << " changes" << std::endl;
+    return 5;
+  }
+
+  for (size_t s = 0; s < kSymbolCount; ++s)
+  {
+    if (!mirror_matches(mirror[s][0], books[s], Side::Bid) || !mirror_matches(mirror[s][1], books[s], Side::Ask))
+    {
+      std::cerr << "decoded stream does not reproduce symbol " << s << std::endl;
+      return 6;
+    }
+  }
+
+  const double per_change = static_cast<double>(bytes.size() - sizeof(DeltaStreamHeader)) / static_cast<double>(changes);
+  if (per_change > 12.0)
+  {
+    std::cerr << "delta stream too large: " << per_change << " bytes/change" << std::endl;
+    return 7;
+  }
+
+  std::cout << "delta stream round trip ok: " << changes << " changes, " << bytes.size() << " bytes ("
+            << per_change << " bytes/change)" << std::endl;
+  return 0;
+}
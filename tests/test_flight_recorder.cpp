@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: Apache-2.0
+// Flight recorder: the ring keeps the newest N records and dumps them oldest
+// first across the wrap, SIGUSR1 raises a one-shot request, and a replay
+// whose breaker escalates leaves a dump of what it stepped on - without
+// changing the run.
+#include "flight_recorder.hpp"
+#include "fork_snapshot.hpp"
+#include "test_util.hpp"
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace lob;
+using namespace lob::test;
+
+namespace
+{
+  bool load(const std::string &path, FlightHeader &h, std::vector<FlightRecord> &recs)
+  {
+    std::ifstream f(path, std::ios::binary);
+    const std::vector<char> b{std::istreambuf_iterator<char>(f), {}};
+    if (b.size() < sizeof(h))
+      return false;
+    std::memcpy(&h, b.data(), sizeof(h));
+    if (std::memcmp(h.magic, kFlightMagic, 8) != 0 || h.version != kFlightVersion ||
+        h.record_bytes != sizeof(FlightRecord) || b.size() != sizeof(h) + h.count * sizeof(FlightRecord))
+      return false;
+    recs.resize(h.count);
+    std::memcpy(recs.data(), b.data() + sizeof(h), h.count * sizeof(FlightRecord));
+    return true;
+  }
+} // namespace
+
+int main()
+{
+  if (FlightRecorder(0).enabled() || FlightRecorder(5).capacity() != 8)
+    return fail("capacity");
+
+  // 20 records through an 8-slot ring: 12..19 survive, in order.
+  FlightRecorder ring(5);
+  DetectorReadings r{};
+  for (uint64_t i = 0; i < 20; ++i)
+  {
+    Event e{};
+    e.ref = 1000 + i;
+    e.type = static_cast<MsgType>(i % 4);
+    r.gap_rate = static_cast<double>(i);
+    ring.record(i, e, i % 2 == 0, r, i < 15 ? BreakerState::Fuse : BreakerState::Feeder);
+  }
+  if (ring.size() != 8 || ring.recorded() != 20 || ring.at(0).msg_index != 12 || ring.at(7).msg_index != 19)
+    return fail("ring contents");
+  std::string err;
+  if (!ring.write("flight_unit.bin", FlightTrigger::escalation, BreakerState::Fuse, BreakerState::Feeder, err))
+    return fail("write: " + err);
+  FlightHeader h{};
+  std::vector<FlightRecord> recs;
+  if (!load("flight_unit.bin", h, recs))
+    return fail("dump header");
+  std::remove("flight_unit.bin");
+  if (h.count != 8 || h.capacity != 8 || h.recorded != 20 || h.trigger_msg != 19 ||
+      h.trigger != static_cast<uint32_t>(FlightTrigger::escalation) || h.from != 0 || h.to != 2)
+    return fail("dump header fields");
+  for (size_t i = 0; i < recs.size(); ++i)
+    if (recs[i].msg_index != 12 + i || recs[i].ref != 1012 + i || recs[i].gap_ppm != float(12 + i) ||
+        recs[i].applied != (i % 2 == 0) || recs[i].breaker != (12 + i < 15 ? 0 : 2))
+      return fail("dump record " + std::to_string(i));
+
+  if (!install_flight_signal(SIGUSR1, err))
+    return fail("install: " + err);
+  const bool before = take_flight_request();
+  std::raise(SIGUSR1);
+  const bool first = take_flight_request(), second = take_flight_request();
+  if (before || !first || second)
+    return fail("SIGUSR1 request is not one-shot");
+
+  // Two snapshotters in one process (replay runs the checkpointer and the
+  // flight dumper side by side) each reap only their own children.
+  {
+    ForkSnapshotter a, b;
+    for (int i = 0; i < 3; ++i)
+    {
+      if (!a.spawn([] { return ::usleep(20'000) == 0; }) || !b.spawn([] { return true; }))
+        return fail("spawn");
+      ::usleep(5'000); // b's child is done before a's next spawn reaps
+    }
+    a.reap(true);
+    b.reap(true);
+    if (a.completed() != 3 || a.failed() != 0 || b.completed() != 3 || b.failed() != 0 ||
+        a.stats().forked != 3 || b.stats().forked != 3)
+      return fail("snapshotters reaped each other's children: a " + std::to_string(a.completed()) + "/" +
+                  std::to_string(a.failed()) + " b " + std::to_string(b.completed()) + "/" +
+                  std::to_string(b.failed()));
+  }
+
+  int rc = -1;
+  const std::string out = run(std::string(REPLAY_BIN_PATH) + " --flight-records -1", rc);
+  if (rc == 0 || out.find("Invalid value for --flight-records") == std::string::npos)
+    return fail("--flight-records -1 accepted:\n" + out);
+
+  // An injected 300 ppm gap rate reads 240 ppm on the first event: Main.
+  const std::filesystem::path dir = "flight_art/flight";
+  std::filesystem::remove_all(dir);
+  const ReplayRun ref = replay_golden("flight_art");
+  const ReplayRun esc = replay_golden("flight_art", "--gap-ppm 300");
+  if (esc.rc != 0 || !same_digests(esc.out, ref) ||
+      esc.out.find("flight dumps written=1 failed=0") == std::string::npos)
+    return fail("replay with escalation:\n" + esc.out);
+  if (esc.jsonl.find("\"flight_records\":4096,\"flight_dumps\":1,") == std::string::npos ||
+      esc.prom.find("lob_flight_dumps 1\n") == std::string::npos)
+    return fail("flight dumps not reported:\n" + esc.prom);
+  const auto path = dir / "flight_000000000000_escalation.bin";
+  if (!load(path.string(), h, recs))
+    return fail("no escalation dump at " + path.string());
+  std::filesystem::remove_all(dir);
+  if (h.from != 0 || h.to != 3 || h.count != 1 || h.trigger_msg != 0 || recs[0].msg_index != 0 ||
+      recs[0].breaker != 3 || recs[0].gap_ppm < 200.0f)
+    return fail("escalation dump contents");
+
+  // With checkpoints cut alongside, both kinds of dump are still accounted.
+  const ReplayRun with_ckpt = replay_golden("flight_art", "--gap-ppm 300 --checkpoint-every 100000");
+  std::filesystem::remove_all("flight_art/checkpoints");
+  const bool both = std::filesystem::exists(path);
+  std::filesystem::remove_all(dir);
+  if (with_ckpt.rc != 0 || !both || with_ckpt.out.find("flight dumps written=1 failed=0") == std::string::npos ||
+      with_ckpt.out.find("state dumps written=1 failed=0") == std::string::npos)
+    return fail("flight dumps alongside checkpoints:\n" + with_ckpt.out);
+
+  std::cout << "flight recorder ok" << std::endl;
+  return 0;
+}
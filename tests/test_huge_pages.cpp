@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: Apache-2.0
+// Huge pages: large allocations follow the policy (mapped, 2 MiB aligned,
+// released by munmap even after the policy changes), small ones and `off`
+// stay on the heap, a book over huge-page pools replays identically, and
+// `replay --hugepages` keeps the golden digest and reports what it got.
+#include "huge_pages.hpp"
+#include "order_book.hpp"
+#include "test_util.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace lob;
+using namespace lob::test;
+
+namespace
+{
+  uint64_t mapped_bytes(const HugePageReport &r)
+  {
+    return r.hugetlb_1g_bytes + r.hugetlb_2m_bytes + r.thp_bytes;
+  }
+
+  // Same pseudo-random flow into any book: adds, cancels and partial fills.
+  uint64_t churn(OrderBook &b)
+  {
+    std::mt19937_64 rng(11);
+    for (uint64_t id = 1; id <= 200'000; ++id)
+    {
+      const Side s = rng() & 1 ? Side::Bid : Side::Ask;
+      b.add(id, s, s == Side::Bid ? 1000 - int64_t(rng() % 64) : 1001 + int64_t(rng() % 64), 1 + rng() % 100);
+      if (rng() % 3 == 0)
+        b.erase(1 + rng() % id);
+    }
+    return b.digest();
+  }
+} // namespace
+
+int main()
+{
+  // off: nothing is mapped, whatever the size.
+  set_huge_page_policy(HugePagePolicy::off);
+  {
+    HugeVector<uint64_t> v(1 << 20);
+    if (mapped_bytes(huge_page_report()) != 0)
+      return fail("policy off mapped memory");
+  }
+
+#ifdef __linux__
+  std::string why;
+  const bool available = huge_pages_available(why);
+  set_huge_page_policy(HugePagePolicy::automatic);
+  {
+    HugeVector<uint8_t> small(kHugePageSize - 1);
+    if (mapped_bytes(huge_page_report()) != 0)
+      return fail("allocation below 2 MiB was mapped");
+  }
+  {
+    HugeVector<uint64_t> v(3 << 17); // 3 MiB
+    for (size_t i = 0; i < v.size(); i += 512)
+      v[i] = i;
+    const HugePageReport r = huge_page_report();
+    if (available)
+    {
+      if (mapped_bytes(r) != 4u << 20 || reinterpret_cast<uintptr_t>(v.data()) % kHugePageSize != 0)
+        return fail("3 MiB allocation not mapped as two aligned huge pages");
+      if (r.thp_backed_bytes > r.thp_bytes || (r.page_size != 4096 && r.page_size < kHugePageSize))
+        return fail("inconsistent report");
+      std::cout << "3 MiB: page_size=" << r.page_size << " hugetlb=" << r.hugetlb_2m_bytes
+                << " thp=" << r.thp_bytes << " thp_backed=" << r.thp_backed_bytes << std::endl;
+    }
+    else
+      std::cout << "no huge pages here: " << why << std::endl;
+    // Released by munmap although the policy changed in between.
+    set_huge_page_policy(HugePagePolicy::off);
+  }
+  if (!detail::huge_page_state().live.empty())
+    return fail("mapping outlived its vector");
+#endif
+
+  // A book whose pools were reserved onto huge pages behaves identically.
+  OrderBook heap_book;
+  const uint64_t want = churn(heap_book);
+  set_huge_page_policy(HugePagePolicy::automatic);
+  OrderBook huge_book;
+  huge_book.reserve(400'000);
+  if (churn(huge_book) != want || huge_book.size() != heap_book.size())
+    return fail("book over huge-page pools diverged");
+  set_huge_page_policy(HugePagePolicy::off);
+
+  int rc = -1;
+  const std::string out = run(std::string(REPLAY_BIN_PATH) + " --hugepages sometimes", rc);
+  if (rc == 0 || out.find("Invalid value for --hugepages") == std::string::npos)
+    return fail("bad --hugepages value accepted:\n" + out);
+  const ReplayRun ref = replay_golden("huge_pages_art");
+  for (const char *mode : {"off", "auto", "on"})
+  {
+    const ReplayRun r = replay_golden("huge_pages_art", std::string("--hugepages ") + mode);
+#ifdef __linux__
+    if (std::string(mode) == "on" && !available)
+    {
+      if (r.rc == 0 || r.out.find("--hugepages on:") == std::string::npos)
+        return fail("--hugepages on started without huge pages:\n" + r.out);
+      continue;
+    }
+#endif
+    if (r.rc != 0 || !same_digests(r.out, ref))
+      return fail(std::string("--hugepages ") + mode + " changed the run:\n" + r.out);
+    // The stderr summary is for runs that asked for huge pages.
+    if ((r.out.find("hugepages policy=") != std::string::npos) != (std::string(mode) == "on"))
+      return fail(std::string("--hugepages ") + mode + " summary line:\n" + r.out);
+    const std::string &jsonl = r.jsonl, &prom = r.prom;
+    const std::string last = jsonl.substr(jsonl.rfind('\n', jsonl.size() - 2) + 1);
+    if (last.find(std::string("\"hugepages\":\"") + mode + "\",\"hugepage_size\":") == std::string::npos ||
+        prom.find(std::string("lob_hugepage_policy{policy=\"") + mode + "\"} 1") == std::string::npos ||
+        prom.find("lob_hugepage_size_bytes ") == std::string::npos)
+      return fail(std::string("--hugepages ") + mode + " not reported:\n" + last + prom);
+    if (std::string(mode) == "off" && prom.find("lob_hugepage_bytes{backing=\"thp_advised\"} 0") == std::string::npos)
+      return fail("--hugepages off mapped the input:\n" + prom);
+  }
+  std::cout << "huge pages ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: Apache-2.0
+// L2 view consistency: after every message the cached top-N must equal a
+// rescan of the L3 levels, and replaying the per-message level deltas into a
+// plain price->level map must reproduce the full aggregated book.
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "event.hpp"
+
+using namespace lob;
+
+namespace
+{
+  bool top_matches(const OrderBook &b, Side s)
+  {
+    L2Level got[OrderBook::kL2Depth];
+    const size_t n = b.depth(s, got, OrderBook::kL2Depth);
+    const auto &lv = b.levels(s);
+    if (n != std::min(lv.size(), OrderBook::kL2Depth))
+      return false;
+    for (size_t r = 0; r < n; ++r)
+    {
+      const Level &l = lv[lv.size() - 1 - r];
+      if (got[r].px != l.px || got[r].qty != l.qty || got[r].count != l.count)
+        return false;
+    }
+    return true;
+  }
+
+  bool mirror_matches(const std::map<int64_t, LevelDelta> &mirror, const OrderBook &b, Side s)
+  {
+    const auto &lv = b.levels(s);
+    if (mirror.size() != lv.size())
+      return false;
+    for (const auto &l : lv)
+    {
+      auto it = mirror.find(l.px);
+      if (it == mirror.end() || it->second.qty != l.qty || it->second.count != l.count)
+        return false;
+    }
+    return true;
+  }
+} // namespace
+
+int main()
+{
+  OrderBook book;
+  book.record_deltas(true);
+  std::map<int64_t, LevelDelta> mirror[2];
+
+  std::mt19937_64 rng(0x12C0FFEEULL);
+  uint8_t ev[kEventSize];
+  for (uint64_t i = 0; i < 200'000; ++i)
+  {
+    for (size_t w = 0; w < kEventSize / 8; ++w)
+    {
+      uint64_t v = rng();
+      std::memcpy(ev + w * 8, &v, 8);
+    }
+    Event e = decode_event(ev, i);
+    // Single book: fold all symbols together for a denser level ladder.
+    apply_event(book, e);
+
+    for (const auto &d : book.deltas())
+    {
+      auto &m = mirror[static_cast<size_t>(d.side)];
+      if (d.qty == 0)
+        m.erase(d.px);
+      else
+        m[d.px] = d;
+    }
+    book.clear_deltas();
+
+    if (!top_matches(book, Side::Bid) || !top_matches(book, Side::Ask))
+    {
+      std::cerr << "top-N cache diverged from L3 levels at message " << i << std::endl;
+      return 1;
+    }
+    if (i % 1000 == 0 &&
+        (!mirror_matches(mirror[0], book, Side::Bid) || !mirror_matches(mirror[1], book, Side::Ask)))
+    {
+      std::cerr << "delta stream does not reproduce levels at message " << i << std::endl;
+      return 2;
+    }
+  }
+
+  if (book.bids().size() <= OrderBook::kL2Depth || book.asks().size() <= OrderBook::kL2Depth)
+  {
+    std::cerr << "ladder too shallow to exercise the cache edge" << std::endl;
+    return 3;
+  }
+
+  std::cout << "l2 view consistent over 200000 messages (" << book.bids().size() << " bid / "
+            << book.asks().size() << " ask levels)" << std::endl;
+  return 0;
+}
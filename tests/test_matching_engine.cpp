@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: Apache-2.0
+// Matching engine: hand-checked order-type scenarios, then a random order
+// flow checked fill by fill against a naive price-time reference matcher.
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "matching_engine.hpp"
+#include "test_util.hpp"
+
+using namespace lob;
+using namespace lob::test;
+
+namespace
+{
+  // Price -> FIFO of (id, qty); the straightforward way to write it.
+  struct Reference
+  {
+    struct Resting
+    {
+      uint64_t id;
+      uint32_t qty;
+    };
+    std::map<int64_t, std::deque<Resting>> side[2];
+    std::map<uint64_t, std::pair<Side, int64_t>> where;
+
+    static bool crosses(Side taker, int64_t level, int64_t limit)
+    {
+      return taker == Side::Bid ? level <= limit : level >= limit;
+    }
+
+    uint64_t available(Side taker, int64_t limit)
+    {
+      uint64_t n = 0;
+      auto &book = side[taker == Side::Bid ? 1 : 0];
+      for (auto &[px, q] : book)
+        if (crosses(taker, px, limit))
+          for (auto &r : q)
+            n += r.qty;
+      return n;
+    }
+
+    MatchResult submit(const OrderRequest &o, std::vector<Fill> &fills)
+    {
+      fills.clear();
+      if (o.qty == 0 || where.count(o.id))
+        return {};
+      const int64_t limit = o.type == OrderType::Market ? (o.side == Side::Bid ? INT64_MAX : INT64_MIN) : o.px;
+      const uint64_t avail = available(o.side, limit);
+      if ((o.type == OrderType::PostOnly && avail) || (o.type == OrderType::FOK && avail < o.qty))
+        return {};
+      uint32_t left = o.qty;
+      auto &book = side[o.side == Side::Bid ? 1 : 0];
+      while (left && !book.empty())
+      {
+        auto it = o.side == Side::Bid ? book.begin() : std::prev(book.end());
+        if (!crosses(o.side, it->first, limit))
+          break;
+        auto &q = it->second;
+        while (left && !q.empty())
+        {
+          const uint32_t f = std::min(left, q.front().qty);
+          fills.push_back(Fill{o.id, q.front().id, it->first, f, o.side});
+          left -= f;
+          if ((q.front().qty -= f) == 0)
+          {
+            where.erase(q.front().id);
+            q.pop_front();
+          }
+        }
+        if (q.empty())
+          book.erase(it);
+      }
+      if (left == 0)
+        return {OrderStatus::Filled, o.qty, 0};
+      if (o.type == OrderType::Limit || o.type == OrderType::PostOnly)
+      {
+        side[o.side == Side::Bid ? 0 : 1][o.px].push_back({o.id, left});
+        where[o.id] = {o.side, o.px};
+        return {OrderStatus::Rested, o.qty - left, left};
+      }
+      return {OrderStatus::Cancelled, o.qty - left, 0};
+    }
+
+    bool cancel(uint64_t id)
+    {
+      auto w = where.find(id);
+      if (w == where.end())
+        return false;
+      auto &book = side[w->second.first == Side::Bid ? 0 : 1];
+      auto &q = book[w->second.second];
+      for (auto it = q.begin(); it != q.end(); ++it)
+        if (it->id == id)
+        {
+          q.erase(it);
+          break;
+        }
+      if (q.empty())
+        book.erase(w->second.second);
+      where.erase(w);
+      return true;
+    }
+
+    MatchResult replace(uint64_t id, int64_t px, uint32_t qty, std::vector<Fill> &fills)
+    {
+      fills.clear();
+      auto w = where.find(id);
+      if (w == where.end() || qty == 0)
+        return {};
+      const auto [s, old_px] = w->second;
+      auto &q = side[s == Side::Bid ? 0 : 1][old_px];
+      for (auto &r : q)
+        if (r.id == id && px == old_px && qty <= r.qty)
+        {
+          r.qty = qty;
+          return {OrderStatus::Rested, 0, qty};
+        }
+      cancel(id);
+      return submit(OrderRequest{id, px, qty, s, OrderType::Limit}, fills);
+    }
+  };
+
+  bool same(const MatchResult &a, const MatchResult &b)
+  {
+    return a.status == b.status && a.filled == b.filled && a.resting == b.resting;
+  }
+} // namespace
+
+int main()
+{
+  // Scenarios on a small book: asks 100 (ids 1, 2) and 101 (id 3).
+  {
+    MatchingEngine m(64);
+    m.submit({1, 100, 5, Side::Ask});
+    m.submit({2, 100, 5, Side::Ask});
+    m.submit({3, 101, 10, Side::Ask});
+    m.submit({4, 98, 10, Side::Bid});
+
+    if (m.submit({10, 100, 1, Side::Bid, OrderType::PostOnly}).status != OrderStatus::Rejected)
+      return fail("post-only crossing order was accepted");
+    if (m.submit({11, 99, 1, Side::Bid, OrderType::PostOnly}).status != OrderStatus::Rested)
+      return fail("post-only passive order was not rested");
+    if (m.submit({12, 101, 21, Side::Bid, OrderType::FOK}).status != OrderStatus::Rejected || !m.fills().empty())
+      return fail("FOK short of liquidity traded");
+
+    // Time priority: id 1 fills before id 2 at the same price, and the
+    // sweep trades at the resting prices.
+    auto r = m.submit({13, 101, 12, Side::Bid, OrderType::IOC});
+    const auto f = m.fills();
+    if (r.status != OrderStatus::Filled || f.size() != 3 || f[0].maker_id != 1 || f[1].maker_id != 2 ||
+        f[2].maker_id != 3 || f[0].px != 100 || f[2].px != 101 || f[2].qty != 2)
+      return fail("IOC sweep did not follow price-time priority");
+
+    // Market sell walks the bids; the remainder is cancelled, not rested.
+    r = m.submit({14, 0, 15, Side::Ask, OrderType::Market});
+    if (r.status != OrderStatus::Cancelled || r.filled != 11 || m.book().contains(14) || !m.book().bids().empty())
+      return fail("market order remainder rested or fills wrong");
+
+    // Replace: shrinking keeps priority, a price change goes to the back.
+    m.submit({20, 90, 5, Side::Bid});
+    m.submit({21, 90, 5, Side::Bid});
+    m.replace(20, 90, 3);
+    m.submit({22, 90, 1, Side::Ask, OrderType::IOC});
+    if (m.fills().size() != 1 || m.fills()[0].maker_id != 20)
+      return fail("size-down replace lost queue priority");
+    m.replace(20, 89, 2);
+    m.replace(20, 90, 2);
+    m.submit({23, 90, 1, Side::Ask, OrderType::IOC});
+    if (m.fills().size() != 1 || m.fills()[0].maker_id != 21)
+      return fail("price replace kept queue priority");
+    // A replace that now crosses trades first (id 3 has 8 left at 101).
+    m.submit({24, 99, 3, Side::Bid});
+    r = m.replace(24, 101, 3);
+    if (r.status != OrderStatus::Filled || m.fills().size() != 1 || m.fills()[0].maker_id != 3)
+      return fail("crossing replace did not match");
+    if (m.cancel(24) || !m.cancel(21) || m.replace(21, 100, 1).status != OrderStatus::Rejected)
+      return fail("cancel/replace of unknown ids");
+  }
+
+  // Random flow against the reference: same results, same fills, same book.
+  MatchingEngine m(1 << 16);
+  Reference ref;
+  std::vector<Fill> want;
+  std::vector<uint64_t> live;
+  std::mt19937_64 rng(0x5EEDF111ULL);
+  uint64_t next_id = 1, fills = 0;
+  for (int i = 0; i < 300'000; ++i)
+  {
+    const uint64_t pick = rng() % 100;
+    MatchResult got, exp;
+    if (pick < 15 && !live.empty())
+    {
+      const size_t k = rng() % live.size();
+      const uint64_t id = live[k];
+      live[k] = live.back();
+      live.pop_back();
+      if (m.cancel(id) != ref.cancel(id))
+        return fail("cancel disagrees at step " + std::to_string(i));
+      continue;
+    }
+    if (pick < 25 && !live.empty())
+    {
+      const uint64_t id = live[rng() % live.size()];
+      const int64_t px = 1000 + static_cast<int64_t>(rng() % 40);
+      const uint32_t qty = 1 + static_cast<uint32_t>(rng() % 50);
+      got = m.replace(id, px, qty);
+      exp = ref.replace(id, px, qty, want);
+    }
+    else
+    {
+      OrderRequest o;
+      o.id = next_id++;
+      o.side = rng() & 1 ? Side::Bid : Side::Ask;
+      o.px = 1000 + static_cast<int64_t>(rng() % 40);
+      o.qty = 1 + static_cast<uint32_t>(rng() % 60);
+      const uint64_t t = rng() % 100;
+      o.type = t < 60 ? OrderType::Limit
+               : t < 70 ? OrderType::IOC
+               : t < 78 ? OrderType::FOK
+               : t < 93 ? OrderType::PostOnly
+                        : OrderType::Market;
+      got = m.submit(o);
+      exp = ref.submit(o, want);
+      if (got.resting)
+        live.push_back(o.id);
+    }
+    const auto f = m.fills();
+    if (!same(got, exp) || f.size() != want.size())
+      return fail("result disagrees at step " + std::to_string(i));
+    for (size_t j = 0; j < f.size(); ++j)
+      if (f[j].maker_id != want[j].maker_id || f[j].px != want[j].px || f[j].qty != want[j].qty)
+        return fail("fill " + std::to_string(j) + " disagrees at step " + std::to_string(i));
+    fills += f.size();
+  }
+  // Books agree level by level.
+  for (const Side s : {Side::Bid, Side::Ask})
+  {
+    const auto &lv = m.book().levels(s);
+    const auto &rb = ref.side[s == Side::Bid ? 0 : 1];
+    if (lv.size() != rb.size())
+      return fail("level count differs");
+    for (const Level &l : lv)
+    {
+      auto it = rb.find(l.px);
+      uint64_t q = 0;
+      if (it == rb.end())
+        return fail("level missing from reference");
+      for (auto &r : it->second)
+        q += r.qty;
+      if (q != l.qty || it->second.size() != l.count)
+        return fail("level contents differ");
+    }
+  }
+  // Crossed books never rest.
+  if (!m.book().bids().empty() && !m.book().asks().empty() &&
+      m.book().bids().back().px >= m.book().asks().back().px)
+    return fail("book left crossed");
+
+  std::cout << "matching engine ok: " << fills << " fills, " << m.book().size() << " resting" << std::endl;
+  return 0;
+}
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: Apache-2.0
+// Message trace: the columnar file has the documented header, column table
+// and 64-byte aligned columns, a full buffer counts instead of growing, and
+// `replay --trace-out` writes one row per golden event whose depth columns
+// add up to the final book and whose unflagged rows are exactly the
+// latency percentile samples.
+#include "message_trace.hpp"
+#include "test_util.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace lob;
+using namespace lob::test;
+
+namespace
+{
+  struct Trace
+  {
+    std::vector<uint8_t> bytes;
+    TraceHeader h{};
+    std::map<std::string, TraceColumn> cols;
+    std::vector<std::string> order;
+
+    uint64_t at(const std::string &name, size_t row) const
+    {
+      const TraceColumn &c = cols.at(name);
+      uint64_t v = 0;
+      std::memcpy(&v, bytes.data() + c.offset + row * c.width, c.width);
+      return v;
+    }
+  };
+
+  bool load(const std::string &path, Trace &t, std::string &why)
+  {
+    std::ifstream f(path, std::ios::binary);
+    t.bytes.assign(std::istreambuf_iterator<char>(f), {});
+    if (t.bytes.size() < sizeof(TraceHeader))
+      return why = "short file", false;
+    std::memcpy(&t.h, t.bytes.data(), sizeof(t.h));
+    if (std::memcmp(t.h.magic, kTraceMagic, 8) != 0 || t.h.version != kTraceVersion ||
+        t.h.header_bytes != sizeof(TraceHeader) || t.h.column_count != kTraceColumnCount ||
+        t.h.file_bytes != t.bytes.size())
+      return why = "bad header", false;
+    for (uint32_t c = 0; c < t.h.column_count; ++c)
+    {
+      TraceColumn col;
+      std::memcpy(&col, t.bytes.data() + sizeof(TraceHeader) + c * sizeof(TraceColumn), sizeof(col));
+      const std::string name(col.name, strnlen(col.name, sizeof(col.name)));
+      const char kind = col.width == 1 ? '|' : '<';
+      if (col.offset % 64 != 0 || col.offset + t.h.row_count * col.width > t.bytes.size() ||
+          col.dtype[0] != kind || col.dtype[1] != 'u' || col.dtype[2] != char('0' + col.width))
+        return why = "bad column " + name, false;
+      t.cols[name] = col;
+      t.order.push_back(name);
+    }
+    return true;
+  }
+} // namespace
+
+int main()
+{
+  // Three rows fit; the next two are only counted.
+  MessageTrace small(3);
+  const std::array<uint32_t, kStageCount> stages{1, 2, 3, 4, 5};
+  for (uint64_t i = 0; i < 5; ++i)
+    small.record(100 + i, static_cast<uint8_t>(i % 4), static_cast<uint16_t>(i), kTraceApplied,
+                 i == 1 ? uint64_t{1} << 40 : 50 + i, stages, 7, 9, 11 + i);
+  uint64_t bytes = 0;
+  std::string err;
+  if (small.rows() != 3 || small.dropped() != 2 || !small.write("message_trace_small.bin", bytes, err))
+    return fail("small trace: " + err);
+  Trace t;
+  if (!load("message_trace_small.bin", t, err))
+    return fail("small trace: " + err);
+  std::remove("message_trace_small.bin");
+  const std::vector<std::string> want = {"msg_index",  "type",     "symbol",       "flags",      "total_ns",
+                                         "decode_ns",  "book_ns",  "detectors_ns", "breaker_ns", "publish_ns",
+                                         "bid_levels", "ask_levels", "orders"};
+  if (t.order != want || bytes != t.bytes.size())
+    return fail("column table");
+  if (t.h.row_count != 3 || t.h.dropped != 2 || t.h.first_msg != 100 || t.at("msg_index", 2) != 102 ||
+      t.at("symbol", 2) != 2 || t.at("total_ns", 1) != UINT32_MAX || t.at("breaker_ns", 0) != 4 ||
+      t.at("orders", 2) != 13 || t.at("ask_levels", 0) != 9)
+    return fail("small trace values");
+
+  int rc = -1;
+  const std::string out = run(std::string(REPLAY_BIN_PATH) + " --trace-rows 5", rc);
+  if (rc == 0 || out.find("--trace-rows requires --trace-out") == std::string::npos)
+    return fail("--trace-rows accepted without --trace-out:\n" + out);
+
+  const ReplayRun ref = replay_golden("message_trace_art");
+  const ReplayRun traced = replay_golden("message_trace_art", "--trace-out message_trace.bin");
+  if (traced.rc != 0 || !same_digests(traced.out, ref) ||
+      traced.out.find("trace rows=125000 dropped=0") == std::string::npos)
+    return fail("replay --trace-out:\n" + traced.out);
+  if (!load("message_trace.bin", t, err))
+    return fail("replay trace: " + err);
+  std::remove("message_trace.bin");
+
+  const size_t n = t.h.row_count;
+  std::map<uint64_t, uint64_t> last_orders;
+  size_t plain = 0, applied = 0;
+  for (size_t r = 0; r < n; ++r)
+  {
+    const uint64_t flags = t.at("flags", r);
+    if (t.at("msg_index", r) != r || t.at("type", r) > 3 || t.at("symbol", r) >= 8)
+      return fail("row " + std::to_string(r) + " header columns");
+    uint64_t stage_sum = 0;
+    for (const char *s : {"decode_ns", "book_ns", "detectors_ns", "breaker_ns", "publish_ns"})
+      stage_sum += t.at(s, r);
+    if (!(flags & kTraceStaged) && stage_sum != 0)
+      return fail("row " + std::to_string(r) + " has stage times but is not stage-timed");
+    if ((flags & kTraceStaged) && stage_sum > t.at("total_ns", r))
+      return fail("row " + std::to_string(r) + " stages exceed its interval");
+    plain += (flags & (kTraceStaged | kTracePerf)) == 0;
+    applied += (flags & kTraceApplied) != 0;
+    last_orders[t.at("symbol", r)] = t.at("orders", r);
+  }
+  uint64_t orders = 0;
+  for (const auto &[sym, o] : last_orders)
+    orders += o;
+  if (traced.out.find("samples=" + std::to_string(plain) + " ") == std::string::npos)
+    return fail(std::to_string(plain) + " unflagged rows do not match the percentile samples:\n" + traced.out);
+  if (traced.out.find("book_orders=" + std::to_string(orders) + " ") == std::string::npos || applied == 0)
+    return fail("depth columns end at " + std::to_string(orders) + " orders:\n" + traced.out);
+
+  std::cout << "message trace ok: " << n << " rows, " << applied << " applied" << std::endl;
+  return 0;
+}
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: Apache-2.0
+// Message dispatch: header + per-type body decode reproduces decode_event()
+// field for field, the dispatch chain drives a book to the same state as
+// apply_event(), and a build listing only some types rejects the rest
+// without instantiating their handlers.
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "msg_dispatch.hpp"
+#include "test_util.hpp"
+
+using namespace lob;
+using namespace lob::test;
+
+namespace
+{
+  static_assert(kMsgLayout<MsgType::Add>.side && kMsgLayout<MsgType::Add>.price && kMsgLayout<MsgType::Add>.qty);
+  static_assert(!kMsgLayout<MsgType::Cancel>.price && kMsgLayout<MsgType::Cancel>.qty);
+  static_assert(!kMsgLayout<MsgType::Delete>.side && !kMsgLayout<MsgType::Delete>.qty);
+  static_assert(FullDispatch::handles(MsgType::Execute));
+
+  // A handler family with only Add defined: dispatching on it compiles only
+  // because unlisted types never instantiate their handler.
+  struct Count
+  {
+    uint64_t adds{0};
+  };
+  template <MsgType T>
+  struct AddsOnly;
+  template <>
+  struct AddsOnly<MsgType::Add>
+  {
+    static bool apply(Count &c, const Event &) { return ++c.adds, true; }
+  };
+  using AddFeed = BasicMsgDispatch<Count, AddsOnly, MsgType::Add>;
+  static_assert(AddFeed::handles(MsgType::Add) && !AddFeed::handles(MsgType::Delete));
+
+  bool same(const Event &a, const Event &b, MsgType t)
+  {
+    const bool header = a.ts_ns == b.ts_ns && a.ref == b.ref && a.symbol == b.symbol && a.type == b.type;
+    switch (t)
+    {
+    case MsgType::Add:
+      return header && a.side == b.side && a.px == b.px && a.qty == b.qty;
+    case MsgType::Execute:
+    case MsgType::Cancel:
+      return header && a.qty == b.qty;
+    case MsgType::Delete:
+      return header;
+    }
+    return false;
+  }
+
+  template <MsgType T>
+  Event decode_as(const uint8_t *p, uint64_t i)
+  {
+    Event e = decode_header(p, i);
+    decode_body<T>(p, e);
+    return e;
+  }
+} // namespace
+
+int main()
+{
+  constexpr size_t kN = 300'000;
+  std::vector<uint8_t> buf(kN * kEventSize);
+  std::mt19937_64 rng(5);
+  for (size_t i = 0; i < buf.size(); i += 8)
+  {
+    const uint64_t w = rng();
+    std::memcpy(buf.data() + i, &w, 8);
+  }
+
+  std::array<OrderBook, kSymbolCount> want, chain;
+  OrderBook adds_via_subset;
+  Count count;
+  uint64_t accepted = 0, subset_adds = 0;
+  for (size_t i = 0; i < kN; ++i)
+  {
+    const uint8_t *p = buf.data() + i * kEventSize;
+    const Event full = decode_event(p, i);
+    Event e = decode_header(p, i);
+    if (e.type != full.type)
+      return fail("header type mismatch at " + std::to_string(i));
+    Event body;
+    switch (e.type)
+    {
+    case MsgType::Add:
+      body = decode_as<MsgType::Add>(p, i);
+      break;
+    case MsgType::Execute:
+      body = decode_as<MsgType::Execute>(p, i);
+      break;
+    case MsgType::Cancel:
+      body = decode_as<MsgType::Cancel>(p, i);
+      break;
+    case MsgType::Delete:
+      body = decode_as<MsgType::Delete>(p, i);
+      break;
+    }
+    if (!same(body, full, e.type))
+      return fail("body decode mismatch at " + std::to_string(i));
+
+    const bool ok = apply_event(want[full.symbol], full);
+    accepted += ok;
+    Event a = e, c = e;
+    if (FullDispatch::apply(chain[e.symbol], p, a) != ok)
+      return fail("dispatch result differs at " + std::to_string(i));
+
+    // Adds and deletes only: executions and cancels are refused untouched.
+    const bool sub = MsgDispatch<MsgType::Add, MsgType::Delete>::apply(adds_via_subset, p, c);
+    if ((e.type == MsgType::Cancel || e.type == MsgType::Execute) && sub)
+      return fail("subset dispatch applied an unlisted type");
+    Event d = e;
+    subset_adds += AddFeed::apply(count, p, d);
+  }
+  for (size_t s = 0; s < kSymbolCount; ++s)
+    if (chain[s].digest() != want[s].digest())
+      return fail("book " + std::to_string(s) + " diverged from apply_event");
+  if (subset_adds != count.adds || count.adds == 0 || count.adds > kN / 3)
+    return fail("adds-only dispatch counted " + std::to_string(count.adds));
+
+  std::cout << "msg dispatch ok: " << accepted << " of " << kN << " events applied, " << count.adds << " adds"
+            << std::endl;
+  return 0;
+}
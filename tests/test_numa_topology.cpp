@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: Apache-2.0
+// NUMA: cpulist parsing, topology discovery over a fake two-socket sysfs
+// tree and the live one, page placement queries, huge-page mappings bound
+// to a preferred node, and `replay --cpu-pin` reporting its node.
+#include "huge_pages.hpp"
+#include "numa_topology.hpp"
+#include "test_util.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace lob;
+using namespace lob::test;
+
+namespace
+{
+  void put(const std::filesystem::path &p, const std::string &text)
+  {
+    std::filesystem::create_directories(p.parent_path());
+    std::ofstream(p) << text;
+  }
+} // namespace
+
+int main()
+{
+  std::vector<int> cpus;
+  if (!parse_cpulist("0-3,8,10-11\n", cpus) || cpus != std::vector<int>{0, 1, 2, 3, 8, 10, 11})
+    return fail("cpulist range parse");
+  for (const char *bad : {"3-1", "a", "1,,2", "1-", "-1"})
+  {
+    std::vector<int> v;
+    if (parse_cpulist(bad, v))
+      return fail(std::string("accepted cpulist ") + bad);
+  }
+
+  // Two sockets, interleaved SMT siblings, node 1 with a hole in its ids.
+  const auto root = std::filesystem::temp_directory_path() / "lob_numa_sysfs";
+  std::filesystem::remove_all(root);
+  put(root / "online", "0,2\n");
+  put(root / "node0/cpulist", "0-3,8-11\n");
+  put(root / "node0/meminfo", "Node 0 MemTotal:       16318480 kB\nNode 0 MemFree:  1 kB\n");
+  put(root / "node2/cpulist", "4-7,12-15\n");
+  put(root / "node2/meminfo", "Node 2 MemTotal:       8159240 kB\n");
+  const NumaTopology fake = discover_numa(root.string());
+  std::filesystem::remove_all(root);
+  if (fake.nodes.size() != 2 || fake.nodes[1].id != 2 || fake.nodes[0].cpus.size() != 8 ||
+      fake.nodes[0].mem_bytes != 16318480ull * 1024 || fake.node_of_cpu(9) != 0 || fake.node_of_cpu(12) != 2 ||
+      fake.node_of_cpu(16) != -1)
+    return fail("fake topology");
+  if (!discover_numa("/nonexistent").nodes.empty())
+    return fail("topology from nowhere");
+
+  const NumaTopology live = discover_numa();
+  std::cout << "live topology: " << live.nodes.size() << " node(s)" << std::endl;
+
+#ifdef __linux__
+  // Every resident page is on exactly one node.
+  std::vector<char> touched(8 << 20, 1);
+  double total = 0.0;
+  for (const NumaNode &n : live.nodes)
+    total += fraction_on_node(touched.data(), touched.size(), n.id);
+  if (!live.nodes.empty() && (total < 0.999 || total > 1.001))
+    return fail("page placement fractions sum to " + std::to_string(total));
+
+  // Mappings made with a preferred node are bound to it and land there.
+  std::string why;
+  if (!live.nodes.empty() && huge_pages_available(why))
+  {
+    const int node = live.nodes.back().id;
+    set_huge_page_policy(HugePagePolicy::automatic);
+    set_huge_page_node(node);
+    HugeVector<uint64_t> v(1 << 20, 7);
+    const HugePageReport r = huge_page_report();
+    set_huge_page_node(-1);
+    set_huge_page_policy(HugePagePolicy::off);
+    if (r.node != node || r.node_bound_bytes < v.size() * sizeof(uint64_t))
+      return fail("mapping not bound to node " + std::to_string(node));
+    const double local = fraction_on_node(v.data(), v.size() * sizeof(uint64_t), node);
+    if (local < 0.99)
+      return fail("bound mapping only " + std::to_string(local) + " on its node");
+  }
+#endif
+
+  // Placement is reported on stderr only for pinned (or --verbose) runs.
+  const ReplayRun plain = replay_golden("numa_art");
+  if (plain.rc != 0 || plain.out.find("numa nodes=") != std::string::npos)
+    return fail("unpinned replay printed its NUMA placement:\n" + plain.out);
+  const ReplayRun pinned = replay_golden("numa_art", "--cpu-pin 0");
+  if (pinned.rc != 0 || !same_digests(pinned.out, plain) || pinned.out.find("numa nodes=") == std::string::npos)
+    return fail("replay --cpu-pin 0 changed the run:\n" + pinned.out);
+  const std::string &jsonl = pinned.jsonl, &prom = pinned.prom;
+  const std::string last = jsonl.substr(jsonl.rfind('\n', jsonl.size() - 2) + 1);
+  const std::string node = std::to_string(live.node_of_cpu(0));
+  if (last.find("\"numa_nodes\":" + std::to_string(live.nodes.size()) + ",\"numa_node\":" + node + ",") ==
+          std::string::npos ||
+      prom.find("lob_numa_node " + node + "\n") == std::string::npos)
+    return fail("numa placement not reported:\n" + last + prom);
+  if (live.node_of_cpu(0) >= 0 && prom.find("lob_numa_input_local_ratio 1\n") == std::string::npos)
+    return fail("input buffer not on the pinned core's node:\n" + prom);
+  std::cout << "numa topology ok" << std::endl;
+  return 0;
+}
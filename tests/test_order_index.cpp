@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: Apache-2.0
+// Order index: the open-addressing map agrees with std::unordered_map under
+// random inserts and erases (backward-shift deletion keeps every probe run
+// reachable), prefetch hints never change a book, and `replay
+// --prefetch-distance` keeps the golden digest and reports its distance.
+#include "event.hpp"
+#include "order_book.hpp"
+#include "order_index.hpp"
+#include "test_util.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace lob;
+using namespace lob::test;
+
+int main()
+{
+  OrderIndex idx;
+  if (idx.find(7) != OrderIndex::kNil || idx.erase(7) || idx.size() != 0)
+    return fail("empty index");
+  idx.prefetch(7);
+
+  // Ids drawn from a small range so runs collide, grow and shrink; a few
+  // sequential blocks mimic exchange-assigned ids.
+  std::unordered_map<uint64_t, uint32_t> want;
+  std::mt19937_64 rng(11);
+  for (uint32_t step = 0; step < 400'000; ++step)
+  {
+    const uint64_t id = step % 50'000 < 1000 ? step : rng() % 20'000;
+    const bool present = want.count(id) != 0;
+    if (rng() % 3 != 0)
+    {
+      if (idx.insert(id, step) == present)
+        return fail("insert of " + std::to_string(id) + " disagreed");
+      want.emplace(id, step);
+    }
+    else if (idx.erase(id) != present)
+      return fail("erase of " + std::to_string(id) + " disagreed");
+    else
+      want.erase(id);
+    if (step % 4096 == 0)
+    {
+      if (idx.size() != want.size())
+        return fail("size " + std::to_string(idx.size()) + " vs " + std::to_string(want.size()));
+      for (const auto &[k, v] : want)
+        if (idx.find(k) != v)
+          return fail("lost id " + std::to_string(k) + " at step " + std::to_string(step));
+    }
+  }
+  for (uint64_t id = 0; id < 30'000; ++id)
+  {
+    auto f = want.find(id);
+    if (idx.find(id) != (f == want.end() ? OrderIndex::kNil : f->second))
+      return fail("final lookup of " + std::to_string(id));
+  }
+  const size_t cap = idx.capacity();
+  idx.clear();
+  if (idx.size() != 0 || idx.capacity() != cap)
+    return fail("clear");
+  for (const auto &[k, v] : want)
+    if (idx.contains(k))
+      return fail("clear kept id " + std::to_string(k));
+  idx.reserve(1000);
+  if (idx.capacity() < 2000)
+    return fail("reserve(1000) left capacity " + std::to_string(idx.capacity()));
+
+  // Prefetch hints, including for ids that are absent, are invisible.
+  std::vector<uint8_t> buf(200'000 * kEventSize);
+  for (size_t i = 0; i < buf.size(); i += 8)
+  {
+    const uint64_t w = rng();
+    std::memcpy(buf.data() + i, &w, 8);
+  }
+  OrderBook plain, hinted;
+  for (size_t i = 0; i < buf.size() / kEventSize; ++i)
+  {
+    const Event e = decode_event(buf.data() + i * kEventSize, i);
+    hinted.prefetch_index(e.ref);
+    hinted.prefetch_order(e.ref);
+    hinted.prefetch_order(e.ref + 1);
+    if (apply_event(plain, e) != apply_event(hinted, e))
+      return fail("prefetch changed an apply result at " + std::to_string(i));
+  }
+  if (plain.digest() != hinted.digest() || plain.size() != hinted.size())
+    return fail("prefetch changed the book");
+
+  int rc = -1;
+  const std::string out = run(std::string(REPLAY_BIN_PATH) + " --prefetch-distance 257", rc);
+  if (rc == 0 || out.find("Invalid value for --prefetch-distance") == std::string::npos)
+    return fail("--prefetch-distance 257 accepted:\n" + out);
+  const ReplayRun ref = replay_golden("order_index_art");
+  ReplayRun r;
+  for (const char *k : {"1", "16"})
+  {
+    r = replay_golden("order_index_art", std::string("--prefetch-distance ") + k);
+    if (r.rc != 0 || !same_digests(r.out, ref))
+      return fail(std::string("replay --prefetch-distance ") + k + " changed the run:\n" + r.out);
+  }
+  if (r.jsonl.find("\"prefetch_distance\":16,") == std::string::npos ||
+      r.prom.find("lob_prefetch_distance 16\n") == std::string::npos)
+    return fail("prefetch distance not reported:\n" + r.prom);
+
+  std::cout << "order index ok" << std::endl;
+  return 0;
+}
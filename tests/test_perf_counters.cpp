@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: Apache-2.0
+// Perf counters: a software-event group exercises open/enable/read and the
+// region arithmetic on any Linux host; the hardware group must either count
+// or say why not, and `replay --perf-counters` must keep the golden digest
+// and report the counters (or the reason they are missing) in its artifacts.
+#include "perf_counters.hpp"
+#include "test_util.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#endif
+
+int main()
+{
+  using namespace lob;
+  using namespace lob::test;
+#ifdef __linux__
+  // task-clock and page-faults exist wherever perf_event_open does.
+  static constexpr PerfEventSpec kSoftware[] = {
+      {"task_clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+      {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+      {"bogus", PERF_TYPE_SOFTWARE, 0xFFFF},
+  };
+  PerfCounterGroup sw;
+  if (sw.open(kSoftware))
+  {
+    if (sw.size() != 3 || !sw.available(0) || !sw.available(1) || sw.available(2))
+      return fail("unsupported group member was not dropped on its own");
+    PerfReading a, b;
+    if (!sw.enable() || !sw.read(a))
+      return fail("software group did not enable/read");
+    std::vector<char> touch(64 << 20);
+    for (size_t i = 0; i < touch.size(); i += 4096)
+      touch[i] = 1;
+    if (!sw.read(b) || b.value[0] <= a.value[0] || b.value[1] < a.value[1] + 1000 || b.value[2] != 0)
+      return fail("software counters did not advance");
+    PerfRegion r;
+    r.add(a, b, calibrate(sw), sw.size());
+    if (r.samples != 1 || r.total[1] == 0 || r.total[1] > b.value[1] - a.value[1])
+      return fail("region arithmetic");
+    std::cout << "software group: page_faults=" << r.total[1] << " for 64 MiB" << std::endl;
+  }
+  else
+    std::cout << "software group unavailable: " << sw.error() << std::endl;
+#endif
+
+  PerfCounterGroup hw;
+  const bool hw_ok = hw.open(hardware_perf_events());
+  if (hw_ok != hw.error().empty())
+    return fail("hardware group open() and error() disagree");
+  std::cout << "hardware group: " << (hw_ok ? "available" : hw.error()) << std::endl;
+
+  const ReplayRun ref = replay_golden("perf_counters_art");
+  const ReplayRun counted = replay_golden("perf_counters_art", "--perf-counters");
+  if (counted.rc != 0 || !same_digests(counted.out, ref))
+    return fail("replay --perf-counters changed the run:\n" + counted.out);
+  const std::string &out = counted.out, &jsonl = counted.jsonl, &prom = counted.prom;
+  const std::string last = jsonl.substr(jsonl.rfind('\n', jsonl.size() - 2) + 1);
+  if (hw_ok)
+  {
+    if (last.find("\"perf_available\":true,\"perf_ipc\":") == std::string::npos ||
+        prom.find("lob_perf_per_msg{counter=\"cycles\"}") == std::string::npos ||
+        prom.find("lob_perf_stage_per_msg{stage=\"apply\"") == std::string::npos)
+      return fail("counters available but not exported:\n" + prom);
+  }
+  else if (last.find("\"perf_available\":false,\"perf_error\":") == std::string::npos ||
+           prom.find("lob_perf_available 0") == std::string::npos ||
+           out.find("perf counters unavailable") == std::string::npos)
+    return fail("unavailable counters not reported:\n" + out + prom);
+  std::cout << "perf counters ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: Apache-2.0
+// Realtime mode: pre-faulting keeps contents and removes later faults, core
+// isolation is read from the cpulists, and `replay --realtime` keeps the
+// golden digest, reports what it obtained, and - with memory locked - runs
+// its hot loop without a single page fault.
+#include "order_book.hpp"
+#include "realtime.hpp"
+#include "test_util.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+
+using namespace lob;
+using namespace lob::test;
+
+int main()
+{
+  const auto root = std::filesystem::temp_directory_path() / "lob_rt_sysfs";
+  std::filesystem::create_directories(root);
+  std::ofstream(root / "isolated") << "2-3,6\n";
+  std::ofstream(root / "nohz_full") << "\n";
+  const bool iso3 = cpu_listed("isolated", 3, root.string()), iso4 = cpu_listed("isolated", 4, root.string());
+  const bool nohz = cpu_listed("nohz_full", 3, root.string()), missing = cpu_listed("missing", 3, root.string());
+  std::filesystem::remove_all(root);
+  if (!iso3 || iso4 || nohz || missing || cpu_listed("isolated", -1))
+    return fail("cpulist membership");
+
+#ifdef __linux__
+  // A fresh anonymous mapping faults on first write; once pre-faulted it
+  // does not, and pre-faulting leaves the bytes alone.
+  const size_t len = 16 << 20;
+  auto *p = static_cast<unsigned char *>(
+      mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (p == MAP_FAILED)
+    return fail("mmap");
+  madvise(p, len, MADV_NOHUGEPAGE);
+  p[0] = 42;
+  const FaultCounts a = thread_faults();
+  prefault(p, len);
+  const FaultCounts b = thread_faults();
+  for (size_t i = 0; i < len; i += 4096)
+    p[i] = static_cast<unsigned char>(i);
+  const FaultCounts c = thread_faults();
+  if (b.minor - a.minor < len / 4096 / 2 || c.minor - b.minor > 16)
+    return fail("prefault: " + std::to_string(b.minor - a.minor) + " faults while touching, " +
+                std::to_string(c.minor - b.minor) + " after");
+  munmap(p, len);
+#endif
+
+  // A pre-faulted book behaves exactly like a fresh one.
+  OrderBook fresh, warmed;
+  warmed.reserve(1 << 16);
+  warmed.prefault();
+  for (uint64_t id = 1; id <= 50'000; ++id)
+    for (OrderBook *bk : {&fresh, &warmed})
+    {
+      bk->add(id, id % 2 ? Side::Bid : Side::Ask, id % 2 ? 100 - int64_t(id % 7) : 101 + int64_t(id % 7), 10);
+      if (id % 3 == 0)
+        bk->erase(id - 1);
+    }
+  if (fresh.digest() != warmed.digest())
+    return fail("prefault changed the book");
+
+  int rc = -1;
+  std::string out = run(std::string(REPLAY_BIN_PATH) + " --rt-priority 10", rc);
+  if (rc == 0 || out.find("--rt-priority requires --realtime") == std::string::npos)
+    return fail("--rt-priority accepted without --realtime:\n" + out);
+  out = run(std::string(REPLAY_BIN_PATH) + " --realtime --rt-priority 0", rc);
+  if (rc == 0 || out.find("Invalid value for --rt-priority") == std::string::npos)
+    return fail("--rt-priority 0 accepted:\n" + out);
+
+  // Fault counts reach stderr only for --realtime (or --verbose) runs.
+  const ReplayRun plain = replay_golden("realtime_art");
+  if (plain.rc != 0 || plain.out.find("faults loop_minor=") != std::string::npos)
+    return fail("plain replay printed its fault counts:\n" + plain.out);
+  const ReplayRun rt = replay_golden("realtime_art", "--realtime --cpu-pin 0");
+  if (rt.rc != 0 || !same_digests(rt.out, plain) || rt.out.find("faults loop_minor=") == std::string::npos)
+    return fail("replay --realtime changed the run:\n" + rt.out);
+  const std::string &jsonl = rt.jsonl, &prom = rt.prom;
+  const std::string last = jsonl.substr(jsonl.rfind('\n', jsonl.size() - 2) + 1);
+  if (last.find("\"faults_minor_before\":") == std::string::npos ||
+      last.find("\"faults_major_after\":") == std::string::npos ||
+      last.find("\"realtime\":true,\"rt_mlock\":") == std::string::npos ||
+      last.find("\"rt_isolated\":") == std::string::npos || prom.find("lob_realtime_mlock ") == std::string::npos)
+    return fail("realtime run not reported:\n" + last + prom);
+  if (last.find("\"rt_mlock\":true") != std::string::npos)
+  {
+    if (prom.find("lob_loop_page_faults{kind=\"minor\"} 0\n") == std::string::npos ||
+        prom.find("lob_loop_page_faults{kind=\"major\"} 0\n") == std::string::npos)
+      return fail("locked hot loop still faulted:\n" + prom);
+    std::cout << "memory locked, hot loop fault-free" << std::endl;
+  }
+  else
+    std::cout << "mlockall not permitted here; fault counts reported only" << std::endl;
+  std::cout << "realtime ok" << std::endl;
+  return 0;
+}
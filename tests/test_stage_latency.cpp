@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: Apache-2.0
+// Stage timers: histogram quantiles stay within one bucket of the exact
+// order statistic, a compiled-out lap records nothing, and a replay exports
+// every stage as labeled quantile series without changing the digest.
+#include "stage_timer.hpp"
+#include "test_util.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace lob;
+using namespace lob::test;
+
+int main()
+{
+  // Bucket edges: every value lands in a bucket whose upper edge is >= it
+  // and within 1/16 of it.
+  for (uint64_t v : {uint64_t{0}, uint64_t{1}, uint64_t{15}, uint64_t{16}, uint64_t{17}, uint64_t{31},
+                     uint64_t{32}, uint64_t{33}, uint64_t{1000}, uint64_t{123456789}, uint64_t{1} << 39})
+  {
+    const uint64_t up = LatencyHistogram::upper(LatencyHistogram::index(v));
+    if (up < v || double(up - v) > double(v) / 16.0 + 1.0)
+      return fail("bucket of " + std::to_string(v) + " has upper edge " + std::to_string(up));
+  }
+
+  // Quantiles against exact order statistics of a skewed sample.
+  LatencyHistogram h;
+  std::vector<uint64_t> v;
+  std::mt19937_64 rng(7);
+  std::lognormal_distribution<double> dist(5.0, 1.2);
+  for (int i = 0; i < 200'000; ++i)
+  {
+    const auto ns = static_cast<uint64_t>(dist(rng));
+    v.push_back(ns);
+    h.record(ns);
+  }
+  std::sort(v.begin(), v.end());
+  for (double q : {0.5, 0.9, 0.99, 0.999})
+  {
+    const uint64_t exact = v[static_cast<size_t>(q * double(v.size() - 1))];
+    const uint64_t got = h.quantile(q);
+    if (got < exact || double(got - exact) > double(exact) / 16.0 + 1.0)
+      return fail("q" + std::to_string(q) + ": " + std::to_string(got) + " vs exact " + std::to_string(exact));
+  }
+
+  // A lap compiled out (or inactive) reads no clock and records nothing.
+  StageHistograms hs;
+  {
+    BasicStageLap<false> off(hs, std::chrono::steady_clock::now());
+    off.mark(Stage::decode);
+    BasicStageLap<true> idle(hs, std::chrono::steady_clock::now(), false);
+    idle.mark(Stage::book);
+    BasicStageLap<true> on(hs, std::chrono::steady_clock::now());
+    on.mark(Stage::decode);
+    on.mark(Stage::book);
+  }
+  if (hs[0].count() != 1 || hs[1].count() != 1 || hs[2].count() != 0)
+    return fail("lap recorded into the wrong stages");
+
+  // The replay exports one series per stage and quantile, and prints the
+  // stage summary only under --verbose.
+  const ReplayRun quiet = replay_golden("stage_latency_art");
+  if (quiet.rc != 0 || quiet.out.find("stages ") != std::string::npos)
+    return fail("stage summary printed without --verbose:\n" + quiet.out);
+  const ReplayRun verbose = replay_golden("stage_latency_art", "--verbose");
+  if (verbose.rc != 0 || !same_digests(verbose.out, quiet))
+    return fail("replay failed or digest changed:\n" + verbose.out);
+  if (kStageTimers && verbose.out.find("stages decode_p50_ns=") == std::string::npos)
+    return fail("--verbose did not print the stage summary:\n" + verbose.out);
+  const std::string &prom = verbose.prom, &jsonl = verbose.jsonl;
+  if (!kStageTimers)
+  {
+    if (prom.find("lob_stage_latency_ns") != std::string::npos)
+      return fail("stage series exported with stage timers compiled out");
+    std::cout << "stage timers compiled out" << std::endl;
+    return 0;
+  }
+  const uint64_t events = 125000;
+  for (const char *stage : kStageNames)
+  {
+    for (const char *q : {"0.5", "0.99", "0.999"})
+      if (prom.find("lob_stage_latency_ns{stage=\"" + std::string(stage) + "\",quantile=\"" + q + "\"} ") ==
+          std::string::npos)
+        return fail(std::string("missing ") + stage + " quantile " + q + ":\n" + prom);
+    const std::string key = "lob_stage_latency_ns_count{stage=\"" + std::string(stage) + "\"} ";
+    const auto at = prom.find(key);
+    if (at == std::string::npos || std::stoull(prom.substr(at + key.size())) != events / kStageTimerStride)
+      return fail(std::string("wrong sample count for ") + stage);
+    if (jsonl.find("\"stage_" + std::string(stage) + "_p999_ns\":") == std::string::npos)
+      return fail(std::string("bench.jsonl lacks stage ") + stage);
+  }
+  std::cout << "stage latency ok" << std::endl;
+  return 0;
+}
@@ -26,6 +26,11 @@ int main()
   t.readings.gap_rate = 0.1;
   t.breaker = BreakerState::Fuse;
   t.publish_allowed = true;
+  t.snapshots = 3;
+  t.cow_faults = 42;
+  t.feed_active = true;
+  t.feed_batch_hist = {0, 2, 3, 0, 1}; // values 1, 2-3, 8-15
+  t.feed_batch_sum = 20;
 
   const std::string out_dir = "tests/out";
   const std::string json_file = out_dir + "/telemetry.jsonl";
@@ -87,6 +92,21 @@ int main()
     return 6;
   }
 
+  if (prom_contents.find("lob_snapshot_cow_faults_total 42") == std::string::npos ||
+      contents.find("\"snapshots\":3") == std::string::npos)
+  {
+    std::cerr << "snapshot telemetry not found" << std::endl;
+    return 6;
+  }
+
+  if (prom_contents.find("lob_feed_batch_size_bucket{le=\"3\"} 5") == std::string::npos ||
+      prom_contents.find("lob_feed_batch_size_bucket{le=\"15\"} 6") == std::string::npos ||
+      prom_contents.find("lob_feed_batch_size_count 6") == std::string::npos)
+  {
+    std::cerr << "feed batch histogram not found in prom file" << std::endl;
+    return 6;
+  }
+
   std::cout << "telemetry io test passed" << std::endl;
   return 0;
 }
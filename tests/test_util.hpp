@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: Apache-2.0
+// Helpers shared by the standalone test programs: report a failure, run a
+// command (usually replay) with stderr folded into its output, read an
+// artifact file whole, pick a field out of replay's summary, and replay the
+// golden sample into a private ART_DIR.
+#pragma once
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace lob::test
+{
+  // Prints what failed and returns main()'s exit code for it.
+  inline int fail(const std::string &what)
+  {
+    std::cerr << what << std::endl;
+    return 1;
+  }
+
+  inline std::string run(const std::string &cmd, int &rc)
+  {
+    std::string out;
+    FILE *pipe = popen((cmd + " 2>&1").c_str(), "r");
+    if (!pipe)
+      return out;
+    char buffer[512];
+    while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+      out += buffer;
+    rc = pclose(pipe);
+    return out;
+  }
+
+  // Empty if the file cannot be read.
+  inline std::string slurp(const std::string &path)
+  {
+    std::ifstream f(path);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+  }
+
+  // Value of a `key=` word in replay's output, up to the next space or
+  // newline; empty if absent.
+  inline std::string field(const std::string &out, const std::string &key)
+  {
+    const std::string tag = key + "=";
+    auto pos = out.find(tag);
+    while (pos != std::string::npos && pos != 0 && out[pos - 1] != ' ' && out[pos - 1] != '\n')
+      pos = out.find(tag, pos + 1);
+    if (pos == std::string::npos)
+      return {};
+    pos += tag.size();
+    return out.substr(pos, out.find_first_of(" \n", pos) - pos);
+  }
+
+#if defined(REPLAY_BIN_PATH) && defined(GOLDEN_INPUT_PATH)
+  struct ReplayRun
+  {
+    int rc{-1};
+    std::string out;
+    std::string jsonl;
+    std::string prom;
+  };
+
+  // Replays the golden sample with ART_DIR=art_dir (later --input options
+  // win) and collects bench.jsonl and metrics.prom, removing them so the
+  // next run starts clean.
+  inline ReplayRun replay_golden(const std::string &art_dir, const std::string &args = {})
+  {
+    ReplayRun r;
+    r.out = run("ART_DIR=" + art_dir + " " + REPLAY_BIN_PATH + " --input " + GOLDEN_INPUT_PATH + " " + args, r.rc);
+    r.jsonl = slurp(art_dir + "/bench.jsonl");
+    r.prom = slurp(art_dir + "/metrics.prom");
+    std::remove((art_dir + "/bench.jsonl").c_str());
+    std::remove((art_dir + "/metrics.prom").c_str());
+    return r;
+  }
+
+  // The golden sample's recorded event digest (the .fnv next to it), as
+  // replay prints it; empty if the file is missing.
+  inline std::string golden_fnv()
+  {
+    std::string path = GOLDEN_INPUT_PATH;
+    path.replace(path.rfind('.'), std::string::npos, ".fnv");
+    std::string hex;
+    std::ifstream(path) >> hex;
+    return hex.empty() ? hex : "0x" + hex;
+  }
+
+  // True if `out` ends on the recorded event digest and on the book of the
+  // plain reference run `ref`; the book digest has no recorded value.
+  inline bool same_digests(const std::string &out, const ReplayRun &ref)
+  {
+    const std::string fnv = golden_fnv();
+    const std::string book = field(ref.out, "book_digest");
+    return !fnv.empty() && !book.empty() && field(ref.out, "digest_fnv") == fnv &&
+           field(out, "digest_fnv") == fnv && field(out, "book_digest") == book;
+  }
+#endif
+} // namespace lob::test
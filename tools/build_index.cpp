@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: Apache-2.0
+// Scans a capture once and writes its seek index (<capture>.idx by default)
+// for `replay --symbol --from --to`.
+#include "capture_index.hpp"
+#include "event.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int main(int argc, char **argv)
+{
+    std::string in = "data/golden/itch_1m.bin";
+    std::string out;
+    unsigned long stride = lob::kDefaultIndexStride;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        if (a == "--input" && i + 1 < argc)
+            in = argv[++i];
+        else if (a == "--out" && i + 1 < argc)
+            out = argv[++i];
+        else if (a == "--stride" && i + 1 < argc)
+            stride = std::strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            std::cerr << "usage: build_index [--input <capture>] [--out <path>] [--stride <events>]\n"
+                      << "  --out defaults to <capture>.idx; --stride is events per time sample (default "
+                      << lob::kDefaultIndexStride << ")\n";
+            return a == "--help" || a == "-h" ? 0 : 1;
+        }
+    }
+    if (out.empty())
+        out = in + ".idx";
+    if (stride == 0 || stride > UINT32_MAX)
+    {
+        std::cerr << "Invalid value for --stride\n";
+        return 1;
+    }
+
+    const int fd = ::open(in.c_str(), O_RDONLY);
+    struct stat st{};
+    if (fd < 0 || ::fstat(fd, &st) != 0)
+    {
+        std::cerr << "cannot read " << in << "\n";
+        return 2;
+    }
+    const size_t n = static_cast<size_t>(st.st_size);
+    void *p = n ? ::mmap(nullptr, n, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+    ::close(fd);
+    if (p == MAP_FAILED)
+    {
+        std::cerr << "cannot map " << in << "\n";
+        return 2;
+    }
+    if (p)
+        ::madvise(p, n, MADV_SEQUENTIAL);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::string err;
+    const auto img = lob::build_capture_index({static_cast<const uint8_t *>(p), n}, static_cast<uint32_t>(stride), err);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    if (p)
+        ::munmap(p, n);
+    if (img.empty())
+    {
+        std::cerr << in << ": " << err << "\n";
+        return 2;
+    }
+    if (!lob::write_capture_index(out, img))
+    {
+        std::cerr << "cannot write " << out << "\n";
+        return 2;
+    }
+    std::cout << "index=" << out << " events=" << n / lob::kEventSize << " stride=" << stride << " bytes=" << img.size()
+              << " scan_ms=" << ms << "\n";
+    return 0;
+}